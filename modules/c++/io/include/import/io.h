@@ -52,6 +52,8 @@
  */
 
 #include <io/BidirectionalStream.h>
+#include <io/BufferedOutputStream.h>
+#include <io/BufferRingStreams.h>
 #include <io/BufferViewStream.h>
 #include <io/ByteStream.h>
 #include <io/DataStream.h>
@@ -74,7 +76,6 @@
 #include <io/RotatingFileOutputStream.h>
 #include <io/StreamSplitter.h>
 
-//#include "io/MMapInputStream.h"
-//using namespace io;
+#include <io/MMapInputStream.h>
 
 #endif
@@ -0,0 +1,147 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#ifndef CODA_OSS_io_BufferRingStreams_h_INCLUDED_
+#define CODA_OSS_io_BufferRingStreams_h_INCLUDED_
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <thread>
+
+#include "config/Exports.h"
+#include "sys/Conf.h"
+#include "mem/BufferRing.h"
+#include "io/InputStream.h"
+#include "io/OutputStream.h"
+
+/*!
+ *  \file BufferRingStreams.h
+ *  \brief Feed a mem::BufferRing from a stream, or drain one into a stream,
+ *         on a background thread
+ *
+ *  Together these overlap I/O with compute: while the caller works on one
+ *  block, the next ones are being read and the previous ones written.
+ */
+
+namespace io
+{
+/*!
+ *  \class BufferRingReader
+ *  \brief Fills the buffers of a ring from an InputStream on a background
+ *         thread
+ *
+ *  Each buffer is filled completely except for the last one, and the ring
+ *  is closed at the end of the stream.  If reading fails, the ring is
+ *  aborted and join() rethrows the error.
+ */
+class CODA_OSS_API BufferRingReader final
+{
+public:
+    //! Start reading.  input and ring must outlive this object.
+    BufferRingReader(InputStream& input, mem::BufferRing& ring);
+
+    //! Aborts the ring if the thread is still running
+    ~BufferRingReader();
+
+    BufferRingReader(const BufferRingReader&) = delete;
+    BufferRingReader& operator=(const BufferRingReader&) = delete;
+
+    //! Wait for the thread to finish, rethrowing its error
+    void join();
+
+private:
+    void run();
+
+    InputStream& mInput;
+    mem::BufferRing& mRing;
+    std::exception_ptr mError;
+    std::thread mThread;
+};
+
+/*!
+ *  \class BufferRingWriter
+ *  \brief Writes the buffers published to a ring to an OutputStream on a
+ *         background thread
+ *
+ *  The thread runs until the ring is closed and drained.  If writing fails,
+ *  the ring is aborted and join() rethrows the error.  The stream is
+ *  neither flushed nor closed.
+ */
+class CODA_OSS_API BufferRingWriter final
+{
+public:
+    //! Start writing.  ring and output must outlive this object.
+    BufferRingWriter(mem::BufferRing& ring, OutputStream& output);
+
+    //! Aborts the ring if the thread is still running
+    ~BufferRingWriter();
+
+    BufferRingWriter(const BufferRingWriter&) = delete;
+    BufferRingWriter& operator=(const BufferRingWriter&) = delete;
+
+    //! Wait for the thread to finish, rethrowing its error
+    void join();
+
+private:
+    void run();
+
+    mem::BufferRing& mRing;
+    OutputStream& mOutput;
+    std::exception_ptr mError;
+    std::thread mThread;
+};
+
+/*!
+ *  Transforms one block: given the input bytes, writes at most
+ *  outputCapacity bytes to output and returns how many it wrote.
+ */
+typedef std::function<size_t(const sys::byte* input,
+                             size_t inputSize,
+                             sys::byte* output,
+                             size_t outputCapacity)> BlockTransform;
+
+/*!
+ *  Read the input in blocks, transform each block on the calling thread,
+ *  and write the results, with the reads and writes running in the
+ *  background so that all three stages overlap.
+ *
+ *  \param input Stream to read
+ *  \param output Stream to write
+ *  \param transform Applied to each block in order
+ *  \param inputBlockSize Bytes per input block; only the last one can be
+ *         shorter
+ *  \param outputBlockSize Capacity of each output block
+ *  \param numBuffers Depth of each ring.  Defaults to 3, i.e. one block
+ *         each being read, transformed and written.
+ *
+ *  \throws The first error from reading, transforming or writing
+ */
+CODA_OSS_API void transformPipelined(InputStream& input,
+                                     OutputStream& output,
+                                     const BlockTransform& transform,
+                                     size_t inputBlockSize,
+                                     size_t outputBlockSize,
+                                     size_t numBuffers = 3);
+}
+
+#endif // CODA_OSS_io_BufferRingStreams_h_INCLUDED_
@@ -0,0 +1,184 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#ifndef CODA_OSS_io_BufferedOutputStream_h_INCLUDED_
+#define CODA_OSS_io_BufferedOutputStream_h_INCLUDED_
+#pragma once
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+#include "config/Exports.h"
+#include "sys/Conf.h"
+#include "mem/ScopedAlignedArray.h"
+#include "io/OutputStream.h"
+#include "io/FileOutputStreamOS.h"
+
+#if !defined(USE_IO_STREAMS)
+
+/*!
+ *  \file BufferedOutputStream.h
+ *  \brief Coalesces many small writes into a few large ones
+ */
+
+namespace io
+{
+/*!
+ *  \class BufferedOutputStream
+ *  \brief An OutputStream that gathers writes into a large aligned buffer
+ *
+ *  Data is only passed on to the underlying stream when the buffer fills,
+ *  on flush(), or on close().  Writes at least as large as the buffer
+ *  bypass it entirely.
+ *
+ *  With WRITE_BEHIND, full buffers are written out by a background thread
+ *  while the caller fills a second buffer.  Any error from the background
+ *  thread is rethrown by the next call to write(), flush() or close().
+ *
+ *  When the stream opens the file itself, DIRECT_IO writes it without
+ *  going through the OS page cache, and the expected size of the file may
+ *  be preallocated.  This is intended for very large sequential product
+ *  writes; if the platform or filesystem can't do direct I/O, ordinary
+ *  buffered writes are used instead.
+ */
+class CODA_OSS_API BufferedOutputStream : public OutputStream
+{
+public:
+    enum
+    {
+        WRITE_BEHIND = 1, //!< Write full buffers from a background thread
+        DIRECT_IO = 2 //!< Bypass the page cache (file constructor only)
+    };
+
+    enum
+    {
+        DEFAULT_BUFFER_SIZE = 4 * 1024 * 1024
+    };
+
+    /*!
+     *  Buffer writes to an existing stream
+     *  \param proxy The stream to write to
+     *  \param ownPtr Whether to delete the proxy when done
+     *  \param bufferSize Number of bytes to gather before writing
+     *  \param flags 0 or WRITE_BEHIND
+     */
+    BufferedOutputStream(OutputStream* proxy,
+                         bool ownPtr = false,
+                         size_t bufferSize = DEFAULT_BUFFER_SIZE,
+                         int flags = 0);
+
+    /*!
+     *  Create (or truncate) a file and buffer writes to it
+     *  \param outputFile The file name
+     *  \param bufferSize Number of bytes to gather before writing.  Rounded
+     *  up to a multiple of sys::File::DIRECT_IO_ALIGNMENT with DIRECT_IO.
+     *  \param flags Any combination of WRITE_BEHIND and DIRECT_IO
+     *  \param preallocateSize If non-zero, disk space to reserve up front
+     */
+    BufferedOutputStream(const std::string& outputFile,
+                         size_t bufferSize = DEFAULT_BUFFER_SIZE,
+                         int flags = 0,
+                         sys::Off_T preallocateSize = 0);
+
+    //! Closes the stream if that hasn't been done already
+    virtual ~BufferedOutputStream();
+
+    BufferedOutputStream(const BufferedOutputStream&) = delete;
+    BufferedOutputStream& operator=(const BufferedOutputStream&) = delete;
+
+    using OutputStream::write;
+
+    /*!
+     *  Copy into the buffer, writing it out each time it fills
+     *  \param buffer The data to write
+     *  \param len The number of bytes to write
+     *  \throw IOException
+     */
+    virtual void write(const void* buffer, size_t len);
+
+    /*!
+     *  Write out everything buffered so far, wait for any background
+     *  write to complete, and then flush the underlying stream.
+     */
+    virtual void flush();
+
+    /*!
+     *  Write out everything buffered so far, stop the background thread
+     *  and close the underlying stream.
+     */
+    virtual void close();
+
+    //! \return The number of bytes gathered before each write
+    size_t getBufferSize() const
+    {
+        return mBufferSize;
+    }
+
+    //! \return true if writes are made without the OS page cache
+    bool isDirectIO() const
+    {
+        return mDirectIO;
+    }
+
+private:
+    void init(int flags);
+
+    //! Hand the active buffer off to be written, then switch buffers
+    void drainActive();
+
+    //! Write out the active buffer and wait until nothing is pending
+    void flushBuffers();
+
+    //! Block until the background thread is idle, rethrowing its error
+    void waitForPending();
+
+    void flusherLoop();
+    void stopFlusher();
+
+    std::unique_ptr<OutputStream> mOwned;
+    OutputStream* mOutput = nullptr;
+    FileOutputStreamOS* mFile = nullptr;
+
+    size_t mBufferSize = 0;
+    mem::ScopedAlignedArray<sys::byte> mBuffers[2];
+    size_t mActive = 0;
+    size_t mFill = 0;
+    bool mDirectIO = false;
+    bool mClosed = false;
+
+    // Only used with WRITE_BEHIND
+    bool mWriteBehind = false;
+    std::thread mFlusher;
+    std::mutex mMutex;
+    std::condition_variable mCondition;
+    const sys::byte* mPending = nullptr;
+    size_t mPendingSize = 0;
+    bool mStop = false;
+    std::exception_ptr mError;
+};
+}
+
+#endif
+#endif // CODA_OSS_io_BufferedOutputStream_h_INCLUDED_
@@ -94,6 +94,24 @@ struct CODA_OSS_API ByteStream : public SeekableInputStream, public SeekableOutp
     virtual
     void write(const void* buffer, size_t size);
 
+    using SeekableInputStream::readAt;
+    using SeekableOutputStream::writeAt;
+
+    /*!
+     *  Copy up to len bytes starting at offset.  Safe to call from several
+     *  threads as long as nothing is writing to the stream.
+     *  \see SeekableInputStream::readAt()
+     */
+    virtual
+    sys::SSize_T readAt(sys::Off_T offset, void* buffer, size_t len);
+
+    /*!
+     *  Copy len bytes in at offset, growing the stream if necessary.
+     *  \see SeekableOutputStream::writeAt()
+     */
+    virtual
+    void writeAt(sys::Off_T offset, const void* buffer, size_t len);
+
     void reset()
     {
         mPosition = 0;
@@ -28,6 +28,7 @@
 #include <ios>
 #include <iostream>
 #include <fstream>
+#include <mutex>
 #include "except/Exception.h"
 #include "sys/filesystem.h"
 #include "io/InputStream.h"
@@ -132,6 +133,15 @@ public:
     //!  Close the file
     void close();
 
+    using SeekableInputStream::readAt;
+
+    /*!
+     *  Like the default, but holding a lock so that several threads can
+     *  call it at once.
+     *  \see SeekableInputStream::readAt()
+     */
+    virtual sys::SSize_T readAt(sys::Off_T offset, void* buffer, size_t len);
+
     /*!
      *  Access the stream directly
      *  \return The stream in native C++
@@ -155,6 +165,10 @@ protected:
 
 
     std::ifstream mFStream;
+
+private:
+    // An ifstream has the one position, so positional reads take turns
+    std::mutex mPositionalMutex;
 };
 
 
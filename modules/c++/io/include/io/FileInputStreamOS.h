@@ -25,6 +25,11 @@
 
 #if !defined(USE_IO_STREAMS)
 
+#ifdef _WIN32
+#include <memory>
+#include <mutex>
+#endif
+
 #include "except/Exception.h"
 #include "sys/File.h"
 #include "sys/filesystem.h"
@@ -163,6 +168,24 @@ public:
         mFile.close();
     }
 
+    using SeekableInputStream::readAt;
+
+    /*!
+     *  Read with pread(), so this doesn't disturb, and isn't disturbed
+     *  by, the position used by read(); any number of threads can call it.
+     *  On Windows, where sys::File::readAt() has to move the file pointer
+     *  and put it back, calls take turns, and mustn't overlap with read().
+     *  \see SeekableInputStream::readAt()
+     */
+    virtual sys::SSize_T readAt(sys::Off_T offset, void* buffer, size_t len);
+
+    /*!
+     *  Runs of segments that follow one another in the file are read with
+     *  a single preadv() where it's available.
+     *  \see SeekableInputStream::readv()
+     */
+    virtual void readv(const std::vector<IoSegment>& segments);
+
 protected:
     /*!
      * Read up to len bytes of data from input stream into an array
@@ -174,6 +197,12 @@ protected:
      *
      */
     virtual sys::SSize_T readImpl(void* buffer, size_t len);
+
+#ifdef _WIN32
+private:
+    // Shared, like the handle in mFile, by copies of this stream
+    std::shared_ptr<std::mutex> mPositionalMutex = std::make_shared<std::mutex>();
+#endif
 };
 }
 
@@ -25,6 +25,10 @@
 #pragma once
 
 #include <string>
+#ifdef _WIN32
+#include <memory>
+#include <mutex>
+#endif
 
 #if !defined(USE_IO_STREAMS)
 
@@ -110,6 +114,25 @@ public:
 
     virtual void flush();
 
+    /*!
+     *  Reserve space for the expected size of the file up front.
+     *  \param length The number of bytes to reserve
+     */
+    void preallocate(sys::Off_T length)
+    {
+        mFile.preallocate(length);
+    }
+
+    /*!
+     *  Turn unbuffered (O_DIRECT) writes on or off.
+     *  \return false if direct I/O isn't supported here
+     *  \see sys::File::setDirectIO()
+     */
+    bool setDirectIO(bool enable)
+    {
+        return mFile.setDirectIO(enable);
+    }
+
     sys::Off_T seek(sys::Off_T offset, io::Seekable::Whence whence);
 
     sys::Off_T tell();
@@ -125,6 +148,29 @@ public:
      * \throw IoException
      */
     virtual void write(const void* buffer, size_t len);
+
+    using SeekableOutputStream::writeAt;
+
+    /*!
+     *  Write with pwrite(), leaving the position used by write() alone.
+     *  On Windows, where sys::File::writeAt() has to move the file pointer
+     *  and put it back, calls take turns, and mustn't overlap with write().
+     *  \see SeekableOutputStream::writeAt()
+     */
+    virtual void writeAt(sys::Off_T offset, const void* buffer, size_t len);
+
+    /*!
+     *  Runs of segments that follow one another in the file are written
+     *  with a single pwritev() where it's available.
+     *  \see SeekableOutputStream::writev()
+     */
+    virtual void writev(const std::vector<ConstIoSegment>& segments);
+
+#ifdef _WIN32
+private:
+    // Shared, like the handle in mFile, by copies of this stream
+    std::shared_ptr<std::mutex> mPositionalMutex = std::make_shared<std::mutex>();
+#endif
 };
 }
 
@@ -23,6 +23,10 @@
 #ifndef __IO_FILE_UTILS_H__
 #define __IO_FILE_UTILS_H__
 
+#include <stdint.h>
+
+#include <functional>
+
 #include <import/except.h>
 #include <import/str.h>
 #include <import/sys.h>
@@ -30,20 +34,63 @@
 namespace io
 {
 
+/*!
+ *  How far along io::copy() is
+ */
+struct CopyProgress final
+{
+    size_t numFiles = 0; //! files to copy in all
+    size_t numFilesCopied = 0;
+    uint64_t numBytesCopied = 0;
+    double seconds = 0.0; //! since the files started copying
+
+    double getBytesPerSecond() const
+    {
+        return seconds > 0.0 ? static_cast<double>(numBytesCopied) / seconds : 0.0;
+    }
+};
+
+struct CopyOptions final
+{
+    //! Size of each read and write when the kernel can't copy the file
+    size_t blockSize = 1048576;
+
+    //! Files to copy at once
+    size_t numThreads = 1;
+
+    /*!
+     *  Called after each file and every 64MB or so; calls are serialized,
+     *  so this needn't be thread-safe.
+     */
+    std::function<void(const CopyProgress&)> progress;
+};
+
 /*!
  *  Copy a file or directory to a new path. 
  *  Source and destination cannot be the same location
  *
  *  \param path      - source location
  *  \param newath    - destination location
- *  \param blockSize - files are copied in blocks (1MB default)
- *                     NOTE: This is a placeholder and is unused currently
+ *  \param blockSize - files are copied in blocks (1MB default) when the
+ *                     kernel can't copy them itself
  *  \return True upon success, false if failure
  */
 void copy(const std::string& path, 
           const std::string& newPath,
           size_t blockSize = 1048576);
 
+/*!
+ *  As above, but with the files under a directory copied on
+ *  options.numThreads threads.  On Linux, data is copied in the kernel
+ *  with copy_file_range() or sendfile() when possible.  The directories
+ *  are all created first, with their permissions copied as they are.
+ *  Anything that's neither a file nor a directory (sockets, FIFOs, etc.)
+ *  is skipped, unless it's 'path' itself, which is an error.
+ */
+void copy(const std::string& path, 
+          const std::string& newPath,
+          const CopyOptions& options);
+
 /*!
  *  Move file with this path name to the newPath
  *  \return True upon success, false if failure
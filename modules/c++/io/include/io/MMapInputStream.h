@@ -23,65 +23,181 @@
 #ifndef __IO_MMAP_INPUT_STREAM_H__
 #define __IO_MMAP_INPUT_STREAM_H__
 
-#include <cstdio>
-#include "sys/OS.h"
+#include <string>
+#include <mutex>
+
+#include "config/Exports.h"
+#include "coda_oss/span.h"
+#include "coda_oss/cstddef.h"
+#include "sys/Conf.h"
+#include "sys/File.h"
 #include "io/SeekableStreams.h"
 
+/*!
+ *  \file MMapInputStream.h
+ *  \brief A read-only, memory-mapped file
+ */
 
 namespace io
 {
 
-class MMapInputStream : public SeekableInputStream
+/*!
+ *  \class MMapInputStream
+ *  \brief An InputStream that maps a file into memory, read-only
+ *
+ *  Besides the usual (copying) read() and readAt(), getSpan() hands out
+ *  pointers straight into the page cache so that callers can compute on
+ *  the file's bytes without copying them.
+ *
+ *  By default the whole file is mapped at once.  If a maximum window size
+ *  is given, only that much of the file (rounded out to whole pages) is
+ *  mapped at a time and the window slides as different parts of the file
+ *  are accessed; this allows files larger than the address space budget.
+ *  A span from getSpan() stays valid until the window moves, i.e. until
+ *  the next getSpan(), read(), readAt() or close().  When the whole file
+ *  is mapped, spans stay valid until close().
+ */
+class CODA_OSS_API MMapInputStream : public SeekableInputStream
 {
 public:
-    MMapInputStream() : mFile(nullptr), mLength(0), mData(nullptr), mMark(0)
-    {}
-    MMapInputStream(const std::string& inputFile,
-                    char* flags = "r+b") :
-            mFile(nullptr), mLength(0), mData(nullptr), mMark(0)
+    //! How the mapped pages are expected to be accessed; see madvise()
+    enum Advice
     {
-        open(inputFile, flags);
-
+        NORMAL = 0,
+        SEQUENTIAL,
+        RANDOM,
+        WILL_NEED
+    };
+
+    //! Options for open()
+    enum
+    {
+        POPULATE = 1, //!< Fault every page in when mapping (MAP_POPULATE)
+        HUGE_PAGES = 2 //!< Ask for transparent huge pages (MADV_HUGEPAGE)
+    };
+
+    MMapInputStream() = default;
+
+    /*!
+     *  Map a file
+     *  \param inputFile The file name
+     *  \param flags Any combination of POPULATE and HUGE_PAGES.  These are
+     *  hints; they're ignored where they aren't supported.
+     *  \param maxWindowSize The most to map at once, or 0 to map the whole
+     *  file
+     */
+    explicit MMapInputStream(const std::string& inputFile,
+                             int flags = 0,
+                             size_t maxWindowSize = 0)
+    {
+        open(inputFile, flags, maxWindowSize);
     }
 
     virtual ~MMapInputStream()
     {
-        if (mFile)
-        {
-            close();
-        }
+        close();
     }
 
-    virtual void open(const std::string& fname, char* flags);
+    MMapInputStream(const MMapInputStream&) = delete;
+    MMapInputStream& operator=(const MMapInputStream&) = delete;
+
+    //! \see MMapInputStream(const std::string&, int, size_t)
+    void open(const std::string& inputFile,
+              int flags = 0,
+              size_t maxWindowSize = 0);
 
-    virtual void close();
+    //! Unmap and close the file
+    void close();
 
-    sys::Handle_T getHandle();
+    bool isOpen() const noexcept
+    {
+        return mFile.isOpen();
+    }
 
-    virtual off_t available()
+    //! \return The length of the file
+    sys::Off_T getSize() const
     {
-        return (mLength - mMark);
+        return mLength;
     }
 
-    virtual off_t seek(off_t off);
+    //! \return true if only part of the file is mapped at a time
+    bool isWindowed() const
+    {
+        return mMaxWindowSize != 0;
+    }
 
-    virtual off_t tell()
+    virtual sys::Off_T available()
+    {
+        return mMark < mLength ? mLength - mMark : 0;
+    }
+
+    virtual sys::Off_T seek(sys::Off_T offset, Whence whence);
+
+    virtual sys::Off_T tell()
     {
         return mMark;
     }
 
-protected:
-    virtual sys::SSize_T readImpl(void* buffer, size_t len);
+    /*!
+     *  Tell the OS how the mapping is going to be accessed.  This applies
+     *  to the current window and to every window mapped after it.
+     */
+    void advise(Advice advice);
+
+    /*!
+     *  Ask the OS to start reading a range of the file into memory.
+     *  In windowed mode this maps the range if it isn't already.
+     */
+    void prefetch(sys::Off_T offset, size_t len);
+
+    /*!
+     *  View part of the file without copying it
+     *  \param offset Where the view starts
+     *  \param len The number of bytes to view; at most the maximum window
+     *  size in windowed mode
+     *  \throw IOException if the range runs past the end of the file
+     */
+    coda_oss::span<const coda_oss::byte> getSpan(sys::Off_T offset,
+                                                  size_t len);
+
+    //! View everything from the current position to the end of the file
+    coda_oss::span<const coda_oss::byte> getSpan()
+    {
+        return getSpan(mMark, static_cast<size_t>(available()));
+    }
+
+    using SeekableInputStream::readAt;
 
-    virtual void _map();
-    virtual void _unmap();
-    sys::OS mOs;
+    /*!
+     *  Copy out of the mapping.  Safe to call from any number of threads;
+     *  in windowed mode the calls are serialized since they may move the
+     *  window.
+     */
+    virtual sys::SSize_T readAt(sys::Off_T offset, void* buffer, size_t len);
 
-    FILE* mFile;
-    size_t mLength;
-    sys::byte* mData;
-    size_t mMark;
+protected:
+    virtual sys::SSize_T readImpl(void* buffer, size_t len);
 
+private:
+    //! Make sure [offset, offset + len) is mapped, returning its address
+    const sys::byte* mapRange(sys::Off_T offset, size_t len);
+    void map(sys::Off_T offset, size_t len);
+    void unmap();
+    void applyAdvice();
+
+    sys::File mFile;
+    void* mMapping = nullptr; // file mapping object on Windows
+    sys::Off_T mLength = 0;
+    sys::Off_T mMark = 0;
+    int mFlags = 0;
+    size_t mMaxWindowSize = 0;
+    size_t mGranularity = 0;
+    Advice mAdvice = NORMAL;
+
+    sys::byte* mWindow = nullptr;
+    sys::Off_T mWindowOffset = 0;
+    size_t mWindowSize = 0;
+    std::mutex mWindowMutex;
 };
 
 }
@@ -23,7 +23,10 @@
 #ifndef __IO_SEEKABLE_STREAMS_H__
 #define __IO_SEEKABLE_STREAMS_H__
 
+#include <vector>
+
 #include "config/Exports.h"
+#include "coda_oss/span.h"
 #include "io/InputStream.h"
 #include "io/OutputStream.h"
 #include "io/BidirectionalStream.h"
@@ -42,12 +45,66 @@
 
 namespace io
 {
+/*!
+ *  \struct IoSegment
+ *  \brief One piece of a scattered read: 'length' bytes starting at
+ *  'offset' in the stream go into 'buffer'
+ */
+struct IoSegment
+{
+    sys::Off_T offset;
+    void* buffer;
+    size_t length;
+};
+
+/*!
+ *  \struct ConstIoSegment
+ *  \brief One piece of a gathered write: 'length' bytes from 'buffer' go
+ *  to 'offset' in the stream
+ */
+struct ConstIoSegment
+{
+    sys::Off_T offset;
+    const void* buffer;
+    size_t length;
+};
+
 struct CODA_OSS_API SeekableInputStream :
             public InputStream, public Seekable
 {
     SeekableInputStream() = default;
     virtual ~SeekableInputStream() = default;
     using InputStream::streamTo;
+
+    /*!
+     * Read up to len bytes starting at offset, leaving the current
+     * position (as reported by tell()) where it was.
+     *
+     * This default implementation seeks, reads and seeks back, so it isn't
+     * safe to call from more than one thread at a time.  Streams that can
+     * do real positional reads (or lock around the default) override it
+     * so that any number of threads can read disjoint ranges at once.
+     *
+     * \param offset Where to start reading, from the start of the stream
+     * \param buffer Buffer to read into
+     * \param len The length to read
+     * \throw IOException
+     * \return The number of bytes read, or IS_EOF if offset is at or past
+     * the end of the stream
+     */
+    virtual sys::SSize_T readAt(sys::Off_T offset, void* buffer, size_t len);
+    template<typename T>
+    sys::SSize_T readAt(sys::Off_T offset, coda_oss::span<T> buffer)
+    {
+        return readAt(offset, buffer.data(), buffer.size_bytes());
+    }
+
+    /*!
+     * Fill every segment, in one call where the stream allows it.
+     * Positional like readAt(): the current position doesn't change.
+     * \throw IOException if any segment can't be read in full
+     */
+    virtual void readv(const std::vector<IoSegment>& segments);
 };
 
 struct CODA_OSS_API SeekableOutputStream :
@@ -55,6 +112,29 @@ struct CODA_OSS_API SeekableOutputStream :
 {
     SeekableOutputStream() = default;
     virtual ~SeekableOutputStream() = default;
+
+    /*!
+     * Write len bytes starting at offset, leaving the current position
+     * where it was.  The default seeks, writes and seeks back, so it isn't
+     * thread-safe; file streams override it with positional writes.
+     *
+     * \param offset Where to start writing, from the start of the stream
+     * \param buffer The data to write
+     * \param len The number of bytes to write
+     * \throw IOException
+     */
+    virtual void writeAt(sys::Off_T offset, const void* buffer, size_t len);
+    template<typename T>
+    void writeAt(sys::Off_T offset, coda_oss::span<const T> buffer)
+    {
+        writeAt(offset, buffer.data(), buffer.size_bytes());
+    }
+
+    /*!
+     * Write every segment, in one call where the stream allows it.
+     * Positional like writeAt(): the current position doesn't change.
+     */
+    virtual void writev(const std::vector<ConstIoSegment>& segments);
 };
 
 struct SeekableBidirectionalStream :
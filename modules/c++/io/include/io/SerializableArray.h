@@ -23,7 +23,14 @@
 #ifndef __IO_SERIALIZABLE_ARRAY_H__
 #define __IO_SERIALIZABLE_ARRAY_H__
 
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "io/Serializable.h"
+#include "except/Exception.h"
 #include <import/sys.h>
 
 namespace io
@@ -31,11 +38,20 @@ namespace io
 
 /**
  * Serialize an array to/from a stream.
+ *
+ * With a stride, elements are gathered into (or scattered from) blocks
+ * so that the stream sees a few large reads and writes rather than one
+ * per element.
  */
 template<typename T>
 class SerializableArray : public Serializable
 {
 public:
+    enum
+    {
+        //! Size in bytes of the blocks used for strided and swapped I/O
+        BLOCK_SIZE = 64 * 1024
+    };
 
     /**
      * \param buf       the data buffer
@@ -45,7 +61,8 @@ public:
      */
     SerializableArray(T* buf, sys::Size_T offset, sys::Size_T length,
                       sys::Size_T skip = 0) :
-        mBuf(buf), mOffset(offset), mLength(length), mSkip(skip)
+        mBuf(buf), mOffset(offset), mLength(length), mSkip(skip),
+        mSwapSize(0)
     {
     }
 
@@ -54,7 +71,7 @@ public:
      * \param length    the length (in elements, not bytes) of the buffer
      */
     SerializableArray(T* buf, sys::Size_T length) :
-        mBuf(buf), mOffset(0), mLength(length), mSkip(0)
+        mBuf(buf), mOffset(0), mLength(length), mSkip(0), mSwapSize(0)
     {
     }
 
@@ -62,41 +79,154 @@ public:
     {
     }
 
+    /**
+     * Byte swap the data as it's serialized or deserialized.  The buffer
+     * itself is never swapped when serializing.
+     *
+     * \param swapSize  size in bytes of each value to swap, e.g.
+     *                  sizeof(float) for std::complex<float>.  Use 0 to
+     *                  turn swapping off.
+     */
+    void setByteSwap(size_t swapSize = sizeof(T))
+    {
+        if (swapSize != 0 && sizeof(T) % swapSize != 0)
+        {
+            throw except::InvalidArgumentException(Ctxt(
+                    "Swap size must evenly divide the element size"));
+        }
+        // Single bytes have nothing to swap
+        mSwapSize = swapSize > 1 ? swapSize : 0;
+    }
+
     void serialize(io::OutputStream& os)
     {
-        T* buf = (T*) (mBuf + mOffset);
-        if (mSkip == 0)
-            os.write((sys::byte*) buf, sizeof(T) * mLength);
-        else
+        const T* buf = mBuf + mOffset;
+        if (mSkip == 0 && mSwapSize == 0)
         {
-            sys::Size_T skip = mSkip + 1;
-            for (sys::Size_T i = 0; i < mLength; i += skip, buf += skip)
-                os.write((sys::byte*) buf, sizeof(T));
+            os.write((const sys::byte*) buf, sizeof(T) * mLength);
+            return;
+        }
+
+        // Every (mSkip + 1)th element is written
+        const sys::Size_T stride = mSkip + 1;
+        const sys::Size_T numElements = (mLength + stride - 1) / stride;
+        const sys::Size_T blockElements = getBlockElements();
+        std::vector<sys::byte> block(
+                std::min(numElements, blockElements) * sizeof(T));
+
+        for (sys::Size_T ii = 0; ii < numElements; )
+        {
+            const sys::Size_T numThisBlock =
+                    std::min(blockElements, numElements - ii);
+            for (sys::Size_T jj = 0; jj < numThisBlock; ++jj)
+            {
+                copyElement(buf + (ii + jj) * stride,
+                            &block[jj * sizeof(T)]);
+            }
+            os.write(block.data(), numThisBlock * sizeof(T));
+            ii += numThisBlock;
         }
     }
 
+    /**
+     * Read mLength elements, keeping every (mSkip + 1)th one.
+     *
+     * \throws except::IOException if the stream ends before all of them
+     *         have been read
+     */
     void deserialize(io::InputStream& is)
     {
-        T* buf = (T*) (mBuf + mOffset);
+        T* buf = mBuf + mOffset;
         if (mSkip == 0)
-            is.read((sys::byte*) buf, sizeof(T) * mLength);
-        else
         {
-            sys::Size_T skip = mSkip + 1;
-            sys::byte bytes[sizeof(T)];
-            for (sys::Size_T i = 0; i < mLength; ++i)
+            readElements(is, (sys::byte*) buf, mLength);
+            if (mSwapSize != 0)
+            {
+                sys::byteSwap(buf, static_cast<unsigned short>(mSwapSize),
+                              mLength * sizeof(T) / mSwapSize);
+            }
+            return;
+        }
+
+        // mLength elements are read and every (mSkip + 1)th one is kept,
+        // packed into the buffer
+        const sys::Size_T stride = mSkip + 1;
+        const sys::Size_T blockElements = getBlockElements();
+        std::vector<sys::byte> block(
+                std::min(mLength, blockElements) * sizeof(T));
+
+        sys::byte* out = (sys::byte*) buf;
+        for (sys::Size_T ii = 0; ii < mLength; )
+        {
+            const sys::Size_T numThisBlock =
+                    std::min(blockElements, mLength - ii);
+            readElements(is, block.data(), numThisBlock);
+
+            // First element of this block that lands on the stride
+            for (sys::Size_T jj = (stride - ii % stride) % stride;
+                 jj < numThisBlock;
+                 jj += stride, out += sizeof(T))
             {
-                if (i % skip == 0)
-                    is.read((sys::byte*) buf++, sizeof(T));
-                else
-                    is.read(bytes, sizeof(T));
+                copyElement(&block[jj * sizeof(T)], out);
             }
+            ii += numThisBlock;
         }
     }
 
 protected:
     T* mBuf;
     sys::Size_T mOffset, mLength, mSkip;
+    size_t mSwapSize;
+
+private:
+    static sys::Size_T getBlockElements()
+    {
+        return std::max<sys::Size_T>(BLOCK_SIZE / sizeof(T), 1);
+    }
+
+    //! Read numElements elements, however many reads the stream takes
+    void readElements(io::InputStream& is, sys::byte* buffer,
+                      sys::Size_T numElements) const
+    {
+        const sys::Size_T numBytes = numElements * sizeof(T);
+        sys::Size_T numRead = 0;
+        while (numRead < numBytes)
+        {
+            const sys::SSize_T thisRead =
+                    is.read(buffer + numRead, numBytes - numRead);
+            if (thisRead <= 0)
+            {
+                break;
+            }
+            numRead += static_cast<sys::Size_T>(thisRead);
+        }
+
+        if (numRead % sizeof(T) != 0)
+        {
+            throw except::IOException(Ctxt(
+                    "Stream ended partway through an element"));
+        }
+        if (numRead < numBytes)
+        {
+            throw except::IOException(Ctxt(
+                    "Stream ended before all " + std::to_string(mLength) +
+                    " elements were read"));
+        }
+    }
+
+    //! Copy one element, swapping it on the way if requested
+    void copyElement(const void* source, void* dest) const
+    {
+        if (mSwapSize == 0)
+        {
+            ::memcpy(dest, source, sizeof(T));
+        }
+        else
+        {
+            sys::byteSwap(source, static_cast<unsigned short>(mSwapSize),
+                          sizeof(T) / mSwapSize, dest);
+        }
+    }
 };
 }
 
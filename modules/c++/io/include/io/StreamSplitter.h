@@ -23,12 +23,15 @@
 #ifndef __IO_STREAM_SPLITTER_H__
 #define __IO_STREAM_SPLITTER_H__
 
+#include <functional>
 #include <string>
 #include <vector>
 
 #include "config/Exports.h"
+#include "coda_oss/span.h"
 #include "sys/Conf.h"
 #include "io/InputStream.h"
+#include "io/SeekableStreams.h"
 
 namespace io
 {
@@ -36,9 +39,22 @@ namespace io
  * StreamSplitter splits the bytes from a stream into substrings separated by a
  * specified delimiter string. It uses buffered stream reads internally for
  * better efficiency than InputStream::readln for reading large amounts of data.
+ *
+ * Several delimiters may be given, in which case a substring ends at the
+ * first one found; when more than one matches at the same position (e.g.
+ * "\r\n" and "\n") the longest wins.
  */
 struct CODA_OSS_API StreamSplitter
 {
+    //! A view of a substring; see getNext(View&)
+    typedef coda_oss::span<const char> View;
+
+    /*!
+     * Called by splitParallel() with the index of the chunk the substring
+     * came from and the substring itself
+     */
+    typedef std::function<void(size_t, View)> SubstringHandler;
+
     /*!
      * \brief Create a stream splitter.
      *
@@ -52,6 +68,19 @@ struct CODA_OSS_API StreamSplitter
                             const std::string& delimiter = std::string("\n"),
                             size_t bufferSize = 65536);
 
+    /*!
+     * \brief Create a stream splitter that splits on any of several
+     *        delimiters.
+     *
+     * \param inputStream The stream to read.
+     * \param delimiters Delimiter strings; at least one is required and
+     *        none may be empty.
+     * \param bufferSize Size of internal buffer.
+     */
+    StreamSplitter(io::InputStream& inputStream,
+                   const std::vector<std::string>& delimiters,
+                   size_t bufferSize = 65536);
+
     StreamSplitter(const StreamSplitter&) = delete;
     StreamSplitter& operator=(const StreamSplitter&) = delete;
 
@@ -65,6 +94,19 @@ struct CODA_OSS_API StreamSplitter
      */
     bool getNext(std::string& substring);
 
+    /*!
+     * \brief Get the next substring from the stream without copying it.
+     *
+     * The view points into the splitter's buffer and is only valid until
+     * the next call to getNext().  If a substring doesn't fit in the
+     * buffer, the buffer grows to hold it.
+     *
+     * \param[out] substring Set to the substring if this call succeeds.
+     *             Otherwise it will NOT be modified.
+     * \return true if this call succeeded, false if this call failed.
+     */
+    bool getNext(View& substring);
+
     /*!
      * \brief Check if the stream has no more substrings to return.
      *
@@ -96,7 +138,48 @@ struct CODA_OSS_API StreamSplitter
      */
     size_t getNumBytesProcessed() const;
 
+    /*!
+     * \brief Split the rest of a stream using several threads.
+     *
+     * The bytes from the current position to the end of the stream are
+     * divided into one chunk per thread, with each chunk boundary moved
+     * forward to the next delimiter, and the chunks are split concurrently
+     * using positional reads.  Substrings come out in order within a chunk,
+     * but handler is called from several threads at once.  The results
+     * match a StreamSplitter run over the whole stream as long as
+     * delimiters can't overlap one another.  On return the stream is
+     * positioned at its end.
+     *
+     * \param inputStream The stream to read.  It must support concurrent
+     *        readAt() calls, as the file streams do.
+     * \param delimiters Delimiter strings.
+     * \param numThreads Number of threads (and chunks) to use.
+     * \param handler Called with each chunk index and substring.
+     * \param bufferSize Size of each thread's buffer.
+     */
+    static void splitParallel(io::SeekableInputStream& inputStream,
+                              const std::vector<std::string>& delimiters,
+                              size_t numThreads,
+                              const SubstringHandler& handler,
+                              size_t bufferSize = 65536);
+
 private:
+    //! Check the delimiters and set up the tables used to find them
+    void initDelimiters(const std::vector<std::string>& delimiters);
+
+    /*!
+     * \brief Find the first delimiter starting in [begin, end).
+     *
+     * \param[out] delimiterSize Size of the delimiter found
+     * \return Buffer position of the delimiter, or -1 if there isn't one
+     */
+    sys::SSize_T findDelimiter(sys::SSize_T begin,
+                               sys::SSize_T end,
+                               size_t& delimiterSize) const;
+
+    //! Last buffer position a delimiter can currently start at, plus one
+    sys::SSize_T getSearchEnd() const;
+
     /*!
      * \brief Append the buffer section from mBufferBegin to bufferSegmentEnd
      *        to the substring and remove it from the buffer.
@@ -110,15 +193,33 @@ private:
      */
     void handleStreamRead();
 
-    const std::string mDelimiter;
+    //! Double the size of the buffer
+    void growBuffer();
+
+    /*!
+     * \brief Discard bytes up to and including the next delimiter.
+     *
+     * The discarded bytes are counted as returned, so afterwards
+     * getNumBytesProcessed() is the offset just past the delimiter.
+     *
+     * \return true if a delimiter was found, false if the stream ended first
+     */
+    bool skipPastDelimiter();
+
+    std::vector<std::string> mDelimiters; // longest first
+    size_t mMaxDelimiterSize;
+    std::vector<bool> mIsDelimiterStart; // indexed by unsigned byte value
+    int mDelimiterStart; // first byte of every delimiter, or -1 if they differ
+    size_t mPendingDelimiterSize;
     sys::SSize_T mBufferValidBegin;
     sys::SSize_T mBufferValidEnd;
     size_t mNumSubstringsReturned;
     size_t mNumBytesReturned;
     size_t mNumDelimitersProcessed;
+    size_t mNumDelimiterBytesProcessed;
     std::vector<sys::byte> mBufferStorage;
-    const sys::SSize_T mBufferCapacity;
-    sys::byte* const mBuffer;
+    sys::SSize_T mBufferCapacity;
+    sys::byte* mBuffer;
     io::InputStream& mInputStream;
     bool mStreamEmpty;
 };
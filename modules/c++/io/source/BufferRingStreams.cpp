@@ -0,0 +1,190 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "io/BufferRingStreams.h"
+
+#include "except/Exception.h"
+
+io::BufferRingReader::BufferRingReader(InputStream& input,
+                                       mem::BufferRing& ring) :
+    mInput(input),
+    mRing(ring)
+{
+    mThread = std::thread(&BufferRingReader::run, this);
+}
+
+io::BufferRingReader::~BufferRingReader()
+{
+    if (mThread.joinable())
+    {
+        mRing.abort();
+        mThread.join();
+    }
+}
+
+void io::BufferRingReader::join()
+{
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    if (mError)
+    {
+        std::exception_ptr error = mError;
+        mError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void io::BufferRingReader::run()
+{
+    try
+    {
+        const size_t capacity = mRing.getNumBytes();
+        bool atEnd = false;
+        size_t index = 0;
+        while (!atEnd && mRing.acquireForWrite(index))
+        {
+            sys::byte* const buffer = mRing.getBuffer<sys::byte>(index);
+            size_t numBytes = 0;
+            while (numBytes < capacity)
+            {
+                const sys::SSize_T numRead =
+                        mInput.read(buffer + numBytes, capacity - numBytes);
+                if (numRead <= 0)
+                {
+                    atEnd = true;
+                    break;
+                }
+                numBytes += static_cast<size_t>(numRead);
+            }
+
+            // An empty buffer at the end is simply never published
+            if (numBytes > 0)
+            {
+                mRing.publish(index, numBytes);
+            }
+        }
+        mRing.close();
+    }
+    catch (...)
+    {
+        mError = std::current_exception();
+        mRing.abort();
+    }
+}
+
+io::BufferRingWriter::BufferRingWriter(mem::BufferRing& ring,
+                                       OutputStream& output) :
+    mRing(ring),
+    mOutput(output)
+{
+    mThread = std::thread(&BufferRingWriter::run, this);
+}
+
+io::BufferRingWriter::~BufferRingWriter()
+{
+    if (mThread.joinable())
+    {
+        mRing.abort();
+        mThread.join();
+    }
+}
+
+void io::BufferRingWriter::join()
+{
+    if (mThread.joinable())
+    {
+        mThread.join();
+    }
+    if (mError)
+    {
+        std::exception_ptr error = mError;
+        mError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void io::BufferRingWriter::run()
+{
+    try
+    {
+        size_t index = 0;
+        while (mRing.acquireForRead(index))
+        {
+            mOutput.write(mRing.getBuffer<sys::byte>(index),
+                          mRing.getNumBytesUsed(index));
+            mRing.release(index);
+        }
+    }
+    catch (...)
+    {
+        mError = std::current_exception();
+        mRing.abort();
+    }
+}
+
+void io::transformPipelined(InputStream& input,
+                            OutputStream& output,
+                            const BlockTransform& transform,
+                            size_t inputBlockSize,
+                            size_t outputBlockSize,
+                            size_t numBuffers)
+{
+    if (inputBlockSize == 0)
+    {
+        throw except::InvalidArgumentException(Ctxt(
+                "Block size must be positive"));
+    }
+
+    mem::BufferRing inputRing(numBuffers, inputBlockSize);
+    mem::BufferRing outputRing(numBuffers, outputBlockSize);
+
+    // If anything below throws, the destructors abort both rings and stop
+    // the threads
+    BufferRingReader reader(input, inputRing);
+    BufferRingWriter writer(outputRing, output);
+
+    size_t inputIndex = 0;
+    size_t outputIndex = 0;
+    while (inputRing.acquireForRead(inputIndex))
+    {
+        if (!outputRing.acquireForWrite(outputIndex))
+        {
+            // The writer failed; stop the reader too and let join() report it
+            inputRing.abort();
+            break;
+        }
+
+        const size_t numBytes = transform(
+                inputRing.getBuffer<sys::byte>(inputIndex),
+                inputRing.getNumBytesUsed(inputIndex),
+                outputRing.getBuffer<sys::byte>(outputIndex),
+                outputBlockSize);
+        outputRing.publish(outputIndex, numBytes);
+        inputRing.release(inputIndex);
+    }
+    outputRing.close();
+
+    reader.join();
+    writer.join();
+}
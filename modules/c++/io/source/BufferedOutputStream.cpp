@@ -0,0 +1,303 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "io/BufferedOutputStream.h"
+
+#if !defined(USE_IO_STREAMS)
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "except/Exception.h"
+
+io::BufferedOutputStream::BufferedOutputStream(OutputStream* proxy,
+                                               bool ownPtr,
+                                               size_t bufferSize,
+                                               int flags) :
+    mOutput(proxy),
+    mBufferSize(bufferSize)
+{
+    if (!proxy)
+    {
+        throw except::NullPointerReference(Ctxt("Null output stream"));
+    }
+    if (ownPtr)
+    {
+        mOwned.reset(proxy);
+    }
+    if (flags & DIRECT_IO)
+    {
+        throw except::InvalidArgumentException(Ctxt(
+                "Direct I/O requires the stream to open the file itself"));
+    }
+    init(flags);
+}
+
+io::BufferedOutputStream::BufferedOutputStream(
+        const std::string& outputFile,
+        size_t bufferSize,
+        int flags,
+        sys::Off_T preallocateSize) :
+    mBufferSize(bufferSize)
+{
+    mFile = new FileOutputStreamOS(outputFile);
+    mOwned.reset(mFile);
+    mOutput = mFile;
+
+    if (preallocateSize > 0)
+    {
+        mFile->preallocate(preallocateSize);
+    }
+    if (flags & DIRECT_IO)
+    {
+        // Every direct write is a whole number of aligned blocks
+        const size_t alignment = sys::File::DIRECT_IO_ALIGNMENT;
+        mBufferSize = (mBufferSize + alignment - 1) / alignment * alignment;
+        mDirectIO = mFile->setDirectIO(true);
+    }
+    init(flags);
+}
+
+io::BufferedOutputStream::~BufferedOutputStream()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+void io::BufferedOutputStream::init(int flags)
+{
+    if (mBufferSize == 0)
+    {
+        throw except::InvalidArgumentException(Ctxt(
+                "Buffer size must be positive"));
+    }
+
+    mWriteBehind = (flags & WRITE_BEHIND) != 0;
+    const size_t numBuffers = mWriteBehind ? 2 : 1;
+    for (size_t ii = 0; ii < numBuffers; ++ii)
+    {
+        mBuffers[ii].reset(mBufferSize, sys::File::DIRECT_IO_ALIGNMENT);
+    }
+
+    if (mWriteBehind)
+    {
+        mFlusher = std::thread(&BufferedOutputStream::flusherLoop, this);
+    }
+}
+
+void io::BufferedOutputStream::write(const void* buffer, size_t len)
+{
+    if (mClosed)
+    {
+        throw except::IOException(Ctxt("Cannot write to a closed stream"));
+    }
+
+    const sys::byte* data = static_cast<const sys::byte*>(buffer);
+
+    // Copying a write this large buys nothing, unless direct I/O needs
+    // the data to be in an aligned buffer
+    if (!mDirectIO && len >= mBufferSize)
+    {
+        drainActive();
+        waitForPending();
+        mOutput->write(data, len);
+        return;
+    }
+
+    while (len > 0)
+    {
+        const size_t numToCopy = std::min(len, mBufferSize - mFill);
+        ::memcpy(mBuffers[mActive].get() + mFill, data, numToCopy);
+        mFill += numToCopy;
+        data += numToCopy;
+        len -= numToCopy;
+
+        if (mFill == mBufferSize)
+        {
+            drainActive();
+        }
+    }
+}
+
+void io::BufferedOutputStream::flush()
+{
+    if (mClosed)
+    {
+        return;
+    }
+    flushBuffers();
+    mOutput->flush();
+}
+
+void io::BufferedOutputStream::close()
+{
+    if (mClosed)
+    {
+        return;
+    }
+    mClosed = true;
+
+    try
+    {
+        flushBuffers();
+    }
+    catch (...)
+    {
+        stopFlusher();
+        mOutput->close();
+        throw;
+    }
+    stopFlusher();
+    mOutput->close();
+}
+
+void io::BufferedOutputStream::drainActive()
+{
+    if (mFill == 0)
+    {
+        return;
+    }
+
+    if (!mWriteBehind)
+    {
+        mOutput->write(mBuffers[mActive].get(), mFill);
+        mFill = 0;
+        return;
+    }
+
+    // The other buffer has to be written out before we can fill it
+    waitForPending();
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mPending = mBuffers[mActive].get();
+        mPendingSize = mFill;
+    }
+    mCondition.notify_all();
+
+    mActive = 1 - mActive;
+    mFill = 0;
+}
+
+void io::BufferedOutputStream::flushBuffers()
+{
+    const size_t alignment = sys::File::DIRECT_IO_ALIGNMENT;
+    if (mDirectIO && mFill % alignment != 0)
+    {
+        waitForPending();
+
+        sys::byte* const buffer = mBuffers[mActive].get();
+        const size_t numAligned = mFill - mFill % alignment;
+        const size_t numTail = mFill - numAligned;
+        if (numAligned > 0)
+        {
+            mFile->write(buffer, numAligned);
+        }
+
+        // Direct I/O can't write a partial block.  Write the tail through
+        // the page cache, then back up so that it's written again, aligned,
+        // along with whatever comes after it.
+        mFile->setDirectIO(false);
+        mFile->write(buffer + numAligned, numTail);
+        mFile->seek(-static_cast<sys::Off_T>(numTail), Seekable::CURRENT);
+        mFile->setDirectIO(true);
+
+        ::memmove(buffer, buffer + numAligned, numTail);
+        mFill = numTail;
+    }
+    else
+    {
+        drainActive();
+    }
+    waitForPending();
+}
+
+void io::BufferedOutputStream::waitForPending()
+{
+    if (!mWriteBehind)
+    {
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]() { return mPending == nullptr; });
+    if (mError)
+    {
+        std::exception_ptr error = mError;
+        mError = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void io::BufferedOutputStream::flusherLoop()
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    while (true)
+    {
+        mCondition.wait(lock, [this]() { return mPending || mStop; });
+        if (!mPending)
+        {
+            return;
+        }
+
+        const sys::byte* const data = mPending;
+        const size_t size = mPendingSize;
+        lock.unlock();
+        std::exception_ptr error;
+        try
+        {
+            mOutput->write(data, size);
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+        lock.lock();
+
+        if (error && !mError)
+        {
+            mError = error;
+        }
+        mPending = nullptr;
+        mCondition.notify_all();
+    }
+}
+
+void io::BufferedOutputStream::stopFlusher()
+{
+    if (!mFlusher.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mStop = true;
+    }
+    mCondition.notify_all();
+    mFlusher.join();
+}
+
+#endif
@@ -99,3 +99,35 @@ sys::SSize_T io::ByteStream::readImpl(void* buffer, size_t len)
     return static_cast<sys::SSize_T>(len);
 }
 
+
+sys::SSize_T io::ByteStream::readAt(sys::Off_T offset, void* buffer, size_t len)
+{
+    if (offset < 0)
+        throw except::Exception(Ctxt("Invalid read at negative offset"));
+
+    if (offset >= static_cast<sys::Off_T>(mData.size()))
+        return io::InputStream::IS_END;
+
+    const size_t maxSize = mData.size() - static_cast<size_t>(offset);
+    if (len > maxSize) len = maxSize;
+    if (len == 0) return 0;
+
+    ::memcpy(buffer, &mData[static_cast<size_t>(offset)], len);
+    return static_cast<sys::SSize_T>(len);
+}
+
+void io::ByteStream::writeAt(sys::Off_T offset, const void* buffer, size_t len)
+{
+    if (offset < 0)
+        throw except::Exception(Ctxt("Invalid write at negative offset"));
+
+    if (len > 0)
+    {
+        const size_t end = static_cast<size_t>(offset) + len;
+        if (end > mData.size())
+            mData.resize(end);
+
+        const auto bufferPtr = static_cast<const sys::ubyte*>(buffer);
+        std::copy(bufferPtr, bufferPtr + len, &mData[static_cast<size_t>(offset)]);
+    }
+}
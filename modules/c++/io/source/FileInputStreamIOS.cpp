@@ -102,6 +102,14 @@ void io::FileInputStreamIOS::close()
     mFStream.close();
 }
 
+sys::SSize_T io::FileInputStreamIOS::readAt(sys::Off_T offset,
+                                            void* buffer,
+                                            size_t len)
+{
+    std::lock_guard<std::mutex> lock(mPositionalMutex);
+    return SeekableInputStream::readAt(offset, buffer, len);
+}
+
 sys::SSize_T io::FileInputStreamIOS::readImpl(void* buffer, size_t len)
 {
     ::memset(buffer, 0, len);
@@ -24,6 +24,12 @@
 
 #if !defined(USE_IO_STREAMS)
 
+#if defined(__linux) || defined(__linux__)
+#include <sys/uio.h>
+#include <limits.h>
+#include <errno.h>
+#endif
+
 /*!
  * Returns the number of bytes that can be read
  * without blocking by the next caller of a method for this input
@@ -56,4 +62,92 @@ sys::SSize_T io::FileInputStreamOS::readImpl(void* buffer, size_t len)
     return static_cast<sys::SSize_T>(len);
 }
 
+sys::SSize_T io::FileInputStreamOS::readAt(sys::Off_T offset,
+                                           void* buffer,
+                                           size_t len)
+{
+#ifdef _WIN32
+    std::lock_guard<std::mutex> lock(*mPositionalMutex);
+#endif
+    const size_t bytesRead = mFile.readAtMost(offset, buffer, len);
+    if (bytesRead == 0 && len > 0)
+        return io::InputStream::IS_EOF;
+    return static_cast<sys::SSize_T>(bytesRead);
+}
+
+#if defined(__linux) || defined(__linux__)
+namespace
+{
+// preadv() until every byte of every iovec has been filled
+void preadvFully(int handle, sys::Off_T offset, std::vector<iovec>& iov)
+{
+    size_t first = 0;
+    while (first < iov.size())
+    {
+        const ssize_t bytesRead = ::preadv(handle,
+                                           &iov[first],
+                                           static_cast<int>(iov.size() - first),
+                                           offset);
+        if (bytesRead == -1)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            throw sys::SystemException(Ctxt("While reading from file"));
+        }
+        if (bytesRead == 0)
+        {
+            throw sys::SystemException(Ctxt("Unexpected end of file"));
+        }
+
+        offset += bytesRead;
+        size_t remaining = static_cast<size_t>(bytesRead);
+        while (first < iov.size() && remaining >= iov[first].iov_len)
+        {
+            remaining -= iov[first].iov_len;
+            ++first;
+        }
+        if (remaining > 0)
+        {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+}
+}
+#endif
+
+void io::FileInputStreamOS::readv(const std::vector<IoSegment>& segments)
+{
+#if defined(__linux) || defined(__linux__)
+    std::vector<iovec> iov;
+    size_t ii = 0;
+    while (ii < segments.size())
+    {
+        const sys::Off_T start = segments[ii].offset;
+        sys::Off_T end = start;
+        iov.clear();
+        for (; ii < segments.size() && segments[ii].offset == end &&
+               iov.size() < IOV_MAX; ++ii)
+        {
+            if (segments[ii].length == 0)
+                continue;
+            iovec vec;
+            vec.iov_base = segments[ii].buffer;
+            vec.iov_len = segments[ii].length;
+            iov.push_back(vec);
+            end += static_cast<sys::Off_T>(segments[ii].length);
+        }
+        preadvFully(mFile.getHandle(), start, iov);
+    }
+#else
+#ifdef _WIN32
+    std::lock_guard<std::mutex> lock(*mPositionalMutex);
+#endif
+    for (const auto& segment : segments)
+    {
+        mFile.readAt(segment.offset, segment.buffer, segment.length);
+    }
+#endif
+}
+
 #endif
@@ -24,6 +24,12 @@
 
 #if !defined(USE_IO_STREAMS)
 
+#if defined(__linux) || defined(__linux__)
+#include <sys/uio.h>
+#include <limits.h>
+#include <errno.h>
+#endif
+
 io::FileOutputStreamOS::FileOutputStreamOS(const path& str,
         int creationFlags)
 {
@@ -47,6 +53,87 @@ void io::FileOutputStreamOS::write(const void* buffer, size_t len)
     mFile.writeFrom(buffer, len);
 }
 
+void io::FileOutputStreamOS::writeAt(sys::Off_T offset,
+                                     const void* buffer,
+                                     size_t len)
+{
+#ifdef _WIN32
+    std::lock_guard<std::mutex> lock(*mPositionalMutex);
+#endif
+    mFile.writeAt(offset, buffer, len);
+}
+
+#if defined(__linux) || defined(__linux__)
+namespace
+{
+// pwritev() until every byte of every iovec has been written
+void pwritevFully(int handle, sys::Off_T offset, std::vector<iovec>& iov)
+{
+    size_t first = 0;
+    while (first < iov.size())
+    {
+        const ssize_t bytesWritten = ::pwritev(handle,
+                                               &iov[first],
+                                               static_cast<int>(iov.size() - first),
+                                               offset);
+        if (bytesWritten == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            throw sys::SystemException(Ctxt("Writing to file"));
+        }
+
+        offset += bytesWritten;
+        size_t remaining = static_cast<size_t>(bytesWritten);
+        while (first < iov.size() && remaining >= iov[first].iov_len)
+        {
+            remaining -= iov[first].iov_len;
+            ++first;
+        }
+        if (remaining > 0)
+        {
+            iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + remaining;
+            iov[first].iov_len -= remaining;
+        }
+    }
+}
+}
+#endif
+
+void io::FileOutputStreamOS::writev(const std::vector<ConstIoSegment>& segments)
+{
+#if defined(__linux) || defined(__linux__)
+    std::vector<iovec> iov;
+    size_t ii = 0;
+    while (ii < segments.size())
+    {
+        const sys::Off_T start = segments[ii].offset;
+        sys::Off_T end = start;
+        iov.clear();
+        for (; ii < segments.size() && segments[ii].offset == end &&
+               iov.size() < IOV_MAX; ++ii)
+        {
+            if (segments[ii].length == 0)
+                continue;
+            iovec vec;
+            vec.iov_base = const_cast<void*>(segments[ii].buffer);
+            vec.iov_len = segments[ii].length;
+            iov.push_back(vec);
+            end += static_cast<sys::Off_T>(segments[ii].length);
+        }
+        pwritevFully(mFile.getHandle(), start, iov);
+    }
+#else
+#ifdef _WIN32
+    std::lock_guard<std::mutex> lock(*mPositionalMutex);
+#endif
+    for (const auto& segment : segments)
+    {
+        mFile.writeAt(segment.offset, segment.buffer, segment.length);
+    }
+#endif
+}
+
 void io::FileOutputStreamOS::flush()
 {
     mFile.flush();
@@ -22,9 +22,24 @@
 
 #include <sstream>
 #include <io/FileUtils.h>
-#include <io/FileInputStream.h>
+
+#include <errno.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include <mt/WorkSharingBalancedRunnable1D.h>
+#include <sys/FileFinder.h>
 #include <io/FileOutputStream.h>
 
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/sendfile.h>
+#endif
+
 /*!
  *  Copy a file or directory permissions and ownership.
  *
@@ -74,9 +89,196 @@ void copyPermissions(const std::string& src,
 #endif
 }
 
+namespace
+{
+// Report progress at least this often while copying a large file
+const uint64_t PROGRESS_BYTES = 64 * 1024 * 1024;
+
+struct FileToCopy final
+{
+    std::string source;
+    std::string destination;
+};
+
+bool isDelimiter(char ch)
+{
+    return ch == '/' || ch == sys::Path::delimiter()[0];
+}
+
+std::string copyFailed(const FileToCopy& file)
+{
+    std::ostringstream oss;
+    oss << "Copy Failed: Could not copy source [" <<
+        file.source << "] to destination [" <<
+        file.destination << "]";
+    return oss.str();
+}
+
+// The part of 'entry' below 'root', which it must be under; empty for root
+std::string relativePath(const std::string& root, const std::string& entry)
+{
+    if (entry.compare(0, root.length(), root) != 0 ||
+        (entry.length() > root.length() && !root.empty() &&
+         !isDelimiter(root.back()) && !isDelimiter(entry[root.length()])))
+    {
+        throw except::Exception(Ctxt("Copy Failed: [" + entry +
+                                     "] isn't under [" + root + "]"));
+    }
+    size_t start = root.length();
+    while (start < entry.length() && isDelimiter(entry[start]))
+    {
+        ++start;
+    }
+    return entry.substr(start);
+}
+
+// Totals across all of the copying threads
+class ProgressReporter final
+{
+public:
+    ProgressReporter(size_t numFiles,
+                     const std::function<void(const io::CopyProgress&)>& callback) :
+        mCallback(callback),
+        mStart(std::chrono::steady_clock::now())
+    {
+        mProgress.numFiles = numFiles;
+    }
+
+    void addBytes(uint64_t numBytes)
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mProgress.numBytesCopied += numBytes;
+        if (mProgress.numBytesCopied - mReportedBytes >= PROGRESS_BYTES)
+        {
+            report();
+        }
+    }
+
+    void addFile()
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        ++mProgress.numFilesCopied;
+        report();
+    }
+
+private:
+    void report()
+    {
+        if (mCallback)
+        {
+            const std::chrono::duration<double> elapsed =
+                    std::chrono::steady_clock::now() - mStart;
+            mProgress.seconds = elapsed.count();
+            mReportedBytes = mProgress.numBytesCopied;
+            mCallback(mProgress);
+        }
+    }
+
+    const std::function<void(const io::CopyProgress&)>& mCallback;
+    const std::chrono::steady_clock::time_point mStart;
+    std::mutex mMutex;
+    io::CopyProgress mProgress;
+    uint64_t mReportedBytes = 0;
+};
+
+#if defined(__linux__)
+// Copy in the kernel, without the data passing through user space.  Stops
+// (returning what's been copied) as soon as neither call works for this
+// pair of files, e.g. copy_file_range() across file systems on older
+// kernels; both files' offsets are left just past the copied data.
+uint64_t copyInKernel(int inFd, int outFd, uint64_t size,
+                      ProgressReporter& reporter)
+{
+    // large chunks, but progress still gets reported now and then
+    const size_t chunkSize = static_cast<size_t>(PROGRESS_BYTES);
+
+    bool useCopyFileRange = true;
+    bool useSendfile = true;
+    uint64_t copied = 0;
+    while (copied < size && (useCopyFileRange || useSendfile))
+    {
+        const size_t numBytes = static_cast<size_t>(
+                std::min<uint64_t>(size - copied, chunkSize));
+        const ssize_t result = useCopyFileRange ?
+                ::copy_file_range(inFd, nullptr, outFd, nullptr, numBytes, 0) :
+                ::sendfile(outFd, inFd, nullptr, numBytes);
+        if (result < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno == EXDEV || errno == ENOSYS || errno == EINVAL ||
+                errno == EOPNOTSUPP || errno == EBADF)
+            {
+                (useCopyFileRange ? useCopyFileRange : useSendfile) = false;
+                continue;
+            }
+            throw sys::SystemException(Ctxt("Copy Failed: kernel copy"));
+        }
+        if (result == 0)
+        {
+            break; // the file got shorter
+        }
+        copied += static_cast<uint64_t>(result);
+        reporter.addBytes(static_cast<uint64_t>(result));
+    }
+    return copied;
+}
+#endif
+
+void copyFile(const FileToCopy& file,
+              size_t blockSize,
+              ProgressReporter& reporter)
+{
+    sys::File input(file.source);
+    sys::File output(file.destination, sys::File::WRITE_ONLY,
+                     sys::File::CREATE | sys::File::TRUNCATE);
+    const uint64_t size = static_cast<uint64_t>(input.length());
+    output.preallocate(static_cast<sys::Off_T>(size));
+
+    uint64_t copied = 0;
+#if defined(__linux__)
+    copied = copyInKernel(input.getHandle(), output.getHandle(), size,
+                          reporter);
+#endif
+
+    // whatever the kernel couldn't do
+    std::vector<sys::byte> buffer;
+    if (copied < size)
+    {
+        buffer.resize(static_cast<size_t>(
+                std::min<uint64_t>(size - copied, std::max<size_t>(blockSize, 1))));
+    }
+    while (copied < size)
+    {
+        const size_t numBytes = static_cast<size_t>(
+                std::min<uint64_t>(size - copied, buffer.size()));
+        input.readInto(buffer.data(), numBytes);
+        output.writeFrom(buffer.data(), numBytes);
+        copied += numBytes;
+        reporter.addBytes(numBytes);
+    }
+
+    input.close();
+    output.close();
+    copyPermissions(file.source, file.destination);
+    reporter.addFile();
+}
+}
+
 void io::copy(const std::string& path, 
               const std::string& newPath,
               size_t blockSize)
+{
+    CopyOptions options;
+    options.blockSize = blockSize;
+    io::copy(path, newPath, options);
+}
+
+void io::copy(const std::string& path, 
+              const std::string& newPath,
+              const CopyOptions& options)
 {
     //! list will find '.' and '..' in the directory
     const std::string item = sys::Path::splitPath(path).second;
@@ -85,46 +287,78 @@ void io::copy(const std::string& path,
         return;
     }
 
-    sys::OS os;
-    if(os.isDirectory(path))
+    const sys::OS os;
+    if (!os.exists(path))
     {
-        std::string destDir = sys::Path::joinPaths(newPath, item);
+        throw except::FileNotFoundException(Ctxt(path));
+    }
 
-        // make the destination directory if it doesn't exist
-        if (!os.exists(destDir))
+    // Create the directories (parents first) and list the files; the
+    // source's path is replaced by the destination's in each entry.
+    const std::string destination = sys::Path::joinPaths(newPath, item);
+    std::vector<FileToCopy> files;
+    sys::FileFinder::walk({ path }, [&](const std::vector<sys::FileEntry>& entries)
+    {
+        for (const auto& entry : entries)
         {
-            os.makeDirectory(destDir);
+            if (entry.type == sys::FileEntry::Type::Other)
+            {
+                if (entry.path == path)
+                {
+                    throw except::IOException(Ctxt(
+                            "Copy Failed: [" + path +
+                            "] is neither a file nor a directory"));
+                }
+                continue; // sockets, FIFOs, devices, etc.
+            }
+
+            const std::string relative = relativePath(path, entry.path);
+            const std::string destPath = relative.empty() ? destination :
+                    sys::Path::joinPaths(destination, relative);
+            if (entry.type == sys::FileEntry::Type::Directory)
+            {
+                // make the destination directory if it doesn't exist
+                if (!os.exists(destPath))
+                {
+                    os.makeDirectory(destPath);
+                }
+                copyPermissions(entry.path, destPath);
+            }
+            else
+            {
+                files.push_back({ entry.path, destPath });
+            }
         }
-        copyPermissions(path, destDir);
+    }, true /*recursive*/);
 
-        // recursively copy directories
-        std::vector<std::string> contents = sys::Path::list(path);
-        for (size_t ii = 0; ii < contents.size(); ++ii)
+    ProgressReporter reporter(files.size(), options.progress);
+    std::atomic<bool> failed(false);
+    const auto copyOne = [&](size_t ii)
+    {
+        if (failed)
         {
-            std::string srcFile  = sys::Path::joinPaths(path, contents[ii]);
-            io::copy(srcFile, destDir, blockSize);
+            return; // don't start anything new
         }
-    }
-    else
-    {
-        std::string newFile = sys::Path::joinPaths(newPath, item);
-        io::FileInputStream fis(path);
-        io::FileOutputStream fos(newFile);
-        const sys::SSize_T numBytes = fis.streamTo(fos);
-        fis.close();
-        fos.close();
-
-        copyPermissions(path, newFile);
-
-        if (numBytes < 0)
+        try
         {
-            std::ostringstream oss;
-            oss << "Copy Failed: Could not copy source [" <<
-                path << "] to destination [" <<
-                newFile << "]";
-            throw except::Exception(Ctxt(oss.str()));
+            copyFile(files[ii], options.blockSize, reporter);
         }
-    }
+        catch (const except::Exception& ex)
+        {
+            failed = true;
+            throw except::Exception(ex, Ctxt(copyFailed(files[ii])));
+        }
+        catch (const std::exception& ex)
+        {
+            failed = true;
+            throw except::Exception(Ctxt(copyFailed(files[ii]) + ": " +
+                                         ex.what()));
+        }
+    };
+    mt::runWorkSharingBalanced1D(files.size(),
+                                 std::min(std::max<size_t>(options.numThreads, 1),
+                                          std::max<size_t>(files.size(), 1)),
+                                 copyOne);
 }
 
 std::string io::FileUtils::createFile(std::string dirname,
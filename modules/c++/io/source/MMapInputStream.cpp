@@ -22,65 +22,329 @@
 
 #include "io/MMapInputStream.h"
 
-void io::MMapInputStream::open(const std::string& fname, char* flags)
+#include <string.h>
+
+#include <algorithm>
+
+#if !(defined(WIN32) || defined(_WIN32))
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "except/Exception.h"
+#include "str/Convert.h"
+
+void io::MMapInputStream::open(const std::string& inputFile,
+                               int flags,
+                               size_t maxWindowSize)
 {
-    mLength = mOs.getSize(fname);
-    //    std::cout << mLength << std::endl;
-    mFile = fopen(fname.c_str(), "r");
-    if (!mFile)
-        throw sys::SystemException(FmtX("Failure while opening file: %s", fname.c_str()));
+    close();
 
-    _map();
+    mFile.create(inputFile, sys::File::READ_ONLY, sys::File::EXISTING);
+    mLength = mFile.length();
+    mMark = 0;
+    mFlags = flags;
+    mAdvice = NORMAL;
 
+#if defined(WIN32) || defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    mGranularity = info.dwAllocationGranularity;
+#else
+    mGranularity = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+#endif
+
+    // Windows always start on a page boundary, so size them in whole pages
+    mMaxWindowSize = (maxWindowSize + mGranularity - 1) /
+            mGranularity * mGranularity;
+    if (static_cast<sys::Off_T>(mMaxWindowSize) >= mLength)
+    {
+        mMaxWindowSize = 0;
+    }
+
+    if (mLength == 0)
+    {
+        // Nothing to map
+        return;
+    }
+
+    try
+    {
+#if defined(WIN32) || defined(_WIN32)
+        mMapping = CreateFileMapping(mFile.getHandle(), nullptr,
+                                     PAGE_READONLY, 0, 0, nullptr);
+        if (!mMapping)
+        {
+            throw sys::SystemException(Ctxt(
+                    "Unable to create a mapping of " + inputFile));
+        }
+#endif
+        if (!isWindowed())
+        {
+            map(0, static_cast<size_t>(mLength));
+        }
+    }
+    catch (...)
+    {
+        close();
+        throw;
+    }
 }
 
 void io::MMapInputStream::close()
 {
-    _unmap();
-    fclose(mFile);
-    mFile = NULL;
+    unmap();
+#if defined(WIN32) || defined(_WIN32)
+    if (mMapping)
+    {
+        CloseHandle(static_cast<HANDLE>(mMapping));
+    }
+#endif
+    mMapping = nullptr;
+    if (mFile.isOpen())
+    {
+        mFile.close();
+    }
+    mLength = 0;
+    mMark = 0;
 }
 
-void io::MMapInputStream::_map()
+sys::Off_T io::MMapInputStream::seek(sys::Off_T offset, Whence whence)
 {
-    sys::Handle_T handle = getHandle();
-    mData = (sys::byte*)mOs.mapFile(handle, mLength, PROT_READ, MAP_SHARED, 0);
+    sys::Off_T mark = offset;
+    switch (whence)
+    {
+    case END:
+        mark += mLength;
+        break;
+    case CURRENT:
+        mark += mMark;
+        break;
+    case START:
+    default:
+        break;
+    }
+
+    if (mark < 0)
+    {
+        throw except::IOException(Ctxt("Cannot seek before the start of " +
+                                       mFile.getPath().getPath()));
+    }
+    mMark = mark;
+    return mMark;
 }
-void io::MMapInputStream::_unmap()
+
+void io::MMapInputStream::advise(Advice advice)
 {
-    //     std::cout << "Unmapping file... ";
-    mOs.unmapFile(mData, mLength);
-    mData = NULL;
-    //    std::cout << "done!" << std::endl;
+    std::lock_guard<std::mutex> lock(mWindowMutex);
+    mAdvice = advice;
+    applyAdvice();
 }
 
-sys::Handle_T io::MMapInputStream::getHandle()
+void io::MMapInputStream::prefetch(sys::Off_T offset, size_t len)
 {
-    if (!mFile) throw except::NullPointerReference(Ctxt("Uninitialized memory mapped file stream!"));
-    return ::fileno(mFile);
+    if (offset < 0 || offset >= mLength)
+    {
+        return;
+    }
+    len = static_cast<size_t>(std::min<sys::Off_T>(len, mLength - offset));
+    if (isWindowed())
+    {
+        len = std::min(len, mMaxWindowSize);
+    }
+
+    std::lock_guard<std::mutex> lock(mWindowMutex);
+    const sys::byte* const address = mapRange(offset, len);
+#if !(defined(WIN32) || defined(_WIN32))
+    // The advice has to start on a page boundary
+    const size_t pad = static_cast<size_t>(offset - mWindowOffset) % mGranularity;
+    (void) ::posix_madvise(const_cast<sys::byte*>(address - pad), len + pad,
+                           POSIX_MADV_WILLNEED);
+#else
+    (void) address;
+#endif
 }
 
+coda_oss::span<const coda_oss::byte>
+io::MMapInputStream::getSpan(sys::Off_T offset, size_t len)
+{
+    if (offset < 0 || offset > mLength ||
+        static_cast<sys::Off_T>(len) > mLength - offset)
+    {
+        throw except::IOException(Ctxt(
+                "Range of " + str::toString(len) + " bytes at offset " +
+                str::toString(offset) + " runs past the end of " +
+                mFile.getPath().getPath()));
+    }
+    if (len == 0)
+    {
+        return coda_oss::span<const coda_oss::byte>();
+    }
 
+    const sys::byte* address;
+    if (!isWindowed())
+    {
+        address = mWindow + offset;
+    }
+    else
+    {
+        if (len > mMaxWindowSize)
+        {
+            throw except::IOException(Ctxt(
+                    "Cannot view " + str::toString(len) +
+                    " bytes at once with a window of " +
+                    str::toString(mMaxWindowSize) + " bytes"));
+        }
+        std::lock_guard<std::mutex> lock(mWindowMutex);
+        address = mapRange(offset, len);
+    }
+    return coda_oss::span<const coda_oss::byte>(
+            reinterpret_cast<const coda_oss::byte*>(address), len);
+}
 
-long io::MMapInputStream::seek(long off)
+sys::SSize_T io::MMapInputStream::readAt(sys::Off_T offset,
+                                         void* buffer,
+                                         size_t len)
 {
-    long where = mMark;
-    mMark = off;
-    return mMark - where;
-}
+    if (offset < 0 || offset >= mLength)
+    {
+        return io::InputStream::IS_EOF;
+    }
+    len = static_cast<size_t>(std::min<sys::Off_T>(len, mLength - offset));
+
+    if (!isWindowed())
+    {
+        ::memcpy(buffer, mWindow + offset, len);
+        return static_cast<sys::SSize_T>(len);
+    }
 
+    // Copy at most a window's worth at a time
+    std::lock_guard<std::mutex> lock(mWindowMutex);
+    sys::byte* const output = static_cast<sys::byte*>(buffer);
+    size_t numCopied = 0;
+    while (numCopied < len)
+    {
+        const size_t numToCopy = std::min(len - numCopied, mMaxWindowSize);
+        const sys::Off_T position = offset + static_cast<sys::Off_T>(numCopied);
+        ::memcpy(output + numCopied, mapRange(position, numToCopy), numToCopy);
+        numCopied += numToCopy;
+    }
+    return static_cast<sys::SSize_T>(len);
+}
 
 sys::SSize_T io::MMapInputStream::readImpl(void* buffer, size_t len)
 {
-    int size = available();
-    //    std::cout << "Available: " << size << std::endl;
-    //     std::cout << "Len: " << len << std::endl;
-
-    if (len < size)
-        size = len;
-    memcpy(buffer, &mData[mMark], size);
-    mMark += size;
-    //    std::cout << "Used: " << size << std::endl;
-    return size;
+    const sys::SSize_T numRead = readAt(mMark, buffer, len);
+    if (numRead > 0)
+    {
+        mMark += numRead;
+    }
+    return numRead;
 }
 
+const sys::byte* io::MMapInputStream::mapRange(sys::Off_T offset, size_t len)
+{
+    if (mWindow && offset >= mWindowOffset &&
+        offset + static_cast<sys::Off_T>(len) <=
+                mWindowOffset + static_cast<sys::Off_T>(mWindowSize))
+    {
+        return mWindow + (offset - mWindowOffset);
+    }
+
+    // Slide the window so that it starts on the page holding offset
+    const sys::Off_T start = offset - offset % mGranularity;
+    const size_t needed = static_cast<size_t>(offset - start) + len;
+    const size_t size = static_cast<size_t>(std::min<sys::Off_T>(
+            mLength - start, std::max(mMaxWindowSize, needed)));
+    unmap();
+    map(start, size);
+    return mWindow + (offset - start);
+}
+
+void io::MMapInputStream::map(sys::Off_T offset, size_t len)
+{
+#if defined(WIN32) || defined(_WIN32)
+    LARGE_INTEGER start;
+    start.QuadPart = offset;
+    void* const address = MapViewOfFile(static_cast<HANDLE>(mMapping),
+                                        FILE_MAP_READ,
+                                        start.HighPart,
+                                        start.LowPart,
+                                        len);
+    if (!address)
+    {
+        throw sys::SystemException(Ctxt("Unable to map " +
+                                        mFile.getPath().getPath()));
+    }
+#else
+    int mapFlags = MAP_SHARED;
+#if defined(MAP_POPULATE)
+    if (mFlags & POPULATE)
+    {
+        mapFlags |= MAP_POPULATE;
+    }
+#endif
+    void* const address = ::mmap(nullptr, len, PROT_READ, mapFlags,
+                                 mFile.getHandle(), offset);
+    if (address == MAP_FAILED)
+    {
+        throw sys::SystemException(Ctxt("Unable to map " +
+                                        mFile.getPath().getPath()));
+    }
+#if defined(MADV_HUGEPAGE)
+    if (mFlags & HUGE_PAGES)
+    {
+        (void) ::madvise(address, len, MADV_HUGEPAGE);
+    }
+#endif
+#endif
+
+    mWindow = static_cast<sys::byte*>(address);
+    mWindowOffset = offset;
+    mWindowSize = len;
+    applyAdvice();
+}
+
+void io::MMapInputStream::unmap()
+{
+    if (!mWindow)
+    {
+        return;
+    }
+#if defined(WIN32) || defined(_WIN32)
+    UnmapViewOfFile(mWindow);
+#else
+    ::munmap(mWindow, mWindowSize);
+#endif
+    mWindow = nullptr;
+    mWindowOffset = 0;
+    mWindowSize = 0;
+}
+
+void io::MMapInputStream::applyAdvice()
+{
+#if !(defined(WIN32) || defined(_WIN32))
+    if (!mWindow)
+    {
+        return;
+    }
+
+    int advice = POSIX_MADV_NORMAL;
+    switch (mAdvice)
+    {
+    case SEQUENTIAL:
+        advice = POSIX_MADV_SEQUENTIAL;
+        break;
+    case RANDOM:
+        advice = POSIX_MADV_RANDOM;
+        break;
+    case WILL_NEED:
+        advice = POSIX_MADV_WILLNEED;
+        break;
+    case NORMAL:
+    default:
+        break;
+    }
+    (void) ::posix_madvise(mWindow, mWindowSize, advice);
+#endif
+}
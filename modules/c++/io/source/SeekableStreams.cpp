@@ -0,0 +1,96 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#include "io/SeekableStreams.h"
+
+#include "except/Exception.h"
+#include "str/Convert.h"
+
+sys::SSize_T io::SeekableInputStream::readAt(sys::Off_T offset,
+                                             void* buffer,
+                                             size_t len)
+{
+    const sys::Off_T where = tell();
+    seek(offset, Seekable::START);
+
+    sys::SSize_T numRead;
+    try
+    {
+        numRead = read(buffer, len);
+    }
+    catch (...)
+    {
+        seek(where, Seekable::START);
+        throw;
+    }
+    seek(where, Seekable::START);
+    return numRead;
+}
+
+void io::SeekableInputStream::readv(const std::vector<IoSegment>& segments)
+{
+    for (const auto& segment : segments)
+    {
+        auto buffer = static_cast<sys::byte*>(segment.buffer);
+        size_t numRead = 0;
+        while (numRead < segment.length)
+        {
+            const sys::SSize_T thisRead =
+                    readAt(segment.offset + numRead,
+                           buffer + numRead,
+                           segment.length - numRead);
+            if (thisRead <= 0)
+            {
+                throw except::IOException(Ctxt(
+                        "Unexpected end of stream reading segment at offset " +
+                        str::toString(segment.offset)));
+            }
+            numRead += static_cast<size_t>(thisRead);
+        }
+    }
+}
+
+void io::SeekableOutputStream::writeAt(sys::Off_T offset,
+                                       const void* buffer,
+                                       size_t len)
+{
+    const sys::Off_T where = tell();
+    seek(offset, Seekable::START);
+    try
+    {
+        write(buffer, len);
+    }
+    catch (...)
+    {
+        seek(where, Seekable::START);
+        throw;
+    }
+    seek(where, Seekable::START);
+}
+
+void io::SeekableOutputStream::writev(
+        const std::vector<ConstIoSegment>& segments)
+{
+    for (const auto& segment : segments)
+    {
+        writeAt(segment.offset, segment.buffer, segment.length);
+    }
+}
@@ -20,37 +20,98 @@
  *
  */
 
+#include <string.h>
+
 #include <algorithm>
 #include <sstream>
 
 #include <io/StreamSplitter.h>
 #include <except/Exception.h>
 #include <io/InputStream.h>
+#include <mt/Runnable1D.h>
+
+namespace
+{
+/*!
+ * Reads a range of a seekable stream through readAt() so that several
+ * threads can read the same stream at once
+ */
+class RangeInputStream final : public io::InputStream
+{
+public:
+    RangeInputStream(io::SeekableInputStream& stream,
+                     sys::Off_T begin,
+                     sys::Off_T end) :
+        mStream(stream),
+        mPosition(begin),
+        mEnd(end)
+    {
+    }
+
+    sys::Off_T available() override
+    {
+        return mEnd - mPosition;
+    }
+
+protected:
+    sys::SSize_T readImpl(void* buffer, size_t len) override
+    {
+        const size_t numToRead = static_cast<size_t>(
+                std::min<sys::Off_T>(len, mEnd - mPosition));
+        if (numToRead == 0)
+        {
+            return io::InputStream::IS_EOF;
+        }
+
+        const sys::SSize_T numRead =
+                mStream.readAt(mPosition, buffer, numToRead);
+        if (numRead > 0)
+        {
+            mPosition += numRead;
+        }
+        return numRead;
+    }
+
+private:
+    io::SeekableInputStream& mStream;
+    sys::Off_T mPosition;
+    const sys::Off_T mEnd;
+};
+}
 
 namespace io
 {
 StreamSplitter::StreamSplitter(io::InputStream& inputStream,
                                const std::string& delimiter,
                                size_t bufferSize) :
-    mDelimiter(delimiter),
+    StreamSplitter(inputStream,
+                   std::vector<std::string>(1, delimiter),
+                   bufferSize)
+{
+}
+
+StreamSplitter::StreamSplitter(io::InputStream& inputStream,
+                               const std::vector<std::string>& delimiters,
+                               size_t bufferSize) :
+    mMaxDelimiterSize(0),
+    mIsDelimiterStart(256, false),
+    mDelimiterStart(-1),
+    mPendingDelimiterSize(0),
     mBufferValidBegin(0),
     mBufferValidEnd(0),
     mNumSubstringsReturned(0),
     mNumBytesReturned(0),
     mNumDelimitersProcessed(0),
+    mNumDelimiterBytesProcessed(0),
     mBufferStorage(bufferSize),
     mBufferCapacity(mBufferStorage.size()),
     mBuffer(mBufferStorage.empty() ? NULL : &mBufferStorage[0]),
     mInputStream(inputStream),
     mStreamEmpty(false)
 {
-    if (delimiter.empty())
-    {
-        throw except::InvalidArgumentException(
-                Ctxt("delimiter must be a string with size > 0"));
-    }
+    initDelimiters(delimiters);
 
-    if (static_cast<size_t>(mBufferCapacity) < delimiter.size() * 2 + 1)
+    if (static_cast<size_t>(mBufferCapacity) < mMaxDelimiterSize * 2 + 1)
     {
         std::ostringstream os;
         os << "bufferSize must be >= twice the delimiter size + 1 byte. "
@@ -59,6 +120,41 @@ StreamSplitter::StreamSplitter(io::InputStream& inputStream,
     }
 }
 
+void StreamSplitter::initDelimiters(const std::vector<std::string>& delimiters)
+{
+    if (delimiters.empty())
+    {
+        throw except::InvalidArgumentException(
+                Ctxt("at least one delimiter is required"));
+    }
+
+    mDelimiters = delimiters;
+    for (size_t ii = 0; ii < mDelimiters.size(); ++ii)
+    {
+        const std::string& delimiter = mDelimiters[ii];
+        if (delimiter.empty())
+        {
+            throw except::InvalidArgumentException(
+                    Ctxt("delimiter must be a string with size > 0"));
+        }
+
+        mMaxDelimiterSize = std::max(mMaxDelimiterSize, delimiter.size());
+        mIsDelimiterStart[static_cast<unsigned char>(delimiter[0])] = true;
+    }
+
+    // When delimiters match at the same position, the longest one wins
+    std::stable_sort(mDelimiters.begin(), mDelimiters.end(),
+                     [](const std::string& lhs, const std::string& rhs)
+                     {
+                         return lhs.size() > rhs.size();
+                     });
+
+    if (std::count(mIsDelimiterStart.begin(), mIsDelimiterStart.end(), true) == 1)
+    {
+        mDelimiterStart = static_cast<unsigned char>(mDelimiters[0][0]);
+    }
+}
+
 bool StreamSplitter::getNext(std::string& substring)
 {
     if (isEnd())
@@ -66,11 +162,9 @@ bool StreamSplitter::getNext(std::string& substring)
         return false;
     }
 
-    if (mNumDelimitersProcessed > 0)
-    {
-        // discard the delimiter before the start of the next substring
-        mBufferValidBegin += mDelimiter.size();
-    }
+    // discard the delimiter before the start of the next substring
+    mBufferValidBegin += mPendingDelimiterSize;
+    mPendingDelimiterSize = 0;
 
     size_t substringSize = 0;
     while (true)
@@ -78,32 +172,26 @@ bool StreamSplitter::getNext(std::string& substring)
         handleStreamRead();
 
         // search for delimiter in buffer
-        for (sys::SSize_T ii = mBufferValidBegin;
-             ii < mBufferValidEnd - static_cast<sys::SSize_T>(mDelimiter.size() - 1);
-             ++ii)
+        size_t delimiterSize = 0;
+        const sys::SSize_T searchEnd = getSearchEnd();
+        const sys::SSize_T delimiterPos =
+                findDelimiter(mBufferValidBegin, searchEnd, delimiterSize);
+        if (delimiterPos >= 0)
         {
-            if (0 == mDelimiter.compare(0,
-                                        mDelimiter.size(),
-                                        mBuffer + ii,
-                                        mDelimiter.size()))
-            {
-                // delimiter found starting at buffer position ii
-                // append the buffer contents preceding that point to output
-                transferBufferSegmentToSubstring(substring, substringSize, ii);
-                mNumDelimitersProcessed++;
-                mNumSubstringsReturned++;
-                mNumBytesReturned += substringSize;
-                return true;
-            }
+            // append the buffer contents preceding the delimiter to output
+            transferBufferSegmentToSubstring(substring, substringSize,
+                                             delimiterPos);
+            mPendingDelimiterSize = delimiterSize;
+            mNumDelimitersProcessed++;
+            mNumDelimiterBytesProcessed += delimiterSize;
+            mNumSubstringsReturned++;
+            mNumBytesReturned += substringSize;
+            return true;
         }
 
         // no delimiter found in buffer
         // append the current buffer contents to output
-        const sys::SSize_T segmentEnd = mStreamEmpty ?
-                mBufferValidEnd
-                :
-                mBufferValidEnd - static_cast<sys::SSize_T>(mDelimiter.size() - 1);
-        transferBufferSegmentToSubstring(substring, substringSize, segmentEnd);
+        transferBufferSegmentToSubstring(substring, substringSize, searchEnd);
 
         // if no bytes remain in stream or buffer, we are done
         if (isEnd())
@@ -117,6 +205,88 @@ bool StreamSplitter::getNext(std::string& substring)
     }
 }
 
+bool StreamSplitter::getNext(View& substring)
+{
+    if (isEnd())
+    {
+        return false;
+    }
+
+    mBufferValidBegin += mPendingDelimiterSize;
+    mPendingDelimiterSize = 0;
+
+    // The part of the substring already searched, relative to
+    // mBufferValidBegin since reads may shift the buffer contents
+    sys::SSize_T searchedSize = 0;
+    while (true)
+    {
+        if (!mStreamEmpty && mBufferValidEnd == mBufferCapacity &&
+            mBufferValidBegin <= mBufferCapacity / 2)
+        {
+            // the substring takes up most of the buffer, so shifting it
+            // down won't make enough space
+            growBuffer();
+        }
+        handleStreamRead();
+
+        size_t delimiterSize = 0;
+        const sys::SSize_T searchEnd = getSearchEnd();
+        const sys::SSize_T delimiterPos =
+                findDelimiter(mBufferValidBegin + searchedSize,
+                              searchEnd,
+                              delimiterSize);
+        if (delimiterPos >= 0 || mStreamEmpty)
+        {
+            const sys::SSize_T substringEnd =
+                    delimiterPos >= 0 ? delimiterPos : mBufferValidEnd;
+            const size_t substringSize =
+                    static_cast<size_t>(substringEnd - mBufferValidBegin);
+            substring = View(mBuffer + mBufferValidBegin, substringSize);
+            mBufferValidBegin = substringEnd;
+
+            if (delimiterPos >= 0)
+            {
+                mPendingDelimiterSize = delimiterSize;
+                mNumDelimitersProcessed++;
+                mNumDelimiterBytesProcessed += delimiterSize;
+            }
+            mNumSubstringsReturned++;
+            mNumBytesReturned += substringSize;
+            return true;
+        }
+
+        searchedSize = std::max(searchedSize, searchEnd - mBufferValidBegin);
+    }
+}
+
+bool StreamSplitter::skipPastDelimiter()
+{
+    while (true)
+    {
+        handleStreamRead();
+
+        size_t delimiterSize = 0;
+        const sys::SSize_T searchEnd = getSearchEnd();
+        const sys::SSize_T delimiterPos =
+                findDelimiter(mBufferValidBegin, searchEnd, delimiterSize);
+        if (delimiterPos >= 0)
+        {
+            mNumBytesReturned += delimiterPos - mBufferValidBegin;
+            mBufferValidBegin = delimiterPos + delimiterSize;
+            mNumDelimitersProcessed++;
+            mNumDelimiterBytesProcessed += delimiterSize;
+            return true;
+        }
+
+        mNumBytesReturned += searchEnd - mBufferValidBegin;
+        mBufferValidBegin = searchEnd;
+        if (isEnd())
+        {
+            return false;
+        }
+    }
+}
+
 bool StreamSplitter::isEnd() const
 {
     return mStreamEmpty && mBufferValidBegin >= mBufferValidEnd;
@@ -134,7 +304,130 @@ size_t StreamSplitter::getNumBytesReturned() const
 
 size_t StreamSplitter::getNumBytesProcessed() const
 {
-    return getNumBytesReturned() + mNumDelimitersProcessed * mDelimiter.size();
+    return getNumBytesReturned() + mNumDelimiterBytesProcessed;
+}
+
+void StreamSplitter::splitParallel(io::SeekableInputStream& inputStream,
+                                   const std::vector<std::string>& delimiters,
+                                   size_t numThreads,
+                                   const SubstringHandler& handler,
+                                   size_t bufferSize)
+{
+    const sys::Off_T begin = inputStream.tell();
+    const sys::Off_T end = begin + inputStream.available();
+    numThreads = std::max<size_t>(numThreads, 1);
+
+    // Move each evenly spaced boundary forward to just past the next
+    // delimiter.  The search backs up a little so that a delimiter
+    // straddling the boundary is found whole.
+    std::vector<sys::Off_T> chunkBegins(1, begin);
+    std::vector<sys::Off_T> chunkEnds;
+    size_t maxDelimiterSize = 0;
+    for (size_t ii = 0; ii < delimiters.size(); ++ii)
+    {
+        maxDelimiterSize = std::max(maxDelimiterSize, delimiters[ii].size());
+    }
+    for (size_t ii = 1; ii < numThreads; ++ii)
+    {
+        const sys::Off_T boundary = begin +
+                (end - begin) * static_cast<sys::Off_T>(ii) /
+                static_cast<sys::Off_T>(numThreads);
+        const sys::Off_T searchBegin = std::max(
+                boundary - static_cast<sys::Off_T>(maxDelimiterSize) + 1,
+                chunkBegins.back());
+
+        RangeInputStream range(inputStream, searchBegin, end);
+        StreamSplitter finder(range, delimiters, bufferSize);
+        if (!finder.skipPastDelimiter())
+        {
+            break;
+        }
+        const sys::Off_T chunkBegin = searchBegin +
+                static_cast<sys::Off_T>(finder.getNumBytesProcessed());
+        chunkEnds.push_back(chunkBegin -
+                static_cast<sys::Off_T>(finder.mNumDelimiterBytesProcessed));
+        chunkBegins.push_back(chunkBegin);
+    }
+    chunkEnds.push_back(end);
+
+    mt::run1D(chunkBegins.size(), chunkBegins.size(),
+              [&](size_t chunk)
+              {
+                  RangeInputStream range(inputStream,
+                                         chunkBegins[chunk],
+                                         chunkEnds[chunk]);
+                  StreamSplitter splitter(range, delimiters, bufferSize);
+                  View substring;
+                  while (splitter.getNext(substring))
+                  {
+                      handler(chunk, substring);
+                  }
+              });
+
+    inputStream.seek(end, io::Seekable::START);
+}
+
+sys::SSize_T StreamSplitter::findDelimiter(sys::SSize_T begin,
+                                           sys::SSize_T end,
+                                           size_t& delimiterSize) const
+{
+    const sys::byte* const bufferEnd = mBuffer + mBufferValidEnd;
+    const sys::byte* const searchEnd = mBuffer + end;
+    const sys::byte* pos = mBuffer + begin;
+    while (pos < searchEnd)
+    {
+        // Jump to the next byte that can start a delimiter.  memchr is
+        // vectorized by the C library, so the common case of delimiters
+        // sharing a first byte (e.g. line breaks) scans much faster than
+        // a byte-by-byte comparison.
+        if (mDelimiterStart >= 0)
+        {
+            pos = static_cast<const sys::byte*>(
+                    ::memchr(pos, mDelimiterStart, searchEnd - pos));
+            if (pos == NULL)
+            {
+                return -1;
+            }
+        }
+        else
+        {
+            while (pos < searchEnd &&
+                   !mIsDelimiterStart[static_cast<unsigned char>(*pos)])
+            {
+                ++pos;
+            }
+            if (pos == searchEnd)
+            {
+                return -1;
+            }
+        }
+
+        for (size_t ii = 0; ii < mDelimiters.size(); ++ii)
+        {
+            const std::string& delimiter = mDelimiters[ii];
+            if (delimiter.size() <= static_cast<size_t>(bufferEnd - pos) &&
+                ::memcmp(pos, delimiter.data(), delimiter.size()) == 0)
+            {
+                delimiterSize = delimiter.size();
+                return pos - mBuffer;
+            }
+        }
+        ++pos;
+    }
+    return -1;
+}
+
+sys::SSize_T StreamSplitter::getSearchEnd() const
+{
+    // Until the stream is exhausted, don't search the last few bytes since
+    // a delimiter starting there might continue past the end of the buffer
+    if (mStreamEmpty)
+    {
+        return mBufferValidEnd;
+    }
+    return std::max(mBufferValidBegin,
+                    mBufferValidEnd -
+                            static_cast<sys::SSize_T>(mMaxDelimiterSize - 1));
 }
 
 void StreamSplitter::transferBufferSegmentToSubstring(
@@ -184,4 +477,11 @@ void StreamSplitter::handleStreamRead()
         }
     }
 }
+
+void StreamSplitter::growBuffer()
+{
+    mBufferStorage.resize(mBufferStorage.size() * 2);
+    mBufferCapacity = mBufferStorage.size();
+    mBuffer = &mBufferStorage[0];
+}
 }
@@ -0,0 +1,199 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <stdlib.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <except/Exception.h>
+#include <io/FileInputStreamOS.h>
+#include <io/FileOutputStream.h>
+#include <io/MMapInputStream.h>
+#include <io/TempFile.h>
+#include <str/Convert.h>
+#include <sys/Conf.h>
+#include <sys/StopWatch.h>
+
+/*!
+ *  Compares reading a file through FileInputStreamOS with reading it
+ *  through MMapInputStream, both by copying and by summing the bytes in
+ *  place through getSpan().  The last pass does random positional reads.
+ */
+namespace
+{
+const size_t CHUNK_SIZE = 64 * 1024;
+
+void report(const std::string& name, double millis, size_t numBytes,
+            size_t checksum)
+{
+    const double mbPerSec = (numBytes / (1024.0 * 1024.0)) / (millis / 1000.0);
+    std::cout << name << ": " << millis << " ms, " << mbPerSec
+              << " MB/s (checksum " << checksum << ")" << std::endl;
+}
+
+size_t sum(const sys::byte* data, size_t size)
+{
+    size_t total = 0;
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        total += static_cast<unsigned char>(data[ii]);
+    }
+    return total;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t numMB = argc > 1 ?
+                str::toType<size_t>(argv[1]) : static_cast<size_t>(256);
+        const size_t numBytes = numMB * 1024 * 1024;
+
+        const io::TempFile tempFile;
+        {
+            std::vector<sys::byte> chunk(CHUNK_SIZE);
+            for (size_t ii = 0; ii < chunk.size(); ++ii)
+            {
+                chunk[ii] = static_cast<sys::byte>(ii * 31);
+            }
+            io::FileOutputStream output(tempFile.pathname());
+            for (size_t ii = 0; ii < numBytes; ii += CHUNK_SIZE)
+            {
+                output.write(chunk.data(), chunk.size());
+            }
+            output.close();
+        }
+
+        std::vector<sys::byte> buffer(CHUNK_SIZE);
+        sys::RealTimeStopWatch sw;
+
+        {
+            sw.start();
+            io::FileInputStreamOS input(tempFile.pathname());
+            size_t checksum = 0;
+            sys::SSize_T numRead;
+            while ((numRead = input.read(buffer.data(), buffer.size())) > 0)
+            {
+                checksum += sum(buffer.data(), static_cast<size_t>(numRead));
+            }
+            report("FileInputStreamOS::read", sw.stop(), numBytes, checksum);
+        }
+
+        {
+            sw.start();
+            io::MMapInputStream input(tempFile.pathname());
+            input.advise(io::MMapInputStream::SEQUENTIAL);
+            size_t checksum = 0;
+            sys::SSize_T numRead;
+            while ((numRead = input.read(buffer.data(), buffer.size())) > 0)
+            {
+                checksum += sum(buffer.data(), static_cast<size_t>(numRead));
+            }
+            report("MMapInputStream::read", sw.stop(), numBytes, checksum);
+        }
+
+        {
+            sw.start();
+            io::MMapInputStream input(tempFile.pathname());
+            input.advise(io::MMapInputStream::SEQUENTIAL);
+            const auto span = input.getSpan();
+            const size_t checksum = sum(
+                    reinterpret_cast<const sys::byte*>(span.data()),
+                    span.size());
+            report("MMapInputStream::getSpan", sw.stop(), numBytes, checksum);
+        }
+
+        {
+            sw.start();
+            io::MMapInputStream input(tempFile.pathname(), 0, 16 * CHUNK_SIZE);
+            input.advise(io::MMapInputStream::SEQUENTIAL);
+            size_t checksum = 0;
+            for (size_t ii = 0; ii < numBytes; ii += CHUNK_SIZE)
+            {
+                const auto span = input.getSpan(ii, CHUNK_SIZE);
+                checksum += sum(
+                        reinterpret_cast<const sys::byte*>(span.data()),
+                        span.size());
+            }
+            report("MMapInputStream::getSpan (windowed)", sw.stop(),
+                   numBytes, checksum);
+        }
+
+        // Random 4K reads
+        const size_t numRandom = numBytes / CHUNK_SIZE * 16;
+        const size_t readSize = 4096;
+        std::vector<sys::Off_T> offsets(numRandom);
+        srand(42);
+        for (size_t ii = 0; ii < numRandom; ++ii)
+        {
+            offsets[ii] = static_cast<sys::Off_T>(
+                    (static_cast<size_t>(rand()) * readSize) %
+                    (numBytes - readSize));
+        }
+
+        {
+            sw.start();
+            io::FileInputStreamOS input(tempFile.pathname());
+            size_t checksum = 0;
+            for (size_t ii = 0; ii < numRandom; ++ii)
+            {
+                input.readAt(offsets[ii], buffer.data(), readSize);
+                checksum += static_cast<unsigned char>(buffer[1]);
+            }
+            report("FileInputStreamOS::readAt (random)", sw.stop(),
+                   numRandom * readSize, checksum);
+        }
+
+        {
+            sw.start();
+            io::MMapInputStream input(tempFile.pathname());
+            input.advise(io::MMapInputStream::RANDOM);
+            size_t checksum = 0;
+            for (size_t ii = 0; ii < numRandom; ++ii)
+            {
+                input.readAt(offsets[ii], buffer.data(), readSize);
+                checksum += static_cast<unsigned char>(buffer[1]);
+            }
+            report("MMapInputStream::readAt (random)", sw.stop(),
+                   numRandom * readSize, checksum);
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+    return 0;
+}
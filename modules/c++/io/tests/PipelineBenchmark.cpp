@@ -0,0 +1,191 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <except/Exception.h>
+#include <io/BufferRingStreams.h>
+#include <io/InputStream.h>
+#include <io/OutputStream.h>
+#include <str/Convert.h>
+#include <sys/Conf.h>
+#include <sys/StopWatch.h>
+
+/*!
+ *  Runs a read -> compute -> write strip loop over streams that take a
+ *  fixed time per block (standing in for a disk or network), first with the
+ *  stages alternating and then with io::transformPipelined overlapping
+ *  them.  With the three stages equally slow the pipeline should approach
+ *  three times the throughput.
+ */
+namespace
+{
+const size_t BLOCK_SIZE = 64 * 1024;
+
+struct ThrottledInputStream final : public io::InputStream
+{
+    ThrottledInputStream(size_t numBytes, std::chrono::microseconds delay) :
+        mRemaining(numBytes),
+        mDelay(delay)
+    {
+    }
+
+protected:
+    sys::SSize_T readImpl(void* buffer, size_t len) override
+    {
+        if (mRemaining == 0)
+        {
+            return io::InputStream::IS_END;
+        }
+        std::this_thread::sleep_for(mDelay);
+        len = std::min(len, mRemaining);
+        memset(buffer, static_cast<int>(++mNumReads & 0xff), len);
+        mRemaining -= len;
+        return static_cast<sys::SSize_T>(len);
+    }
+
+private:
+    size_t mRemaining;
+    size_t mNumReads = 0;
+    const std::chrono::microseconds mDelay;
+};
+
+struct ThrottledOutputStream final : public io::OutputStream
+{
+    explicit ThrottledOutputStream(std::chrono::microseconds delay) :
+        mDelay(delay)
+    {
+    }
+
+    using io::OutputStream::write;
+    void write(const void* buffer, size_t len) override
+    {
+        std::this_thread::sleep_for(mDelay);
+        for (size_t ii = 0; ii < len; ii += 4096)
+        {
+            checksum += static_cast<const unsigned char*>(buffer)[ii];
+        }
+    }
+
+    size_t checksum = 0;
+
+private:
+    const std::chrono::microseconds mDelay;
+};
+
+// Spins for roughly the given time so the compute stage is CPU-bound
+size_t compute(const sys::byte* input,
+               size_t inputSize,
+               sys::byte* output,
+               std::chrono::microseconds duration)
+{
+    const auto end = std::chrono::steady_clock::now() + duration;
+    unsigned char value = 0;
+    do
+    {
+        for (size_t ii = 0; ii < inputSize; ++ii)
+        {
+            value = static_cast<unsigned char>(value * 31 + input[ii]);
+            output[ii] = static_cast<sys::byte>(value);
+        }
+    } while (std::chrono::steady_clock::now() < end);
+    return inputSize;
+}
+
+void report(const std::string& name, double millis, size_t numBytes,
+            size_t checksum)
+{
+    const double mbPerSec = (numBytes / (1024.0 * 1024.0)) / (millis / 1000.0);
+    std::cout << name << ": " << millis << " ms, " << mbPerSec
+              << " MB/s (checksum " << checksum << ")" << std::endl;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t numBlocks = argc > 1 ?
+                str::toType<size_t>(argv[1]) : static_cast<size_t>(200);
+        const std::chrono::microseconds delay(argc > 2 ?
+                str::toType<long>(argv[2]) : 2000);
+        const size_t numBytes = numBlocks * BLOCK_SIZE;
+
+        sys::RealTimeStopWatch sw;
+
+        {
+            sw.start();
+            ThrottledInputStream input(numBytes, delay);
+            ThrottledOutputStream output(delay);
+            std::vector<sys::byte> inputBlock(BLOCK_SIZE);
+            std::vector<sys::byte> outputBlock(BLOCK_SIZE);
+            sys::SSize_T numRead;
+            while ((numRead = input.read(inputBlock.data(),
+                                         inputBlock.size())) > 0)
+            {
+                const size_t numOut = compute(inputBlock.data(),
+                                              static_cast<size_t>(numRead),
+                                              outputBlock.data(), delay);
+                output.write(outputBlock.data(), numOut);
+            }
+            report("Alternating", sw.stop(), numBytes, output.checksum);
+        }
+
+        {
+            sw.start();
+            ThrottledInputStream input(numBytes, delay);
+            ThrottledOutputStream output(delay);
+            io::transformPipelined(
+                    input, output,
+                    [delay](const sys::byte* in, size_t inSize,
+                            sys::byte* out, size_t)
+                    {
+                        return compute(in, inSize, out, delay);
+                    },
+                    BLOCK_SIZE, BLOCK_SIZE);
+            report("Pipelined", sw.stop(), numBytes, output.checksum);
+        }
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (...)
+    {
+        std::cerr << "Unknown exception\n";
+        return 1;
+    }
+    return 0;
+}
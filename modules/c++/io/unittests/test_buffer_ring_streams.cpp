@@ -0,0 +1,192 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+#include <except/Exception.h>
+#include <io/BufferRingStreams.h>
+#include <io/ByteStream.h>
+#include <io/StringStream.h>
+#include "TestCase.h"
+
+namespace
+{
+std::string makeData(size_t size)
+{
+    std::string data(size, ' ');
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        data[ii] = static_cast<char>('a' + ii % 26);
+    }
+    return data;
+}
+
+std::string toString(io::ByteStream& stream)
+{
+    const void* const data = stream.get();
+    return std::string(static_cast<const char*>(data), stream.getSize());
+}
+
+// Upper-cases each block and appends a '|' so block boundaries show up in
+// the output
+size_t markBlock(const sys::byte* input,
+                 size_t inputSize,
+                 sys::byte* output,
+                 size_t outputCapacity)
+{
+    if (inputSize + 1 > outputCapacity)
+    {
+        throw except::Exception(Ctxt("Output block too small"));
+    }
+    for (size_t ii = 0; ii < inputSize; ++ii)
+    {
+        output[ii] = static_cast<sys::byte>(input[ii] - 'a' + 'A');
+    }
+    output[inputSize] = '|';
+    return inputSize + 1;
+}
+
+std::string markBlocks(const std::string& data, size_t blockSize)
+{
+    std::string expected;
+    for (size_t ii = 0; ii < data.size(); ii += blockSize)
+    {
+        for (size_t jj = ii; jj < std::min(ii + blockSize, data.size()); ++jj)
+        {
+            expected += static_cast<char>(data[jj] - 'a' + 'A');
+        }
+        expected += '|';
+    }
+    return expected;
+}
+
+struct FailingInputStream final : public io::InputStream
+{
+    explicit FailingInputStream(size_t numBytes) : mRemaining(numBytes)
+    {
+    }
+
+protected:
+    sys::SSize_T readImpl(void* buffer, size_t len) override
+    {
+        if (mRemaining == 0)
+        {
+            throw except::IOException(Ctxt("Read failed"));
+        }
+        len = std::min(len, mRemaining);
+        memset(buffer, 'a', len);
+        mRemaining -= len;
+        return static_cast<sys::SSize_T>(len);
+    }
+
+private:
+    size_t mRemaining;
+};
+
+struct FailingOutputStream final : public io::OutputStream
+{
+    using io::OutputStream::write;
+    void write(const void*, size_t) override
+    {
+        throw except::IOException(Ctxt("Write failed"));
+    }
+};
+}
+
+TEST_CASE(testTransformPipelined)
+{
+    const size_t blockSize = 100;
+    const size_t sizes[] = {0, 1, blockSize, 3 * blockSize, 12345};
+    for (size_t ii = 0; ii < sizeof(sizes) / sizeof(sizes[0]); ++ii)
+    {
+        const std::string data = makeData(sizes[ii]);
+        io::StringStream input;
+        input.write(data);
+        io::ByteStream output;
+
+        io::transformPipelined(input, output, markBlock,
+                               blockSize, blockSize + 1);
+        TEST_ASSERT_EQ(toString(output), markBlocks(data, blockSize));
+    }
+
+    // a single buffer per ring still works, just without the overlap
+    const std::string data = makeData(1000);
+    io::StringStream input;
+    input.write(data);
+    io::ByteStream output;
+    io::transformPipelined(input, output, markBlock, 64, 65, 1);
+    TEST_ASSERT_EQ(toString(output), markBlocks(data, 64));
+}
+
+TEST_CASE(testErrorsPropagate)
+{
+    // read error
+    {
+        FailingInputStream input(1000);
+        io::ByteStream output;
+        TEST_THROWS(io::transformPipelined(input, output, markBlock, 64, 65));
+    }
+
+    // write error
+    {
+        const std::string data = makeData(100000);
+        io::StringStream input;
+        input.write(data);
+        FailingOutputStream output;
+        TEST_THROWS(io::transformPipelined(input, output, markBlock, 64, 65));
+    }
+
+    // transform error, here from an output block that is too small
+    {
+        const std::string data = makeData(100000);
+        io::StringStream input;
+        input.write(data);
+        io::ByteStream output;
+        TEST_THROWS(io::transformPipelined(input, output, markBlock, 64, 64));
+    }
+}
+
+TEST_CASE(testReaderAndWriter)
+{
+    // The reader and writer can also be used on their own, here to copy
+    // a stream through a ring
+    const std::string data = makeData(5000);
+    io::StringStream input;
+    input.write(data);
+    io::ByteStream output;
+
+    mem::BufferRing ring(4, 128);
+    io::BufferRingReader reader(input, ring);
+    io::BufferRingWriter writer(ring, output);
+    reader.join();
+    writer.join();
+    TEST_ASSERT_EQ(toString(output), data);
+}
+
+TEST_MAIN(
+    TEST_CHECK(testTransformPipelined);
+    TEST_CHECK(testErrorsPropagate);
+    TEST_CHECK(testReaderAndWriter);
+    )
@@ -0,0 +1,138 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <string>
+#include <vector>
+
+#include <io/BufferedOutputStream.h>
+#include <io/ByteStream.h>
+#include <io/FileInputStream.h>
+#include <io/TempFile.h>
+#include "TestCase.h"
+
+namespace
+{
+std::string readFile(const std::string& pathname)
+{
+    io::FileInputStream input(pathname);
+    std::vector<sys::byte> buffer(static_cast<size_t>(input.available()));
+    if (!buffer.empty())
+    {
+        input.read(buffer.data(), buffer.size(), true);
+    }
+    return std::string(buffer.begin(), buffer.end());
+}
+
+std::string toString(io::ByteStream& stream)
+{
+    const void* const data = stream.get();
+    return std::string(static_cast<const char*>(data), stream.getSize());
+}
+
+std::string makeData(size_t size)
+{
+    std::string data(size, ' ');
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        data[ii] = static_cast<char>('a' + ii % 26);
+    }
+    return data;
+}
+}
+
+TEST_CASE(testBufferedUntilFlush)
+{
+    io::ByteStream stream;
+    io::BufferedOutputStream buffered(&stream, false, 16);
+
+    buffered.write("abc");
+    buffered.write("def");
+    TEST_ASSERT_EQ(stream.getSize(), static_cast<size_t>(0));
+
+    buffered.flush();
+    TEST_ASSERT_EQ(stream.getSize(), static_cast<size_t>(6));
+
+    // Filling the buffer forces it out
+    buffered.write("0123456789abcdef");
+    TEST_ASSERT_EQ(stream.getSize(), static_cast<size_t>(22));
+
+    buffered.write("xyz");
+    buffered.close();
+    TEST_ASSERT_EQ(stream.getSize(), static_cast<size_t>(25));
+    TEST_ASSERT_EQ(toString(stream), "abcdef0123456789abcdefxyz");
+}
+
+TEST_CASE(testWriteBehind)
+{
+    const std::string data = makeData(100000);
+    io::ByteStream stream;
+    {
+        io::BufferedOutputStream buffered(&stream, false, 1000,
+                                          io::BufferedOutputStream::WRITE_BEHIND);
+        for (size_t ii = 0; ii < data.size(); ii += 7)
+        {
+            const size_t size = std::min<size_t>(7, data.size() - ii);
+            buffered.write(data.data() + ii, size);
+        }
+        buffered.flush();
+        TEST_ASSERT_EQ(stream.getSize(), data.size());
+
+        // Larger than the buffer
+        buffered.write(data);
+    }
+    TEST_ASSERT_EQ(toString(stream), data + data);
+}
+
+TEST_CASE(testDirectIO)
+{
+    const io::TempFile tempFile;
+    const std::string data = makeData(3 * 4096 + 123);
+    {
+        io::BufferedOutputStream buffered(tempFile.pathname(), 8192,
+                io::BufferedOutputStream::DIRECT_IO |
+                io::BufferedOutputStream::WRITE_BEHIND,
+                data.size() * 2);
+        TEST_ASSERT_EQ(buffered.getBufferSize(), static_cast<size_t>(8192));
+
+        buffered.write(data);
+        buffered.flush();
+        TEST_ASSERT_EQ(readFile(tempFile.pathname()), data);
+
+        // Writing after a partial block was flushed
+        buffered.write(data);
+        buffered.close();
+    }
+    TEST_ASSERT_EQ(readFile(tempFile.pathname()), data + data);
+}
+
+TEST_CASE(testDirectIORequiresFile)
+{
+    io::ByteStream stream;
+    TEST_EXCEPTION(io::BufferedOutputStream(&stream, false, 4096,
+                                            io::BufferedOutputStream::DIRECT_IO));
+}
+
+TEST_MAIN(
+    TEST_CHECK(testBufferedUntilFlush);
+    TEST_CHECK(testWriteBehind);
+    TEST_CHECK(testDirectIO);
+    TEST_CHECK(testDirectIORequiresFile);
+    )
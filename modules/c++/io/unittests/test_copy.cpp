@@ -0,0 +1,199 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/OS.h>
+#include <sys/Path.h>
+#include <io/FileUtils.h>
+#include "TestCase.h"
+
+#if !(defined(WIN32) || defined(_WIN32))
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+const std::string SOURCE = "copyTestSource";
+const std::string DESTINATION = "copyTestDestination";
+
+void removeTrees()
+{
+    const sys::OS os;
+    for (const auto& path : { SOURCE, DESTINATION })
+    {
+        if (os.exists(path))
+        {
+            os.remove(path);
+        }
+    }
+}
+
+std::string contents(size_t size, size_t seed)
+{
+    std::string retval(size, '\0');
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        retval[ii] = static_cast<char>((ii * 31 + seed) % 251);
+    }
+    return retval;
+}
+
+std::string readFile(const std::string& pathname)
+{
+    std::ifstream in(pathname.c_str(), std::ios::binary);
+    std::ostringstream oss;
+    oss << in.rdbuf();
+    return oss.str();
+}
+
+// SOURCE/{empty, small, large, sub/{...}, sub/sub/{...}}
+std::vector<std::string> createSource()
+{
+    removeTrees();
+    const sys::OS os;
+    os.makeDirectory(DESTINATION);
+
+    std::vector<std::string> files;
+    std::string directory = SOURCE;
+    for (size_t level = 0; level < 3; ++level)
+    {
+        os.makeDirectory(directory);
+        const std::vector<size_t> sizes{ 0, 100, 3 * 4096 + 17 };
+        for (size_t ii = 0; ii < sizes.size(); ++ii)
+        {
+            const auto relative = sys::Path::joinPaths(directory, "file" + std::to_string(ii));
+            std::ofstream(relative.c_str(), std::ios::binary) << contents(sizes[ii], level + ii);
+            files.push_back(relative);
+        }
+        directory = sys::Path::joinPaths(directory, "sub");
+    }
+    os.makeDirectory(directory); // an empty one at the bottom
+
+#if !(defined(WIN32) || defined(_WIN32))
+    ::chmod(files[1].c_str(), 0640);
+    ::chmod(files[2].c_str(), 0750);
+#endif
+    return files;
+}
+
+void assertCopied(const std::string& testName, const std::vector<std::string>& files)
+{
+    const sys::OS os;
+    TEST_ASSERT_TRUE(os.isDirectory(sys::Path::joinPaths(DESTINATION, "copyTestSource/sub/sub/sub")));
+    for (const auto& file : files)
+    {
+        const auto copied = sys::Path::joinPaths(DESTINATION, file);
+        TEST_ASSERT_TRUE(os.isFile(copied));
+        TEST_ASSERT(readFile(copied) == readFile(file));
+
+#if !(defined(WIN32) || defined(_WIN32))
+        struct stat sourceStat, copiedStat;
+        TEST_ASSERT(::stat(file.c_str(), &sourceStat) == 0);
+        TEST_ASSERT(::stat(copied.c_str(), &copiedStat) == 0);
+        TEST_ASSERT_EQ(sourceStat.st_mode, copiedStat.st_mode);
+#endif
+    }
+}
+}
+
+TEST_CASE(testCopy)
+{
+    const auto files = createSource();
+    io::copy(SOURCE, DESTINATION);
+    assertCopied(testName, files);
+
+    // and again, over the top of the first copy
+    io::copy(SOURCE, DESTINATION, 4096);
+    assertCopied(testName, files);
+
+    removeTrees();
+}
+
+TEST_CASE(testCopyFile)
+{
+    const auto files = createSource();
+    io::copy(files[2], DESTINATION);
+    const auto copied = sys::Path::joinPaths(DESTINATION, "file2");
+    TEST_ASSERT(readFile(copied) == readFile(files[2]));
+
+    TEST_EXCEPTION(io::copy(sys::Path::joinPaths(SOURCE, "missing"), DESTINATION));
+    removeTrees();
+}
+
+TEST_CASE(testParallelCopy)
+{
+    const auto files = createSource();
+    for (const size_t numThreads : { 1, 2, 4, 32 })
+    {
+        io::CopyOptions options;
+        options.blockSize = 1000;
+        options.numThreads = numThreads;
+
+        size_t numCalls = 0;
+        io::CopyProgress last;
+        options.progress = [&](const io::CopyProgress& progress)
+        {
+            ++numCalls;
+            last = progress;
+        };
+        io::copy(SOURCE, DESTINATION, options);
+        assertCopied(testName, files);
+
+        TEST_ASSERT_EQ(numCalls, files.size());
+        TEST_ASSERT_EQ(last.numFiles, files.size());
+        TEST_ASSERT_EQ(last.numFilesCopied, files.size());
+        TEST_ASSERT_EQ(last.numBytesCopied, static_cast<uint64_t>(3 * (100 + 3 * 4096 + 17)));
+        TEST_ASSERT_GREATER_EQ(last.getBytesPerSecond(), 0.0);
+
+        sys::OS().remove(DESTINATION);
+        sys::OS().makeDirectory(DESTINATION);
+    }
+    removeTrees();
+}
+
+TEST_CASE(testCopySkipsOther)
+{
+    const auto files = createSource();
+#if !(defined(WIN32) || defined(_WIN32))
+    const auto fifo = sys::Path::joinPaths(SOURCE, "fifo");
+    TEST_ASSERT(::mkfifo(fifo.c_str(), 0600) == 0);
+
+    // A FIFO would block the copy forever; it's left behind
+    io::copy("./" + SOURCE, DESTINATION);
+    assertCopied(testName, files);
+    TEST_ASSERT_FALSE(sys::OS().exists(sys::Path::joinPaths(DESTINATION, fifo)));
+
+    TEST_EXCEPTION(io::copy(fifo, DESTINATION));
+#endif
+    removeTrees();
+}
+
+TEST_MAIN(
+    TEST_CHECK(testCopy);
+    TEST_CHECK(testCopyFile);
+    TEST_CHECK(testParallelCopy);
+    TEST_CHECK(testCopySkipsOther);
+    )
@@ -0,0 +1,140 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <string>
+#include <vector>
+
+#include <io/FileOutputStream.h>
+#include <io/MMapInputStream.h>
+#include <io/TempFile.h>
+#include "TestCase.h"
+
+namespace
+{
+std::string makeData(size_t size)
+{
+    std::string data(size, ' ');
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        data[ii] = static_cast<char>('a' + ii % 26);
+    }
+    return data;
+}
+
+void writeFile(const std::string& pathname, const std::string& data)
+{
+    io::FileOutputStream output(pathname);
+    output.write(data);
+    output.close();
+}
+
+std::string toString(coda_oss::span<const coda_oss::byte> span)
+{
+    return std::string(reinterpret_cast<const char*>(span.data()),
+                       span.size());
+}
+}
+
+TEST_CASE(testReadWholeFile)
+{
+    const io::TempFile tempFile;
+    const std::string data = makeData(100000);
+    writeFile(tempFile.pathname(), data);
+
+    io::MMapInputStream input(tempFile.pathname(),
+                              io::MMapInputStream::POPULATE);
+    TEST_ASSERT(!input.isWindowed());
+    TEST_ASSERT_EQ(input.getSize(), static_cast<sys::Off_T>(data.size()));
+    input.advise(io::MMapInputStream::SEQUENTIAL);
+
+    TEST_ASSERT_EQ(toString(input.getSpan()), data);
+    TEST_ASSERT_EQ(toString(input.getSpan(500, 10)), data.substr(500, 10));
+    TEST_EXCEPTION(input.getSpan(data.size() - 5, 10));
+
+    std::vector<char> buffer(data.size());
+    input.read(buffer.data(), 1000, true);
+    TEST_ASSERT_EQ(input.tell(), static_cast<sys::Off_T>(1000));
+    input.read(buffer.data() + 1000, buffer.size() - 1000, true);
+    TEST_ASSERT_EQ(std::string(buffer.begin(), buffer.end()), data);
+    TEST_ASSERT_EQ(input.available(), static_cast<sys::Off_T>(0));
+    TEST_ASSERT_EQ(input.read(buffer.data(), 1),
+                   static_cast<sys::SSize_T>(io::InputStream::IS_EOF));
+
+    input.seek(-26, io::Seekable::END);
+    TEST_ASSERT_EQ(toString(input.getSpan()), data.substr(data.size() - 26));
+    input.seek(-10, io::Seekable::CURRENT);
+    TEST_ASSERT_EQ(input.tell(), static_cast<sys::Off_T>(data.size() - 36));
+}
+
+TEST_CASE(testWindowed)
+{
+    const io::TempFile tempFile;
+    const std::string data = makeData(200000);
+    writeFile(tempFile.pathname(), data);
+
+    // Small enough that reads have to slide the window around
+    io::MMapInputStream input(tempFile.pathname(), 0, 20000);
+    TEST_ASSERT(input.isWindowed());
+
+    TEST_ASSERT_EQ(toString(input.getSpan(150000, 1000)),
+                   data.substr(150000, 1000));
+    TEST_ASSERT_EQ(toString(input.getSpan(3, 7)), data.substr(3, 7));
+    TEST_EXCEPTION(input.getSpan(0, data.size()));
+
+    // Reads larger than the window are copied a window at a time
+    std::vector<char> buffer(data.size());
+    TEST_ASSERT_EQ(input.readAt(12345, buffer.data(), 100000),
+                   static_cast<sys::SSize_T>(100000));
+    TEST_ASSERT_EQ(std::string(buffer.data(), 100000),
+                   data.substr(12345, 100000));
+
+    input.read(buffer.data(), buffer.size(), true);
+    TEST_ASSERT_EQ(std::string(buffer.begin(), buffer.end()), data);
+
+    // Positional reads don't move the mark
+    TEST_ASSERT_EQ(input.readAt(data.size() - 4, buffer.data(), 10),
+                   static_cast<sys::SSize_T>(4));
+    TEST_ASSERT_EQ(input.readAt(data.size(), buffer.data(), 10),
+                   static_cast<sys::SSize_T>(io::InputStream::IS_EOF));
+    TEST_ASSERT_EQ(input.tell(), static_cast<sys::Off_T>(data.size()));
+}
+
+TEST_CASE(testEmptyFile)
+{
+    const io::TempFile tempFile;
+    writeFile(tempFile.pathname(), "");
+
+    io::MMapInputStream input(tempFile.pathname());
+    TEST_ASSERT_EQ(input.getSize(), static_cast<sys::Off_T>(0));
+    TEST_ASSERT(input.getSpan().empty());
+    char c;
+    TEST_ASSERT_EQ(input.read(&c, 1),
+                   static_cast<sys::SSize_T>(io::InputStream::IS_EOF));
+    input.close();
+    input.close();
+}
+
+TEST_MAIN(
+    TEST_CHECK(testReadWholeFile);
+    TEST_CHECK(testWindowed);
+    TEST_CHECK(testEmptyFile);
+    )
@@ -0,0 +1,210 @@
+/* =========================================================================
+ * This file is part of io-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * io-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+#include <io/ByteStream.h>
+#include <io/SerializableArray.h>
+#include "TestCase.h"
+
+namespace
+{
+std::vector<int> makeData(size_t size)
+{
+    std::vector<int> data(size);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        data[ii] = static_cast<int>(ii * 7 + 1);
+    }
+    return data;
+}
+}
+
+TEST_CASE(testContiguous)
+{
+    std::vector<int> data = makeData(1000);
+    io::ByteStream stream;
+    io::SerializableArray<int>(data.data(), data.size()).serialize(stream);
+    TEST_ASSERT_EQ(stream.getSize(), data.size() * sizeof(int));
+
+    stream.seek(0, io::Seekable::START);
+    std::vector<int> result(data.size());
+    io::SerializableArray<int>(result.data(), result.size()).deserialize(stream);
+    TEST_ASSERT(result == data);
+}
+
+TEST_CASE(testStridedSerialize)
+{
+    // Large enough to span several blocks
+    std::vector<int> data = makeData(100000);
+    const size_t skip = 2;
+    io::ByteStream stream;
+    io::SerializableArray<int>(data.data(), 5, data.size() - 5, skip).serialize(stream);
+
+    std::vector<int> expected;
+    for (size_t ii = 5; ii < data.size(); ii += skip + 1)
+    {
+        expected.push_back(data[ii]);
+    }
+    TEST_ASSERT_EQ(stream.getSize(), expected.size() * sizeof(int));
+
+    stream.seek(0, io::Seekable::START);
+    std::vector<int> result(expected.size());
+    stream.read(result.data(), result.size() * sizeof(int), true);
+    TEST_ASSERT(result == expected);
+}
+
+TEST_CASE(testStridedDeserialize)
+{
+    std::vector<int> data = makeData(100003);
+    io::ByteStream stream;
+    stream.write(data.data(), data.size() * sizeof(int));
+    stream.seek(0, io::Seekable::START);
+
+    // Every 4th element is kept, packed at the front of the buffer
+    const size_t skip = 3;
+    std::vector<int> result(data.size() / (skip + 1) + 1);
+    io::SerializableArray<int>(result.data(), 0, data.size(), skip).deserialize(stream);
+    for (size_t ii = 0; ii < result.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(result[ii], data[ii * (skip + 1)]);
+    }
+    TEST_ASSERT_EQ(stream.available(), static_cast<sys::Off_T>(0));
+}
+
+TEST_CASE(testShortInput)
+{
+    // Both paths refuse a stream that runs out early
+    std::vector<int> data = makeData(10);
+    io::ByteStream stream;
+    stream.write(data.data(), data.size() * sizeof(int));
+
+    stream.seek(0, io::Seekable::START);
+    std::vector<int> result(20, -1);
+    TEST_EXCEPTION(io::SerializableArray<int>(result.data(), result.size()).deserialize(stream));
+
+    stream.seek(0, io::Seekable::START);
+    TEST_EXCEPTION(io::SerializableArray<int>(result.data(), 0, result.size(), 1).deserialize(stream));
+
+    // Including partway through an element
+    io::ByteStream partial;
+    partial.write(data.data(), data.size() * sizeof(int) - 1);
+    partial.seek(0, io::Seekable::START);
+    TEST_EXCEPTION(io::SerializableArray<int>(result.data(), data.size()).deserialize(partial));
+    partial.seek(0, io::Seekable::START);
+    TEST_EXCEPTION(io::SerializableArray<int>(result.data(), 0, data.size(), 1).deserialize(partial));
+
+    // Exactly enough is fine
+    stream.seek(0, io::Seekable::START);
+    std::fill(result.begin(), result.end(), -1);
+    io::SerializableArray<int>(result.data(), 0, data.size(), 1).deserialize(stream);
+    for (size_t ii = 0; ii < 5; ++ii)
+    {
+        TEST_ASSERT_EQ(result[ii], data[ii * 2]);
+    }
+    TEST_ASSERT_EQ(result[5], -1);
+}
+
+TEST_CASE(testShortReads)
+{
+    // Like a pipe or socket, hands back a few bytes at a time, splitting
+    // elements across reads
+    struct TrickleStream : public io::ByteStream
+    {
+    protected:
+        sys::SSize_T readImpl(void* buffer, size_t len) override
+        {
+            return io::ByteStream::readImpl(buffer, std::min<size_t>(len, 7));
+        }
+    };
+
+    std::vector<int> data = makeData(50000);
+    TrickleStream stream;
+    stream.write(data.data(), data.size() * sizeof(int));
+
+    stream.seek(0, io::Seekable::START);
+    std::vector<int> result(data.size());
+    io::SerializableArray<int>(result.data(), result.size()).deserialize(stream);
+    TEST_ASSERT(result == data);
+
+    stream.seek(0, io::Seekable::START);
+    const size_t skip = 2;
+    std::vector<int> strided(data.size() / (skip + 1) + 1);
+    io::SerializableArray<int>(strided.data(), 0, data.size(), skip).deserialize(stream);
+    for (size_t ii = 0; ii < strided.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(strided[ii], data[ii * (skip + 1)]);
+    }
+    TEST_ASSERT_EQ(stream.available(), static_cast<sys::Off_T>(0));
+}
+
+TEST_CASE(testByteSwap)
+{
+    std::vector<std::complex<float> > data;
+    for (size_t ii = 0; ii < 10; ++ii)
+    {
+        data.push_back(std::complex<float>(static_cast<float>(ii),
+                                           static_cast<float>(-ii)));
+    }
+    const std::vector<std::complex<float> > original(data);
+
+    io::ByteStream stream;
+    io::SerializableArray<std::complex<float> > out(data.data(), 0, data.size(), 1);
+    out.setByteSwap(sizeof(float));
+    out.serialize(stream);
+    TEST_ASSERT(data == original);
+
+    stream.seek(0, io::Seekable::START);
+    std::vector<std::complex<float> > swapped(5);
+    stream.read(swapped.data(), swapped.size() * sizeof(swapped[0]), true);
+    for (size_t ii = 0; ii < swapped.size(); ++ii)
+    {
+        TEST_ASSERT_EQ(swapped[ii].real(),
+                       sys::byteSwap(original[ii * 2].real()));
+        TEST_ASSERT_EQ(swapped[ii].imag(),
+                       sys::byteSwap(original[ii * 2].imag()));
+    }
+
+    // Swapping again on the way in restores the values
+    stream.seek(0, io::Seekable::START);
+    std::vector<std::complex<float> > result(swapped.size());
+    io::SerializableArray<std::complex<float> > in(result.data(), result.size());
+    in.setByteSwap(sizeof(float));
+    in.deserialize(stream);
+    for (size_t ii = 0; ii < result.size(); ++ii)
+    {
+        TEST_ASSERT(result[ii] == original[ii * 2]);
+    }
+
+    TEST_EXCEPTION(in.setByteSwap(3));
+}
+
+TEST_MAIN(
+    TEST_CHECK(testContiguous);
+    TEST_CHECK(testStridedSerialize);
+    TEST_CHECK(testStridedDeserialize);
+    TEST_CHECK(testShortInput);
+    TEST_CHECK(testShortReads);
+    TEST_CHECK(testByteSwap);
+    )
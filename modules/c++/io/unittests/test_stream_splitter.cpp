@@ -21,10 +21,14 @@
  */
 
 #include <algorithm>
+#include <mutex>
 #include <string>
 #include <vector>
+#include <io/FileInputStreamOS.h>
+#include <io/FileOutputStream.h>
 #include <io/StreamSplitter.h>
 #include <io/StringStream.h>
+#include <io/TempFile.h>
 #include <TestCase.h>
 
 // return true if the string sequences are the same, false otherwise
@@ -232,9 +236,158 @@ TEST_CASE(testStreamSplitterInputValidation)
     TEST_ASSERT(streamSplitterTestRunner(10, 10, "abc", 7));
 }
 
+// split with the string and view versions of getNext() and check they agree
+std::vector<std::string> splitViews(const std::string& input,
+                                    const std::vector<std::string>& delimiters,
+                                    size_t bufferSize)
+{
+    io::StringStream stringStream;
+    stringStream.write(input);
+    io::StreamSplitter stringSplitter(stringStream, delimiters, bufferSize);
+
+    io::StringStream viewStream;
+    viewStream.write(input);
+    io::StreamSplitter viewSplitter(viewStream, delimiters, bufferSize);
+
+    std::vector<std::string> substrings;
+    std::string substring;
+    io::StreamSplitter::View view;
+    while (viewSplitter.getNext(view))
+    {
+        substrings.push_back(std::string(view.data(), view.size()));
+        if (!stringSplitter.getNext(substring) || substring != substrings.back())
+        {
+            throw except::Exception(Ctxt("String and view splits differ"));
+        }
+    }
+    if (stringSplitter.getNext(substring) ||
+        viewSplitter.getNumBytesProcessed() != input.size() ||
+        stringSplitter.getNumBytesProcessed() != input.size())
+    {
+        throw except::Exception(Ctxt("String and view splits differ"));
+    }
+    return substrings;
+}
+
+TEST_CASE(testStreamSplitterView)
+{
+    std::vector<std::string> lines;
+    std::string input;
+    for (size_t ii = 0; ii < 40; ++ii)
+    {
+        // some lines are longer than the smaller buffers
+        lines.push_back(std::string(ii % 13 * 3, static_cast<char>('a' + ii % 26)));
+        input += lines.back();
+        if (ii < 39)
+        {
+            input += "\n";
+        }
+    }
+
+    const size_t bufferSizes[] = { 3, 4, 7, 16, 65536 };
+    for (size_t ii = 0; ii < sizeof(bufferSizes) / sizeof(bufferSizes[0]); ++ii)
+    {
+        const std::vector<std::string> substrings = splitViews(
+                input, std::vector<std::string>(1, "\n"), bufferSizes[ii]);
+        TEST_ASSERT(compareStringSequence(substrings, lines));
+    }
+
+    // the view stays valid until the next call
+    io::StringStream stream;
+    stream.write("abc\ndef");
+    io::StreamSplitter splitter(stream);
+    io::StreamSplitter::View view;
+    TEST_ASSERT(splitter.getNext(view));
+    TEST_ASSERT_EQ(std::string(view.data(), view.size()), "abc");
+    TEST_ASSERT(splitter.getNext(view));
+    TEST_ASSERT_EQ(std::string(view.data(), view.size()), "def");
+    TEST_ASSERT(!splitter.getNext(view));
+}
+
+TEST_CASE(testStreamSplitterMultipleDelimiters)
+{
+    std::vector<std::string> delimiters;
+    delimiters.push_back("\n");
+    delimiters.push_back("\r\n");
+    delimiters.push_back(",");
+
+    std::vector<std::string> expected;
+    expected.push_back("a");
+    expected.push_back("bb");
+    expected.push_back("ccc");
+    expected.push_back("");
+    expected.push_back("dd\r");
+    expected.push_back("e");
+
+    const std::string input = "a\r\nbb,ccc\n,dd\r\r\ne";
+    const size_t bufferSizes[] = { 5, 6, 9, 65536 };
+    for (size_t ii = 0; ii < sizeof(bufferSizes) / sizeof(bufferSizes[0]); ++ii)
+    {
+        TEST_ASSERT(compareStringSequence(
+                splitViews(input, delimiters, bufferSizes[ii]), expected));
+    }
+
+    TEST_EXCEPTION(splitViews(input, std::vector<std::string>(), 100));
+    delimiters.push_back("");
+    TEST_EXCEPTION(splitViews(input, delimiters, 100));
+}
+
+TEST_CASE(testStreamSplitterParallel)
+{
+    std::vector<std::string> delimiters;
+    delimiters.push_back("\r\n");
+
+    std::vector<std::string> lines;
+    std::string input;
+    for (size_t ii = 0; ii < 5000; ++ii)
+    {
+        lines.push_back(std::string(ii % 17, static_cast<char>('a' + ii % 26)));
+        input += lines.back() + "\r\n";
+    }
+    lines.push_back(""); // after the final delimiter
+
+    const io::TempFile tempFile;
+    {
+        io::FileOutputStream output(tempFile.pathname());
+        output.write(input);
+        output.close();
+    }
+
+    const size_t threadCounts[] = { 1, 2, 3, 7, 16 };
+    for (size_t ii = 0; ii < sizeof(threadCounts) / sizeof(threadCounts[0]); ++ii)
+    {
+        const size_t numThreads = threadCounts[ii];
+        std::vector<std::vector<std::string> > chunks(numThreads);
+        std::mutex mutex;
+
+        io::FileInputStreamOS stream(tempFile.pathname());
+        io::StreamSplitter::splitParallel(
+                stream, delimiters, numThreads,
+                [&](size_t chunk, io::StreamSplitter::View substring)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    chunks.at(chunk).push_back(
+                            std::string(substring.data(), substring.size()));
+                },
+                64);
+        TEST_ASSERT_EQ(stream.tell(), static_cast<sys::Off_T>(input.size()));
+
+        std::vector<std::string> substrings;
+        for (size_t chunk = 0; chunk < chunks.size(); ++chunk)
+        {
+            substrings.insert(substrings.end(),
+                              chunks[chunk].begin(), chunks[chunk].end());
+        }
+        TEST_ASSERT(compareStringSequence(substrings, lines));
+    }
+}
+
 int main(int, char**)
 {
     TEST_CHECK(testStreamSplitterEmpty);
     TEST_CHECK(testStreamSplitter);
     TEST_CHECK(testStreamSplitterInputValidation);
+    TEST_CHECK(testStreamSplitterView);
+    TEST_CHECK(testStreamSplitterMultipleDelimiters);
+    TEST_CHECK(testStreamSplitterParallel);
 }
@@ -23,7 +23,11 @@
 #include <std/span>
 #include <std/cstddef>
 
+#include <thread>
+#include <vector>
+
 #include <import/io.h>
+#include <io/TempFile.h>
 #include <mem/BufferView.h>
 #include <sys/Conf.h>
 #include <TestCase.h>
@@ -220,6 +224,135 @@ TEST_CASE(testBufferViewIntStream)
     TEST_ASSERT_EQ(output[1], 0);
 }
 
+TEST_CASE(testByteStreamPositional)
+{
+    io::ByteStream stream;
+    stream.write("0123456789");
+    stream.seek(3, io::Seekable::START);
+
+    char buf[8] = {};
+    TEST_ASSERT_EQ(stream.readAt(5, buf, 3), 3);
+    TEST_ASSERT_EQ(std::string(buf, 3), "567");
+    TEST_ASSERT_EQ(stream.readAt(8, buf, 5), 2);
+    TEST_ASSERT_EQ(stream.readAt(10, buf, 1), io::InputStream::IS_EOF);
+    TEST_ASSERT_EQ(stream.tell(), 3);
+
+    char first[2], second[3];
+    std::vector<io::IoSegment> segments(2);
+    segments[0].offset = 7; segments[0].buffer = first; segments[0].length = 2;
+    segments[1].offset = 0; segments[1].buffer = second; segments[1].length = 3;
+    stream.readv(segments);
+    TEST_ASSERT_EQ(std::string(first, 2), "78");
+    TEST_ASSERT_EQ(std::string(second, 3), "012");
+
+    segments[0].offset = 9;
+    TEST_EXCEPTION(stream.readv(segments));
+
+    stream.writeAt(8, "abcd", 4);
+    TEST_ASSERT_EQ(stream.getSize(), static_cast<size_t>(12));
+    TEST_ASSERT_EQ(stream.tell(), 3);
+    TEST_ASSERT_EQ(stream.readAt(6, buf, 6), 6);
+    TEST_ASSERT_EQ(std::string(buf, 6), "67abcd");
+}
+
+TEST_CASE(testBufferViewReadAt)
+{
+    // Falls back on seek() + read()
+    std::string data("0123456789");
+    mem::BufferView<sys::ubyte> bufferView(
+            reinterpret_cast<sys::ubyte*>(&data[0]), data.size());
+    io::BufferViewStream<sys::ubyte> stream(bufferView);
+    stream.seek(2, io::Seekable::START);
+
+    char buf[4] = {};
+    TEST_ASSERT_EQ(stream.readAt(6, buf, 4), 4);
+    TEST_ASSERT_EQ(std::string(buf, 4), "6789");
+    TEST_ASSERT_EQ(stream.tell(), 2);
+
+    stream.writeAt(0, "ab", 2);
+    TEST_ASSERT_EQ(data, "ab23456789");
+    TEST_ASSERT_EQ(stream.tell(), 2);
+}
+
+TEST_CASE(testFilePositional)
+{
+    const io::TempFile tempFile;
+    const size_t blockSize = 1000;
+    const size_t numBlocks = 16;
+
+    std::vector<std::vector<sys::ubyte> > blocks(numBlocks);
+    for (size_t ii = 0; ii < numBlocks; ++ii)
+    {
+        blocks[ii].assign(blockSize, static_cast<sys::ubyte>(ii));
+    }
+    {
+        // Write the blocks out of order; the adjacent ones get coalesced
+        std::vector<io::ConstIoSegment> segments;
+        for (size_t ii = numBlocks / 2; ii < numBlocks; ++ii)
+        {
+            io::ConstIoSegment segment = { static_cast<sys::Off_T>(ii * blockSize),
+                                           blocks[ii].data(), blockSize };
+            segments.push_back(segment);
+        }
+        for (size_t ii = 0; ii < numBlocks / 2; ++ii)
+        {
+            io::ConstIoSegment segment = { static_cast<sys::Off_T>(ii * blockSize),
+                                           blocks[ii].data(), blockSize };
+            segments.push_back(segment);
+        }
+        io::FileOutputStreamOS output(tempFile.pathname());
+        output.writev(segments);
+        TEST_ASSERT_EQ(output.tell(), 0);
+    }
+
+    io::FileInputStreamOS input(tempFile.pathname());
+
+    // Each thread reads its own blocks from the same stream
+    std::vector<std::vector<sys::ubyte> > results(numBlocks,
+            std::vector<sys::ubyte>(blockSize));
+    std::vector<std::thread> threads;
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        threads.emplace_back([&, ii]()
+        {
+            for (size_t block = ii; block < numBlocks; block += 4)
+            {
+                input.readAt(static_cast<sys::Off_T>(block * blockSize),
+                             results[block].data(), blockSize);
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    TEST_ASSERT(results == blocks);
+    TEST_ASSERT_EQ(input.tell(), 0);
+
+    // Half of each of two adjacent blocks, then the start of the file
+    std::vector<sys::ubyte> gathered(blockSize + 10);
+    std::vector<io::IoSegment> segments(3);
+    segments[0].offset = blockSize / 2;
+    segments[0].buffer = gathered.data();
+    segments[0].length = blockSize / 2;
+    segments[1].offset = blockSize;
+    segments[1].buffer = gathered.data() + blockSize / 2;
+    segments[1].length = blockSize / 2;
+    segments[2].offset = 0;
+    segments[2].buffer = gathered.data() + blockSize;
+    segments[2].length = 10;
+    input.readv(segments);
+    TEST_ASSERT_EQ(gathered[0], 0);
+    TEST_ASSERT_EQ(gathered[blockSize / 2], 1);
+    TEST_ASSERT_EQ(gathered[blockSize], 0);
+
+    // Reads running past the end come up short
+    TEST_ASSERT_EQ(input.readAt(numBlocks * blockSize - 3, gathered.data(), 10),
+                   3);
+    TEST_ASSERT_EQ(input.readAt(numBlocks * blockSize, gathered.data(), 1),
+                   io::InputStream::IS_EOF);
+}
+
 void cleanupFiles(std::string base)
 {
     // cleanup
@@ -327,6 +460,9 @@ TEST_MAIN(
     TEST_CHECK(testCountingOutputStream);
     TEST_CHECK(testBufferViewStream);
     TEST_CHECK(testBufferViewIntStream);
+    TEST_CHECK(testByteStreamPositional);
+    TEST_CHECK(testBufferViewReadAt);
+    TEST_CHECK(testFilePositional);
     TEST_CHECK(testRotate);
     TEST_CHECK(testNeverRotate);
     TEST_CHECK(testRotateReset);
@@ -27,6 +27,7 @@
 #include <sstream>
 #include <vector>
 #include <iterator>
+#include <coda_oss/span.h>
 #include <math/linear/Vector.h>
 
 namespace math
@@ -191,6 +192,23 @@ public:
     void copyFrom(const OneD<_T>& p);
 
     _T operator ()(double at) const;
+
+#ifndef SWIG // SWIG doesn't know coda_oss::span
+    /*!
+     * Evaluates the polynomial at every point of 'at', writing the results
+     * to 'out'.  This runs Horner's method across a block of points at a
+     * time, which the compiler can vectorize, so it's much faster than
+     * calling operator() per point.  Results may differ from operator() in
+     * the last bits.
+     *
+     * \param at The points to evaluate at
+     * \param out The results; must be the same size as 'at'
+     * \throws except::Exception if the sizes differ
+     */
+    void evaluate(coda_oss::span<const double> at,
+                  coda_oss::span<_T> out) const;
+#endif
+
     _T integrate(double start, double end) const;
     OneD<_T>derivative() const;
     _T velocity(double x) const;
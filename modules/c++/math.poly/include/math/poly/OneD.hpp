@@ -20,7 +20,9 @@
  *
  */
 
+#include <algorithm>
 #include <cmath>
+#include <string>
 #include <import/except.h>
 #include <import/sys.h>
 #include <math/poly/Utils.h>
@@ -46,6 +48,48 @@ OneD<_T>::operator () (double at) const
    return ret;
 }
 
+template<typename _T>
+void
+OneD<_T>::evaluate(coda_oss::span<const double> at,
+                   coda_oss::span<_T> out) const
+{
+    if (at.size() != out.size())
+    {
+        throw except::Exception(Ctxt(
+                "Got " + std::to_string(at.size()) + " points but room for " +
+                std::to_string(out.size()) + " results"));
+    }
+    if (empty())
+    {
+        std::fill(out.begin(), out.end(), _T(0.0));
+        return;
+    }
+
+    // Each pass over a block applies one coefficient to every point, so
+    // the inner loop has no dependencies between iterations.  The block
+    // stays in cache across the passes.
+    static const size_t blockSize = 256;
+    const double* const x = at.data();
+    _T* const y = out.data();
+    const size_t last = mCoef.size() - 1;
+    for (size_t start = 0; start < at.size(); start += blockSize)
+    {
+        const size_t end = std::min(at.size(), start + blockSize);
+        for (size_t ii = start; ii < end; ++ii)
+        {
+            y[ii] = mCoef[last];
+        }
+        for (size_t jj = last; jj-- > 0;)
+        {
+            const _T coef = mCoef[jj];
+            for (size_t ii = start; ii < end; ++ii)
+            {
+                y[ii] = y[ii] * x[ii] + coef;
+            }
+        }
+    }
+}
+
 template<typename _T>
 _T
 OneD<_T>::integrate(double start, double end) const
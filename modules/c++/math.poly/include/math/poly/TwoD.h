@@ -101,6 +101,32 @@ public:
         return mCoef[0].order();
     }
     _T operator () (double atX, double atY) const;
+
+#ifndef SWIG // SWIG doesn't know coda_oss::span
+    /*!
+     * Evaluates the polynomial at every (xs[i], ys[i]), writing the results
+     * to 'out'.  Like OneD::evaluate(), this works a block of points at a
+     * time so the compiler can vectorize it.
+     *
+     * \throws except::Exception if the spans aren't all the same size
+     */
+    void evaluate(coda_oss::span<const double> xs,
+                  coda_oss::span<const double> ys,
+                  coda_oss::span<_T> out) const;
+
+    /*!
+     * Evaluates the polynomial at every point of the grid xs by ys, writing
+     * xs.size() rows of ys.size() results to 'out', so that
+     * out[i * ys.size() + j] == poly(xs[i], ys[j]).  The y terms are only
+     * evaluated once per column.
+     *
+     * \throws except::Exception if 'out' isn't xs.size() * ys.size()
+     */
+    void evaluateGrid(coda_oss::span<const double> xs,
+                      coda_oss::span<const double> ys,
+                      coda_oss::span<_T> out) const;
+#endif
+
     _T integrate(double xStart, double xEnd, double yStart, double yEnd) const;
 
     //! Must check the size of the OneD coming in because
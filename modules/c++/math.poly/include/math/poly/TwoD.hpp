@@ -20,8 +20,11 @@
  *
  */
 
+#include <algorithm>
 #include <cmath>
 #include <limits>
+#include <string>
+#include <vector>
 
 #include <import/except.h>
 #include <import/sys.h>
@@ -48,6 +51,97 @@ TwoD<_T>::operator () (double atX, double atY) const
     return ret;
 }
 
+template<typename _T>
+void
+TwoD<_T>::evaluate(coda_oss::span<const double> xs,
+                   coda_oss::span<const double> ys,
+                   coda_oss::span<_T> out) const
+{
+    if (xs.size() != ys.size() || xs.size() != out.size())
+    {
+        throw except::Exception(Ctxt(
+                "Got " + std::to_string(xs.size()) + " x values, " +
+                std::to_string(ys.size()) + " y values and room for " +
+                std::to_string(out.size()) + " results"));
+    }
+    if (empty())
+    {
+        std::fill(out.begin(), out.end(), _T(0.0));
+        return;
+    }
+
+    // Horner's method in x, where each coefficient is a 1D polynomial in y
+    // evaluated over the same block of points
+    static const size_t blockSize = 256;
+    std::vector<_T> coefAtY(std::min(blockSize, xs.size()));
+    const size_t last = mCoef.size() - 1;
+    for (size_t start = 0; start < xs.size(); start += blockSize)
+    {
+        const size_t count = std::min(xs.size() - start, blockSize);
+        const double* const x = xs.data() + start;
+        const coda_oss::span<const double> y(ys.data() + start, count);
+        _T* const result = out.data() + start;
+
+        mCoef[last].evaluate(y, coda_oss::span<_T>(result, count));
+        for (size_t jj = last; jj-- > 0;)
+        {
+            mCoef[jj].evaluate(y, coda_oss::span<_T>(coefAtY.data(), count));
+            for (size_t ii = 0; ii < count; ++ii)
+            {
+                result[ii] = result[ii] * x[ii] + coefAtY[ii];
+            }
+        }
+    }
+}
+
+template<typename _T>
+void
+TwoD<_T>::evaluateGrid(coda_oss::span<const double> xs,
+                       coda_oss::span<const double> ys,
+                       coda_oss::span<_T> out) const
+{
+    if (xs.size() * ys.size() != out.size())
+    {
+        throw except::Exception(Ctxt(
+                "Got a grid of " + std::to_string(xs.size()) + " x " +
+                std::to_string(ys.size()) + " but room for " +
+                std::to_string(out.size()) + " results"));
+    }
+    if (empty())
+    {
+        std::fill(out.begin(), out.end(), _T(0.0));
+        return;
+    }
+
+    // Every row shares the same y values, so each x coefficient is
+    // evaluated at them once up front
+    const size_t numCols = ys.size();
+    std::vector<_T> coefAtY(mCoef.size() * numCols);
+    for (size_t jj = 0; jj < mCoef.size(); ++jj)
+    {
+        mCoef[jj].evaluate(ys, coda_oss::span<_T>(coefAtY.data() +
+                                                          jj * numCols,
+                                                  numCols));
+    }
+
+    const size_t last = mCoef.size() - 1;
+    for (size_t row = 0; row < xs.size(); ++row)
+    {
+        const double x = xs[row];
+        _T* const result = out.data() + row * numCols;
+        const _T* coef = coefAtY.data() + last * numCols;
+        std::copy(coef, coef + numCols, result);
+        for (size_t jj = last; jj-- > 0;)
+        {
+            coef = coefAtY.data() + jj * numCols;
+            for (size_t col = 0; col < numCols; ++col)
+            {
+                result[col] = result[col] * x + coef[col];
+            }
+        }
+    }
+}
+
 template<typename _T>
 _T
 TwoD<_T>::integrate(double xStart, double xEnd,
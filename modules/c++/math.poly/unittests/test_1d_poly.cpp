@@ -146,9 +146,42 @@ TEST_CASE(testTransformInput)
     }
 }
 
+TEST_CASE(testEvaluate)
+{
+    // More points than fit in one block
+    std::vector<double> values(1000);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        values[ii] = getRand();
+    }
+
+    const math::poly::OneD<double> poly(getRandPoly(5));
+    std::vector<double> results(values.size());
+    poly.evaluate(coda_oss::span<const double>(values.data(), values.size()),
+                  coda_oss::span<double>(results.data(), results.size()));
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        const double expectedValue(poly(values[ii]));
+        TEST_ASSERT_ALMOST_EQ_EPS(results[ii], expectedValue,
+                                  1e-10 * std::abs(expectedValue) + 1e-10);
+    }
+
+    // Empty polynomials evaluate to zero, like operator()
+    const math::poly::OneD<double> empty;
+    empty.evaluate(coda_oss::span<const double>(values.data(), values.size()),
+                   coda_oss::span<double>(results.data(), results.size()));
+    TEST_ASSERT_EQ(results[0], 0.0);
+    TEST_ASSERT_EQ(results.back(), 0.0);
+
+    TEST_EXCEPTION(poly.evaluate(
+            coda_oss::span<const double>(values.data(), values.size()),
+            coda_oss::span<double>(results.data(), results.size() - 1)));
+}
+
 TEST_MAIN(
     TEST_CHECK(testScaleVariable);
     TEST_CHECK(testTruncateTo);
     TEST_CHECK(testTruncateToNonZeros);
     TEST_CHECK(testTransformInput);
+    TEST_CHECK(testEvaluate);
     )
@@ -489,6 +489,72 @@ TEST_CASE(testAtY)
     TEST_ASSERT_EQ(p4.flipXY().atY(4)(5), p4(4, 5));
 }
 
+TEST_CASE(testEvaluate)
+{
+    // More points than fit in one block
+    std::vector<double> xValues(1000);
+    std::vector<double> yValues(xValues.size());
+    for (size_t ii = 0; ii < xValues.size(); ++ii)
+    {
+        xValues[ii] = getRand();
+        yValues[ii] = getRand();
+    }
+    const coda_oss::span<const double> xs(xValues.data(), xValues.size());
+    const coda_oss::span<const double> ys(yValues.data(), yValues.size());
+
+    const math::poly::TwoD<double> poly(getRandPoly(4, 3));
+    std::vector<double> results(xValues.size());
+    poly.evaluate(xs, ys,
+                  coda_oss::span<double>(results.data(), results.size()));
+    for (size_t ii = 0; ii < xValues.size(); ++ii)
+    {
+        const double expectedValue(poly(xValues[ii], yValues[ii]));
+        TEST_ASSERT_ALMOST_EQ_EPS(results[ii], expectedValue,
+                                  1e-10 * std::abs(expectedValue) + 1e-10);
+    }
+    TEST_EXCEPTION(poly.evaluate(xs,
+            coda_oss::span<const double>(yValues.data(), yValues.size() - 1),
+            coda_oss::span<double>(results.data(), results.size())));
+
+    const math::poly::TwoD<double> empty;
+    empty.evaluate(xs, ys,
+                   coda_oss::span<double>(results.data(), results.size()));
+    TEST_ASSERT_EQ(results[0], 0.0);
+}
+
+TEST_CASE(testEvaluateGrid)
+{
+    std::vector<double> xValues(7);
+    std::vector<double> yValues(300);
+    for (size_t ii = 0; ii < xValues.size(); ++ii)
+    {
+        xValues[ii] = getRand();
+    }
+    for (size_t ii = 0; ii < yValues.size(); ++ii)
+    {
+        yValues[ii] = getRand();
+    }
+    const coda_oss::span<const double> xs(xValues.data(), xValues.size());
+    const coda_oss::span<const double> ys(yValues.data(), yValues.size());
+
+    const math::poly::TwoD<double> poly(getRandPoly(3, 5));
+    std::vector<double> results(xValues.size() * yValues.size());
+    poly.evaluateGrid(xs, ys,
+                      coda_oss::span<double>(results.data(), results.size()));
+    for (size_t row = 0; row < xValues.size(); ++row)
+    {
+        for (size_t col = 0; col < yValues.size(); ++col)
+        {
+            const double expectedValue(poly(xValues[row], yValues[col]));
+            TEST_ASSERT_ALMOST_EQ_EPS(results[row * yValues.size() + col],
+                                      expectedValue,
+                                      1e-10 * std::abs(expectedValue) + 1e-10);
+        }
+    }
+    TEST_EXCEPTION(poly.evaluateGrid(xs, ys,
+            coda_oss::span<double>(results.data(), results.size() - 1)));
+}
+
 TEST_MAIN(
     TEST_CHECK(testScaleVariable);
     TEST_CHECK(testTruncateTo);
@@ -497,5 +563,7 @@ TEST_MAIN(
     TEST_CHECK(testOperators);
     TEST_CHECK(testIsScalar);
     TEST_CHECK(testAtY);
+    TEST_CHECK(testEvaluate);
+    TEST_CHECK(testEvaluateGrid);
     )
 
@@ -24,6 +24,7 @@
 #define __IMPORT_MEM_H__
 #pragma once
 
+#include <mem/BufferRing.h>
 #include <mem/BufferView.h>
 #include <mem/ScopedAlignedArray.h>
 #include <mem/ScopedArray.h>
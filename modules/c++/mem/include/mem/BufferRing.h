@@ -0,0 +1,177 @@
+/* =========================================================================
+ * This file is part of mem-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mem-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __MEM_BUFFER_RING_H__
+#define __MEM_BUFFER_RING_H__
+
+#include <stddef.h>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include <sys/Conf.h>
+#include <config/Exports.h>
+#include <mem/ScopedAlignedArray.h>
+
+namespace mem
+{
+/*!
+ *  \class BufferRing
+ *  \brief N-deep ring of buffers handed from a producer thread to a
+ *         consumer thread.
+ *
+ *  This is SwapBuffer generalized to any number of buffers, with the
+ *  hand-off done by the ring rather than by calls to swap(): the producer
+ *  acquires an empty buffer, fills it and publishes it; the consumer
+ *  acquires the oldest published buffer, uses it and releases it so it can
+ *  be filled again.  Both acquires block until a buffer is available, so a
+ *  slow stage holds up the other one by at most getNumBuffers() buffers.
+ *
+ *  Buffers go through the ring in order.  A side may hold several buffers
+ *  at once, but must publish (or release) them in the order it acquired
+ *  them.  There is meant to be one producer and one consumer thread.
+ *
+ *  The producer calls close() once it has published everything, after which
+ *  the consumer's acquireForRead() returns false once the ring is drained.
+ *  Either side may call abort() on an error, after which both acquires
+ *  return false straight away.
+ *
+ *  As with SwapBuffer, externally created buffers are not freed here.
+ */
+class CODA_OSS_API BufferRing final
+{
+public:
+    /*!
+     *  Allocate numBuffers buffers of numBytes each.  Each buffer starts on
+     *  a multiple of alignment.
+     */
+    BufferRing(size_t numBuffers,
+               size_t numBytes,
+               size_t alignment = sys::SSE_INSTRUCTION_ALIGNMENT);
+
+    /*!
+     *  Use externally created buffers, each of which must hold numBytes.
+     *  It is the responsibility of the user to deallocate this memory.
+     */
+    BufferRing(const std::vector<void*>& buffers, size_t numBytes);
+
+    BufferRing(const BufferRing&) = delete;
+    BufferRing& operator=(const BufferRing&) = delete;
+
+    //! Get the number of buffers in the ring
+    size_t getNumBuffers() const
+    {
+        return mBuffers.size();
+    }
+
+    //! Get the capacity of each buffer in bytes
+    size_t getNumBytes() const
+    {
+        return mNumBytes;
+    }
+
+    /*!
+     *  Wait for an empty buffer to fill.
+     *
+     *  \param[out] index Index of the buffer
+     *  \return false if the ring was closed or aborted
+     */
+    bool acquireForWrite(size_t& index);
+
+    /*!
+     *  Hand a filled buffer to the consumer.
+     *
+     *  \param index Index from acquireForWrite()
+     *  \param numBytes Number of bytes filled in, at most getNumBytes()
+     *
+     *  \throws except::Exception if index isn't the oldest buffer acquired
+     *          for writing or numBytes is too large
+     */
+    void publish(size_t index, size_t numBytes);
+
+    /*!
+     *  Wait for the oldest published buffer.
+     *
+     *  \param[out] index Index of the buffer
+     *  \return false once the ring is closed and every published buffer has
+     *          been read, or if the ring was aborted
+     */
+    bool acquireForRead(size_t& index);
+
+    /*!
+     *  Hand a buffer that has been read back to the producer.
+     *
+     *  \param index Index from acquireForRead()
+     *
+     *  \throws except::Exception if index isn't the oldest buffer acquired
+     *          for reading
+     */
+    void release(size_t index);
+
+    //! No more buffers will be published
+    void close();
+
+    //! Stop both sides, e.g. because one of them failed
+    void abort();
+
+    //! Has abort() been called?
+    bool isAborted() const;
+
+    //! Get a buffer
+    template<typename T>
+    T* getBuffer(size_t index)
+    {
+        return static_cast<T*>(mBuffers[index]);
+    }
+
+    template<typename T>
+    const T* getBuffer(size_t index) const
+    {
+        return static_cast<const T*>(mBuffers[index]);
+    }
+
+    //! Get the number of bytes published in a buffer
+    size_t getNumBytesUsed(size_t index) const
+    {
+        return mNumBytesUsed[index];
+    }
+
+private:
+    const size_t mNumBytes;
+    const ScopedAlignedArray<sys::byte> mStorage;
+    std::vector<void*> mBuffers;
+    std::vector<size_t> mNumBytesUsed;
+
+    // Running totals; buffer i of the ring is used by count i modulo N
+    size_t mNumAcquiredForWrite;
+    size_t mNumPublished;
+    size_t mNumAcquiredForRead;
+    size_t mNumReleased;
+    bool mClosed;
+    bool mAborted;
+
+    mutable std::mutex mMutex;
+    std::condition_variable mCondition;
+};
+}
+
+#endif
@@ -0,0 +1,165 @@
+/* =========================================================================
+ * This file is part of mem-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mem-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __MEM_POOL_ALLOCATOR_H__
+#define __MEM_POOL_ALLOCATOR_H__
+
+#include <stddef.h>
+
+#include <limits>
+#include <new>
+
+#include "config/Exports.h"
+
+namespace mem
+{
+/*!
+ * \class PoolAllocator
+ * \brief Fast allocation of small blocks from per-thread free lists
+ *
+ * Requests of up to MAX_POOLED_SIZE bytes are rounded up to a power of
+ * two (16 bytes at least) and served from a free list of that size class
+ * belonging to the calling thread, so no locks or atomic operations are
+ * needed in the common case.  The free lists are refilled from 64K slabs.
+ *
+ * A block may be freed by any thread; it goes onto the freeing thread's
+ * list.  When a thread has more than its share of free blocks of a size
+ * class (say, it frees what another thread allocated), it passes a batch
+ * of them on through a set of lock-free slots for that class, which is
+ * where threads look first when their own lists run dry.  Likewise, a
+ * thread gives back all of its blocks when it exits.
+ *
+ * Memory is never given back to the system; the pool is meant for objects
+ * that are created and destroyed over and over, like tree nodes or work
+ * items.  Larger requests go straight to ::operator new.
+ *
+ * Unlike free(), deallocate() needs to be told the size that was asked
+ * for.
+ */
+class CODA_OSS_API PoolAllocator final
+{
+public:
+    //! Largest request served from the pool
+    static const size_t MAX_POOLED_SIZE = 1024;
+
+    /*!
+     * \param numBytes Size of the block
+     * \return A block aligned for any fundamental type
+     * \throws std::bad_alloc if a slab can't be allocated
+     */
+    static void* allocate(size_t numBytes);
+
+    /*!
+     * \param p Block from allocate(), or NULL
+     * \param numBytes The size that was passed to allocate()
+     */
+    static void deallocate(void* p, size_t numBytes) noexcept;
+
+    PoolAllocator() = delete;
+};
+
+/*!
+ * \class PoolAllocated
+ * \brief Derive from this to make new and delete of a class use the pool
+ *
+ * Deleting through a base class pointer works as long as the base class
+ * has a virtual destructor, since the size then comes from the actual
+ * type.
+ */
+struct PoolAllocated
+{
+    static void* operator new(size_t size)
+    {
+        return PoolAllocator::allocate(size);
+    }
+
+    static void operator delete(void* p, size_t size) noexcept
+    {
+        PoolAllocator::deallocate(p, size);
+    }
+};
+
+/*!
+ * \class PoolSTLAllocator
+ * \brief Standard library allocator that uses PoolAllocator, e.g. for
+ *        the nodes of a std::list or std::map
+ *
+ * All PoolSTLAllocators are interchangeable, so containers using them can
+ * be swapped, spliced, etc.
+ */
+template <typename T>
+struct PoolSTLAllocator
+{
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef size_t size_type;
+    typedef ptrdiff_t difference_type;
+
+    template <typename U>
+    struct rebind
+    {
+        typedef PoolSTLAllocator<U> other;
+    };
+
+    PoolSTLAllocator() = default;
+
+    template <typename U>
+    PoolSTLAllocator(const PoolSTLAllocator<U>&) noexcept
+    {
+    }
+
+    T* allocate(size_t n)
+    {
+        if (n > max_size())
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<T*>(PoolAllocator::allocate(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept
+    {
+        PoolAllocator::deallocate(p, n * sizeof(T));
+    }
+
+    size_t max_size() const noexcept
+    {
+        return std::numeric_limits<size_t>::max() / sizeof(T);
+    }
+};
+
+template <typename T, typename U>
+bool operator==(const PoolSTLAllocator<T>&, const PoolSTLAllocator<U>&)
+{
+    return true;
+}
+
+template <typename T, typename U>
+bool operator!=(const PoolSTLAllocator<T>&, const PoolSTLAllocator<U>&)
+{
+    return false;
+}
+}
+
+#endif
@@ -25,7 +25,6 @@
 
 #include <stddef.h>
 #include <map>
-#include <set>
 #include <sstream>
 #include <string>
 #include <utility>
@@ -53,6 +52,70 @@ public:
     //! Default constructor
     ScratchMemory();
 
+    /*!
+     *  \class Handle
+     *  \brief Integer handle to a segment, returned by put.
+     *
+     *  Looking a segment up through its handle is an index into the
+     *  segment list rather than a string search, so kernels that call get
+     *  inside loops should hold on to the handle.  The element type is part
+     *  of the handle, so get and getBufferView deduce it.
+     */
+    template <typename T>
+    class Handle
+    {
+    public:
+        Handle() :
+            mIndex(static_cast<size_t>(-1))
+        {
+        }
+
+        size_t getIndex() const
+        {
+            return mIndex;
+        }
+
+        bool isValid() const
+        {
+            return mIndex != static_cast<size_t>(-1);
+        }
+
+    private:
+        friend class ScratchMemory;
+
+        explicit Handle(size_t index) :
+            mIndex(index)
+        {
+        }
+
+        size_t mIndex;
+    };
+
+    /*!
+     *  \struct Lifetime
+     *  \brief Inclusive range of phases over which a segment is in use.
+     *
+     *  Phases are whatever the caller counts in, e.g. the stages of a
+     *  processing chain.  Segments whose lifetimes don't overlap may share
+     *  memory.
+     */
+    struct Lifetime final
+    {
+        Lifetime(size_t first, size_t last) :
+            first(first),
+            last(last)
+        {
+        }
+
+        bool overlaps(const Lifetime& other) const
+        {
+            return first <= other.last && other.first <= last;
+        }
+
+        size_t first;
+        size_t last;
+    };
+
     /*!
      * \brief Reserve a buffer segment within this scratch memory buffer.
      *
@@ -62,13 +125,44 @@ public:
      * \param alignment Number of bytes to align segment pointer. Defaults to
      *                  sys::SSE_INSTRUCTION_ALIGNMENT.
      *
+     * \return Handle to the segment
+     *
      * \throws except::Exception if the given key has already been used
      */
     template <typename T>
-    void put(const std::string& key,
-             size_t numElements,
-             size_t numBuffers = 1,
-             size_t alignment = sys::SSE_INSTRUCTION_ALIGNMENT);
+    Handle<T> put(const std::string& key,
+                  size_t numElements,
+                  size_t numBuffers = 1,
+                  size_t alignment = sys::SSE_INSTRUCTION_ALIGNMENT);
+
+    /*!
+     * \brief Reserve a buffer segment that is only in use for the given
+     *        lifetime.
+     *
+     * Rather than being placed in put/release order, these segments are
+     * packed together at the end of the buffer: each one, largest first,
+     * goes in the tightest gap left by the segments already placed whose
+     * lifetimes overlap its own.  Segments reserved this way can't be
+     * released.
+     *
+     * \param key Identifier for scratch segment
+     * \param numElements Size of scratch buffer
+     * \param lifetime Phases during which the segment is in use
+     * \param numBuffers Number of distinct buffers to set up. Defaults to 1.
+     * \param alignment Number of bytes to align segment pointer. Defaults to
+     *                  sys::SSE_INSTRUCTION_ALIGNMENT.
+     *
+     * \return Handle to the segment
+     *
+     * \throws except::Exception if the given key has already been used or
+     *         the lifetime ends before it begins
+     */
+    template <typename T>
+    Handle<T> put(const std::string& key,
+                  size_t numElements,
+                  const Lifetime& lifetime,
+                  size_t numBuffers = 1,
+                  size_t alignment = sys::SSE_INSTRUCTION_ALIGNMENT);
 
     /*!
      * \brief Release a segment so that that memory may be reused
@@ -134,6 +228,63 @@ public:
     BufferView<const T> getBufferView(const std::string& key,
                                       size_t indexBuffer = 0) const;
 
+    /*!
+     * \brief Get pointer to buffer segment from its handle.
+     *
+     * \param handle Handle returned by put
+     * \param indexBuffer Index of distinct buffer. Defaults to 0.
+     *
+     * \return Pointer to buffer segment
+     *
+     * \throws except::Exception if the scratch memory has not been set up,
+     *         the handle is invalid, or index of buffer is out of bounds
+     */
+    template <typename T>
+    T* get(const Handle<T>& handle, size_t indexBuffer = 0)
+    {
+        return reinterpret_cast<T*>(
+                lookupSegment(handle.mIndex, indexBuffer).buffers[indexBuffer]);
+    }
+
+    template <typename T>
+    const T* get(const Handle<T>& handle, size_t indexBuffer = 0) const
+    {
+        return reinterpret_cast<const T*>(
+                lookupSegment(handle.mIndex, indexBuffer).buffers[indexBuffer]);
+    }
+
+    /*!
+     * \brief Get buffer view of buffer segment from its handle.
+     *
+     * \param handle Handle returned by put
+     * \param indexBuffer Index of distinct buffer. Defaults to 0.
+     *
+     * \return Buffer view of buffer segment
+     *
+     * \throws except::Exception if the scratch memory has not been set up,
+     *         the handle is invalid, or index of buffer is out of bounds
+     */
+    template <typename T>
+    BufferView<T> getBufferView(const Handle<T>& handle,
+                                size_t indexBuffer = 0);
+
+    template <typename T>
+    BufferView<const T> getBufferView(const Handle<T>& handle,
+                                      size_t indexBuffer = 0) const;
+
+    /*!
+     * \brief Get the handle of a segment reserved earlier.
+     *
+     * \param key Identifier for scratch segment
+     *
+     * \throws except::Exception if the key does not exist
+     */
+    template <typename T>
+    Handle<T> getHandle(const std::string& key) const
+    {
+        return Handle<T>(lookupIndex(key));
+    }
+
     /*!
      * \brief Ensure underlying memory is properly set up and position segment
      *        pointers.
@@ -155,35 +306,105 @@ public:
      */
     size_t getNumBytes() const
     {
-        return mNumBytesNeeded;
+        return mNumBytesNeeded + mNumPlannedBytes;
     }
 
+    /*!
+     * \brief Make a copy of this layout over different storage.
+     *
+     * The segment offsets, including any lifetime packing and releases, are
+     * taken as they are, so the clone only has to position its pointers.
+     * Handles from this object are valid for the clone.
+     *
+     * \param scratchBuffer Storage for the clone. If buffer of size 0 is
+     *        passed, memory is allocated internally. Defaults to an empty
+     *        buffer.
+     *
+     * \throws except::Exception under the same conditions as setup
+     */
+    ScratchMemory clone(const BufferView<sys::ubyte>& scratchBuffer =
+            BufferView<sys::ubyte>()) const;
+
+    /*!
+     * \brief Make one clone per thread, each over its own slice of a single
+     *        buffer.
+     *
+     * Slices are getCloneStride() bytes apart so that no two threads write
+     * the same cache line.  Pass in a buffer that has been first-touched by
+     * the threads that will use it (see mt::firstTouch) to keep each slice
+     * on its thread's NUMA node; each worker of mt::run1D can then be
+     * handed its own clone.
+     *
+     * \param numThreads Number of clones
+     * \param scratchBuffer Storage of at least
+     *        numThreads * getCloneStride() bytes. If buffer of size 0 is
+     *        passed, each clone allocates its own memory. Defaults to an
+     *        empty buffer.
+     *
+     * \throws except::Exception if the buffer is too small
+     */
+    std::vector<ScratchMemory> cloneForThreads(
+            size_t numThreads,
+            const BufferView<sys::ubyte>& scratchBuffer =
+                    BufferView<sys::ubyte>()) const;
+
+    //! Distance in bytes between the slices used by cloneForThreads
+    size_t getCloneStride() const;
+
     ScratchMemory(const ScratchMemory&) = delete;
     ScratchMemory& operator=(const ScratchMemory&) = delete;
+    ScratchMemory(ScratchMemory&&) = default;
+    ScratchMemory& operator=(ScratchMemory&&) = default;
 
 private:
     struct CODA_OSS_API Segment final
     {
-        Segment(size_t numBytes, size_t numBuffers, size_t alignment, size_t offset);
+        Segment(const std::string& key, size_t numBytes, size_t numBuffers,
+                size_t alignment);
 
+        //! Bytes reserved for the segment, including alignment overhead
+        size_t getFootprint() const
+        {
+            return numBuffers * (numBytes + alignment - 1);
+        }
+
+        std::string key;
         size_t numBytes;
         size_t numBuffers;
         size_t alignment;
         size_t offset;
+        bool released;
+        bool connected;
+        bool planned;
+        Lifetime lifetime;
         std::vector<sys::ubyte*> buffers;
     };
 
+    size_t addSegment(const std::string& key,
+                      size_t numBytes,
+                      size_t numBuffers,
+                      size_t alignment);
+    size_t addPlannedSegment(const std::string& key,
+                             size_t numBytes,
+                             const Lifetime& lifetime,
+                             size_t numBuffers,
+                             size_t alignment);
+    void placeSegment(size_t index);
+    void planLifetimes();
+
+    size_t lookupIndex(const std::string& key) const;
     const Segment& lookupSegment(const std::string& key,
                                  size_t indexBuffer) const;
+    const Segment& lookupSegment(size_t index, size_t indexBuffer) const;
 
-    std::map<std::string, Segment> mSegments;
+    std::vector<Segment> mSegments;
+    std::map<std::string, size_t> mKeyIndices;
     std::vector<sys::ubyte> mStorage;
-    std::vector<std::string> mKeyOrder;
-    std::set<std::string> mReleasedKeys;
-    std::set<std::string> mConnectedKeys;
+    std::vector<size_t> mKeyOrder;
 
     BufferView<sys::ubyte> mBuffer;
     size_t mNumBytesNeeded;
+    size_t mNumPlannedBytes;
     size_t mOffset;
 };
 }
@@ -23,42 +23,24 @@
 namespace mem
 {
 template <typename T>
-void ScratchMemory::put(const std::string& key,
-                        size_t numElements,
-                        size_t numBuffers,
-                        size_t alignment)
+ScratchMemory::Handle<T> ScratchMemory::put(const std::string& key,
+                                            size_t numElements,
+                                            size_t numBuffers,
+                                            size_t alignment)
 {
-    put<sys::ubyte>(key, numElements * sizeof(T), numBuffers, alignment);
+    return Handle<T>(addSegment(key, numElements * sizeof(T), numBuffers,
+                                alignment));
 }
 
-template <>
-inline void ScratchMemory::put<sys::ubyte>(const std::string& key,
-                                           size_t numElements,
-                                           size_t numBuffers,
-                                           size_t alignment)
+template <typename T>
+ScratchMemory::Handle<T> ScratchMemory::put(const std::string& key,
+                                            size_t numElements,
+                                            const Lifetime& lifetime,
+                                            size_t numBuffers,
+                                            size_t alignment)
 {
-    // invalidate buffer (setup must be called before any subsequent get call)
-    mBuffer.data = NULL;
-
-    size_t segmentOffset = mOffset;
-
-    alignment = std::max<size_t>(1, alignment);
-    mOffset += numBuffers * (numElements + alignment - 1);
-
-    mNumBytesNeeded = std::max<size_t>(mNumBytesNeeded, mOffset);
-
-    std::map<std::string, Segment>::iterator iterSeg = mSegments.find(key);
-    if (iterSeg != mSegments.end())
-    {
-        std::ostringstream oss;
-        oss << "Scratch memory space was already reserved for " << key;
-        throw except::Exception(Ctxt(oss.str()));
-    }
-    mSegments.insert(
-            iterSeg,
-            std::make_pair(key, Segment(numElements, numBuffers, alignment, segmentOffset)));
-
-    mKeyOrder.push_back(key);
+    return Handle<T>(addPlannedSegment(key, numElements * sizeof(T),
+                                       lifetime, numBuffers, alignment));
 }
 
 template <typename T>
@@ -81,7 +63,7 @@ BufferView<T> ScratchMemory::getBufferView(const std::string& key,
 {
     const Segment& segment = lookupSegment(key, indexBuffer);
     return BufferView<T>(reinterpret_cast<T*>(segment.buffers[indexBuffer]),
-                         segment.numBytes);
+                         segment.numBytes / sizeof(T));
 }
 
 template <typename T>
@@ -91,6 +73,25 @@ BufferView<const T> ScratchMemory::getBufferView(const std::string& key,
     const Segment& segment = lookupSegment(key, indexBuffer);
     return BufferView<const T>(
             reinterpret_cast<const T*>(segment.buffers[indexBuffer]),
-            segment.numBytes);
+            segment.numBytes / sizeof(T));
+}
+
+template <typename T>
+BufferView<T> ScratchMemory::getBufferView(const Handle<T>& handle,
+                                           size_t indexBuffer)
+{
+    const Segment& segment = lookupSegment(handle.mIndex, indexBuffer);
+    return BufferView<T>(reinterpret_cast<T*>(segment.buffers[indexBuffer]),
+                         segment.numBytes / sizeof(T));
+}
+
+template <typename T>
+BufferView<const T> ScratchMemory::getBufferView(const Handle<T>& handle,
+                                                 size_t indexBuffer) const
+{
+    const Segment& segment = lookupSegment(handle.mIndex, indexBuffer);
+    return BufferView<const T>(
+            reinterpret_cast<const T*>(segment.buffers[indexBuffer]),
+            segment.numBytes / sizeof(T));
 }
 }
@@ -0,0 +1,183 @@
+/* =========================================================================
+ * This file is part of mem-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mem-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <mem/BufferRing.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <except/Exception.h>
+
+namespace
+{
+size_t getStride(size_t numBytes, size_t alignment)
+{
+    alignment = std::max<size_t>(1, alignment);
+    return std::max<size_t>(1, (numBytes + alignment - 1) / alignment) *
+            alignment;
+}
+}
+
+namespace mem
+{
+BufferRing::BufferRing(size_t numBuffers, size_t numBytes, size_t alignment) :
+    mNumBytes(numBytes),
+    // sys::alignedAlloc() needs at least pointer alignment; the stride
+    // keeps every buffer on a multiple of the requested alignment
+    mStorage(numBuffers * getStride(numBytes, alignment),
+             std::max<size_t>(sizeof(void*), alignment)),
+    mBuffers(numBuffers),
+    mNumBytesUsed(numBuffers),
+    mNumAcquiredForWrite(0),
+    mNumPublished(0),
+    mNumAcquiredForRead(0),
+    mNumReleased(0),
+    mClosed(false),
+    mAborted(false)
+{
+    if (numBuffers == 0)
+    {
+        throw except::Exception(Ctxt("BufferRing needs at least one buffer"));
+    }
+
+    const size_t stride = getStride(numBytes, alignment);
+    for (size_t ii = 0; ii < numBuffers; ++ii)
+    {
+        mBuffers[ii] = mStorage.get() + ii * stride;
+    }
+}
+
+BufferRing::BufferRing(const std::vector<void*>& buffers, size_t numBytes) :
+    mNumBytes(numBytes),
+    mBuffers(buffers),
+    mNumBytesUsed(buffers.size()),
+    mNumAcquiredForWrite(0),
+    mNumPublished(0),
+    mNumAcquiredForRead(0),
+    mNumReleased(0),
+    mClosed(false),
+    mAborted(false)
+{
+    if (buffers.empty())
+    {
+        throw except::Exception(Ctxt("BufferRing needs at least one buffer"));
+    }
+}
+
+bool BufferRing::acquireForWrite(size_t& index)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]()
+    {
+        return mAborted || mClosed ||
+                mNumAcquiredForWrite - mNumReleased < mBuffers.size();
+    });
+    if (mAborted || mClosed)
+    {
+        return false;
+    }
+
+    index = mNumAcquiredForWrite++ % mBuffers.size();
+    return true;
+}
+
+void BufferRing::publish(size_t index, size_t numBytes)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mNumPublished == mNumAcquiredForWrite ||
+            index != mNumPublished % mBuffers.size())
+        {
+            std::ostringstream oss;
+            oss << "Buffer " << index << " is not the next one to publish";
+            throw except::Exception(Ctxt(oss.str()));
+        }
+        if (numBytes > mNumBytes)
+        {
+            std::ostringstream oss;
+            oss << "Cannot publish " << numBytes << " bytes in a buffer of "
+                << mNumBytes << " bytes";
+            throw except::Exception(Ctxt(oss.str()));
+        }
+
+        mNumBytesUsed[index] = numBytes;
+        ++mNumPublished;
+    }
+    mCondition.notify_all();
+}
+
+bool BufferRing::acquireForRead(size_t& index)
+{
+    std::unique_lock<std::mutex> lock(mMutex);
+    mCondition.wait(lock, [this]()
+    {
+        return mAborted || mClosed || mNumAcquiredForRead < mNumPublished;
+    });
+    if (mAborted || mNumAcquiredForRead == mNumPublished)
+    {
+        return false;
+    }
+
+    index = mNumAcquiredForRead++ % mBuffers.size();
+    return true;
+}
+
+void BufferRing::release(size_t index)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (mNumReleased == mNumAcquiredForRead ||
+            index != mNumReleased % mBuffers.size())
+        {
+            std::ostringstream oss;
+            oss << "Buffer " << index << " is not the next one to release";
+            throw except::Exception(Ctxt(oss.str()));
+        }
+        ++mNumReleased;
+    }
+    mCondition.notify_all();
+}
+
+void BufferRing::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mClosed = true;
+    }
+    mCondition.notify_all();
+}
+
+void BufferRing::abort()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mAborted = true;
+    }
+    mCondition.notify_all();
+}
+
+bool BufferRing::isAborted() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mAborted;
+}
+}
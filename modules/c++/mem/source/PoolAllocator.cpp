@@ -0,0 +1,388 @@
+/* =========================================================================
+ * This file is part of mem-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mem-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <mem/PoolAllocator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+
+namespace
+{
+// Size classes are 16, 32, ... 1024 bytes
+const size_t MIN_BLOCK_SIZE = 16;
+const size_t NUM_SIZE_CLASSES = 7;
+static_assert(MIN_BLOCK_SIZE << (NUM_SIZE_CLASSES - 1) ==
+                      mem::PoolAllocator::MAX_POOLED_SIZE,
+              "Size classes must reach MAX_POOLED_SIZE");
+
+const size_t SLAB_SIZE = 64 * 1024;
+
+// Threads trade free blocks in batches of this many bytes (or 16 blocks,
+// for the biggest size classes), and keep at most two batches' worth
+const size_t BATCH_BYTES = 16 * 1024;
+
+// Number of lock-free slots holding batches for each size class
+const size_t NUM_BATCH_SLOTS = 32;
+
+// A free block; the first block of a batch also links to the next batch
+// when it's in an overflow list
+struct FreeBlock
+{
+    FreeBlock* next;
+    FreeBlock* nextBatch;
+};
+static_assert(sizeof(FreeBlock) <= MIN_BLOCK_SIZE,
+              "Free blocks must fit in the smallest size class");
+
+size_t getSizeClass(size_t numBytes)
+{
+    size_t sizeClass = 0;
+    while ((MIN_BLOCK_SIZE << sizeClass) < numBytes)
+    {
+        ++sizeClass;
+    }
+    return sizeClass;
+}
+
+size_t getBlockSize(size_t sizeClass)
+{
+    return MIN_BLOCK_SIZE << sizeClass;
+}
+
+size_t getBatchSize(size_t sizeClass)
+{
+    return std::max<size_t>(BATCH_BYTES / getBlockSize(sizeClass), 16);
+}
+
+/*
+ * Free blocks that threads have given up, for each size class.
+ *
+ * Full batches go in the first empty slot, or on the overflow list if
+ * there isn't one.  Anything else (what's left in the cache of a thread
+ * that exits) goes on the loose list.  The lists are pushed onto with a
+ * CAS, but are only ever taken off of by swapping out the whole list, and
+ * slots are emptied with a swap too, so a block can't be taken and given
+ * back in between another thread reading a head and its next pointer (the
+ * ABA problem).
+ */
+struct SharedBlocks
+{
+    std::atomic<FreeBlock*> batchSlots[NUM_BATCH_SLOTS];
+    std::atomic<FreeBlock*> overflowBatches;
+    std::atomic<FreeBlock*> looseBlocks;
+};
+SharedBlocks sharedBlocks[NUM_SIZE_CLASSES];
+
+// Where a thread starts looking through the slots, to spread threads out
+size_t getFirstSlot()
+{
+    return std::hash<std::thread::id>()(std::this_thread::get_id()) %
+            NUM_BATCH_SLOTS;
+}
+
+void pushBatch(size_t sizeClass, FreeBlock* batch)
+{
+    SharedBlocks& shared = sharedBlocks[sizeClass];
+    const size_t firstSlot = getFirstSlot();
+    for (size_t ii = 0; ii < NUM_BATCH_SLOTS; ++ii)
+    {
+        std::atomic<FreeBlock*>& slot =
+                shared.batchSlots[(firstSlot + ii) % NUM_BATCH_SLOTS];
+        FreeBlock* empty = nullptr;
+        if (slot.load(std::memory_order_relaxed) == nullptr &&
+            slot.compare_exchange_strong(empty, batch,
+                                         std::memory_order_release,
+                                         std::memory_order_relaxed))
+        {
+            return;
+        }
+    }
+
+    FreeBlock* oldHead = shared.overflowBatches.load(std::memory_order_relaxed);
+    do
+    {
+        batch->nextBatch = oldHead;
+    }
+    while (!shared.overflowBatches.compare_exchange_weak(
+            oldHead, batch, std::memory_order_release,
+            std::memory_order_relaxed));
+}
+
+// NULL if there are no full batches to be had
+FreeBlock* takeBatch(size_t sizeClass)
+{
+    SharedBlocks& shared = sharedBlocks[sizeClass];
+    const size_t firstSlot = getFirstSlot();
+    for (size_t ii = 0; ii < NUM_BATCH_SLOTS; ++ii)
+    {
+        std::atomic<FreeBlock*>& slot =
+                shared.batchSlots[(firstSlot + ii) % NUM_BATCH_SLOTS];
+        if (slot.load(std::memory_order_relaxed) != nullptr)
+        {
+            FreeBlock* const batch =
+                    slot.exchange(nullptr, std::memory_order_acquire);
+            if (batch != nullptr)
+            {
+                return batch;
+            }
+        }
+    }
+
+    if (shared.overflowBatches.load(std::memory_order_relaxed) == nullptr)
+    {
+        return nullptr;
+    }
+    FreeBlock* const batches = shared.overflowBatches.exchange(
+            nullptr, std::memory_order_acquire);
+    if (batches == nullptr)
+    {
+        return nullptr;
+    }
+
+    // Keep the first and put the rest back, into the slots if they've
+    // been emptied in the meantime
+    for (FreeBlock* batch = batches->nextBatch; batch != nullptr; )
+    {
+        FreeBlock* const nextBatch = batch->nextBatch;
+        pushBatch(sizeClass, batch);
+        batch = nextBatch;
+    }
+    return batches;
+}
+
+void pushLoose(size_t sizeClass, FreeBlock* first, FreeBlock* last)
+{
+    std::atomic<FreeBlock*>& head = sharedBlocks[sizeClass].looseBlocks;
+    FreeBlock* oldHead = head.load(std::memory_order_relaxed);
+    do
+    {
+        last->next = oldHead;
+    }
+    while (!head.compare_exchange_weak(oldHead, first,
+                                       std::memory_order_release,
+                                       std::memory_order_relaxed));
+}
+
+FreeBlock* takeLoose(size_t sizeClass)
+{
+    std::atomic<FreeBlock*>& head = sharedBlocks[sizeClass].looseBlocks;
+    if (head.load(std::memory_order_relaxed) == nullptr)
+    {
+        return nullptr;
+    }
+    return head.exchange(nullptr, std::memory_order_acquire);
+}
+
+// Cuts a new slab into a list of blocks
+FreeBlock* carveSlab(size_t sizeClass, FreeBlock*& last, size_t& numBlocks)
+{
+    const size_t blockSize = getBlockSize(sizeClass);
+    char* const slab = static_cast<char*>(::operator new(SLAB_SIZE));
+    numBlocks = SLAB_SIZE / blockSize;
+    for (size_t ii = 0; ii + 1 < numBlocks; ++ii)
+    {
+        reinterpret_cast<FreeBlock*>(slab + ii * blockSize)->next =
+                reinterpret_cast<FreeBlock*>(slab + (ii + 1) * blockSize);
+    }
+    last = reinterpret_cast<FreeBlock*>(slab + (numBlocks - 1) * blockSize);
+    last->next = nullptr;
+    return reinterpret_cast<FreeBlock*>(slab);
+}
+
+// Kept as plain data so that using it doesn't go through the checks that
+// thread_local objects with constructors or destructors need
+struct ThreadCache
+{
+    FreeBlock* heads[NUM_SIZE_CLASSES];
+    size_t counts[NUM_SIZE_CLASSES];
+};
+
+enum CacheState
+{
+    CACHE_UNUSED = 0,
+    CACHE_LIVE,
+    CACHE_GONE
+};
+
+thread_local ThreadCache threadCache;
+thread_local int threadCacheState;
+
+// Gives a thread's blocks back when it exits
+struct CacheReleaser
+{
+    ~CacheReleaser()
+    {
+        for (size_t sizeClass = 0; sizeClass < NUM_SIZE_CLASSES; ++sizeClass)
+        {
+            FreeBlock* const first = threadCache.heads[sizeClass];
+            if (first != nullptr)
+            {
+                FreeBlock* last = first;
+                while (last->next != nullptr)
+                {
+                    last = last->next;
+                }
+                pushLoose(sizeClass, first, last);
+                threadCache.heads[sizeClass] = nullptr;
+                threadCache.counts[sizeClass] = 0;
+            }
+        }
+
+        // Anything freed during the rest of the thread's teardown goes
+        // straight to the loose lists
+        threadCacheState = CACHE_GONE;
+    }
+
+    bool armed = false;
+};
+thread_local CacheReleaser cacheReleaser;
+
+// NULL once the thread is being torn down
+ThreadCache* getThreadCache()
+{
+    if (threadCacheState != CACHE_LIVE)
+    {
+        if (threadCacheState == CACHE_GONE)
+        {
+            return nullptr;
+        }
+        cacheReleaser.armed = true;
+        threadCacheState = CACHE_LIVE;
+    }
+    return &threadCache;
+}
+
+// Fills an empty list: a batch from another thread if there is one, then
+// blocks left over from threads that have exited, then a new slab
+FreeBlock* getBlocks(size_t sizeClass, size_t& numBlocks)
+{
+    FreeBlock* first = takeBatch(sizeClass);
+    if (first != nullptr)
+    {
+        numBlocks = getBatchSize(sizeClass);
+        return first;
+    }
+
+    first = takeLoose(sizeClass);
+    if (first != nullptr)
+    {
+        numBlocks = 0;
+        for (const FreeBlock* block = first; block != nullptr;
+             block = block->next)
+        {
+            ++numBlocks;
+        }
+        return first;
+    }
+
+    FreeBlock* last = nullptr;
+    return carveSlab(sizeClass, last, numBlocks);
+}
+
+// Passes a batch of a size class's blocks on, keeping the one at the
+// front since it was just freed and is likely still in the CPU's cache
+void shedBatch(ThreadCache& cache, size_t sizeClass)
+{
+    const size_t batchSize = getBatchSize(sizeClass);
+    FreeBlock* const head = cache.heads[sizeClass];
+    FreeBlock* const batch = head->next;
+    FreeBlock* last = batch;
+    for (size_t ii = 1; ii < batchSize; ++ii)
+    {
+        last = last->next;
+    }
+    head->next = last->next;
+    cache.counts[sizeClass] -= batchSize;
+    last->next = nullptr;
+    pushBatch(sizeClass, batch);
+}
+}
+
+namespace mem
+{
+void* PoolAllocator::allocate(size_t numBytes)
+{
+    if (numBytes > MAX_POOLED_SIZE)
+    {
+        return ::operator new(numBytes);
+    }
+
+    const size_t sizeClass = getSizeClass(numBytes);
+    ThreadCache* const cache = getThreadCache();
+    if (cache == nullptr)
+    {
+        // No cache to keep the rest of the blocks in, so hand them back
+        size_t numBlocks = 0;
+        FreeBlock* const block = getBlocks(sizeClass, numBlocks);
+        if (block->next != nullptr)
+        {
+            FreeBlock* last = block->next;
+            while (last->next != nullptr)
+            {
+                last = last->next;
+            }
+            pushLoose(sizeClass, block->next, last);
+        }
+        return block;
+    }
+
+    FreeBlock* block = cache->heads[sizeClass];
+    if (block == nullptr)
+    {
+        block = getBlocks(sizeClass, cache->counts[sizeClass]);
+    }
+    cache->heads[sizeClass] = block->next;
+    --cache->counts[sizeClass];
+    return block;
+}
+
+void PoolAllocator::deallocate(void* p, size_t numBytes) noexcept
+{
+    if (p == nullptr)
+    {
+        return;
+    }
+    if (numBytes > MAX_POOLED_SIZE)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    const size_t sizeClass = getSizeClass(numBytes);
+    FreeBlock* const block = static_cast<FreeBlock*>(p);
+    ThreadCache* const cache = getThreadCache();
+    if (cache == nullptr)
+    {
+        pushLoose(sizeClass, block, block);
+        return;
+    }
+
+    block->next = cache->heads[sizeClass];
+    cache->heads[sizeClass] = block;
+    if (++cache->counts[sizeClass] > 2 * getBatchSize(sizeClass))
+    {
+        shedBatch(*cache, sizeClass);
+    }
+}
+}
@@ -19,53 +19,207 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <algorithm>
+
 #include <mem/Align.h>
 
 #include <mem/ScratchMemory.h>
 
+namespace
+{
+const size_t INVALID_INDEX = static_cast<size_t>(-1);
+
+// Clones handed to different threads start on separate cache lines
+const size_t CLONE_ALIGNMENT = 64;
+}
+
 namespace mem
 {
 ScratchMemory::ScratchMemory() :
     mNumBytesNeeded(0),
+    mNumPlannedBytes(0),
     mOffset(0)
 {
 }
 
-ScratchMemory::Segment::Segment(size_t numBytes,
+ScratchMemory::Segment::Segment(const std::string& key,
+                                size_t numBytes,
                                 size_t numBuffers,
-                                size_t alignment,
-                                size_t offset) :
+                                size_t alignment) :
+    key(key),
     numBytes(numBytes),
     numBuffers(numBuffers),
     alignment(alignment),
-    offset(offset)
+    offset(0),
+    released(false),
+    connected(false),
+    planned(false),
+    lifetime(0, 0)
+{
+}
+
+size_t ScratchMemory::addSegment(const std::string& key,
+                                 size_t numBytes,
+                                 size_t numBuffers,
+                                 size_t alignment)
 {
+    if (mKeyIndices.find(key) != mKeyIndices.end())
+    {
+        std::ostringstream oss;
+        oss << "Scratch memory space was already reserved for " << key;
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    const size_t index = mSegments.size();
+    mSegments.push_back(Segment(key, numBytes, numBuffers,
+                                std::max<size_t>(1, alignment)));
+    mKeyIndices[key] = index;
+
+    placeSegment(index);
+    return index;
+}
+
+size_t ScratchMemory::addPlannedSegment(const std::string& key,
+                                        size_t numBytes,
+                                        const Lifetime& lifetime,
+                                        size_t numBuffers,
+                                        size_t alignment)
+{
+    if (lifetime.last < lifetime.first)
+    {
+        std::ostringstream oss;
+        oss << "Lifetime of " << key << " ends (" << lifetime.last
+            << ") before it begins (" << lifetime.first << ")";
+        throw except::Exception(Ctxt(oss.str()));
+    }
+    if (mKeyIndices.find(key) != mKeyIndices.end())
+    {
+        std::ostringstream oss;
+        oss << "Scratch memory space was already reserved for " << key;
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    // invalidate buffer (setup must be called before any subsequent get call)
+    mBuffer.data = NULL;
+
+    const size_t index = mSegments.size();
+    Segment segment(key, numBytes, numBuffers, std::max<size_t>(1, alignment));
+    segment.planned = true;
+    segment.lifetime = lifetime;
+    mSegments.push_back(segment);
+    mKeyIndices[key] = index;
+
+    planLifetimes();
+    return index;
+}
+
+void ScratchMemory::placeSegment(size_t index)
+{
+    // invalidate buffer (setup must be called before any subsequent get call)
+    mBuffer.data = NULL;
+
+    Segment& segment = mSegments[index];
+    segment.offset = mOffset;
+    mOffset += segment.getFootprint();
+
+    mNumBytesNeeded = std::max<size_t>(mNumBytesNeeded, mOffset);
+
+    mKeyOrder.push_back(index);
+}
+
+void ScratchMemory::planLifetimes()
+{
+    // Greedy by size: place the largest segments first, each in the
+    // smallest gap between the already placed segments that are alive at
+    // the same time.  Offsets are relative to the end of the segments
+    // placed in put/release order, which is only known at setup.
+    std::vector<size_t> order;
+    for (size_t ii = 0; ii < mSegments.size(); ++ii)
+    {
+        if (mSegments[ii].planned)
+        {
+            order.push_back(ii);
+        }
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [this](size_t lhs, size_t rhs)
+                     {
+                         return mSegments[lhs].getFootprint() >
+                                 mSegments[rhs].getFootprint();
+                     });
+
+    mNumPlannedBytes = 0;
+    std::vector<const Segment*> conflicts;
+    for (size_t ii = 0; ii < order.size(); ++ii)
+    {
+        Segment& segment = mSegments[order[ii]];
+        const size_t footprint = segment.getFootprint();
+
+        conflicts.clear();
+        for (size_t jj = 0; jj < ii; ++jj)
+        {
+            const Segment& placed = mSegments[order[jj]];
+            if (placed.lifetime.overlaps(segment.lifetime))
+            {
+                conflicts.push_back(&placed);
+            }
+        }
+        std::sort(conflicts.begin(), conflicts.end(),
+                  [](const Segment* lhs, const Segment* rhs)
+                  {
+                      return lhs->offset < rhs->offset;
+                  });
+
+        size_t bestOffset = INVALID_INDEX;
+        size_t bestGap = INVALID_INDEX;
+        size_t candidate = 0;
+        for (size_t jj = 0; jj < conflicts.size(); ++jj)
+        {
+            const Segment& conflict = *conflicts[jj];
+            if (conflict.offset >= candidate + footprint &&
+                conflict.offset - candidate < bestGap)
+            {
+                bestGap = conflict.offset - candidate;
+                bestOffset = candidate;
+            }
+            candidate = std::max<size_t>(
+                    candidate, conflict.offset + conflict.getFootprint());
+        }
+        if (bestOffset == INVALID_INDEX)
+        {
+            bestOffset = candidate;
+        }
+
+        segment.offset = bestOffset;
+        mNumPlannedBytes = std::max<size_t>(mNumPlannedBytes,
+                                            bestOffset + footprint);
+    }
 }
 
 void ScratchMemory::release(const std::string& key)
 {
-    std::map<std::string, Segment>::const_iterator iterSeg = mSegments.find(key);
-    if (iterSeg == mSegments.end())
+    const size_t index = lookupIndex(key);
+    Segment& segment = mSegments[index];
+    if (segment.planned)
     {
-        throw except::Exception(Ctxt("Key " + key + " does not exist"));
+        throw except::Exception(Ctxt(
+                "Key " + key + " was reserved with a lifetime and can't be "
+                "released"));
     }
-    mReleasedKeys.insert(key);
+    segment.released = true;
 
-    if (mKeyOrder.back() == key)
+    if (mKeyOrder.back() == index)
     {
-        const Segment& segment = iterSeg->second;
         mOffset = segment.offset;
     }
     else
     {
-        const Segment& segment = iterSeg->second;
-
-        mKeyOrder.push_back(key);
-        std::vector<std::string>::iterator keyIter = std::find(mKeyOrder.begin(),
-                                                               mKeyOrder.end(),
-                                                               key);
-        std::vector<std::string>::iterator nextKeyIter = mKeyOrder.erase(keyIter);
-        const std::string nextKey = *nextKeyIter;
+        mKeyOrder.push_back(index);
+        std::vector<size_t>::iterator keyIter = std::find(mKeyOrder.begin(),
+                                                          mKeyOrder.end(),
+                                                          index);
+        std::vector<size_t>::iterator nextKeyIter = mKeyOrder.erase(keyIter);
+        Segment& nextSegment = mSegments[*nextKeyIter];
 
 
         //  The next two if blocks handle the edge case in which there are two
@@ -76,13 +230,11 @@ void ScratchMemory::release(const std::string& key)
         //  If the one that has not been released is released, then we need to
         //  be careful in shifting around the following segments such that there's
         //  no overlap.
-        if (mReleasedKeys.find(nextKey) != mReleasedKeys.end())
+        if (nextSegment.released)
         {
-            if (mConnectedKeys.find(key) != mConnectedKeys.end())
+            if (segment.connected)
             {
-                std::map<std::string, Segment>::const_iterator iterSegOfPrevReleased =
-                        mSegments.find(nextKey);
-                mOffset = iterSegOfPrevReleased->second.offset;
+                mOffset = nextSegment.offset;
             }
             else
             {
@@ -94,13 +246,13 @@ void ScratchMemory::release(const std::string& key)
             mOffset = segment.offset;
         }
 
-        if (mConnectedKeys.find(key) != mConnectedKeys.end())
+        if (segment.connected)
         {
-            mConnectedKeys.insert(nextKey);
+            nextSegment.connected = true;
         }
 
         bool keepGoing = true;
-        std::string firstReleasedKey;
+        size_t firstReleasedIndex = INVALID_INDEX;
 
         size_t endOfReleasedBlock = mOffset;
         bool multipleReleased = false;
@@ -108,31 +260,23 @@ void ScratchMemory::release(const std::string& key)
         //  Keep going until the nextKeyIter == key, but complete that iteration
         while (keepGoing)
         {
-            if (*nextKeyIter == key)
+            if (*nextKeyIter == index)
             {
                 keepGoing = false;
             }
 
             //  Get data for the segment that will be moved
-            std::map<std::string, Segment>::const_iterator mapIter =
-                    mSegments.find(*nextKeyIter);
-            const Segment& segmentToBeMoved = mapIter->second;
-
-            const size_t numElements = segmentToBeMoved.numBytes;
-            const size_t numBuffers = segmentToBeMoved.numBuffers;
-            const size_t alignment = segmentToBeMoved.alignment;
-
-            mSegments.erase(*nextKeyIter);
-            std::string keyToInsert = *nextKeyIter;
+            const size_t indexToPlace = *nextKeyIter;
+            Segment& segmentToBeMoved = mSegments[indexToPlace];
             nextKeyIter = mKeyOrder.erase(nextKeyIter);
 
-            if (mReleasedKeys.find(keyToInsert) != mReleasedKeys.end())
+            if (segmentToBeMoved.released)
             {
                 //  This if else block handles the case in which multiple
                 //  concurrent segments have been released.
-                if (firstReleasedKey.empty())
+                if (firstReleasedIndex == INVALID_INDEX)
                 {
-                    firstReleasedKey = keyToInsert;
+                    firstReleasedIndex = indexToPlace;
                     if (multipleReleased)
                     {
                         mOffset = std::max<size_t>(endOfReleasedBlock, mOffset);
@@ -142,45 +286,40 @@ void ScratchMemory::release(const std::string& key)
                 else
                 {
                     multipleReleased = true;
-                    endOfReleasedBlock = mOffset + numBuffers * (numElements + alignment - 1);
+                    endOfReleasedBlock = mOffset +
+                            segmentToBeMoved.getFootprint();
                 }
             }
             else
             {
-                if (!firstReleasedKey.empty())
+                if (firstReleasedIndex != INVALID_INDEX)
                 {
-                    std::map<std::string, Segment>::const_iterator iterSegNew =
-                            mSegments.find(firstReleasedKey);
-                    const Segment& segmentNew = iterSegNew->second;
-                    mOffset = segmentNew.offset;
-
-                    mConnectedKeys.insert(keyToInsert);
+                    mOffset = mSegments[firstReleasedIndex].offset;
+                    segmentToBeMoved.connected = true;
                 }
-                firstReleasedKey.clear();
+                firstReleasedIndex = INVALID_INDEX;
             }
 
-            put<sys::ubyte>(keyToInsert, numElements, numBuffers, alignment);
+            placeSegment(indexToPlace);
 
         }
-        std::map<std::string, Segment>::const_iterator iterSegNew =
-                mSegments.find(firstReleasedKey);
-        const Segment& segmentNew = iterSegNew->second;
-        mOffset = segmentNew.offset;
+        mOffset = mSegments[firstReleasedIndex].offset;
     }
 }
 
 void ScratchMemory::setup(const BufferView<sys::ubyte>& scratchBuffer)
 {
+    const size_t numBytes = getNumBytes();
     if (scratchBuffer.size == 0)
     {
         // allocate the storage internally
-        mStorage.resize(mNumBytesNeeded);
+        mStorage.resize(numBytes);
         mBuffer = mem::BufferView<sys::ubyte>(mStorage.data(), mStorage.size());
     }
     else
     {
         // use external storage
-        if (mNumBytesNeeded > scratchBuffer.size)
+        if (numBytes > scratchBuffer.size)
         {
             throw except::Exception(Ctxt(
                     "Buffer has insufficient space for scratch memory"));
@@ -193,13 +332,17 @@ void ScratchMemory::setup(const BufferView<sys::ubyte>& scratchBuffer)
         mBuffer = scratchBuffer;
     }
 
-    for (std::map<std::string, Segment>::iterator iterSeg = mSegments.begin();
-         iterSeg != mSegments.end();
-         ++iterSeg)
+    for (size_t ii = 0; ii < mSegments.size(); ++ii)
     {
-        Segment& segment = iterSeg->second;
+        Segment& segment = mSegments[ii];
         segment.buffers.resize(segment.numBuffers);
+
+        // segments packed by lifetime sit after the sequential ones
         size_t currentOffset = segment.offset;
+        if (segment.planned)
+        {
+            currentOffset += mNumBytesNeeded;
+        }
         for (size_t i = 0; i < segment.numBuffers; ++i)
         {
             segment.buffers[i] = mBuffer.data + currentOffset;
@@ -210,6 +353,71 @@ void ScratchMemory::setup(const BufferView<sys::ubyte>& scratchBuffer)
     }
 }
 
+ScratchMemory ScratchMemory::clone(
+        const BufferView<sys::ubyte>& scratchBuffer) const
+{
+    ScratchMemory scratch;
+    scratch.mSegments = mSegments;
+    scratch.mKeyIndices = mKeyIndices;
+    scratch.mKeyOrder = mKeyOrder;
+    scratch.mNumBytesNeeded = mNumBytesNeeded;
+    scratch.mNumPlannedBytes = mNumPlannedBytes;
+    scratch.mOffset = mOffset;
+    scratch.setup(scratchBuffer);
+    return scratch;
+}
+
+size_t ScratchMemory::getCloneStride() const
+{
+    return (getNumBytes() + CLONE_ALIGNMENT - 1) /
+            CLONE_ALIGNMENT * CLONE_ALIGNMENT;
+}
+
+std::vector<ScratchMemory> ScratchMemory::cloneForThreads(
+        size_t numThreads,
+        const BufferView<sys::ubyte>& scratchBuffer) const
+{
+    const size_t stride = getCloneStride();
+    if (scratchBuffer.size != 0 && scratchBuffer.size < numThreads * stride)
+    {
+        std::ostringstream oss;
+        oss << "Buffer of " << scratchBuffer.size << " bytes is too small "
+            << "for " << numThreads << " clones of " << stride << " bytes";
+        throw except::Exception(Ctxt(oss.str()));
+    }
+
+    std::vector<ScratchMemory> clones;
+    clones.reserve(numThreads);
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        if (scratchBuffer.size == 0)
+        {
+            clones.push_back(clone());
+        }
+        else
+        {
+            // the slice is at least one byte so that setup doesn't
+            // mistake it for a request to allocate
+            const BufferView<sys::ubyte> slice(
+                    scratchBuffer.data + ii * stride,
+                    std::max<size_t>(stride, 1));
+            clones.push_back(clone(slice));
+        }
+    }
+    return clones;
+}
+
+size_t ScratchMemory::lookupIndex(const std::string& key) const
+{
+    std::map<std::string, size_t>::const_iterator iterKey =
+            mKeyIndices.find(key);
+    if (iterKey == mKeyIndices.end())
+    {
+        throw except::Exception(Ctxt("Key " + key + " does not exist"));
+    }
+    return iterKey->second;
+}
+
 const ScratchMemory::Segment& ScratchMemory::lookupSegment(
         const std::string& key,
         size_t indexBuffer) const
@@ -222,20 +430,39 @@ const ScratchMemory::Segment& ScratchMemory::lookupSegment(
         throw except::Exception(Ctxt(oss.str()));
     }
 
-    std::map<std::string, Segment>::const_iterator iterSeg = mSegments.find(key);
-    if (iterSeg == mSegments.end())
+    std::map<std::string, size_t>::const_iterator iterKey =
+            mKeyIndices.find(key);
+    if (iterKey == mKeyIndices.end())
     {
         std::ostringstream oss;
         oss << "Scratch memory segment was not found for \"" << key << "\"";
         throw except::Exception(Ctxt(oss.str()));
     }
+    return lookupSegment(iterKey->second, indexBuffer);
+}
+
+const ScratchMemory::Segment& ScratchMemory::lookupSegment(
+        size_t index,
+        size_t indexBuffer) const
+{
+    if (index >= mSegments.size())
+    {
+        throw except::Exception(Ctxt("Invalid scratch memory handle"));
+    }
 
-    const Segment& segment = iterSeg->second;
+    const Segment& segment = mSegments[index];
+    if (mBuffer.data == NULL)
+    {
+        std::ostringstream oss;
+        oss << "Tried to get scratch memory for \"" << segment.key
+            << "\" before running setup.";
+        throw except::Exception(Ctxt(oss.str()));
+    }
     if (indexBuffer >= segment.buffers.size())
     {
         std::ostringstream oss;
         oss << "Trying to get buffer index " << indexBuffer << " for \""
-            << key << "\", which has only " << segment.buffers.size()
+            << segment.key << "\", which has only " << segment.buffers.size()
             << " buffers";
         throw except::Exception(Ctxt(oss.str()));
     }
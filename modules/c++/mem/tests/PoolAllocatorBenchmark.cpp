@@ -0,0 +1,144 @@
+/* =========================================================================
+ * This file is part of mem-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mem-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mem/PoolAllocator.h>
+
+/*
+ * Times 1, 2, 4, ... <maxThreads> threads each allocating and freeing
+ * batches of small blocks of mixed sizes, and each filling and emptying a
+ * std::map, with the global heap and with mem::PoolAllocator.
+ */
+
+namespace
+{
+const size_t BATCH_SIZE = 256;
+const size_t NUM_ROUNDS = 4000;
+const size_t NUM_MAP_ROUNDS = 50;
+const int NUM_MAP_ELEMENTS = 20000;
+
+struct HeapAllocator
+{
+    static void* allocate(size_t numBytes)
+    {
+        return ::operator new(numBytes);
+    }
+    static void deallocate(void* p, size_t)
+    {
+        ::operator delete(p);
+    }
+};
+
+template <typename AllocatorT>
+void churn(unsigned int seed)
+{
+    std::vector<void*> blocks(BATCH_SIZE);
+    std::vector<size_t> sizes(BATCH_SIZE);
+    for (size_t round = 0; round < NUM_ROUNDS; ++round)
+    {
+        for (size_t ii = 0; ii < BATCH_SIZE; ++ii)
+        {
+            seed = seed * 1103515245 + 12345;
+            sizes[ii] = 8 + (seed >> 16) % 500;
+            blocks[ii] = AllocatorT::allocate(sizes[ii]);
+            *static_cast<char*>(blocks[ii]) = 1;
+        }
+        for (size_t ii = 0; ii < BATCH_SIZE; ++ii)
+        {
+            AllocatorT::deallocate(blocks[ii], sizes[ii]);
+        }
+    }
+}
+
+template <typename MapT>
+void fillMaps()
+{
+    for (size_t round = 0; round < NUM_MAP_ROUNDS; ++round)
+    {
+        MapT map;
+        for (int ii = 0; ii < NUM_MAP_ELEMENTS; ++ii)
+        {
+            map[(ii * 7919) % NUM_MAP_ELEMENTS] = ii;
+        }
+    }
+}
+
+double time(size_t numThreads, const std::function<void(unsigned int)>& work)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        threads.emplace_back(work, static_cast<unsigned int>(ii + 1));
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+}
+}
+
+int main(int argc, char** argv)
+{
+    const size_t maxThreads = argc > 1 ? static_cast<size_t>(atoi(argv[1])) :
+            std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    typedef std::map<int, int> HeapMap;
+    typedef std::map<int, int, std::less<int>,
+                     mem::PoolSTLAllocator<std::pair<const int, int> > >
+            PoolMap;
+
+    for (size_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        const double numOps = 2.0 * numThreads * NUM_ROUNDS * BATCH_SIZE;
+        const double heapChurn = time(numThreads, churn<HeapAllocator>);
+        const double poolChurn = time(numThreads, churn<mem::PoolAllocator>);
+        const double heapMaps = time(numThreads, [](unsigned int)
+        {
+            fillMaps<HeapMap>();
+        });
+        const double poolMaps = time(numThreads, [](unsigned int)
+        {
+            fillMaps<PoolMap>();
+        });
+
+        std::cout << numThreads << " threads\n"
+                  << "    Churn, heap: " << heapChurn << " s, "
+                  << numOps / (heapChurn * 1e6) << " M ops/s\n"
+                  << "    Churn, pool: " << poolChurn << " s, "
+                  << numOps / (poolChurn * 1e6) << " M ops/s\n"
+                  << "    std::map, heap: " << heapMaps << " s\n"
+                  << "    std::map, pool: " << poolMaps << " s\n";
+    }
+    return 0;
+}
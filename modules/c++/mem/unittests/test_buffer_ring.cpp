@@ -0,0 +1,169 @@
+/* =========================================================================
+ * This file is part of mem-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mem-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+
+#include <thread>
+#include <vector>
+
+#include <mem/BufferRing.h>
+
+#include "TestCase.h"
+
+TEST_CASE(testInOrder)
+{
+    // Each buffer holds a run of counters; the consumer checks they all
+    // come through once and in order
+    const size_t numBuffers = 3;
+    const size_t valuesPerBuffer = 16;
+    const uint32_t numValues = 10000;
+    mem::BufferRing ring(numBuffers, valuesPerBuffer * sizeof(uint32_t));
+    TEST_ASSERT_EQ(ring.getNumBuffers(), numBuffers);
+
+    std::thread producer([&]()
+    {
+        uint32_t next = 0;
+        size_t index = 0;
+        while (next < numValues && ring.acquireForWrite(index))
+        {
+            uint32_t* const values = ring.getBuffer<uint32_t>(index);
+            size_t count = 0;
+            while (count < valuesPerBuffer && next < numValues)
+            {
+                values[count++] = next++;
+            }
+            ring.publish(index, count * sizeof(uint32_t));
+        }
+        ring.close();
+    });
+
+    uint32_t expected = 0;
+    bool inOrder = true;
+    size_t index = 0;
+    while (ring.acquireForRead(index))
+    {
+        const uint32_t* const values = ring.getBuffer<uint32_t>(index);
+        const size_t count = ring.getNumBytesUsed(index) / sizeof(uint32_t);
+        for (size_t ii = 0; ii < count; ++ii)
+        {
+            inOrder = inOrder && values[ii] == expected++;
+        }
+        ring.release(index);
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(inOrder);
+    TEST_ASSERT_EQ(expected, numValues);
+}
+
+TEST_CASE(testHandOffRules)
+{
+    mem::BufferRing ring(2, 8, 4);
+    TEST_ASSERT_EQ(reinterpret_cast<size_t>(ring.getBuffer<char>(1)) % 4,
+                   static_cast<size_t>(0));
+
+    size_t first = 0;
+    size_t second = 0;
+    TEST_ASSERT_TRUE(ring.acquireForWrite(first));
+    TEST_ASSERT_TRUE(ring.acquireForWrite(second));
+    TEST_ASSERT_NOT_EQ(first, second);
+
+    // publishing out of order or overfilling a buffer throws
+    TEST_EXCEPTION(ring.publish(second, 1));
+    TEST_EXCEPTION(ring.publish(first, 9));
+    ring.publish(first, 8);
+    ring.publish(second, 3);
+
+    size_t index = 0;
+    TEST_EXCEPTION(ring.release(first));
+    TEST_ASSERT_TRUE(ring.acquireForRead(index));
+    TEST_ASSERT_EQ(index, first);
+    TEST_ASSERT_EQ(ring.getNumBytesUsed(index), static_cast<size_t>(8));
+    ring.release(index);
+
+    // whatever was published before close() is still read
+    ring.close();
+    TEST_ASSERT_TRUE(ring.acquireForRead(index));
+    TEST_ASSERT_EQ(index, second);
+    TEST_ASSERT_EQ(ring.getNumBytesUsed(index), static_cast<size_t>(3));
+    ring.release(index);
+    TEST_ASSERT_FALSE(ring.acquireForRead(index));
+    TEST_ASSERT_FALSE(ring.acquireForWrite(index));
+
+    TEST_EXCEPTION(mem::BufferRing(0, 8));
+}
+
+TEST_CASE(testAbort)
+{
+    // A producer blocked on a full ring is woken up by abort()
+    mem::BufferRing ring(1, 4);
+    size_t index = 0;
+    TEST_ASSERT_TRUE(ring.acquireForWrite(index));
+    ring.publish(index, 4);
+
+    bool acquired = true;
+    std::thread producer([&]()
+    {
+        size_t next = 0;
+        acquired = ring.acquireForWrite(next);
+    });
+    ring.abort();
+    producer.join();
+
+    TEST_ASSERT_FALSE(acquired);
+    TEST_ASSERT_TRUE(ring.isAborted());
+    TEST_ASSERT_FALSE(ring.acquireForRead(index));
+}
+
+TEST_CASE(testExternalBuffers)
+{
+    std::vector<double> storage(3 * 4);
+    std::vector<void*> buffers;
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        buffers.push_back(&storage[ii * 4]);
+    }
+    mem::BufferRing ring(buffers, 4 * sizeof(double));
+
+    size_t index = 0;
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        TEST_ASSERT_TRUE(ring.acquireForWrite(index));
+        TEST_ASSERT_EQ(ring.getBuffer<double>(index), &storage[ii * 4]);
+        ring.getBuffer<double>(index)[0] = static_cast<double>(ii);
+        ring.publish(index, sizeof(double));
+    }
+    for (size_t ii = 0; ii < 3; ++ii)
+    {
+        TEST_ASSERT_TRUE(ring.acquireForRead(index));
+        TEST_ASSERT_EQ(ring.getBuffer<double>(index)[0],
+                       static_cast<double>(ii));
+        ring.release(index);
+    }
+}
+
+TEST_MAIN(
+    TEST_CHECK(testInOrder);
+    TEST_CHECK(testHandOffRules);
+    TEST_CHECK(testAbort);
+    TEST_CHECK(testExternalBuffers);
+    )
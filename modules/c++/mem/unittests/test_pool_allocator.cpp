@@ -0,0 +1,225 @@
+/* =========================================================================
+ * This file is part of mem-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mem-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <mem/PoolAllocator.h>
+
+#include "TestCase.h"
+
+namespace
+{
+struct Node : public mem::PoolAllocated
+{
+    explicit Node(int value_) : value(value_)
+    {
+    }
+    virtual ~Node()
+    {
+    }
+
+    int value;
+};
+
+struct BigNode final : public Node
+{
+    explicit BigNode(int value_) : Node(value_)
+    {
+        memset(padding, value_, sizeof(padding));
+    }
+
+    char padding[600];
+};
+}
+
+TEST_CASE(testAllocateSizes)
+{
+    const size_t sizes[] = {0, 1, 15, 16, 17, 100, 512, 1000, 1024, 1025,
+                            100000};
+    std::vector<void*> blocks;
+    for (size_t rep = 0; rep < 100; ++rep)
+    {
+        for (const auto size : sizes)
+        {
+            void* const block = mem::PoolAllocator::allocate(size);
+            TEST_ASSERT_NOT_EQ(block, static_cast<void*>(nullptr));
+            TEST_ASSERT_EQ(reinterpret_cast<uintptr_t>(block) % 16,
+                           static_cast<uintptr_t>(0));
+            memset(block, static_cast<int>(size & 0xFF), size);
+            blocks.push_back(block);
+        }
+    }
+
+    // Nothing got handed out twice or overwritten
+    for (size_t ii = 0; ii < blocks.size(); ++ii)
+    {
+        const size_t size = sizes[ii % (sizeof(sizes) / sizeof(sizes[0]))];
+        const unsigned char* const bytes =
+                static_cast<const unsigned char*>(blocks[ii]);
+        for (size_t jj = 0; jj < size; ++jj)
+        {
+            TEST_ASSERT_EQ(bytes[jj], static_cast<unsigned char>(size & 0xFF));
+        }
+    }
+    TEST_ASSERT_EQ(std::set<void*>(blocks.begin(), blocks.end()).size(),
+                   blocks.size());
+
+    for (size_t ii = 0; ii < blocks.size(); ++ii)
+    {
+        mem::PoolAllocator::deallocate(
+                blocks[ii], sizes[ii % (sizeof(sizes) / sizeof(sizes[0]))]);
+    }
+    mem::PoolAllocator::deallocate(nullptr, 16);
+}
+
+TEST_CASE(testBlocksAreReused)
+{
+    void* const first = mem::PoolAllocator::allocate(48);
+    mem::PoolAllocator::deallocate(first, 48);
+
+    // Same thread and size class, so the block comes straight back
+    void* const second = mem::PoolAllocator::allocate(64);
+    TEST_ASSERT_EQ(first, second);
+    mem::PoolAllocator::deallocate(second, 64);
+}
+
+TEST_CASE(testPoolAllocated)
+{
+    std::vector<Node*> nodes;
+    for (int ii = 0; ii < 10000; ++ii)
+    {
+        nodes.push_back(ii % 3 ? new Node(ii) : new BigNode(ii));
+    }
+    for (int ii = 0; ii < 10000; ++ii)
+    {
+        TEST_ASSERT_EQ(nodes[ii]->value, ii);
+    }
+
+    // Deleting through the base class gives back the right size
+    for (auto node : nodes)
+    {
+        delete node;
+    }
+}
+
+TEST_CASE(testCrossThreadFree)
+{
+    // One thread allocates everything and others free it, which pushes
+    // blocks through the shared lists
+    const size_t numThreads = 4;
+    const size_t numBlocks = 50000;
+    std::vector<std::vector<int*> > blocks(numThreads);
+    std::thread producer([&]()
+    {
+        for (size_t ii = 0; ii < numThreads * numBlocks; ++ii)
+        {
+            int* const block = static_cast<int*>(
+                    mem::PoolAllocator::allocate(sizeof(int) * 8));
+            block[0] = static_cast<int>(ii);
+            blocks[ii % numThreads].push_back(block);
+        }
+    });
+    producer.join();
+
+    std::vector<std::thread> consumers;
+    std::vector<size_t> numBad(numThreads, 0);
+    for (size_t tt = 0; tt < numThreads; ++tt)
+    {
+        consumers.emplace_back([&, tt]()
+        {
+            for (size_t ii = 0; ii < blocks[tt].size(); ++ii)
+            {
+                if (blocks[tt][ii][0] !=
+                    static_cast<int>(ii * numThreads + tt))
+                {
+                    ++numBad[tt];
+                }
+                mem::PoolAllocator::deallocate(blocks[tt][ii],
+                                               sizeof(int) * 8);
+            }
+
+            // And allocate some back, from what was just freed
+            std::vector<void*> mine;
+            for (size_t ii = 0; ii < numBlocks; ++ii)
+            {
+                mine.push_back(mem::PoolAllocator::allocate(sizeof(int) * 8));
+            }
+            for (auto block : mine)
+            {
+                mem::PoolAllocator::deallocate(block, sizeof(int) * 8);
+            }
+        });
+    }
+    for (auto& consumer : consumers)
+    {
+        consumer.join();
+    }
+    for (const auto bad : numBad)
+    {
+        TEST_ASSERT_EQ(bad, static_cast<size_t>(0));
+    }
+}
+
+TEST_CASE(testSTLAllocator)
+{
+    std::list<int, mem::PoolSTLAllocator<int> > list;
+    std::map<int, std::string, std::less<int>,
+             mem::PoolSTLAllocator<std::pair<const int, std::string> > > map;
+    for (int ii = 0; ii < 5000; ++ii)
+    {
+        list.push_back(ii);
+        map[ii] = std::to_string(ii);
+    }
+    TEST_ASSERT_EQ(list.size(), static_cast<size_t>(5000));
+    TEST_ASSERT_EQ(map[1234], std::string("1234"));
+
+    std::list<int, mem::PoolSTLAllocator<int> > other(list);
+    list.splice(list.end(), other);
+    TEST_ASSERT_EQ(list.size(), static_cast<size_t>(10000));
+
+    // Vectors outgrow the pool and switch over to the heap
+    std::vector<double, mem::PoolSTLAllocator<double> > vec;
+    for (int ii = 0; ii < 1000; ++ii)
+    {
+        vec.push_back(ii);
+    }
+    TEST_ASSERT_EQ(vec[999], 999.0);
+
+    TEST_ASSERT_TRUE(mem::PoolSTLAllocator<int>() ==
+                     mem::PoolSTLAllocator<double>());
+}
+
+TEST_MAIN(
+    TEST_CHECK(testAllocateSizes);
+    TEST_CHECK(testBlocksAreReused);
+    TEST_CHECK(testPoolAllocated);
+    TEST_CHECK(testCrossThreadFree);
+    TEST_CHECK(testSTLAllocator);
+    )
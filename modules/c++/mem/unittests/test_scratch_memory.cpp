@@ -621,6 +621,162 @@ TEST_CASE(testScratchMemory)
     TEST_EXCEPTION(scratch.setup(invalidBuffer));
 }
 
+TEST_CASE(testHandles)
+{
+    mem::ScratchMemory scratch;
+
+    const mem::ScratchMemory::Handle<int> hInts =
+            scratch.put<int>("ints", 17, 2, 16);
+    const mem::ScratchMemory::Handle<double> hDoubles =
+            scratch.put<double>("doubles", 8);
+    TEST_ASSERT_TRUE(hInts.isValid());
+    TEST_ASSERT_FALSE(mem::ScratchMemory::Handle<int>().isValid());
+
+    // handles can't be used before setup, like keys
+    TEST_EXCEPTION(scratch.get(hInts));
+
+    scratch.setup();
+
+    int* pInts0 = scratch.get(hInts);
+    int* pInts1 = scratch.get(hInts, 1);
+    double* pDoubles = scratch.get(hDoubles);
+    TEST_ASSERT_EQ(pInts0, scratch.get<int>("ints"));
+    TEST_ASSERT_EQ(pInts1, scratch.get<int>("ints", 1));
+    TEST_ASSERT_EQ(pDoubles, scratch.get<double>("doubles"));
+    TEST_ASSERT_EQ(scratch.getHandle<double>("doubles").getIndex(),
+                   hDoubles.getIndex());
+    TEST_EXCEPTION(scratch.getHandle<double>("nothing"));
+
+    const mem::ScratchMemory& constScratch = scratch;
+    const int* pConstInts = constScratch.get(hInts);
+    TEST_ASSERT_EQ(pConstInts, pInts0);
+
+    mem::BufferView<int> view = scratch.getBufferView(hInts, 1);
+    TEST_ASSERT_EQ(view.data, pInts1);
+    TEST_ASSERT_EQ(view.size, static_cast<size_t>(17));
+    for (size_t ii = 0; ii < view.size; ++ii)
+    {
+        view.data[ii] = static_cast<int>(ii);
+    }
+    for (size_t ii = 0; ii < view.size; ++ii)
+    {
+        TEST_ASSERT_EQ(pInts1[ii], static_cast<int>(ii));
+    }
+
+    TEST_EXCEPTION(scratch.get(hInts, 2));
+    TEST_EXCEPTION(scratch.get(mem::ScratchMemory::Handle<int>()));
+
+    // handles still resolve after a release moves segments around
+    mem::ScratchMemory released;
+    const mem::ScratchMemory::Handle<sys::ubyte> h0 =
+            released.put<sys::ubyte>("buf0", 10, 1, 1);
+    const mem::ScratchMemory::Handle<sys::ubyte> h1 =
+            released.put<sys::ubyte>("buf1", 10, 1, 1);
+    const mem::ScratchMemory::Handle<sys::ubyte> h2 =
+            released.put<sys::ubyte>("buf2", 10, 1, 1);
+    released.release("buf0");
+    const mem::ScratchMemory::Handle<sys::ubyte> h3 =
+            released.put<sys::ubyte>("buf3", 5, 1, 1);
+    released.setup();
+    TEST_ASSERT_EQ(released.get(h0), released.get<sys::ubyte>("buf0"));
+    TEST_ASSERT_EQ(released.get(h1), released.get<sys::ubyte>("buf1"));
+    TEST_ASSERT_EQ(released.get(h2), released.get<sys::ubyte>("buf2"));
+    TEST_ASSERT_EQ(released.get(h3), released.get<sys::ubyte>("buf3"));
+}
+
+TEST_CASE(testLifetimePlanning)
+{
+    typedef mem::ScratchMemory::Lifetime Lifetime;
+    mem::ScratchMemory scratch;
+
+    // a -- b -- c chain where only neighbours are alive together:
+    // a and c can share memory, b can't share with either
+    const mem::ScratchMemory::Handle<sys::ubyte> hA =
+            scratch.put<sys::ubyte>("a", 100, Lifetime(0, 1), 1, 1);
+    const mem::ScratchMemory::Handle<sys::ubyte> hB =
+            scratch.put<sys::ubyte>("b", 50, Lifetime(1, 2), 1, 1);
+    const mem::ScratchMemory::Handle<sys::ubyte> hC =
+            scratch.put<sys::ubyte>("c", 80, Lifetime(2, 3), 1, 1);
+    TEST_ASSERT_EQ(scratch.getNumBytes(), static_cast<size_t>(150));
+
+    // d fits in the gap c leaves behind a
+    const mem::ScratchMemory::Handle<sys::ubyte> hD =
+            scratch.put<sys::ubyte>("d", 20, Lifetime(3, 3), 1, 1);
+    TEST_ASSERT_EQ(scratch.getNumBytes(), static_cast<size_t>(150));
+
+    // a segment placed in put order goes before the planned ones
+    scratch.put<sys::ubyte>("fixed", 7, 1, 1);
+    TEST_ASSERT_EQ(scratch.getNumBytes(), static_cast<size_t>(157));
+
+    TEST_EXCEPTION(scratch.put<sys::ubyte>("a", 1, Lifetime(0, 0)));
+    TEST_EXCEPTION(scratch.put<sys::ubyte>("backwards", 1, Lifetime(2, 1)));
+    TEST_EXCEPTION(scratch.release("a"));
+
+    scratch.setup();
+    const sys::ubyte* fixed = scratch.get<sys::ubyte>("fixed");
+    const sys::ubyte* a = scratch.get(hA);
+    const sys::ubyte* b = scratch.get(hB);
+    const sys::ubyte* c = scratch.get(hC);
+    const sys::ubyte* d = scratch.get(hD);
+    TEST_ASSERT_TRUE(a >= fixed + 7);
+    TEST_ASSERT_EQ(a, c);
+    TEST_ASSERT_EQ(d, c + 80);
+    TEST_ASSERT_TRUE(b >= a + 100 || b + 50 <= a);
+
+    // alignment overhead is part of each footprint
+    mem::ScratchMemory aligned;
+    aligned.put<double>("x", 4, Lifetime(0, 0));
+    aligned.put<double>("y", 4, Lifetime(0, 0));
+    aligned.put<double>("z", 4, Lifetime(1, 1));
+    const size_t footprint = 4 * sizeof(double) +
+            sys::SSE_INSTRUCTION_ALIGNMENT - 1;
+    TEST_ASSERT_EQ(aligned.getNumBytes(), 2 * footprint);
+    aligned.setup();
+    TEST_ASSERT_EQ(reinterpret_cast<size_t>(aligned.get<double>("z")) %
+                           sys::SSE_INSTRUCTION_ALIGNMENT,
+                   static_cast<size_t>(0));
+}
+
+TEST_CASE(testCloneForThreads)
+{
+    typedef mem::ScratchMemory::Lifetime Lifetime;
+    mem::ScratchMemory scratch;
+    const mem::ScratchMemory::Handle<float> hIn =
+            scratch.put<float>("in", 33);
+    const mem::ScratchMemory::Handle<float> hOut =
+            scratch.put<float>("out", 33, Lifetime(0, 0));
+
+    const size_t numThreads = 3;
+    const size_t stride = scratch.getCloneStride();
+    TEST_ASSERT_TRUE(stride >= scratch.getNumBytes());
+    TEST_ASSERT_EQ(stride % 64, static_cast<size_t>(0));
+
+    std::vector<sys::ubyte> storage(numThreads * stride);
+    const mem::BufferView<sys::ubyte> buffer(storage.data(), storage.size());
+    std::vector<mem::ScratchMemory> clones =
+            scratch.cloneForThreads(numThreads, buffer);
+    TEST_ASSERT_EQ(clones.size(), numThreads);
+    for (size_t ii = 0; ii < numThreads; ++ii)
+    {
+        const sys::ubyte* begin = storage.data() + ii * stride;
+        const sys::ubyte* in =
+                reinterpret_cast<const sys::ubyte*>(clones[ii].get(hIn));
+        const sys::ubyte* out =
+                reinterpret_cast<const sys::ubyte*>(clones[ii].get(hOut));
+        TEST_ASSERT_TRUE(in >= begin && in + 33 * sizeof(float) <= begin + stride);
+        TEST_ASSERT_TRUE(out >= in + 33 * sizeof(float));
+        TEST_ASSERT_TRUE(out + 33 * sizeof(float) <= begin + stride);
+    }
+
+    // clones of the original layout can also own their memory
+    std::vector<mem::ScratchMemory> owning = scratch.cloneForThreads(2);
+    TEST_ASSERT_NOT_EQ(owning[0].get(hIn), owning[1].get(hIn));
+    owning[1].get(hOut)[32] = 1.0f;
+
+    const mem::BufferView<sys::ubyte> small(storage.data(), stride);
+    TEST_EXCEPTION(scratch.cloneForThreads(numThreads, small));
+}
+
 TEST_MAIN(
     TEST_CHECK(testScratchMemory);
     TEST_CHECK(testReleaseSingleEndBuffer);
@@ -630,4 +786,7 @@ TEST_MAIN(
     TEST_CHECK(testReleaseConcurrentKeys);
     TEST_CHECK(testReleaseConnectedKeys);
     TEST_CHECK(testGenerateBuffersForRelease);
+    TEST_CHECK(testHandles);
+    TEST_CHECK(testLifetimePlanning);
+    TEST_CHECK(testCloneForThreads);
     )
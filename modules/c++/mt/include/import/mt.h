@@ -40,6 +40,7 @@
 #include "mt/Runnable1D.h"
 #include "mt/BalancedRunnable1D.h"
 #include "mt/WorkSharingBalancedRunnable1D.h"
+#include "mt/FirstTouch.h"
 
 #include "mt/CPUAffinityInitializer.h"
 #include "mt/CPUAffinityThreadInitializer.h"
@@ -25,8 +25,16 @@
 #pragma once
 
 #include <algorithm>
+#include <exception>
 #include <iterator>
 #include <future>
+#include <vector>
+
+#include <sys/Runnable.h>
+#include <mem/PoolAllocator.h>
+#include <mt/GenerationThreadPool.h>
+#include <mt/ThreadPlanner.h>
+#include <mt/WorkSharingBalancedRunnable1D.h>
 
 namespace mt
 {
@@ -65,6 +73,348 @@ inline OutputIt transform_async(const InputIt first1, const InputIt last1, Outpu
     return transform_async(first1, last1, d_first, f, cutoff, policy);
 }
 
+
+/*!
+ * How the parallel reductions below (reduce, transform_reduce,
+ * inclusive_scan) split up their input and combine the pieces
+ */
+enum class Combine
+{
+    //! One piece per thread, combined in thread order. The result only
+    //! depends on the number of threads, but for floating-point
+    //! operations a different number of threads may round differently.
+    ByThread,
+
+    //! Pieces of DETERMINISTIC_CHUNK_SIZE elements, combined in order no
+    //! matter which thread did them, so floating-point results are
+    //! bitwise the same for any number of threads
+    Deterministic
+};
+
+//! Elements per piece with Combine::Deterministic
+static const size_t DETERMINISTIC_CHUNK_SIZE = 4096;
+
+namespace details
+{
+    // Keeps each thread's partial result on its own cache line(s)
+    template <typename T>
+    struct PaddedPartial final
+    {
+        PaddedPartial(const T& value_) : value(value_)
+        {
+        }
+
+        T value;
+        char padding[WorkSharingCounters::CACHE_LINE_SIZE];
+    };
+
+    template <typename FuncT>
+    struct ChunkRunnable final : public sys::Runnable, public mem::PoolAllocated
+    {
+        ChunkRunnable(size_t startChunk, size_t numChunks, const FuncT& func,
+                      std::exception_ptr& error) :
+            mStartChunk(startChunk),
+            mEndChunk(startChunk + numChunks),
+            mFunc(func),
+            mError(error)
+        {
+        }
+
+        void run() override
+        {
+            // The pool's threads don't expect exceptions, so hand them
+            // back to the caller
+            try
+            {
+                for (size_t chunk = mStartChunk; chunk < mEndChunk; ++chunk)
+                {
+                    mFunc(chunk);
+                }
+            }
+            catch (...)
+            {
+                mError = std::current_exception();
+            }
+        }
+
+    private:
+        const size_t mStartChunk;
+        const size_t mEndChunk;
+        const FuncT& mFunc;
+        std::exception_ptr& mError;
+    };
+
+    // Calls func(chunk) for each of [0, numChunks), giving each of the
+    // pool's threads a contiguous run of chunks
+    template <typename FuncT>
+    void forEachChunk(GenerationThreadPool& pool, size_t numChunks,
+                      const FuncT& func)
+    {
+        const size_t numThreads = std::min(pool.getSize(), numChunks);
+        if (numThreads <= 1)
+        {
+            for (size_t chunk = 0; chunk < numChunks; ++chunk)
+            {
+                func(chunk);
+            }
+            return;
+        }
+
+        std::vector<std::exception_ptr> errors(numThreads);
+        std::vector<sys::Runnable*> runnables;
+        const ThreadPlanner planner(numChunks, numThreads);
+        size_t threadNum(0);
+        size_t startChunk(0);
+        size_t numChunksThisThread(0);
+        while (planner.getThreadInfo(threadNum, startChunk, numChunksThisThread))
+        {
+            runnables.push_back(new ChunkRunnable<FuncT>(
+                    startChunk, numChunksThisThread, func, errors[threadNum]));
+            ++threadNum;
+        }
+        pool.addAndWaitGroup(runnables);
+
+        for (const auto& error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+
+    inline size_t getChunkSize(size_t numElements, size_t numThreads,
+                               Combine combine)
+    {
+        if (combine == Combine::Deterministic)
+        {
+            return DETERMINISTIC_CHUNK_SIZE;
+        }
+        numThreads = std::max<size_t>(numThreads, 1);
+        return std::max<size_t>((numElements + numThreads - 1) / numThreads, 1);
+    }
+
+    // The op-combination of transformOp(element) over each chunk, in
+    // order, accumulated in T (as std::reduce() does) starting from the
+    // chunk's first element converted to T
+    template <typename T, typename InputIt, typename BinaryOp, typename UnaryOp>
+    std::vector<PaddedPartial<T>> reduceChunks(
+            GenerationThreadPool& pool, InputIt first, size_t numElements,
+            size_t chunkSize, BinaryOp op, UnaryOp transformOp)
+    {
+        const size_t numChunks = (numElements + chunkSize - 1) / chunkSize;
+
+        std::vector<PaddedPartial<T>> partials;
+        partials.reserve(numChunks);
+        for (size_t chunk = 0; chunk < numChunks; ++chunk)
+        {
+            partials.emplace_back(T(transformOp(first[chunk * chunkSize])));
+        }
+
+        forEachChunk(pool, numChunks, [&](size_t chunk)
+        {
+            const size_t begin = chunk * chunkSize;
+            const size_t end = std::min(begin + chunkSize, numElements);
+            T partial = partials[chunk].value;
+            for (size_t ii = begin + 1; ii < end; ++ii)
+            {
+                partial = op(partial, transformOp(first[ii]));
+            }
+            partials[chunk].value = partial;
+        });
+        return partials;
+    }
 }
-#endif // CODA_OSS_mt_Algorithm_h_INCLUDED_
 
+/*!
+ * Parallel std::transform_reduce(): init combined with
+ * transformOp(element) for every element of [first, last), using the
+ * pool's threads.
+ *
+ * Like std::transform_reduce(), op must be associative and everything is
+ * accumulated in T; unlike it, the elements are always combined in order,
+ * so op needn't be commutative.
+ *
+ * \param pool A started pool to run on. It can't be in the middle of
+ *        another group.
+ * \param first,last Random-access range of elements
+ * \param init Initial value
+ * \param op Combines two values
+ * \param transformOp Applied to each element before it's combined
+ * \param combine How the elements are split up among the threads
+ */
+template <typename InputIt, typename T, typename BinaryOp, typename UnaryOp>
+T transform_reduce(GenerationThreadPool& pool, InputIt first, InputIt last,
+                   T init, BinaryOp op, UnaryOp transformOp,
+                   Combine combine = Combine::ByThread)
+{
+    const size_t numElements = static_cast<size_t>(std::distance(first, last));
+    if (numElements == 0)
+    {
+        return init;
+    }
+
+    const auto partials = details::reduceChunks<T>(pool, first, numElements,
+            details::getChunkSize(numElements, pool.getSize(), combine),
+            op, transformOp);
+    for (const auto& partial : partials)
+    {
+        init = op(init, partial.value);
+    }
+    return init;
+}
+
+/*!
+ * Parallel std::reduce(): init combined with every element of
+ * [first, last). See transform_reduce().
+ */
+template <typename InputIt, typename T, typename BinaryOp>
+T reduce(GenerationThreadPool& pool, InputIt first, InputIt last, T init,
+         BinaryOp op, Combine combine = Combine::ByThread)
+{
+    typedef typename std::iterator_traits<InputIt>::value_type Value;
+    return transform_reduce(pool, first, last, init, op,
+                            [](const Value& value) -> const Value& { return value; },
+                            combine);
+}
+
+//! Parallel sum of [first, last), starting from init
+template <typename InputIt, typename T>
+T reduce(GenerationThreadPool& pool, InputIt first, InputIt last, T init,
+         Combine combine = Combine::ByThread)
+{
+    return reduce(pool, first, last, init,
+                  [](const T& lhs, const T& rhs) { return lhs + rhs; },
+                  combine);
+}
+
+/*!
+ * Parallel std::inclusive_scan(): element i of the output is the
+ * op-combination of elements 0 through i of the input.
+ *
+ * Each thread reduces its piece, the partial results are scanned
+ * serially, and then each thread scans its piece starting from the
+ * combination of everything before it. So the input is read twice, and
+ * op must be associative.
+ *
+ * \param pool A started pool to run on
+ * \param first,last Random-access range of elements
+ * \param d_first Start of the output, which may be first
+ * \param op Combines two values
+ * \param combine How the elements are split up among the threads
+ *
+ * \return The end of the output
+ */
+template <typename InputIt, typename OutputIt, typename BinaryOp>
+OutputIt inclusive_scan(GenerationThreadPool& pool, InputIt first, InputIt last,
+                        OutputIt d_first, BinaryOp op,
+                        Combine combine = Combine::ByThread)
+{
+    typedef typename std::iterator_traits<InputIt>::value_type Value;
+    const size_t numElements = static_cast<size_t>(std::distance(first, last));
+    if (numElements == 0)
+    {
+        return d_first;
+    }
+
+    const size_t chunkSize =
+            details::getChunkSize(numElements, pool.getSize(), combine);
+    auto partials = details::reduceChunks<Value>(pool, first, numElements, chunkSize,
+            op, [](const Value& value) -> const Value& { return value; });
+
+    // Turn each chunk's partial into the combination of everything before
+    // it; the first chunk has nothing before it, and its partial is unused
+    for (size_t chunk = 1; chunk < partials.size(); ++chunk)
+    {
+        partials[chunk].value = op(partials[chunk - 1].value,
+                                   partials[chunk].value);
+    }
+    for (size_t chunk = partials.size() - 1; chunk > 0; --chunk)
+    {
+        partials[chunk].value = partials[chunk - 1].value;
+    }
+
+    details::forEachChunk(pool, partials.size(), [&](size_t chunk)
+    {
+        const size_t begin = chunk * chunkSize;
+        const size_t end = std::min(begin + chunkSize, numElements);
+        Value value = (chunk == 0) ?
+                Value(first[begin]) : op(partials[chunk].value, first[begin]);
+        d_first[begin] = value;
+        for (size_t ii = begin + 1; ii < end; ++ii)
+        {
+            value = op(value, first[ii]);
+            d_first[ii] = value;
+        }
+    });
+    return d_first + numElements;
+}
+
+//! Parallel prefix sum of [first, last)
+template <typename InputIt, typename OutputIt>
+OutputIt inclusive_scan(GenerationThreadPool& pool, InputIt first, InputIt last,
+                        OutputIt d_first, Combine combine = Combine::ByThread)
+{
+    typedef typename std::iterator_traits<InputIt>::value_type Value;
+    return inclusive_scan(pool, first, last, d_first,
+                          [](const Value& lhs, const Value& rhs) { return lhs + rhs; },
+                          combine);
+}
+
+/*!
+ * Parallel histogram: counts how many elements of [first, last) land in
+ * each bin.
+ *
+ * Each thread counts its piece into its own histogram, and the
+ * histograms are added up at the end, so there's no contention over the
+ * bins (and counts come out the same however the work is split up).
+ *
+ * \param pool A started pool to run on
+ * \param first,last Random-access range of elements
+ * \param numBins Number of bins
+ * \param toBin Maps an element to its bin. Elements mapped to a bin
+ *        >= numBins aren't counted.
+ *
+ * \return The count for each bin
+ */
+template <typename InputIt, typename BinOp>
+std::vector<size_t> histogram(GenerationThreadPool& pool, InputIt first,
+                              InputIt last, size_t numBins, BinOp toBin)
+{
+    const size_t numElements = static_cast<size_t>(std::distance(first, last));
+    const size_t chunkSize = details::getChunkSize(
+            numElements, pool.getSize(), Combine::ByThread);
+    const size_t numChunks = (numElements + chunkSize - 1) / chunkSize;
+
+    // Each thread allocates its own, so they're on its NUMA node and
+    // never share a cache line
+    std::vector<std::vector<size_t>> counts(numChunks);
+    details::forEachChunk(pool, numChunks, [&](size_t chunk)
+    {
+        std::vector<size_t> chunkCounts(numBins, 0);
+        const size_t begin = chunk * chunkSize;
+        const size_t end = std::min(begin + chunkSize, numElements);
+        for (size_t ii = begin; ii < end; ++ii)
+        {
+            const size_t bin = static_cast<size_t>(toBin(first[ii]));
+            if (bin < numBins)
+            {
+                ++chunkCounts[bin];
+            }
+        }
+        counts[chunk].swap(chunkCounts);
+    });
+
+    std::vector<size_t> total(numBins, 0);
+    for (const auto& chunkCounts : counts)
+    {
+        for (size_t bin = 0; bin < numBins; ++bin)
+        {
+            total[bin] += chunkCounts[bin];
+        }
+    }
+    return total;
+}
+
+}
+#endif // CODA_OSS_mt_Algorithm_h_INCLUDED_
@@ -29,6 +29,7 @@
 #include <sys/Runnable.h>
 #include <sys/AtomicCounter.h>
 #include <except/Exception.h>
+#include <mem/PoolAllocator.h>
 #include <mt/ThreadPlanner.h>
 #include <mt/ThreadGroup.h>
 
@@ -50,7 +51,7 @@ namespace mt
  *
  */
 template <typename OpT>
-class BalancedRunnable1D : public sys::Runnable
+class BalancedRunnable1D : public sys::Runnable, public mem::PoolAllocated
 {
 public:
 
@@ -39,6 +39,7 @@ namespace mt
 {
 struct AbstractNextCPUProviderLinux
 {
+    virtual ~AbstractNextCPUProviderLinux() {}
     virtual mem::auto_ptr<const sys::ScopedCPUMaskUnix> nextCPU() = 0;
 };
 
@@ -49,6 +50,23 @@ struct AbstractNextCPUProviderLinux
 class CPUAffinityInitializerLinux : public AbstractCPUAffinityInitializer
 {
 public:
+    /*!
+     * How threads are laid out across NUMA nodes
+     *
+     * NUMA_COMPACT fills one node's CPUs before moving on to the next, so
+     * a small pool shares one node's memory.
+     *
+     * NUMA_SPREAD takes a CPU from each node in turn, so a pool gets the
+     * memory bandwidth of every node.
+     *
+     * Either way, physical CPUs are handed out before hyperthreaded ones
+     * within a node.
+     */
+    enum NUMAPlacement
+    {
+        NUMA_COMPACT,
+        NUMA_SPREAD
+    };
 
     /*!
      * Constructor that uses the available CPUs (possibly restricted
@@ -64,6 +82,22 @@ public:
      */
     CPUAffinityInitializerLinux(int initialOffset);
 
+    /*!
+     * Constructor that uses the available CPUs, ordered by NUMA node
+     * (see sys::OS::getAvailableCPUsByNUMANode)
+     *
+     * \param placement How to lay the threads out across the nodes
+     */
+    explicit CPUAffinityInitializerLinux(NUMAPlacement placement);
+
+    /*!
+     * Constructor that pins each thread to the next CPU in a list, e.g.
+     * one NUMA node's CPUs from sys::OS::getAvailableCPUsByNUMANode
+     *
+     * \param cpus CPUs to use, in order
+     */
+    explicit CPUAffinityInitializerLinux(const std::vector<int>& cpus);
+
     /*!
      * \throws if there are no more available CPUs to bind to
      * \returns a new CPUAffinityInitializerLinux for the next available
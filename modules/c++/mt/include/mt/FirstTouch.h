@@ -0,0 +1,121 @@
+/* =========================================================================
+ * This file is part of mt-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mt-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef __MT_FIRST_TOUCH_H__
+#define __MT_FIRST_TOUCH_H__
+
+#include <algorithm>
+#include <memory>
+
+#include <sys/Runnable.h>
+#include <mem/PoolAllocator.h>
+#include <mt/CPUAffinityInitializer.h>
+#include <mt/ThreadGroup.h>
+#include <mt/ThreadPlanner.h>
+
+namespace mt
+{
+/*!
+ *  \class FirstTouchRunnable
+ *  \brief Fills [startElement, startElement + numElements) of a buffer
+ */
+template <typename T>
+struct FirstTouchRunnable : public sys::Runnable, public mem::PoolAllocated
+{
+    FirstTouchRunnable(T* buffer,
+                       size_t startElement,
+                       size_t numElements,
+                       const T& value) :
+        mBuffer(buffer),
+        mStartElement(startElement),
+        mNumElements(numElements),
+        mValue(value)
+    {
+    }
+
+    virtual void run()
+    {
+        std::fill_n(mBuffer + mStartElement, mNumElements, mValue);
+    }
+
+private:
+    T* const mBuffer;
+    const size_t mStartElement;
+    const size_t mNumElements;
+    const T& mValue;
+};
+
+/*!
+ *  Initialize a freshly allocated buffer in parallel, with each thread
+ *  filling the share of it that the same thread of a run1D() (or
+ *  runBalanced1D()) over the buffer with numThreads threads will process.
+ *
+ *  Linux places a page on the NUMA node of the CPU that first writes to
+ *  it, so when the threads are pinned (see ThreadGroup), each share ends
+ *  up in memory local to the thread that will work on it rather than all
+ *  of it on the allocating thread's node.  This only helps pages that
+ *  haven't been written yet, i.e. the buffer should come straight from
+ *  the allocator (mem::ScopedAlignedArray, mem::ScratchMemory, etc.) and
+ *  be large enough to be mapped fresh rather than recycled from the heap.
+ *
+ *  \param buffer Buffer to fill
+ *  \param numElements Number of elements in the buffer
+ *  \param numThreads Number of threads that will process the buffer
+ *  \param value Value to fill the buffer with
+ *  \param affinityInit Source of each thread's CPU affinity; this should
+ *  hand out CPUs in the same order as the pool that will process the
+ *  buffer.  If NULL, a ThreadGroup() is used, which pins its threads only
+ *  if ThreadGroup::getDefaultPinToCPU() is set.  Unpinned threads still
+ *  fill the buffer in parallel, but nothing keeps each share on the node
+ *  of the thread that will later process it.
+ */
+template <typename T>
+void firstTouch(T* buffer,
+                size_t numElements,
+                size_t numThreads,
+                const T& value = T(),
+                std::unique_ptr<CPUAffinityInitializer>&& affinityInit =
+                        std::unique_ptr<CPUAffinityInitializer>())
+{
+    if (numThreads <= 1)
+    {
+        std::fill_n(buffer, numElements, value);
+        return;
+    }
+
+    std::unique_ptr<ThreadGroup> threads(affinityInit.get() ?
+            new ThreadGroup(std::move(affinityInit)) : new ThreadGroup());
+    const ThreadPlanner planner(numElements, numThreads);
+
+    size_t threadNum(0);
+    size_t startElement(0);
+    size_t numElementsThisThread(0);
+    while (planner.getThreadInfo(threadNum++, startElement,
+                                 numElementsThisThread))
+    {
+        threads->createThread(new FirstTouchRunnable<T>(
+                buffer, startElement, numElementsThisThread, value));
+    }
+    threads->joinAll();
+}
+}
+
+#endif
@@ -7,13 +7,14 @@
 #include <sys/Conf.h>
 #include <sys/Runnable.h>
 #include <except/Exception.h>
+#include <mem/PoolAllocator.h>
 #include "mt/ThreadPlanner.h"
 #include "mt/ThreadGroup.h"
 
 namespace mt
 {
 template <typename OpT>
-class Runnable1D : public sys::Runnable
+class Runnable1D : public sys::Runnable, public mem::PoolAllocated
 {
 public:
     Runnable1D(size_t startElement,
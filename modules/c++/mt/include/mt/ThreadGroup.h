@@ -65,6 +65,15 @@ struct CODA_OSS_API ThreadGroup
      */
     ThreadGroup(bool pinToCPU = getDefaultPinToCPU());
 
+    /*!
+     * Constructor that pins threads with the given initializer, e.g. one
+     * that lays them out by NUMA node.
+     * \param affinityInit Source of each thread's CPU affinity. If NULL,
+     *                     no pinning occurs.
+     */
+    explicit ThreadGroup(
+            std::unique_ptr<CPUAffinityInitializer>&& affinityInit);
+
     /*!
     *  Destructor. Attempts to join all threads.
     */
@@ -22,35 +22,144 @@
 #ifndef __MT_WORK_SHARING_BALANCED_RUNNABLE_1D_H__
 #define __MT_WORK_SHARING_BALANCED_RUNNABLE_1D_H__
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <type_traits>
 #include <vector>
 #include <sstream>
 
 #include <sys/Conf.h>
 #include <sys/Runnable.h>
-#include <sys/AtomicCounter.h>
 #include <except/Exception.h>
+#include <mem/PoolAllocator.h>
 #include <mt/ThreadPlanner.h>
 #include <mt/ThreadGroup.h>
 #include <types/Range.h>
-#include <gsl/gsl.h>
 
 namespace mt
 {
-typedef std::vector<std::shared_ptr<sys::AtomicCounter> > SharedAtomicCounterVec;
+/*!
+ *  \class WorkSharingCounters
+ *  \brief The per-thread work counters shared by a set of
+ *  WorkSharingBalancedRunnable1D's
+ *
+ *  Each thread's counter holds the next unclaimed element of its range and
+ *  the end of that range.  The counters live in one array, one cache line
+ *  apiece, so a thread bumping its own counter doesn't invalidate the line
+ *  holding anyone else's.
+ */
+class WorkSharingCounters
+{
+public:
+    enum { CACHE_LINE_SIZE = 64 };
+
+    //!  One counter for each range, starting at the start of the range
+    explicit WorkSharingCounters(const std::vector<types::Range>& ranges) :
+        mNumCounters(ranges.size()),
+        mStorage(new char[(ranges.size() + 1) * sizeof(Counter)]),
+        mCounters(nullptr)
+    {
+        // new[] only promises alignment for the fundamental types, so the
+        // extra line of storage is for lining the array up by hand
+        void* storage = mStorage.get();
+        size_t space = (mNumCounters + 1) * sizeof(Counter);
+        mCounters = static_cast<Counter*>(std::align(
+                CACHE_LINE_SIZE, mNumCounters * sizeof(Counter),
+                storage, space));
+        for (size_t ii = 0; ii < mNumCounters; ++ii)
+        {
+            new (&mCounters[ii]) Counter(ranges[ii]);
+        }
+    }
+
+    WorkSharingCounters(const WorkSharingCounters&) = delete;
+    WorkSharingCounters& operator=(const WorkSharingCounters&) = delete;
+
+    size_t size() const
+    {
+        return mNumCounters;
+    }
+
+    /*!
+     *  Claim the next (up to) grainSize elements of thread threadNum's
+     *  range as [begin, end).
+     *
+     *  \return false if the range has been used up
+     */
+    bool claim(size_t threadNum, size_t grainSize, size_t& begin, size_t& end)
+    {
+        Counter& counter = mCounters[threadNum];
+
+        // Don't keep bumping (and so dirtying the line of) a finished counter
+        if (counter.next.load(std::memory_order_relaxed) >= counter.end)
+        {
+            return false;
+        }
+        begin = counter.next.fetch_add(grainSize, std::memory_order_relaxed);
+        if (begin >= counter.end)
+        {
+            return false;
+        }
+        end = std::min(begin + grainSize, counter.end);
+        return true;
+    }
+
+    //!  \return The thread with the most unclaimed elements, or size() if
+    //!  every element has been claimed
+    size_t findMostLoaded() const
+    {
+        size_t mostLoaded = mNumCounters;
+        size_t mostRemaining = 0;
+        for (size_t ii = 0; ii < mNumCounters; ++ii)
+        {
+            const size_t next =
+                    mCounters[ii].next.load(std::memory_order_relaxed);
+            const size_t end = mCounters[ii].end;
+            if (next < end && end - next > mostRemaining)
+            {
+                mostRemaining = end - next;
+                mostLoaded = ii;
+            }
+        }
+        return mostLoaded;
+    }
+
+private:
+    struct Counter
+    {
+        explicit Counter(const types::Range& range) :
+            next(range.mStartElement),
+            end(range.mStartElement + range.mNumElements)
+        {
+        }
+
+        std::atomic<size_t> next;
+        const size_t end;
+        char padding[CACHE_LINE_SIZE - sizeof(std::atomic<size_t>) -
+                     sizeof(size_t)];
+    };
+    static_assert(sizeof(Counter) == CACHE_LINE_SIZE,
+                  "Counters must each fill one cache line");
+
+    const size_t mNumCounters;
+    std::unique_ptr<char[]> mStorage;
+    Counter* mCounters;
+};
 
 /*!
  *  \class WorkSharingBalancedRunnable1D
  *  \tparam OpT The type of functor that will be used to process elements
  *
- *  This runnable takes both a reference to the associated thread's
- *  atomic counter as well as atomic counter and range information for all
- *  other threads in the thread pool.
+ *  This runnable takes the counters of every thread in the pool, along with
+ *  which of them is its own.
  *
  *  Each runnable will operate on a contiguous range of elements
- *  ([startElement, startElement + numElements]). Once all work has been
- *  completed in its range, the atomic counters and terminating indices of
- *  other threads will be used to grab additional work rather than let
- *  the thread die.
+ *  ([startElement, startElement + numElements]), claiming grainSize of
+ *  them at a time from its counter.  Once all work has been claimed in its
+ *  range, it takes work from whichever other thread has the most left
+ *  rather than let the thread die.
  *
  *  This runnable is useful in cases where work needs to be
  *  done across a range of elements, but when dividing these elements
@@ -58,39 +167,34 @@ typedef std::vector<std::shared_ptr<sys::AtomicCounter> > SharedAtomicCounterVec
  *  terminate earlier than other threads. By giving each thread
  *  its own range and atomic counter rather than one shared atomic counter
  *  used to grab elements from a global range, we get better locality of
- *  reference and in practice better caching.
+ *  reference and in practice better caching.  Claiming several elements at
+ *  a time keeps the atomic traffic down when the op is cheap.
  *
  */
 template <typename OpT>
-struct WorkSharingBalancedRunnable1D : public sys::Runnable
+struct WorkSharingBalancedRunnable1D : public sys::Runnable,
+                                       public mem::PoolAllocated
 {
     /*!
      *  Constructor
      *
-     *  \param range Range of elements for this runnable to work on
+     *  \param[in,out] counters Counters for every thread in the pool;
+     *  when this thread has used up its own range, the others will be used
+     *  to grab additional work
      *
-     *  \param[in,out] atomicCounter Atomic counter this thread will initially
-     *  use to fetch elements within its range to process
+     *  \param threadNum Which of the counters is this thread's
      *
-     *  \param threadPoolCounters Atomic counters of other threads - if
-     *  this thread finishes processing the elements within its range, these
-     *  counters will be used to grab additional work
-     *
-     *  \param threadPoolEndElements Terminating indices (exclusive) for each
-     *  thread
+     *  \param grainSize How many elements to claim at a time
      *
      */
     WorkSharingBalancedRunnable1D(
-            const types::Range& range,
-            sys::AtomicCounter& counter,
-            const SharedAtomicCounterVec& threadCounters,
-            const std::vector<size_t>& threadPoolEndElements,
+            WorkSharingCounters& counters,
+            size_t threadNum,
+            size_t grainSize,
             const OpT& op) :
-        mStartElement(range.mStartElement),
-        mEndElement(mStartElement + range.mNumElements),
-        mCounter(counter),
-        mThreadPoolCounters(threadCounters),
-        mThreadPoolEndElements(threadPoolEndElements),
+        mCounters(counters),
+        mThreadNum(threadNum),
+        mGrainSize(std::max<size_t>(grainSize, 1)),
         mOp(op)
     {
     }
@@ -102,43 +206,96 @@ struct WorkSharingBalancedRunnable1D : public sys::Runnable
     virtual void run()
     {
         // Operate over this thread's range
-        processElements(mCounter, mEndElement);
+        processElements(mThreadNum);
 
-        // Help other threads that have yet to process every element in
-        // their range
-        for (size_t ii = 0; ii < mThreadPoolEndElements.size(); ++ii)
+        // Help the thread with the most left to do, until nobody has
+        // anything left
+        size_t victim;
+        while ((victim = mCounters.findMostLoaded()) != mCounters.size())
         {
-            const size_t threadEndElement = mThreadPoolEndElements[ii];
-            sys::AtomicCounter& threadCounter = *mThreadPoolCounters[ii];
-            processElements(threadCounter, threadEndElement);
+            processElements(victim);
         }
     }
 
 private:
-    void processElements(sys::AtomicCounter& counter, size_t endElement)
+    void processElements(size_t threadNum)
     {
-        while (true)
+        size_t begin = 0;
+        size_t end = 0;
+        while (mCounters.claim(threadNum, mGrainSize, begin, end))
         {
-            const auto element = gsl::narrow<size_t>(counter.getThenIncrement());
-            if (element < endElement)
+            for (size_t element = begin; element < end; ++element)
             {
                 mOp(element);
             }
-            else
-            {
-                break;
-            }
         }
     }
 
-    const size_t mStartElement;
-    const size_t mEndElement;
-    sys::AtomicCounter& mCounter;
-    const SharedAtomicCounterVec& mThreadPoolCounters;
-    const std::vector<size_t >& mThreadPoolEndElements;
+    WorkSharingCounters& mCounters;
+    const size_t mThreadNum;
+    const size_t mGrainSize;
     const OpT& mOp;
 };
 
+/*!
+ *  The grain size used when none is given: a sixty-fourth of each thread's
+ *  share, so the tail end of the work can still be spread around.
+ */
+inline size_t getWorkSharingGrainSize(size_t numElements, size_t numThreads)
+{
+    const size_t perThread =
+            (numElements + numThreads - 1) / std::max<size_t>(numThreads, 1);
+    return std::max<size_t>(perThread / 64, 1);
+}
+
+namespace detail
+{
+template <typename OpsT>
+void runWorkSharingBalanced1D(size_t numElements,
+                              size_t numThreads,
+                              const OpsT& getOp,
+                              size_t grainSize)
+{
+    if (numThreads <= 1)
+    {
+        const auto& op = getOp(0);
+        for (size_t element = 0; element < numElements; ++element)
+        {
+            op(element);
+        }
+        return;
+    }
+
+    if (grainSize == 0)
+    {
+        grainSize = getWorkSharingGrainSize(numElements, numThreads);
+    }
+
+    size_t threadNum = 0;
+    size_t startElement = 0;
+    size_t numElementsThisThread = 0;
+    const ThreadPlanner planner(numElements, numThreads);
+    std::vector<types::Range> threadPoolRange;
+    while (planner.getThreadInfo(
+            threadNum++, startElement, numElementsThisThread))
+    {
+        threadPoolRange.push_back(
+                types::Range(startElement, numElementsThisThread));
+    }
+    WorkSharingCounters counters(threadPoolRange);
+
+    typedef typename std::decay<decltype(getOp(0))>::type OpT;
+    ThreadGroup threads;
+    for (size_t ii = 0; ii < threadPoolRange.size(); ++ii)
+    {
+        threads.createThread(
+                new WorkSharingBalancedRunnable1D<OpT>(
+                        counters, ii, grainSize, getOp(ii)));
+    }
+    threads.joinAll();
+}
+}
+
 /*!
  *  This method will divide numElements across numThreads, associating with
  *  each thread a range of elements to work on as well as an atomic counter
@@ -159,63 +316,22 @@ private:
  *  \param numElements Number of elements of work
  *  \param numThreads Number of threads
  *  \param op Functor to use
+ *  \param grainSize Number of elements a thread claims at a time; 1 gives
+ *  the finest balance, for ops whose cost varies a lot.  0 (the default)
+ *  uses getWorkSharingGrainSize().
  */
 template <typename OpT>
 void runWorkSharingBalanced1D(size_t numElements,
                               size_t numThreads,
-                              const OpT& op)
+                              const OpT& op,
+                              size_t grainSize = 0)
 {
-    std::vector<size_t> threadPoolEndElements;
-    SharedAtomicCounterVec threadPoolCounters;
-    if (numThreads <= 1)
-    {
-        threadPoolEndElements.push_back(numElements);
-
-        threadPoolCounters.push_back(
-                std::shared_ptr<sys::AtomicCounter>(
-                        new sys::AtomicCounter(0)));
-
-        const types::Range range(0, numElements);
-        WorkSharingBalancedRunnable1D<OpT>(range,
-                                           *threadPoolCounters[0],
-                                           threadPoolCounters,
-                                           threadPoolEndElements,
-                                           op).run();
-    }
-    else
-    {
-        size_t threadNum = 0;
-        size_t startElement = 0;
-        size_t numElementsThisThread = 0;
-        const ThreadPlanner planner(numElements, numThreads);
-        std::vector<types::Range> threadPoolRange;
-        while (planner.getThreadInfo(
-                threadNum++, startElement, numElementsThisThread))
-        {
-            const types::Range range(startElement, numElementsThisThread);
-            threadPoolRange.push_back(range);
-
-            threadPoolCounters.push_back(
-                    std::shared_ptr<sys::AtomicCounter>(
-                            new sys::AtomicCounter(static_cast<sys::AtomicCounter::ValueType>(startElement))));
-
-            threadPoolEndElements.push_back(
-                    startElement + numElementsThisThread);
-        }
-
-        ThreadGroup threads;
-        for (size_t ii = 0; ii < threadPoolRange.size(); ++ii)
-        {
-            threads.createThread(
-                    new WorkSharingBalancedRunnable1D<OpT>(
-                            threadPoolRange[ii],
-                            *threadPoolCounters[ii],
-                            threadPoolCounters,
-                            threadPoolEndElements,
-                            op));
-        }
-        threads.joinAll();
-    }
+    detail::runWorkSharingBalanced1D(numElements, numThreads,
+                                     [&op](size_t) -> const OpT&
+                                     {
+                                         return op;
+                                     },
+                                     grainSize);
 }
 
 /*!
@@ -227,11 +343,13 @@ void runWorkSharingBalanced1D(size_t numElements,
  *  \param numElements Number of elements of work
  *  \param numThreads Number of threads
  *  \param ops Vector of functors to use
+ *  \param grainSize Number of elements a thread claims at a time
  */
 template <typename OpT>
 void runWorkSharingBalanced1D(size_t numElements,
                               size_t numThreads,
-                              const std::vector<OpT>& ops)
+                              const std::vector<OpT>& ops,
+                              size_t grainSize = 0)
 {
     if (ops.size() != numThreads)
     {
@@ -241,52 +359,12 @@ void runWorkSharingBalanced1D(size_t numElements,
         throw except::Exception(Ctxt(ostr.str()));
     }
 
-    std::vector<size_t> threadPoolEndElements;
-    SharedAtomicCounterVec threadPoolCounters;
-    if (numThreads <= 1)
-    {
-        threadPoolEndElements.push_back(numElements);
-
-        threadPoolCounters.push_back(std::make_shared<sys::AtomicCounter>(0));
-
-        const types::Range range(0, numElements);
-        WorkSharingBalancedRunnable1D<OpT>(range,
-                                           *threadPoolCounters[0],
-                                           threadPoolCounters,
-                                           threadPoolEndElements,
-                                           ops[0]).run();
-    }
-    else
-    {
-        size_t threadNum = 0;
-        size_t startElement = 0;
-        size_t numElementsThisThread = 0;
-        const ThreadPlanner planner(numElements, numThreads);
-        std::vector<types::Range> threadPoolRange;
-        while (planner.getThreadInfo(
-                  threadNum++, startElement, numElementsThisThread))
-        {
-              const types::Range range(startElement, numElementsThisThread);
-              threadPoolRange.push_back(range);
-
-              auto counter = std::make_shared<sys::AtomicCounter>(gsl::narrow<sys::AtomicCounter::ValueType>(startElement));
-              threadPoolCounters.push_back(counter);
-              threadPoolEndElements.push_back(startElement + numElementsThisThread);
-        }
-
-        ThreadGroup threads;
-        for (size_t ii = 0; ii < threadPoolRange.size(); ++ii)
-        {
-            threads.createThread(
-                    new WorkSharingBalancedRunnable1D<OpT>(
-                            threadPoolRange[ii],
-                            *threadPoolCounters[ii],
-                            threadPoolCounters,
-                            threadPoolEndElements,
-                            ops[ii]));
-        }
-        threads.joinAll();
-    }
+    detail::runWorkSharingBalanced1D(numElements, numThreads,
+                                     [&ops](size_t ii) -> const OpT&
+                                     {
+                                         return ops[ii];
+                                     },
+                                     grainSize);
 }
 
 /*!
@@ -299,14 +377,16 @@ void runWorkSharingBalanced1D(size_t numElements,
  *  \param numElements Number of elements of work
  *  \param numThreads Number of threads
  *  \param op Functor to use
+ *  \param grainSize Number of elements a thread claims at a time
  */
 template <typename OpT>
 void runWorkSharingBalanced1DWithCopies(size_t numElements,
                                         size_t numThreads,
-                                        const OpT& op)
+                                        const OpT& op,
+                                        size_t grainSize = 0)
 {
     const std::vector<OpT> ops(numThreads, op);
-    runWorkSharingBalanced1D(numElements, numThreads, ops);
+    runWorkSharingBalanced1D(numElements, numThreads, ops, grainSize);
 }
 }
 
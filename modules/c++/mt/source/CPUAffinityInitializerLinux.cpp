@@ -47,6 +47,43 @@ std::vector<int> mergeAvailableCPUs()
     mergedCPUs.insert(mergedCPUs.end(), htCPUs.begin(), htCPUs.end());
     return mergedCPUs;
 }
+
+std::vector<int> orderNUMACPUs(
+        mt::CPUAffinityInitializerLinux::NUMAPlacement placement)
+{
+    std::vector<std::vector<int> > nodeCPUs;
+    sys::OS().getAvailableCPUsByNUMANode(nodeCPUs);
+
+    std::vector<int> orderedCPUs;
+    if (placement == mt::CPUAffinityInitializerLinux::NUMA_COMPACT)
+    {
+        for (const auto& cpus : nodeCPUs)
+        {
+            orderedCPUs.insert(orderedCPUs.end(), cpus.begin(), cpus.end());
+        }
+    }
+    else
+    {
+        // Deal the nodes' CPUs out like cards until every node runs dry
+        for (size_t cpuIndex = 0; ; ++cpuIndex)
+        {
+            bool foundCPU = false;
+            for (const auto& cpus : nodeCPUs)
+            {
+                if (cpuIndex < cpus.size())
+                {
+                    orderedCPUs.push_back(cpus[cpuIndex]);
+                    foundCPU = true;
+                }
+            }
+            if (!foundCPU)
+            {
+                break;
+            }
+        }
+    }
+    return orderedCPUs;
+}
 }
 
 namespace mt
@@ -54,8 +91,8 @@ namespace mt
 class AvailableCPUProvider : public AbstractNextCPUProviderLinux
 {
 public:
-    AvailableCPUProvider() :
-        mCPUs(mergeAvailableCPUs()),
+    AvailableCPUProvider(const std::vector<int>& cpus) :
+        mCPUs(cpus),
         mNextCPUIndex(0)
     {
     }
@@ -99,7 +136,7 @@ private:
 };
 
 CPUAffinityInitializerLinux::CPUAffinityInitializerLinux() :
-    mCPUProvider(new AvailableCPUProvider())
+    mCPUProvider(new AvailableCPUProvider(mergeAvailableCPUs()))
 {
 }
 
@@ -107,6 +144,18 @@ CPUAffinityInitializerLinux::CPUAffinityInitializerLinux(int initialOffset) :
     mCPUProvider(new OffsetCPUProvider(initialOffset))
 {
 }
+
+CPUAffinityInitializerLinux::CPUAffinityInitializerLinux(
+        NUMAPlacement placement) :
+    mCPUProvider(new AvailableCPUProvider(orderNUMACPUs(placement)))
+{
+}
+
+CPUAffinityInitializerLinux::CPUAffinityInitializerLinux(
+        const std::vector<int>& cpus) :
+    mCPUProvider(new AvailableCPUProvider(cpus))
+{
+}
 }
 
 #endif
@@ -39,6 +39,13 @@ ThreadGroup::ThreadGroup(bool pinToCPU) :
 {
 }
 
+ThreadGroup::ThreadGroup(
+        std::unique_ptr<CPUAffinityInitializer>&& affinityInit) :
+    mAffinityInit(std::move(affinityInit)),
+    mLastJoined(0)
+{
+}
+
 ThreadGroup::~ThreadGroup()
 {
     try
@@ -0,0 +1,108 @@
+/* =========================================================================
+ * This file is part of mt-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mt-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/except.h>
+#include <import/mt.h>
+
+/*
+ * Runs mt::runWorkSharingBalanced1D over <numElements> elements on 1, 2,
+ * 4, ... 64 threads, with a light op (one add per element) and a heavy one
+ * whose cost grows along the range, claiming one element at a time and
+ * with the default grain size.
+ */
+
+namespace
+{
+double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename OpT>
+void time(const std::string& label, size_t numElements, size_t numThreads,
+          size_t grainSize, const OpT& op)
+{
+    const auto start = std::chrono::steady_clock::now();
+    mt::runWorkSharingBalanced1D(numElements, numThreads, op, grainSize);
+    const double seconds = secondsSince(start);
+    std::cout << "    " << label << ": " << seconds << " s, "
+              << numElements / (seconds * 1e6) << " M elements/s\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                  << " <numElements>\n";
+        return 1;
+    }
+
+    try
+    {
+        const size_t numElements = static_cast<size_t>(atol(argv[1]));
+        std::vector<double> values(numElements, 1.0);
+
+        const auto light = [&values](size_t element)
+        {
+            values[element] += 1.0;
+        };
+
+        // Later elements cost more, so an even split leaves the last
+        // threads with most of the work
+        const auto heavy = [&values, numElements](size_t element)
+        {
+            const size_t numIterations = 1 + 256 * element / numElements;
+            double value = values[element];
+            for (size_t ii = 0; ii < numIterations; ++ii)
+            {
+                value = value * 0.999 + 0.5;
+            }
+            values[element] = value;
+        };
+
+        for (size_t numThreads = 1; numThreads <= 64; numThreads *= 2)
+        {
+            std::cout << numThreads << " threads\n";
+            time("Light, grain 1", numElements, numThreads, 1, light);
+            time("Light, default grain", numElements, numThreads, 0, light);
+            time("Heavy, grain 1", numElements, numThreads, 1, heavy);
+            time("Heavy, default grain", numElements, numThreads, 0, heavy);
+        }
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,250 @@
+/* =========================================================================
+ * This file is part of mt-c++ 
+ * =========================================================================
+ * 
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * mt-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "import/mt.h"
+#include "TestCase.h"
+
+namespace
+{
+std::vector<double> makeValues(size_t numValues)
+{
+    // Values of wildly different magnitudes, so that regrouping a sum
+    // changes how it rounds
+    std::vector<double> values(numValues);
+    for (size_t ii = 0; ii < numValues; ++ii)
+    {
+        values[ii] = (ii % 7 == 0 ? 1.0e10 : 0.1) * ((ii % 3) ? 1.0 : -1.0) +
+                static_cast<double>(ii) / 3.0;
+    }
+    return values;
+}
+}
+
+TEST_CASE(ReduceTest)
+{
+    std::vector<int> values(10001);
+    std::iota(values.begin(), values.end(), 0);
+    const int expected = std::accumulate(values.begin(), values.end(), 5);
+    const int expectedMax = 10000;
+
+    for (unsigned short numThreads = 1; numThreads <= 8; numThreads *= 2)
+    {
+        mt::GenerationThreadPool pool(numThreads);
+        pool.start();
+        TEST_ASSERT_EQ(mt::reduce(pool, values.begin(), values.end(), 5),
+                       expected);
+        TEST_ASSERT_EQ(mt::reduce(pool, values.begin(), values.end(), 5,
+                                  mt::Combine::Deterministic),
+                       expected);
+        TEST_ASSERT_EQ(mt::reduce(pool, values.begin(), values.end(), -1,
+                                  [](int lhs, int rhs)
+                                  {
+                                      return std::max(lhs, rhs);
+                                  }),
+                       expectedMax);
+        TEST_ASSERT_EQ(mt::reduce(pool, values.begin(), values.begin(), 5),
+                       5);
+    }
+}
+
+TEST_CASE(TransformReduceTest)
+{
+    const std::vector<int> values(1000, 3);
+    mt::GenerationThreadPool pool(4);
+    pool.start();
+    const long long sumOfSquares = mt::transform_reduce(
+            pool, values.begin(), values.end(), 0LL,
+            [](long long lhs, long long rhs) { return lhs + rhs; },
+            [](int value) { return static_cast<long long>(value) * value; });
+    TEST_ASSERT_EQ(sumOfSquares, 9000LL);
+}
+
+TEST_CASE(MixedTypeReduceTest)
+{
+    // Each chunk is summed in the type of init, not of the elements
+    const std::vector<unsigned char> bytes(1000, 200);
+    const float value = 1.0f + std::numeric_limits<float>::epsilon();
+    const std::vector<float> floats(100000, value);
+    double expected = 0.0;
+    for (size_t ii = 0; ii < floats.size(); ++ii)
+    {
+        expected += value; // exact in a double
+    }
+
+    for (unsigned short numThreads = 1; numThreads <= 8; numThreads *= 2)
+    {
+        mt::GenerationThreadPool pool(numThreads);
+        pool.start();
+        TEST_ASSERT_EQ(mt::reduce(pool, bytes.begin(), bytes.end(), size_t(0)),
+                       static_cast<size_t>(200000));
+        TEST_ASSERT_EQ(mt::reduce(pool, bytes.begin(), bytes.end(), size_t(0),
+                                  mt::Combine::Deterministic),
+                       static_cast<size_t>(200000));
+        TEST_ASSERT_TRUE(mt::reduce(pool, floats.begin(), floats.end(), 0.0) ==
+                         expected);
+        TEST_ASSERT_TRUE(mt::reduce(pool, floats.begin(), floats.end(), 0.0,
+                                    mt::Combine::Deterministic) == expected);
+        TEST_ASSERT_EQ(mt::transform_reduce(
+                               pool, bytes.begin(), bytes.end(), 0,
+                               [](int lhs, int rhs) { return lhs + rhs; },
+                               [](unsigned char byte) { return byte; }),
+                       200000);
+    }
+}
+
+TEST_CASE(DeterministicReduceTest)
+{
+    const std::vector<double> values(makeValues(100003));
+
+    double expected = 0.0;
+    for (unsigned short numThreads = 1; numThreads <= 8; ++numThreads)
+    {
+        mt::GenerationThreadPool pool(numThreads);
+        pool.start();
+        const double sum = mt::reduce(pool, values.begin(), values.end(), 0.0,
+                                      mt::Combine::Deterministic);
+        if (numThreads == 1)
+        {
+            expected = sum;
+        }
+        // Bitwise, not just close
+        TEST_ASSERT_TRUE(sum == expected);
+    }
+}
+
+TEST_CASE(InclusiveScanTest)
+{
+    std::vector<long long> values(20011);
+    std::iota(values.begin(), values.end(), 1);
+    std::vector<long long> expected(values.size());
+    std::partial_sum(values.begin(), values.end(), expected.begin());
+
+    for (unsigned short numThreads = 1; numThreads <= 8; numThreads *= 2)
+    {
+        mt::GenerationThreadPool pool(numThreads);
+        pool.start();
+        for (const auto combine :
+             { mt::Combine::ByThread, mt::Combine::Deterministic })
+        {
+            std::vector<long long> result(values.size(), 0);
+            const auto end = mt::inclusive_scan(
+                    pool, values.begin(), values.end(), result.begin(),
+                    combine);
+            TEST_ASSERT_TRUE(end == result.end());
+            TEST_ASSERT_TRUE(result == expected);
+        }
+
+        // In place
+        std::vector<long long> inPlace(values);
+        mt::inclusive_scan(pool, inPlace.begin(), inPlace.end(),
+                           inPlace.begin());
+        TEST_ASSERT_TRUE(inPlace == expected);
+    }
+}
+
+TEST_CASE(DeterministicScanTest)
+{
+    const std::vector<double> values(makeValues(50000));
+
+    std::vector<double> expected;
+    for (unsigned short numThreads = 1; numThreads <= 6; ++numThreads)
+    {
+        mt::GenerationThreadPool pool(numThreads);
+        pool.start();
+        std::vector<double> result(values.size());
+        mt::inclusive_scan(pool, values.begin(), values.end(), result.begin(),
+                           mt::Combine::Deterministic);
+        if (numThreads == 1)
+        {
+            expected = result;
+        }
+        TEST_ASSERT_TRUE(result == expected);
+    }
+}
+
+TEST_CASE(HistogramTest)
+{
+    std::vector<unsigned char> values(100000);
+    for (size_t ii = 0; ii < values.size(); ++ii)
+    {
+        values[ii] = static_cast<unsigned char>(ii * 7);
+    }
+    std::vector<size_t> expected(16, 0);
+    for (const auto value : values)
+    {
+        if (value < 240)
+        {
+            ++expected[value / 15];
+        }
+    }
+
+    for (unsigned short numThreads = 1; numThreads <= 8; numThreads *= 2)
+    {
+        mt::GenerationThreadPool pool(numThreads);
+        pool.start();
+        // Values of 240 and up go to bin 16, which isn't counted
+        const std::vector<size_t> counts = mt::histogram(
+                pool, values.begin(), values.end(), 16,
+                [](unsigned char value) { return value / 15; });
+        TEST_ASSERT_TRUE(counts == expected);
+    }
+}
+
+TEST_CASE(ReduceExceptionTest)
+{
+    const std::vector<int> values(1000, 1);
+    mt::GenerationThreadPool pool(4);
+    pool.start();
+    bool threw = false;
+    try
+    {
+        mt::transform_reduce(pool, values.begin(), values.end(), 0,
+                             [](int lhs, int rhs) { return lhs + rhs; },
+                             [](int value) -> int
+                             {
+                                 throw except::Exception(Ctxt("Bad value"));
+                             });
+    }
+    catch (const except::Exception&)
+    {
+        threw = true;
+    }
+    TEST_ASSERT_TRUE(threw);
+
+    // The pool is still usable afterwards
+    TEST_ASSERT_EQ(mt::reduce(pool, values.begin(), values.end(), 0), 1000);
+}
+
+TEST_MAIN(
+    TEST_CHECK(ReduceTest);
+    TEST_CHECK(TransformReduceTest);
+    TEST_CHECK(MixedTypeReduceTest);
+    TEST_CHECK(DeterministicReduceTest);
+    TEST_CHECK(InclusiveScanTest);
+    TEST_CHECK(DeterministicScanTest);
+    TEST_CHECK(HistogramTest);
+    TEST_CHECK(ReduceExceptionTest);
+    )
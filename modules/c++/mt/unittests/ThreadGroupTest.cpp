@@ -24,6 +24,41 @@
 #include "import/mt.h"
 #include "TestCase.h"
 
+#if !defined(__APPLE_CC__) && (defined(__linux) || defined(__linux__))
+#include <sched.h>
+
+#include <algorithm>
+#include <vector>
+
+// Records the CPU it ran on and the CPUs it was allowed to run on
+struct WhereAmITask final : public sys::Runnable
+{
+    int* cpu;
+    std::vector<int>* allowed;
+
+    WhereAmITask(int* cpu_, std::vector<int>* allowed_) :
+        cpu(cpu_), allowed(allowed_)
+    {
+    }
+
+    virtual void run()
+    {
+        *cpu = ::sched_getcpu();
+
+        cpu_set_t mask;
+        CPU_ZERO(&mask);
+        if (::sched_getaffinity(0, sizeof(mask), &mask) == 0)
+        {
+            for (int ii = 0; ii < CPU_SETSIZE; ++ii)
+            {
+                if (CPU_ISSET(ii, &mask))
+                    allowed->push_back(ii);
+            }
+        }
+    }
+};
+#endif
+
 struct MyRunTask final : public sys::Runnable
 {
     int result;
@@ -101,7 +136,73 @@ TEST_CASE(PinToCPUTest)
     TEST_ASSERT_EQ(threads3.isPinToCPUEnabled(), false);
 }
 
+TEST_CASE(NUMAPinToCPUTest)
+{
+#if !defined(__APPLE_CC__) && (defined(__linux) || defined(__linux__))
+    std::vector<std::vector<int> > nodeCPUs;
+    sys::OS().getAvailableCPUsByNUMANode(nodeCPUs);
+    TEST_ASSERT_FALSE(nodeCPUs.empty());
+
+    size_t numCPUs = 0;
+    for (const auto& cpus : nodeCPUs)
+    {
+        TEST_ASSERT_FALSE(cpus.empty());
+        numCPUs += cpus.size();
+    }
+    TEST_ASSERT_EQ(numCPUs, sys::OS().getNumCPUsAvailable());
+
+    // Thread i lands on node i % numNodes while every node has CPUs left,
+    // so the first thread on each node is placed that way
+    mt::ThreadGroup threads(std::unique_ptr<mt::CPUAffinityInitializer>(
+            new mt::CPUAffinityInitializer(
+                    mt::CPUAffinityInitializer::NUMA_SPREAD)));
+    TEST_ASSERT_TRUE(threads.isPinToCPUEnabled());
+    std::vector<int> cpus(nodeCPUs.size(), -1);
+    std::vector<std::vector<int> > allowed(nodeCPUs.size());
+    for (size_t ii = 0; ii < nodeCPUs.size(); ++ii)
+    {
+        threads.createThread(new WhereAmITask(&cpus[ii], &allowed[ii]));
+    }
+    threads.joinAll();
+
+    for (size_t ii = 0; ii < nodeCPUs.size(); ++ii)
+    {
+        // Pinned to exactly one CPU on its node, and ran there
+        TEST_ASSERT_EQ(allowed[ii].size(), static_cast<size_t>(1));
+        TEST_ASSERT_TRUE(std::find(nodeCPUs[ii].begin(), nodeCPUs[ii].end(),
+                                   allowed[ii][0]) != nodeCPUs[ii].end());
+        TEST_ASSERT_EQ(cpus[ii], allowed[ii][0]);
+    }
+
+    mt::ThreadGroup unpinned(std::unique_ptr<mt::CPUAffinityInitializer>{});
+    TEST_ASSERT_FALSE(unpinned.isPinToCPUEnabled());
+#endif
+}
+
+TEST_CASE(FirstTouchTest)
+{
+    const size_t numElements = 12345;
+    for (size_t numThreads = 1; numThreads <= 8; numThreads *= 2)
+    {
+        std::vector<double> buffer(numElements, 0.0);
+        mt::firstTouch(buffer.data(), numElements, numThreads, 1.5);
+        for (const auto& value : buffer)
+        {
+            TEST_ASSERT_EQ(value, 1.5);
+        }
+    }
+
+    std::vector<int> buffer(100, 7);
+    mt::firstTouch(buffer.data(), buffer.size(), 3);
+    for (const auto& value : buffer)
+    {
+        TEST_ASSERT_EQ(value, 0);
+    }
+}
+
 TEST_MAIN(
     TEST_CHECK(DoThreadGroupTest);
     TEST_CHECK(PinToCPUTest);
+    TEST_CHECK(NUMAPinToCPUTest);
+    TEST_CHECK(FirstTouchTest);
     )
@@ -82,7 +82,82 @@ TEST_CASE(WorkSharingBalancedRunnable1DTestWorkDoneLessWorkThanThreads)
     }
 }
 
+TEST_CASE(WorkSharingBalancedRunnable1DTestGrainSizes)
+{
+    const size_t numElements = 10007;
+    const size_t numThreads = 5;
+    const size_t grainSizes[] = {1, 7, 64, 3000, numElements * 2};
+    for (const auto grainSize : grainSizes)
+    {
+        std::vector<size_t> workVec(numElements, 0);
+        IncOp op(workVec);
+
+        mt::runWorkSharingBalanced1D(numElements, numThreads, op, grainSize);
+
+        for (const auto& value : workVec)
+        {
+            TEST_ASSERT_EQ(value, static_cast<size_t>(1));
+        }
+    }
+}
+
+TEST_CASE(WorkSharingBalancedRunnable1DTestUnevenWork)
+{
+    // All the cost is in the first thread's range, so the rest of the
+    // threads have to take it from there
+    const size_t numElements = 4000;
+    const size_t numThreads = 4;
+    std::vector<size_t> workVec(numElements, 0);
+    const auto op = [&workVec](size_t index)
+    {
+        if (index < 1000)
+        {
+            volatile size_t sum = 0;
+            for (size_t ii = 0; ii < 2000; ++ii)
+            {
+                sum = sum + ii;
+            }
+        }
+        workVec[index]++;
+    };
+
+    mt::runWorkSharingBalanced1D(numElements, numThreads, op, 1);
+
+    for (const auto& value : workVec)
+    {
+        TEST_ASSERT_EQ(value, static_cast<size_t>(1));
+    }
+}
+
+TEST_CASE(WorkSharingCountersClaim)
+{
+    const std::vector<types::Range> ranges = {types::Range(0, 10),
+                                              types::Range(10, 25)};
+    mt::WorkSharingCounters counters(ranges);
+    TEST_ASSERT_EQ(counters.size(), static_cast<size_t>(2));
+    TEST_ASSERT_EQ(counters.findMostLoaded(), static_cast<size_t>(1));
+
+    size_t begin = 0;
+    size_t end = 0;
+    TEST_ASSERT_TRUE(counters.claim(0, 4, begin, end));
+    TEST_ASSERT_EQ(begin, static_cast<size_t>(0));
+    TEST_ASSERT_EQ(end, static_cast<size_t>(4));
+    TEST_ASSERT_TRUE(counters.claim(0, 4, begin, end));
+    TEST_ASSERT_TRUE(counters.claim(0, 4, begin, end));
+    TEST_ASSERT_EQ(begin, static_cast<size_t>(8));
+    TEST_ASSERT_EQ(end, static_cast<size_t>(10));
+    TEST_ASSERT_FALSE(counters.claim(0, 4, begin, end));
+
+    TEST_ASSERT_TRUE(counters.claim(1, 25, begin, end));
+    TEST_ASSERT_EQ(begin, static_cast<size_t>(10));
+    TEST_ASSERT_EQ(end, static_cast<size_t>(35));
+    TEST_ASSERT_EQ(counters.findMostLoaded(), counters.size());
+}
+
 TEST_MAIN(
     TEST_CHECK(WorkSharingBalancedRunnable1DTestWorkDone);
     TEST_CHECK(WorkSharingBalancedRunnable1DTestWorkDoneLessWorkThanThreads);
+    TEST_CHECK(WorkSharingBalancedRunnable1DTestGrainSizes);
+    TEST_CHECK(WorkSharingBalancedRunnable1DTestUnevenWork);
+    TEST_CHECK(WorkSharingCountersClaim);
 )
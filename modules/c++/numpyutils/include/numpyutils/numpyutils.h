@@ -31,9 +31,15 @@ CODA_OSS_disable_warning_system_header_push
 #include <numpy/arrayobject.h>
 CODA_OSS_disable_warning_pop
 
-#include <types/RowCol.h>
+#include <memory>
+#include <type_traits>
 #include <vector>
 
+#include <coda_oss/span.h>
+#include <mem/ScopedAlignedArray.h>
+#include <sys/Conf.h>
+#include <types/RowCol.h>
+
 namespace numpyutils
 {
 
@@ -91,6 +97,30 @@ void verifyObjectsAreOfSameDimensions(PyObject* lhs, PyObject* rhs);
  */
 void createOrVerify(PyObject*& pyObject, int typeNum, const types::RowCol<size_t>& dims);
 
+/*!
+ * Like the above, but for an array of any number of dimensions that's also
+ * checked to be C-contiguous and writeable, so that it can be filled
+ * through getBuffer().
+ * \param pyObject None or array to verify
+ * \param typeNum desired type number
+ * \param numDims desired number of dimensions
+ * \param dims desired dimensions of array
+ * \throws except::Exception if pyObject is not None and doesn't match
+ *              specified parameters
+ */
+void createOrVerify(PyObject*& pyObject, int typeNum,
+                    int numDims, const npy_intp* dims);
+
+/*!
+ * Converts any array or sequence to a C-contiguous, aligned array of the
+ * requested type, only copying if it isn't one already.
+ * \param pyObject object to convert
+ * \param typeNum desired type number
+ * \returns a new reference to the array
+ * \throws except::Exception if pyObject can't be converted
+ */
+PyObject* toContiguousArray(PyObject* pyObject, int typeNum);
+
 /*!
  * Verifies Array Type and TypeNum for input and output.  If output
  * array is Py_None, constructs a new PyArray of the desired specifications
@@ -183,6 +213,122 @@ T* getBuffer(PyObject* pyObject)
  */
 void verifyNewPyObject(PyObject* object);
 
+namespace details
+{
+/*
+ * Wraps numBytes at 'data' in a new C-contiguous array whose base object is
+ * 'owner', stealing that reference (so dropping the owner if this throws)
+ */
+PyObject* wrapInNumpyArray(int numDims, const npy_intp* dims, int typenum,
+                           const void* data, size_t numBytes, bool writeable,
+                           PyObject* owner);
+
+template <typename OwnerT>
+void deleteCapsuleOwner(PyObject* capsule)
+{
+    delete static_cast<OwnerT*>(PyCapsule_GetPointer(capsule, nullptr));
+}
+
+template <typename OwnerT, typename T>
+PyObject* adoptAsNumpyArray(std::unique_ptr<OwnerT> owner,
+                            T* data, size_t numElements,
+                            int numDims, const npy_intp* dims, int typenum)
+{
+    PyObject* const capsule = PyCapsule_New(owner.get(), nullptr,
+                                            &deleteCapsuleOwner<OwnerT>);
+    verifyNewPyObject(capsule);
+    owner.release();
+    return wrapInNumpyArray(numDims, dims, typenum, data,
+                            numElements * sizeof(T),
+                            !std::is_const<T>::value, capsule);
+}
+
+struct AlignedFree
+{
+    void operator()(const void* p) const
+    {
+        sys::alignedFree(const_cast<void*>(p));
+    }
+};
+}
+
+/*!
+ * Hand a buffer to NumPy without copying it.  The array takes ownership of
+ * the buffer through a capsule set as its base object, so the buffer is
+ * freed once the array and every view of it are gone, and not before.
+ *
+ * If this throws, the buffer has already been freed.
+ *
+ * \param data the buffer to give up; left empty
+ * \param numDims number of dimensions of the array
+ * \param dims dimensions of the array.  Must fit in the buffer.
+ * \param typenum value of desired datatype
+ * \return a new C-contiguous numpy array
+ */
+template <typename T>
+PyObject* toNumpyArray(std::vector<T>&& data,
+                       int numDims, const npy_intp* dims, int typenum)
+{
+    T* const buffer = data.data();
+    const size_t numElements = data.size();
+    std::unique_ptr<std::vector<T> > owner(new std::vector<T>(std::move(data)));
+    return details::adoptAsNumpyArray(std::move(owner), buffer, numElements,
+                                      numDims, dims, typenum);
+}
+
+/*!
+ * Same as above for an array allocated with new[].  If T is const, the
+ * array is read-only.
+ * \param numElements number of elements in 'data'
+ */
+template <typename T>
+PyObject* toNumpyArray(std::unique_ptr<T[]>&& data, size_t numElements,
+                       int numDims, const npy_intp* dims, int typenum)
+{
+    T* const buffer = data.get();
+    std::unique_ptr<std::unique_ptr<T[]> > owner(
+            new std::unique_ptr<T[]>(std::move(data)));
+    return details::adoptAsNumpyArray(std::move(owner), buffer, numElements,
+                                      numDims, dims, typenum);
+}
+
+/*!
+ * Same as above for an array from sys::alignedAlloc(), which 'data'
+ * releases.
+ */
+template <typename T>
+PyObject* toNumpyArray(mem::ScopedAlignedArray<T>& data, size_t numElements,
+                       int numDims, const npy_intp* dims, int typenum)
+{
+    typedef std::unique_ptr<T, details::AlignedFree> Owner;
+    std::unique_ptr<Owner> owner(new Owner(data.release()));
+    T* const buffer = owner->get();
+    return details::adoptAsNumpyArray(std::move(owner), buffer, numElements,
+                                      numDims, dims, typenum);
+}
+
+/*!
+ * Wrap memory that some Python object owns (e.g. a SWIG-wrapped C++ object
+ * or another array) without copying it.  'base' becomes the array's base
+ * object, so it's kept alive as long as the array is.  If T is const, the
+ * array is read-only.
+ * \param data the memory to wrap
+ * \param numDims number of dimensions of the array
+ * \param dims dimensions of the array.  Must fit in 'data'.
+ * \param typenum value of desired datatype
+ * \param base the object that owns 'data'
+ * \return a new C-contiguous numpy array
+ */
+template <typename T>
+PyObject* toNumpyArrayView(coda_oss::span<T> data,
+                           int numDims, const npy_intp* dims, int typenum,
+                           PyObject* base)
+{
+    Py_INCREF(base);
+    return details::wrapInNumpyArray(numDims, dims, typenum, data.data(),
+                                     data.size() * sizeof(T),
+                                     !std::is_const<T>::value, base);
+}
 }
 
 #endif
@@ -20,6 +20,8 @@
  *
  */
 
+#include <string.h>
+
 #include <numpyutils/numpyutils.h>
 #include <except/Exception.h>
 #include <sys/Conf.h>
@@ -160,6 +162,48 @@ void createOrVerify(PyObject*& pyObject,
     }
 }
 
+void createOrVerify(PyObject*& pyObject,
+                    int typeNum,
+                    int numDims,
+                    const npy_intp* dims)
+{
+    if (pyObject == Py_None) // none passed in-- so create new
+    {
+        pyObject = PyArray_SimpleNew(numDims, const_cast<npy_intp*>(dims),
+                                     typeNum);
+        verifyNewPyObject(pyObject);
+        return;
+    }
+
+    verifyArrayType(pyObject, typeNum);
+    PyArrayObject* const array = reinterpret_cast<PyArrayObject*>(pyObject);
+    if (!PyArray_IS_C_CONTIGUOUS(array) || !PyArray_ISWRITEABLE(array))
+    {
+        throw except::Exception(Ctxt(
+                "Desired array must be C-contiguous and writeable"));
+    }
+    if (PyArray_NDIM(array) != numDims ||
+        !PyArray_CompareLists(PyArray_DIMS(array),
+                              const_cast<npy_intp*>(dims), numDims))
+    {
+        throw except::Exception(Ctxt(
+                "Desired array does not match required dimensions"));
+    }
+}
+
+PyObject* toContiguousArray(PyObject* pyObject, int typeNum)
+{
+    PyObject* const array =
+            PyArray_FROM_OTF(pyObject, typeNum, NPY_ARRAY_IN_ARRAY);
+    if (!array)
+    {
+        // NumPy's error is left set to say why
+        throw except::Exception(Ctxt(
+                "Object can't be converted to a numpy array"));
+    }
+    return array;
+}
+
 PyObject* toNumpyArray(size_t numRows, size_t numColumns,
         int typenum, const void* data)
 {
@@ -175,20 +219,16 @@ PyObject* toNumpyArray(size_t numRows, size_t numColumns,
         dimensions[1] = numColumns;
     }
 
-    // PyArray_SimpleNewFromData takes a void* for the buffer it's wrapping.
-    // The buffer is non-const, and this makes sense because we're wrapping it
-    // in a numpy array which anyone else would be free to modify.
-    //
-    // Since the function shouldn't be modifying the data itself, we're casting
-    // away the const in order to get the intermediate array object.  We then
-    // immediately copy and return, so nothing is actually getting modified
-    PyObject* wrappedArray =
-            PyArray_SimpleNewFromData(nDims, dimensions, typenum,
-                                      const_cast<void*>(data));
-    PyObject* copy = PyArray_NewCopy(reinterpret_cast<PyArrayObject*>(wrappedArray),
-            NPY_CORDER);
-    verifyNewPyObject(copy);
-    return copy;
+    // Allocated and filled in one go, rather than wrapping 'data' and
+    // copying that
+    PyObject* const array = PyArray_SimpleNew(nDims, dimensions, typenum);
+    verifyNewPyObject(array);
+    PyArrayObject* const pyArray = reinterpret_cast<PyArrayObject*>(array);
+    if (PyArray_NBYTES(pyArray) > 0)
+    {
+        memcpy(PyArray_DATA(pyArray), data, PyArray_NBYTES(pyArray));
+    }
+    return array;
 }
 
 PyObject* toNumpyArray(size_t numColumns, int typenum,
@@ -243,6 +283,43 @@ char* getDataBuffer(PyArrayObject* pyInObject)
    return PyArray_BYTES(pyInObject);
 }
 
+PyObject* details::wrapInNumpyArray(int numDims,
+                                    const npy_intp* dims,
+                                    int typenum,
+                                    const void* data,
+                                    size_t numBytes,
+                                    bool writeable,
+                                    PyObject* owner)
+{
+    PyObject* const array = PyArray_New(
+            &PyArray_Type, numDims, const_cast<npy_intp*>(dims), typenum,
+            nullptr, const_cast<void*>(data), 0,
+            writeable ? NPY_ARRAY_CARRAY : NPY_ARRAY_CARRAY_RO, nullptr);
+    if (!array)
+    {
+        Py_DECREF(owner);
+        verifyNewPyObject(array);
+    }
+
+    PyArrayObject* const pyArray = reinterpret_cast<PyArrayObject*>(array);
+    if (static_cast<size_t>(PyArray_NBYTES(pyArray)) > numBytes)
+    {
+        Py_DECREF(array);
+        Py_DECREF(owner);
+        throw except::Exception(Ctxt(
+                "Array dimensions don't fit in the buffer"));
+    }
+
+    // This steals 'owner' even if it fails
+    if (PyArray_SetBaseObject(pyArray, owner) < 0)
+    {
+        Py_DECREF(array);
+        PyErr_Print();
+        throw except::Exception(Ctxt("Couldn't set the array's base object"));
+    }
+    return array;
+}
+
 void verifyNewPyObject(PyObject* object)
 {
     if (!object)
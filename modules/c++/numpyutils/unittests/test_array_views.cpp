@@ -0,0 +1,140 @@
+/* =========================================================================
+ * This file is part of numpyutils-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * numpyutils-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <complex>
+#include <memory>
+#include <vector>
+
+#include <TestCase.h>
+#include <config/compiler_extensions.h>
+#include <numpyutils/numpyutils.h>
+
+namespace
+{
+// NOTE: These run standalone, outside of any Python extension, and only
+// check what the arrays point at.  See test_num_elements.cpp.
+
+const void* getData(PyObject* array)
+{
+    return PyArray_DATA(reinterpret_cast<PyArrayObject*>(array));
+}
+
+bool isWriteable(PyObject* array)
+{
+    return PyArray_ISWRITEABLE(reinterpret_cast<PyArrayObject*>(array));
+}
+
+PyObject* getBase(PyObject* array)
+{
+    return PyArray_BASE(reinterpret_cast<PyArrayObject*>(array));
+}
+
+TEST_CASE(testAdoptVector)
+{
+    std::vector<float> data(6 * 4, 1.5f);
+    const float* const buffer = data.data();
+    const npy_intp dims[] = {6, 4};
+    PyObject* const array =
+            numpyutils::toNumpyArray(std::move(data), 2, dims, NPY_FLOAT);
+
+    // The array took over the vector's buffer rather than copying it
+    TEST_ASSERT(getData(array) == buffer);
+    TEST_ASSERT(data.empty());
+    TEST_ASSERT(isWriteable(array));
+    TEST_ASSERT(PyCapsule_CheckExact(getBase(array)));
+    TEST_ASSERT_EQ(numpyutils::getNumElements(array),
+                   static_cast<size_t>(24));
+    TEST_ASSERT_EQ(numpyutils::getBuffer<float>(array)[23], 1.5f);
+
+    // Freeing the array frees the vector along with it
+    Py_DECREF(array);
+}
+
+TEST_CASE(testAdoptArrays)
+{
+    const npy_intp dims[] = {10};
+
+    std::unique_ptr<std::complex<float>[]> data(new std::complex<float>[10]);
+    const void* buffer = data.get();
+    PyObject* array = numpyutils::toNumpyArray(std::move(data), 10, 1, dims,
+                                               NPY_CFLOAT);
+    TEST_ASSERT(getData(array) == buffer);
+    TEST_ASSERT(isWriteable(array));
+    Py_DECREF(array);
+
+    // Const data is read-only
+    std::unique_ptr<const double[]> constData(new double[10]());
+    buffer = constData.get();
+    array = numpyutils::toNumpyArray(std::move(constData), 10, 1, dims,
+                                     NPY_DOUBLE);
+    TEST_ASSERT(getData(array) == buffer);
+    TEST_ASSERT(!isWriteable(array));
+    Py_DECREF(array);
+
+    mem::ScopedAlignedArray<int> aligned(10);
+    buffer = aligned.get();
+    array = numpyutils::toNumpyArray(aligned, 10, 1, dims, NPY_INT);
+    TEST_ASSERT(getData(array) == buffer);
+    TEST_ASSERT(aligned.get() == nullptr);
+    Py_DECREF(array);
+
+    // Dimensions bigger than the buffer
+    const npy_intp tooBig[] = {11};
+    std::vector<double> small(10);
+    TEST_THROWS(numpyutils::toNumpyArray(std::move(small), 1, tooBig,
+                                         NPY_DOUBLE));
+}
+
+TEST_CASE(testView)
+{
+    std::vector<double> data(12);
+    const npy_intp dims[] = {3, 4};
+    PyObject* const base = numpyutils::toNumpyArray(std::move(data), 2, dims,
+                                                    NPY_DOUBLE);
+    double* const buffer = numpyutils::getBuffer<double>(base);
+    const Py_ssize_t baseRefs = Py_REFCNT(base);
+
+    // The view keeps the object owning the memory alive
+    const npy_intp rowDims[] = {4};
+    PyObject* const view = numpyutils::toNumpyArrayView(
+            coda_oss::span<const double>(buffer + 4, 4), 1, rowDims,
+            NPY_DOUBLE, base);
+    TEST_ASSERT(getData(view) == buffer + 4);
+    TEST_ASSERT(getBase(view) == base);
+    TEST_ASSERT(!isWriteable(view));
+    TEST_ASSERT_EQ(Py_REFCNT(base), baseRefs + 1);
+
+    Py_DECREF(view);
+    TEST_ASSERT_EQ(Py_REFCNT(base), baseRefs);
+    Py_DECREF(base);
+}
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    TEST_CHECK(testAdoptVector);
+    TEST_CHECK(testAdoptArrays);
+    TEST_CHECK(testView);
+    // wreaks havoc from the bowels of <numpy/arrayobject.h>
+    CODA_OSS_mark_symbol_unused(_import_array);
+    return 0;
+}
@@ -149,6 +149,13 @@ public:
         differentByteOrdering = isDifferent;
     }
 
+    /**
+     * Size of the words to reverse when byte swapping the data: the
+     * element size, half of it for complex types (each component is
+     * swapped), or 1 for N_BYTE types, which aren't swapped
+     */
+    size_t getByteSwapSize() const;
+
     /**
      * Does a given user data field exist?
      *
@@ -197,8 +204,10 @@ public:
      * Writes the SIO header to the given OutputStream
      * @param numBands the number of bands intended for the SIO file
      * @os    the OutputStream to write the header to
+     * @byteSwap write the header fields in the opposite of the system's
+     *           byte order
      */
-    void to(size_t numBands, io::OutputStream& os);
+    void to(size_t numBands, io::OutputStream& os, bool byteSwap = false);
 
 protected:
     /** Number of lines in the image or vector */
@@ -224,7 +233,7 @@ protected:
     bool differentByteOrdering;
 
     /** Write the version2 user data */
-    void writeUserData(io::OutputStream& os);
+    void writeUserData(io::OutputStream& os, bool byteSwap = false);
 };
 
 }
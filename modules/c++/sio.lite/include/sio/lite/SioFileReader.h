@@ -23,8 +23,10 @@
 #define __SIO_LITE_FILE_READER_H__
 
 #include <import/sys.h>
+#include <coda_oss/span.h>
 #include <io/Seekable.h>
 #include <io/FileInputStream.h>
+#include <types/RowCol.h>
 #include "sio/lite/InvalidHeaderException.h"
 #include "sio/lite/StreamReader.h"
 
@@ -136,9 +138,73 @@ public:
      */
     sys::Off_T tell();
 
+    /*!
+     *  Read a window of the image without reading the rest of it.
+     *
+     *  The rows of the window are fetched with positional reads, adjacent
+     *  rows coalesced into single reads, spread across numThreads threads,
+     *  and byte swapped in place if the file's byte order differs from the
+     *  system's.  The position reported by tell() doesn't change.
+     *
+     *  \param origin First line and element of the window
+     *  \param dims Number of lines and elements in the window
+     *  \param buffer Destination of at least dims.area() elements of the
+     *         header's element size, stored row by row
+     *  \param numThreads Number of threads to read with.  0 (the default)
+     *         uses every CPU.
+     *
+     *  \throws except::Exception if the window doesn't fit in the image or
+     *          the buffer is too small
+     */
+    template <typename T>
+    void readWindow(const types::RowCol<size_t>& origin,
+                    const types::RowCol<size_t>& dims,
+                    coda_oss::span<T> buffer,
+                    size_t numThreads = 0)
+    {
+        readWindow(origin, dims, buffer.data(), buffer.size_bytes(),
+                   numThreads);
+    }
+
+    /*!
+     *  Read every step.row-th line and every step.col-th element of the
+     *  image, e.g. for a quick look, reading only those lines.  Reads are
+     *  done as in readWindow().
+     *
+     *  \param step Decimation in each direction
+     *  \param buffer Destination of at least getDecimatedDims(step).area()
+     *         elements of the header's element size, stored row by row
+     *  \param numThreads Number of threads to read with.  0 (the default)
+     *         uses every CPU.
+     */
+    template <typename T>
+    void readDecimated(const types::RowCol<size_t>& step,
+                       coda_oss::span<T> buffer,
+                       size_t numThreads = 0)
+    {
+        readDecimated(step, buffer.data(), buffer.size_bytes(), numThreads);
+    }
+
+    //! Dimensions of the image read by readDecimated()
+    types::RowCol<size_t>
+    getDecimatedDims(const types::RowCol<size_t>& step) const;
 
     void killStream();
 protected:
+
+private:
+    void readWindow(const types::RowCol<size_t>& origin,
+                    const types::RowCol<size_t>& dims,
+                    void* buffer,
+                    size_t numBytes,
+                    size_t numThreads);
+
+    void readDecimated(const types::RowCol<size_t>& step,
+                       void* buffer,
+                       size_t numBytes,
+                       size_t numThreads);
+
+    io::SeekableInputStream& getSeekableStream();
 };
 }
 }
@@ -25,6 +25,7 @@
 #include <memory>
 #include <vector>
 
+#include <coda_oss/span.h>
 #include <import/sys.h>
 #include <import/io.h>
 #include <import/mem.h>
@@ -50,21 +51,12 @@ namespace lite
  */
 struct FileWriter
 {
-    FileWriter(const std::string& outputFile) : mFileName(outputFile), mAdopt(true)
-    {
-        mStream.reset(new io::FileOutputStream(mFileName));
-    }
+    FileWriter(const std::string& outputFile);
 
-    FileWriter(const char* outputFile) : mFileName(outputFile), mAdopt(true)
-    {
-        mStream.reset(new io::FileOutputStream(mFileName));
-    }
+    FileWriter(const char* outputFile);
 
     //! The input stream will get freed by the Writer if adopt is set to true
-    FileWriter(io::OutputStream* stream, bool adopt = true) : mAdopt(adopt)
-    {
-        mStream.reset(stream);
-    }
+    FileWriter(io::OutputStream* stream, bool adopt = true);
 
     // need copy for Python binding w/SWIG
     //FileWriter(const FileWriter&) = default;
@@ -72,11 +64,15 @@ struct FileWriter
     //FileWriter(FileWriter&&) = default;
     //FileWriter& operator=(FileWriter&&) = default;
 
-    virtual ~FileWriter()
+    virtual ~FileWriter();
+
+    //! Byte order of the header and data written by beginRows()
+    enum ByteOrder
     {
-        //if we aren't adopting it, release it
-        if (!mAdopt) mStream.release();
-    }
+        NATIVE_ORDER,
+        BIG_ENDIAN_ORDER,
+        LITTLE_ENDIAN_ORDER
+    };
 
     /*!
      * Writes the SIO given the FileHeader and InputStreams.
@@ -103,10 +99,113 @@ struct FileWriter
     void write(int numLines, int numElements, int elementSize,
                int elementType, const void* data, int numBands = 1);
 
+    /*!
+     * Writes the SIO given the FileHeader and one span per band, each
+     * holding numLines * numElements elements of sizeof(T) bytes.  See
+     * beginRows() for the layout, byte order and threading.
+     */
+    template <typename T>
+    void write(FileHeader* header,
+               const std::vector<coda_oss::span<const T> >& bands,
+               ByteOrder byteOrder = NATIVE_ORDER,
+               size_t numThreads = 0)
+    {
+        beginRows(header, bands.size(), byteOrder, numThreads);
+        appendRows(bands);
+        finishRows();
+    }
+
+    //! Writes a single band SIO given the FileHeader and its data
+    template <typename T>
+    void write(FileHeader* header,
+               coda_oss::span<const T> data,
+               ByteOrder byteOrder = NATIVE_ORDER,
+               size_t numThreads = 0)
+    {
+        write(header, std::vector<coda_oss::span<const T> >(1, data),
+              byteOrder, numThreads);
+    }
+
+    /*!
+     * Writes the header and gets ready for the image to be appended a
+     * block of rows at a time with appendRows(), so a producer never has to
+     * hold the whole image.
+     *
+     * Multi-band UNSIGNED and SIGNED images of more than two bands are
+     * stored as N_BYTE elements, i.e. interleaved by pixel; each call to
+     * appendRows() then takes the same rows of every band and interleaves
+     * them.  Anything else is band-sequential: appendRows() takes one span
+     * and the rows run through the first band, then the second and so on.
+     *
+     * Rows are gathered into large blocks, interleaving and byte swapping
+     * on numThreads threads, and each full block is written by a
+     * background thread while the next one is filled.
+     *
+     * \param header Header of the image; as with the other overloads its
+     *        line count and element type are updated for numBands
+     * \param numBands Number of bands
+     * \param byteOrder Byte order of the header and data in the file.
+     *        Elements are swapped per component for complex types and not
+     *        at all for N_BYTE types.
+     * \param numThreads Number of threads for interleaving and swapping.
+     *        0 (the default) uses every CPU.
+     */
+    void beginRows(FileHeader* header,
+                   size_t numBands,
+                   ByteOrder byteOrder = NATIVE_ORDER,
+                   size_t numThreads = 0);
+
+    /*!
+     * Appends the next rows of the image; see beginRows().  Every span
+     * must be the same size, hold whole rows, and use elements of the
+     * header's element size.
+     *
+     * \throws except::Exception if the rows don't fit what beginRows()
+     *         was told, or rethrows an error from the background writer
+     */
+    template <typename T>
+    void appendRows(const std::vector<coda_oss::span<const T> >& bands)
+    {
+        std::vector<const sys::byte*> data(bands.size());
+        for (size_t ii = 0; ii < bands.size(); ++ii)
+        {
+            if (bands[ii].size() != bands[0].size())
+            {
+                throw except::Exception(Ctxt("Bands must all be the same size"));
+            }
+            data[ii] = reinterpret_cast<const sys::byte*>(bands[ii].data());
+        }
+        appendRows(data, bands.empty() ? 0 : bands[0].size(), sizeof(T));
+    }
+
+    //! Appends the next rows of a single span; see beginRows()
+    template <typename T>
+    void appendRows(coda_oss::span<const T> data)
+    {
+        appendRows(std::vector<coda_oss::span<const T> >(1, data));
+    }
+
+    /*!
+     * Writes out the last block and waits for the background writer.
+     *
+     * \throws except::Exception if fewer rows were appended than the header
+     *         calls for, or rethrows an error from the background writer
+     */
+    void finishRows();
+
 protected:
     std::string mFileName;
     mem::auto_ptr<io::OutputStream> mStream;
     bool mAdopt;
+
+private:
+    struct RowWriter;
+
+    void appendRows(const std::vector<const sys::byte*>& bands,
+                    size_t numElements,
+                    size_t elementSize);
+
+    std::unique_ptr<RowWriter> mRows;
 };
 
 /** Automatic data, this is not explicitly valid, dont use this in an FileHeader */
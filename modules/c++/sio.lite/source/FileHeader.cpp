@@ -24,6 +24,18 @@
 // magic + nl + ne + et + es
 const int SIO_HEADER_LENGTH = 20;
 
+namespace
+{
+void writeInt(io::OutputStream& os, int32_t value, bool byteSwap)
+{
+    if (byteSwap)
+    {
+        value = sys::byteSwap(value);
+    }
+    os.write((const sys::byte*)&value, 4);
+}
+}
+
 std::string sio::lite::FileHeader::getElementTypeAsString() const
 {
     std::string type;
@@ -61,6 +73,22 @@ std::string sio::lite::FileHeader::getElementTypeAsString() const
     return type;
 }
 
+size_t sio::lite::FileHeader::getByteSwapSize() const
+{
+    switch (et)
+    {
+    case COMPLEX_UNSIGNED:
+    case COMPLEX_SIGNED:
+    case COMPLEX_FLOAT:
+        return static_cast<size_t>(es / 2);
+    case N_BYTE_UNSIGNED:
+    case N_BYTE_SIGNED:
+        return 1;
+    default:
+        return static_cast<size_t>(es);
+    }
+}
+
 long sio::lite::FileHeader::getLength() const
 {
     size_t length = SIO_HEADER_LENGTH;
@@ -102,7 +130,8 @@ std::vector<sys::byte>& sio::lite::FileHeader::getUserData(const std::string& ke
 }
 
 
-void sio::lite::FileHeader::to(size_t numBands, io::OutputStream& os)
+void sio::lite::FileHeader::to(size_t numBands, io::OutputStream& os,
+                               bool byteSwap)
 {
     if (numBands <= 0) numBands = 1;
     //compare the input numBands to the elementType
@@ -146,20 +175,20 @@ void sio::lite::FileHeader::to(size_t numBands, io::OutputStream& os)
     //construct the magic byte
     int magic = (255 - version) | 127 << 8 | version << 16 | 255 << 24;
 
-    os.write((const sys::byte*)&magic, 4);
-    os.write((const sys::byte*)&nl, 4);
-    os.write((const sys::byte*)&ne, 4);
-    os.write((const sys::byte*)&elementType, 4);
-    os.write((const sys::byte*)&elementSize, 4);
+    writeInt(os, magic, byteSwap);
+    writeInt(os, nl, byteSwap);
+    writeInt(os, ne, byteSwap);
+    writeInt(os, elementType, byteSwap);
+    writeInt(os, elementSize, byteSwap);
 
     if (version > 1)
-        writeUserData(os);
+        writeUserData(os, byteSwap);
 }
 
-void sio::lite::FileHeader::writeUserData(io::OutputStream& os)
+void sio::lite::FileHeader::writeUserData(io::OutputStream& os, bool byteSwap)
 {
     const auto numFields = static_cast<int32_t>(userData.size());
-    os.write((const sys::byte*)&numFields, 4);
+    writeInt(os, numFields, byteSwap);
 
     for(sio::lite::UserDataDictionary::Iterator it = userData.begin();
             it != userData.end(); ++it)
@@ -167,12 +196,12 @@ void sio::lite::FileHeader::writeUserData(io::OutputStream& os)
         std::string key = it->first;
         //add 1 for null-byte termination
         const auto keySize = static_cast<int32_t>(key.length() + 1);
-        os.write((const sys::byte*)&keySize, 4);
+        writeInt(os, keySize, byteSwap);
         os.write((const sys::byte*)key.c_str(), keySize);
 
         std::vector<sys::byte>& uData = it->second;
         const auto udSize =  static_cast<int32_t>(uData.size());
-        os.write((const sys::byte*)&udSize, 4);
+        writeInt(os, udSize, byteSwap);
 
         //Do we need to check for endian-ness and possibly byteswap???
         for (std::vector<sys::byte>::iterator iter = uData.begin();
@@ -21,6 +21,210 @@
  */
 #include "sio/lite/FileReader.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <mt/Runnable1D.h>
+
+namespace
+{
+// Reads are split into pieces of at least this many bytes between threads
+const size_t MIN_BYTES_PER_THREAD = 1024 * 1024;
+
+size_t getNumThreads(size_t numThreads)
+{
+    return numThreads == 0 ? sys::OS().getNumCPUs() : numThreads;
+}
+
+void byteSwap(void* buffer, size_t numBytes, size_t swapSize)
+{
+    if (swapSize > 1)
+    {
+        sys::byteSwap(buffer, static_cast<unsigned short>(swapSize),
+                      numBytes / swapSize);
+    }
+}
+
+/*
+ * Add a segment, merging it into the last one if it continues it both in
+ * the file and in memory
+ */
+void addSegment(sys::Off_T offset,
+                sys::byte* buffer,
+                size_t length,
+                std::vector<io::IoSegment>& segments)
+{
+    if (!segments.empty())
+    {
+        io::IoSegment& last = segments.back();
+        if (last.offset + static_cast<sys::Off_T>(last.length) == offset &&
+            static_cast<sys::byte*>(last.buffer) + last.length == buffer)
+        {
+            last.length += length;
+            return;
+        }
+    }
+    const io::IoSegment segment = {offset, buffer, length};
+    segments.push_back(segment);
+}
+
+/*
+ * Read each group of segments with a single readv() and byte swap it
+ */
+class ReadSegments
+{
+public:
+    ReadSegments(io::SeekableInputStream& stream,
+                 const std::vector<std::vector<io::IoSegment> >& groups,
+                 size_t swapSize) :
+        mStream(stream),
+        mGroups(groups),
+        mSwapSize(swapSize)
+    {
+    }
+
+    void operator()(size_t group) const
+    {
+        const std::vector<io::IoSegment>& segments = mGroups[group];
+        mStream.readv(segments);
+        for (size_t ii = 0; ii < segments.size(); ++ii)
+        {
+            byteSwap(segments[ii].buffer, segments[ii].length, mSwapSize);
+        }
+    }
+
+private:
+    io::SeekableInputStream& mStream;
+    const std::vector<std::vector<io::IoSegment> >& mGroups;
+    const size_t mSwapSize;
+};
+
+/*
+ * Split the (already coalesced) segments into groups of roughly equal size,
+ * one or more per thread, never splitting an element, and read them
+ */
+void readSegments(io::SeekableInputStream& stream,
+                  const std::vector<io::IoSegment>& segments,
+                  size_t elementSize,
+                  size_t swapSize,
+                  size_t numThreads)
+{
+    size_t numBytes = 0;
+    for (size_t ii = 0; ii < segments.size(); ++ii)
+    {
+        numBytes += segments[ii].length;
+    }
+
+    size_t bytesPerGroup = std::max(MIN_BYTES_PER_THREAD,
+                                    (numBytes + numThreads - 1) / numThreads);
+    bytesPerGroup = std::max(elementSize,
+                             bytesPerGroup / elementSize * elementSize);
+
+    std::vector<std::vector<io::IoSegment> > groups(1);
+    size_t groupBytes = 0;
+    for (size_t ii = 0; ii < segments.size(); ++ii)
+    {
+        io::IoSegment segment = segments[ii];
+        while (segment.length > 0)
+        {
+            if (groupBytes == bytesPerGroup)
+            {
+                groups.push_back(std::vector<io::IoSegment>());
+                groupBytes = 0;
+            }
+            const size_t length =
+                    std::min(segment.length, bytesPerGroup - groupBytes);
+            const io::IoSegment piece = {segment.offset, segment.buffer,
+                                         length};
+            groups.back().push_back(piece);
+            groupBytes += length;
+
+            segment.offset += length;
+            segment.buffer = static_cast<sys::byte*>(segment.buffer) + length;
+            segment.length -= length;
+        }
+    }
+
+    const ReadSegments op(stream, groups, swapSize);
+    mt::run1D(groups.size(), std::min(numThreads, groups.size()), op);
+}
+
+/*
+ * Read the lines of a decimated image that skips elements: each thread
+ * reads the span of a line covering the elements it needs into its own
+ * scratch buffer and picks them out of that
+ */
+class ReadDecimatedLines
+{
+public:
+    ReadDecimatedLines(io::SeekableInputStream& stream,
+                       sys::Off_T imageOffset,
+                       size_t numElements,
+                       size_t elementSize,
+                       size_t swapSize,
+                       const types::RowCol<size_t>& step,
+                       const types::RowCol<size_t>& dims,
+                       sys::byte* buffer) :
+        mStream(stream),
+        mImageOffset(imageOffset),
+        mNumElements(numElements),
+        mElementSize(elementSize),
+        mSwapSize(swapSize),
+        mStep(step),
+        mDims(dims),
+        mBuffer(buffer),
+        mScratch(((dims.col - 1) * step.col + 1) * elementSize)
+    {
+    }
+
+    void operator()(size_t row) const
+    {
+        const sys::Off_T offset = mImageOffset + static_cast<sys::Off_T>(
+                row * mStep.row * mNumElements * mElementSize);
+        const std::vector<io::IoSegment> segments(
+                1, io::IoSegment{offset, mScratch.data(), mScratch.size()});
+        mStream.readv(segments);
+
+        sys::byte* const output = mBuffer + row * mDims.col * mElementSize;
+        const size_t inputStride = mStep.col * mElementSize;
+        for (size_t col = 0; col < mDims.col; ++col)
+        {
+            memcpy(output + col * mElementSize,
+                   mScratch.data() + col * inputStride,
+                   mElementSize);
+        }
+        byteSwap(output, mDims.col * mElementSize, mSwapSize);
+    }
+
+private:
+    io::SeekableInputStream& mStream;
+    const sys::Off_T mImageOffset;
+    const size_t mNumElements;
+    const size_t mElementSize;
+    const size_t mSwapSize;
+    const types::RowCol<size_t> mStep;
+    const types::RowCol<size_t> mDims;
+    sys::byte* const mBuffer;
+    mutable std::vector<sys::byte> mScratch;
+};
+
+void checkBufferSize(const types::RowCol<size_t>& dims,
+                     size_t elementSize,
+                     size_t numBytes)
+{
+    if (numBytes < dims.area() * elementSize)
+    {
+        std::ostringstream ostr;
+        ostr << "Buffer of " << numBytes << " bytes is too small for "
+             << dims.row << " x " << dims.col << " elements of "
+             << elementSize << " bytes";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+}
+}
+
 sys::Off_T sio::lite::FileReader::seek( sys::Off_T offset, Whence whence )
 {
     if (whence == START)
@@ -45,3 +249,122 @@ void sio::lite::FileReader::killStream()
     }
 }
 
+
+io::SeekableInputStream& sio::lite::FileReader::getSeekableStream()
+{
+    io::SeekableInputStream* const stream =
+            dynamic_cast<io::SeekableInputStream*>(inputStream);
+    if (!stream)
+    {
+        throw except::Exception(Ctxt(
+                "Positional reads need a seekable input stream"));
+    }
+    return *stream;
+}
+
+void sio::lite::FileReader::readWindow(const types::RowCol<size_t>& origin,
+                                       const types::RowCol<size_t>& dims,
+                                       void* buffer,
+                                       size_t numBytes,
+                                       size_t numThreads)
+{
+    const size_t numLines = static_cast<size_t>(header->getNumLines());
+    const size_t numElements = static_cast<size_t>(header->getNumElements());
+    const size_t elementSize = static_cast<size_t>(header->getElementSize());
+    if (origin.row + dims.row > numLines ||
+        origin.col + dims.col > numElements)
+    {
+        std::ostringstream ostr;
+        ostr << "Window of " << dims.row << " x " << dims.col << " at ("
+             << origin.row << ", " << origin.col
+             << ") doesn't fit in an image of " << numLines << " x "
+             << numElements;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+    checkBufferSize(dims, elementSize, numBytes);
+    if (dims.area() == 0)
+    {
+        return;
+    }
+
+    // A window spanning whole lines ends up as one segment
+    const size_t lineBytes = numElements * elementSize;
+    const size_t windowLineBytes = dims.col * elementSize;
+    sys::byte* const output = static_cast<sys::byte*>(buffer);
+    std::vector<io::IoSegment> segments;
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        const sys::Off_T offset = headerLength + static_cast<sys::Off_T>(
+                (origin.row + row) * lineBytes + origin.col * elementSize);
+        addSegment(offset, output + row * windowLineBytes, windowLineBytes,
+                   segments);
+    }
+
+    const size_t swapSize = header->isDifferentByteOrdering() ?
+            header->getByteSwapSize() : 1;
+    readSegments(getSeekableStream(), segments, elementSize, swapSize,
+                 getNumThreads(numThreads));
+}
+
+types::RowCol<size_t>
+sio::lite::FileReader::getDecimatedDims(const types::RowCol<size_t>& step) const
+{
+    if (step.row == 0 || step.col == 0)
+    {
+        throw except::Exception(Ctxt("Decimation must be at least 1"));
+    }
+    const size_t numLines = static_cast<size_t>(header->getNumLines());
+    const size_t numElements = static_cast<size_t>(header->getNumElements());
+    return types::RowCol<size_t>((numLines + step.row - 1) / step.row,
+                                 (numElements + step.col - 1) / step.col);
+}
+
+void sio::lite::FileReader::readDecimated(const types::RowCol<size_t>& step,
+                                          void* buffer,
+                                          size_t numBytes,
+                                          size_t numThreads)
+{
+    const types::RowCol<size_t> dims = getDecimatedDims(step);
+    const size_t elementSize = static_cast<size_t>(header->getElementSize());
+    checkBufferSize(dims, elementSize, numBytes);
+    if (dims.area() == 0)
+    {
+        return;
+    }
+
+    if (step.row == 1 && step.col == 1)
+    {
+        readWindow(types::RowCol<size_t>(0, 0), dims, buffer, numBytes,
+                   numThreads);
+        return;
+    }
+
+    io::SeekableInputStream& stream = getSeekableStream();
+    const size_t numElements = static_cast<size_t>(header->getNumElements());
+    const size_t swapSize = header->isDifferentByteOrdering() ?
+            header->getByteSwapSize() : 1;
+    numThreads = std::min(getNumThreads(numThreads), dims.row);
+
+    if (step.col == 1)
+    {
+        // Whole lines, so each one is a segment
+        const size_t lineBytes = numElements * elementSize;
+        sys::byte* const output = static_cast<sys::byte*>(buffer);
+        std::vector<io::IoSegment> segments;
+        for (size_t row = 0; row < dims.row; ++row)
+        {
+            const sys::Off_T offset = headerLength + static_cast<sys::Off_T>(
+                    row * step.row * lineBytes);
+            addSegment(offset, output + row * lineBytes, lineBytes,
+                       segments);
+        }
+        readSegments(stream, segments, elementSize, swapSize, numThreads);
+    }
+    else
+    {
+        const ReadDecimatedLines op(stream, headerLength, numElements,
+                                    elementSize, swapSize, step, dims,
+                                    static_cast<sys::byte*>(buffer));
+        mt::run1DWithCopies(dims.row, numThreads, op);
+    }
+}
@@ -21,6 +21,217 @@
  */
 #include "sio/lite/FileWriter.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <mem/BufferRing.h>
+#include <io/BufferRingStreams.h>
+#include <mt/Runnable1D.h>
+
+namespace
+{
+// Rows are gathered into blocks of about this size before being written
+const size_t BLOCK_SIZE = 4 * 1024 * 1024;
+const size_t NUM_BLOCKS = 3;
+
+// Pixels handed to each call of the interleaving functor
+const size_t PIXELS_PER_GROUP = 4096;
+
+template <size_t ElementSizeT>
+void copyStrided(const sys::byte* input,
+                 size_t numPixels,
+                 sys::byte* output,
+                 size_t outputStride)
+{
+    for (size_t ii = 0; ii < numPixels; ++ii)
+    {
+        memcpy(output + ii * outputStride, input + ii * ElementSizeT,
+               ElementSizeT);
+    }
+}
+
+/*
+ * Copy numPixels elements of one band to every outputStride bytes of the
+ * output, reversing the bytes of each swapSize-byte word if swapSize > 1
+ */
+void copyBand(const sys::byte* input,
+              size_t numPixels,
+              size_t elementSize,
+              size_t swapSize,
+              sys::byte* output,
+              size_t outputStride)
+{
+    if (swapSize > 1)
+    {
+        for (size_t ii = 0; ii < numPixels; ++ii)
+        {
+            const sys::byte* const in = input + ii * elementSize;
+            sys::byte* const out = output + ii * outputStride;
+            for (size_t word = 0; word < elementSize; word += swapSize)
+            {
+                for (size_t jj = 0; jj < swapSize; ++jj)
+                {
+                    out[word + jj] = in[word + swapSize - 1 - jj];
+                }
+            }
+        }
+    }
+    else if (outputStride == elementSize)
+    {
+        memcpy(output, input, numPixels * elementSize);
+    }
+    else
+    {
+        switch (elementSize)
+        {
+        case 1:
+            copyStrided<1>(input, numPixels, output, outputStride);
+            break;
+        case 2:
+            copyStrided<2>(input, numPixels, output, outputStride);
+            break;
+        case 4:
+            copyStrided<4>(input, numPixels, output, outputStride);
+            break;
+        case 8:
+            copyStrided<8>(input, numPixels, output, outputStride);
+            break;
+        default:
+            for (size_t ii = 0; ii < numPixels; ++ii)
+            {
+                memcpy(output + ii * outputStride, input + ii * elementSize,
+                       elementSize);
+            }
+        }
+    }
+}
+
+// Interleaves (or just copies and swaps, for one band) a group of pixels
+struct InterleavePixels final
+{
+    InterleavePixels(const std::vector<const sys::byte*>& bands,
+                     size_t firstPixel,
+                     size_t numPixels,
+                     size_t elementSize,
+                     size_t swapSize,
+                     sys::byte* output) :
+        mBands(bands),
+        mFirstPixel(firstPixel),
+        mNumPixels(numPixels),
+        mElementSize(elementSize),
+        mSwapSize(swapSize),
+        mOutput(output)
+    {
+    }
+
+    void operator()(size_t group) const
+    {
+        const size_t begin = group * PIXELS_PER_GROUP;
+        const size_t count = std::min(PIXELS_PER_GROUP, mNumPixels - begin);
+        const size_t stride = mElementSize * mBands.size();
+        for (size_t band = 0; band < mBands.size(); ++band)
+        {
+            copyBand(mBands[band] + (mFirstPixel + begin) * mElementSize,
+                     count, mElementSize, mSwapSize,
+                     mOutput + begin * stride + band * mElementSize, stride);
+        }
+    }
+
+private:
+    const std::vector<const sys::byte*>& mBands;
+    const size_t mFirstPixel;
+    const size_t mNumPixels;
+    const size_t mElementSize;
+    const size_t mSwapSize;
+    sys::byte* const mOutput;
+};
+}
+
+struct sio::lite::FileWriter::RowWriter final
+{
+    RowWriter(io::OutputStream& output,
+              size_t numBands,
+              size_t numElementsPerRow,
+              size_t elementSize,
+              size_t swapSize,
+              size_t numBytes,
+              size_t numThreads) :
+        numBands(numBands),
+        numElementsPerRow(numElementsPerRow),
+        elementSize(elementSize),
+        swapSize(swapSize),
+        numThreads(numThreads),
+        numBytesRemaining(numBytes),
+        ring(NUM_BLOCKS,
+             std::max<size_t>(1, BLOCK_SIZE / (elementSize * numBands)) *
+                     elementSize * numBands),
+        writer(ring, output)
+    {
+    }
+
+    //! Get a block with space left, waiting on the writer if need be
+    sys::byte* getBlock()
+    {
+        if (!haveBlock)
+        {
+            if (!ring.acquireForWrite(index))
+            {
+                // The writer only aborts on an error, which join() rethrows
+                writer.join();
+                throw except::IOException(Ctxt("SIO writer stopped"));
+            }
+            haveBlock = true;
+            fill = 0;
+        }
+        return ring.getBuffer<sys::byte>(index);
+    }
+
+    void publish()
+    {
+        ring.publish(index, fill);
+        haveBlock = false;
+    }
+
+    const size_t numBands;
+    const size_t numElementsPerRow;
+    const size_t elementSize;
+    const size_t swapSize;
+    const size_t numThreads;
+    size_t numBytesRemaining;
+
+    mem::BufferRing ring;
+    size_t index = 0;
+    size_t fill = 0;
+    bool haveBlock = false;
+    io::BufferRingWriter writer;
+};
+
+sio::lite::FileWriter::FileWriter(const std::string& outputFile) :
+    mFileName(outputFile), mAdopt(true)
+{
+    mStream.reset(new io::FileOutputStream(mFileName));
+}
+
+sio::lite::FileWriter::FileWriter(const char* outputFile) :
+    mFileName(outputFile), mAdopt(true)
+{
+    mStream.reset(new io::FileOutputStream(mFileName));
+}
+
+sio::lite::FileWriter::FileWriter(io::OutputStream* stream, bool adopt) :
+    mAdopt(adopt)
+{
+    mStream.reset(stream);
+}
+
+sio::lite::FileWriter::~FileWriter()
+{
+    //if we aren't adopting it, release it
+    if (!mAdopt) mStream.release();
+}
+
 void sio::lite::FileWriter::write(sio::lite::FileHeader* header, std::vector<io::InputStream*> bandStreams)
 {
     header->to(bandStreams.size(), *mStream); //write header
@@ -58,3 +269,137 @@ void sio::lite::FileWriter::write(int numLines, int numElements, int elementSize
     write(&hdr, data, numBands);
 }
 
+
+void sio::lite::FileWriter::beginRows(sio::lite::FileHeader* header,
+                                      size_t numBands,
+                                      ByteOrder byteOrder,
+                                      size_t numThreads)
+{
+    if (mRows.get())
+    {
+        throw except::Exception(Ctxt("Rows are already being written"));
+    }
+    numBands = std::max<size_t>(1, numBands);
+
+    const int elementType = header->getElementType();
+    const size_t elementSize = static_cast<size_t>(header->getElementSize());
+    if (elementSize == 0)
+    {
+        throw except::Exception(Ctxt("Element size must be positive"));
+    }
+
+    // Mirrors FileHeader::to(): more than two integer bands become one
+    // N_BYTE band interleaved by pixel, anything else is band-sequential
+    const bool interleaved = numBands > 2 &&
+            (elementType == sio::lite::FileHeader::UNSIGNED ||
+             elementType == sio::lite::FileHeader::SIGNED);
+
+    const bool bigEndianSystem = sys::isBigEndianSystem();
+    const bool byteSwap =
+            (byteOrder == BIG_ENDIAN_ORDER && !bigEndianSystem) ||
+            (byteOrder == LITTLE_ENDIAN_ORDER && bigEndianSystem);
+    // Before to(), which may turn the elements into N_BYTE ones
+    const size_t swapSize = byteSwap ? header->getByteSwapSize() : 1;
+
+    const size_t numBytes = static_cast<size_t>(header->getNumLines()) *
+            static_cast<size_t>(header->getNumElements()) * elementSize *
+            numBands;
+
+    header->to(numBands, *mStream, byteSwap);
+
+    mRows.reset(new RowWriter(*mStream,
+                              interleaved ? numBands : 1,
+                              static_cast<size_t>(header->getNumElements()),
+                              elementSize,
+                              swapSize,
+                              numBytes,
+                              numThreads == 0 ?
+                                      sys::OS().getNumCPUs() : numThreads));
+}
+
+void sio::lite::FileWriter::appendRows(
+        const std::vector<const sys::byte*>& bands,
+        size_t numElements,
+        size_t elementSize)
+{
+    if (!mRows.get())
+    {
+        throw except::Exception(Ctxt("beginRows() must be called first"));
+    }
+    RowWriter& rows = *mRows;
+
+    if (bands.size() != rows.numBands)
+    {
+        std::ostringstream oss;
+        oss << "Expected " << rows.numBands << " bands but got "
+            << bands.size();
+        throw except::Exception(Ctxt(oss.str()));
+    }
+    if (elementSize != rows.elementSize)
+    {
+        std::ostringstream oss;
+        oss << "Expected elements of " << rows.elementSize
+            << " bytes but got " << elementSize;
+        throw except::Exception(Ctxt(oss.str()));
+    }
+    if (rows.numElementsPerRow == 0 ||
+        numElements % rows.numElementsPerRow != 0)
+    {
+        throw except::Exception(Ctxt("Only whole rows can be appended"));
+    }
+    const size_t pixelSize = rows.elementSize * rows.numBands;
+    if (numElements * pixelSize > rows.numBytesRemaining)
+    {
+        throw except::Exception(Ctxt("More rows appended than the header "
+                                     "calls for"));
+    }
+
+    // Blocks hold a whole number of pixels, so a pixel never straddles two
+    const size_t blockPixels = rows.ring.getNumBytes() / pixelSize;
+    size_t pixel = 0;
+    while (pixel < numElements)
+    {
+        sys::byte* const block = rows.getBlock();
+        const size_t numPixels = std::min(numElements - pixel,
+                                          blockPixels - rows.fill / pixelSize);
+
+        const InterleavePixels op(bands, pixel, numPixels, rows.elementSize,
+                                  rows.swapSize, block + rows.fill);
+        const size_t numGroups =
+                (numPixels + PIXELS_PER_GROUP - 1) / PIXELS_PER_GROUP;
+        mt::run1D(numGroups, std::min(rows.numThreads, numGroups), op);
+
+        pixel += numPixels;
+        rows.fill += numPixels * pixelSize;
+        rows.numBytesRemaining -= numPixels * pixelSize;
+        if (rows.fill == blockPixels * pixelSize)
+        {
+            rows.publish();
+        }
+    }
+}
+
+void sio::lite::FileWriter::finishRows()
+{
+    if (!mRows.get())
+    {
+        throw except::Exception(Ctxt("beginRows() must be called first"));
+    }
+
+    // Whatever happens, the next beginRows() starts fresh
+    std::unique_ptr<RowWriter> rows(std::move(mRows));
+    if (rows->haveBlock && rows->fill > 0)
+    {
+        rows->publish();
+    }
+    rows->ring.close();
+    rows->writer.join();
+
+    if (rows->numBytesRemaining != 0)
+    {
+        std::ostringstream oss;
+        oss << "SIO is " << rows->numBytesRemaining
+            << " bytes short of what the header calls for";
+        throw except::Exception(Ctxt(oss.str()));
+    }
+}
@@ -0,0 +1,240 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <complex>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/except.h>
+#include <import/sio/lite.h>
+#include <io/TempFile.h>
+#include <str/Convert.h>
+#include <sys/StopWatch.h>
+
+/*!
+ *  Writes a big-endian complex float image, reads windows of it and a
+ *  decimated copy of it back through FileReader::readWindow() and
+ *  readDecimated(), and checks them.  Then times a quick look of about 1% of
+ *  the image against reading the whole image and picking the same pixels out.
+ */
+namespace
+{
+typedef std::complex<float> Pixel;
+
+Pixel makePixel(size_t row, size_t col)
+{
+    return Pixel(static_cast<float>(row), -static_cast<float>(col));
+}
+
+void check(bool condition, const std::string& message)
+{
+    if (!condition)
+    {
+        throw except::Exception(Ctxt(message));
+    }
+}
+
+void checkWindow(sio::lite::FileReader& reader,
+                 const types::RowCol<size_t>& origin,
+                 const types::RowCol<size_t>& dims,
+                 size_t numThreads)
+{
+    std::vector<Pixel> window(dims.area());
+    reader.readWindow(origin, dims, coda_oss::span<Pixel>(window.data(),
+                                                          window.size()),
+                      numThreads);
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            check(window[row * dims.col + col] ==
+                          makePixel(origin.row + row, origin.col + col),
+                  "Wrong pixel in window");
+        }
+    }
+}
+
+void checkDecimated(sio::lite::FileReader& reader,
+                    const types::RowCol<size_t>& step,
+                    size_t numThreads)
+{
+    const types::RowCol<size_t> dims = reader.getDecimatedDims(step);
+    std::vector<Pixel> image(dims.area());
+    reader.readDecimated(step, coda_oss::span<Pixel>(image.data(),
+                                                     image.size()),
+                         numThreads);
+    for (size_t row = 0; row < dims.row; ++row)
+    {
+        for (size_t col = 0; col < dims.col; ++col)
+        {
+            check(image[row * dims.col + col] ==
+                          makePixel(row * step.row, col * step.col),
+                  "Wrong pixel in decimated image");
+        }
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t rows = argc > 1 ?
+                str::toType<size_t>(argv[1]) : static_cast<size_t>(2048);
+        const size_t cols = argc > 2 ?
+                str::toType<size_t>(argv[2]) : static_cast<size_t>(2048);
+
+        const io::TempFile tempFile;
+        {
+            std::vector<Pixel> image(rows * cols);
+            for (size_t row = 0; row < rows; ++row)
+            {
+                for (size_t col = 0; col < cols; ++col)
+                {
+                    image[row * cols + col] = makePixel(row, col);
+                }
+            }
+            sio::lite::FileWriter writer(tempFile.pathname());
+            sio::lite::FileHeader header(static_cast<int>(rows),
+                                         static_cast<int>(cols),
+                                         sizeof(Pixel),
+                                         sio::lite::FileHeader::COMPLEX_FLOAT);
+            writer.write(&header,
+                         coda_oss::span<const Pixel>(image.data(),
+                                                     image.size()),
+                         sio::lite::FileWriter::BIG_ENDIAN_ORDER);
+        }
+
+        sio::lite::FileReader reader(tempFile.pathname());
+        check(reader.getHeader()->isDifferentByteOrdering() ==
+                      !sys::isBigEndianSystem(),
+              "Header should be big-endian");
+
+        const size_t threadCounts[] = {1, 4};
+        for (size_t ii = 0; ii < 2; ++ii)
+        {
+            const size_t numThreads = threadCounts[ii];
+            checkWindow(reader, types::RowCol<size_t>(0, 0),
+                        types::RowCol<size_t>(rows, cols), numThreads);
+            checkWindow(reader, types::RowCol<size_t>(rows / 3, 0),
+                        types::RowCol<size_t>(rows / 2, cols), numThreads);
+            checkWindow(reader, types::RowCol<size_t>(rows / 4, cols / 5),
+                        types::RowCol<size_t>(rows / 2, cols / 3),
+                        numThreads);
+            checkWindow(reader, types::RowCol<size_t>(rows - 1, cols - 1),
+                        types::RowCol<size_t>(1, 1), numThreads);
+
+            checkDecimated(reader, types::RowCol<size_t>(1, 1), numThreads);
+            checkDecimated(reader, types::RowCol<size_t>(3, 1), numThreads);
+            checkDecimated(reader, types::RowCol<size_t>(1, 7), numThreads);
+            checkDecimated(reader, types::RowCol<size_t>(10, 10),
+                           numThreads);
+        }
+
+        // The stream position is left alone
+        check(reader.tell() == 0, "Positional reads moved the stream");
+        std::cout << "Windows and decimation: PASSED" << std::endl;
+
+        // Reading outside of the image, or into too small a buffer, fails
+        {
+            std::vector<Pixel> window(4);
+            bool threw = false;
+            try
+            {
+                reader.readWindow(types::RowCol<size_t>(rows - 1, 0),
+                                  types::RowCol<size_t>(2, 2),
+                                  coda_oss::span<Pixel>(window.data(),
+                                                        window.size()));
+            }
+            catch (const except::Exception&)
+            {
+                threw = true;
+            }
+            check(threw, "Window outside the image should throw");
+
+            threw = false;
+            try
+            {
+                reader.readWindow(types::RowCol<size_t>(0, 0),
+                                  types::RowCol<size_t>(3, 3),
+                                  coda_oss::span<Pixel>(window.data(),
+                                                        window.size()));
+            }
+            catch (const except::Exception&)
+            {
+                threw = true;
+            }
+            check(threw, "Buffer too small should throw");
+        }
+        std::cout << "Errors: PASSED" << std::endl;
+
+        // A 1% quick look, read whole and picked out as callers had to
+        // before, against only reading the lines it needs
+        const types::RowCol<size_t> step(10, 10);
+        const types::RowCol<size_t> dims = reader.getDecimatedDims(step);
+        std::vector<Pixel> quickLook(dims.area());
+        sys::RealTimeStopWatch sw;
+        {
+            sw.start();
+            sio::lite::FileReader wholeReader(tempFile.pathname());
+            std::vector<Pixel> image(rows * cols);
+            wholeReader.read(coda_oss::span<Pixel>(image.data(),
+                                                   image.size()),
+                             true);
+            for (size_t row = 0; row < dims.row; ++row)
+            {
+                for (size_t col = 0; col < dims.col; ++col)
+                {
+                    Pixel pixel = image[row * step.row * cols +
+                                        col * step.col];
+                    if (!sys::isBigEndianSystem())
+                    {
+                        sys::byteSwap(&pixel, sizeof(float), 2);
+                    }
+                    quickLook[row * dims.col + col] = pixel;
+                }
+            }
+            std::cout << "Whole image: " << sw.stop() << " ms" << std::endl;
+        }
+        {
+            sw.start();
+            sio::lite::FileReader quickReader(tempFile.pathname());
+            quickReader.readDecimated(step,
+                                      coda_oss::span<Pixel>(quickLook.data(),
+                                                            quickLook.size()));
+            std::cout << "FileReader::readDecimated(): " << sw.stop()
+                      << " ms" << std::endl;
+        }
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
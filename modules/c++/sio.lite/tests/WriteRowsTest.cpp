@@ -0,0 +1,252 @@
+/* =========================================================================
+ * This file is part of sio.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * sio.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/except.h>
+#include <import/io.h>
+#include <import/sio/lite.h>
+#include <io/TempFile.h>
+#include <str/Convert.h>
+#include <sys/StopWatch.h>
+
+/*!
+ *  Writes a three band 16-bit image, interleaved by pixel and in big-endian
+ *  order, a block of rows at a time through FileWriter::appendRows(), and
+ *  checks what reads back.  Then times writing the same image through the
+ *  span overload against interleaving and swapping it by hand and writing
+ *  it through the raw buffer overload.
+ */
+namespace
+{
+typedef uint16_t Sample;
+const size_t NUM_BANDS = 3;
+
+Sample makeSample(size_t band, size_t pixel)
+{
+    return static_cast<Sample>(band * 7919 + pixel * 31);
+}
+
+void check(bool condition, const std::string& message)
+{
+    if (!condition)
+    {
+        throw except::Exception(Ctxt(message));
+    }
+}
+
+void checkFile(const std::string& pathname, size_t rows, size_t cols)
+{
+    sio::lite::FileReader reader(pathname);
+    sio::lite::FileHeader* const header = reader.readHeader();
+    check(header->isDifferentByteOrdering() == !sys::isBigEndianSystem(),
+          "Header should be big-endian");
+    check(header->getNumLines() == static_cast<int>(rows), "Wrong rows");
+    check(header->getNumElements() == static_cast<int>(cols), "Wrong cols");
+    check(header->getElementType() ==
+                  sio::lite::FileHeader::N_BYTE_UNSIGNED,
+          "Bands should be interleaved into N_BYTE elements");
+    check(header->getElementSize() ==
+                  static_cast<int>(NUM_BANDS * sizeof(Sample)),
+          "Wrong element size");
+
+    std::vector<Sample> data(rows * cols * NUM_BANDS);
+    reader.read(reinterpret_cast<sys::byte*>(data.data()),
+                data.size() * sizeof(Sample));
+    for (size_t pixel = 0; pixel < rows * cols; ++pixel)
+    {
+        for (size_t band = 0; band < NUM_BANDS; ++band)
+        {
+            Sample value = data[pixel * NUM_BANDS + band];
+            if (!sys::isBigEndianSystem())
+            {
+                value = sys::byteSwap(value);
+            }
+            check(value == makeSample(band, pixel), "Wrong sample");
+        }
+    }
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const size_t rows = argc > 1 ?
+                str::toType<size_t>(argv[1]) : static_cast<size_t>(2048);
+        const size_t cols = argc > 2 ?
+                str::toType<size_t>(argv[2]) : static_cast<size_t>(2048);
+        const size_t rowsPerBlock = 37;
+
+        std::vector<std::vector<Sample> > bands(NUM_BANDS);
+        for (size_t band = 0; band < NUM_BANDS; ++band)
+        {
+            bands[band].resize(rows * cols);
+            for (size_t pixel = 0; pixel < rows * cols; ++pixel)
+            {
+                bands[band][pixel] = makeSample(band, pixel);
+            }
+        }
+
+        const io::TempFile tempFile;
+        sys::RealTimeStopWatch sw;
+
+        // Row blocks
+        {
+            sio::lite::FileWriter writer(tempFile.pathname());
+            sio::lite::FileHeader header(static_cast<int>(rows),
+                                         static_cast<int>(cols),
+                                         sizeof(Sample),
+                                         sio::lite::FileHeader::UNSIGNED);
+            writer.beginRows(&header, NUM_BANDS,
+                             sio::lite::FileWriter::BIG_ENDIAN_ORDER);
+            for (size_t row = 0; row < rows; row += rowsPerBlock)
+            {
+                const size_t numRows = std::min(rowsPerBlock, rows - row);
+                std::vector<coda_oss::span<const Sample> > block;
+                for (size_t band = 0; band < NUM_BANDS; ++band)
+                {
+                    block.push_back(coda_oss::span<const Sample>(
+                            bands[band].data() + row * cols,
+                            numRows * cols));
+                }
+                writer.appendRows(block);
+            }
+            writer.finishRows();
+        }
+        checkFile(tempFile.pathname(), rows, cols);
+        std::cout << "Row blocks: PASSED" << std::endl;
+
+        const double numMB = rows * cols * NUM_BANDS * sizeof(Sample) /
+                (1024.0 * 1024.0);
+
+        // By hand, the way callers had to before
+        {
+            sw.start();
+            std::vector<Sample> interleaved(rows * cols * NUM_BANDS);
+            for (size_t pixel = 0; pixel < rows * cols; ++pixel)
+            {
+                for (size_t band = 0; band < NUM_BANDS; ++band)
+                {
+                    Sample value = bands[band][pixel];
+                    if (!sys::isBigEndianSystem())
+                    {
+                        value = sys::byteSwap(value);
+                    }
+                    interleaved[pixel * NUM_BANDS + band] = value;
+                }
+            }
+
+            // Only the header fields need swapping
+            sio::lite::FileHeader header(static_cast<int>(rows),
+                                         static_cast<int>(cols),
+                                         sizeof(Sample),
+                                         sio::lite::FileHeader::UNSIGNED);
+            io::FileOutputStream output(tempFile.pathname());
+            header.to(NUM_BANDS, output, !sys::isBigEndianSystem());
+            output.write(reinterpret_cast<const sys::byte*>(
+                                 interleaved.data()),
+                         interleaved.size() * sizeof(Sample));
+            output.close();
+            const double millis = sw.stop();
+            std::cout << "By hand: " << millis << " ms, "
+                      << numMB / (millis / 1000.0) << " MB/s" << std::endl;
+        }
+        checkFile(tempFile.pathname(), rows, cols);
+
+        // Span overload
+        {
+            sw.start();
+            sio::lite::FileWriter writer(tempFile.pathname());
+            sio::lite::FileHeader header(static_cast<int>(rows),
+                                         static_cast<int>(cols),
+                                         sizeof(Sample),
+                                         sio::lite::FileHeader::UNSIGNED);
+            std::vector<coda_oss::span<const Sample> > spans;
+            for (size_t band = 0; band < NUM_BANDS; ++band)
+            {
+                spans.push_back(coda_oss::span<const Sample>(
+                        bands[band].data(), bands[band].size()));
+            }
+            writer.write(&header, spans,
+                         sio::lite::FileWriter::BIG_ENDIAN_ORDER);
+            const double millis = sw.stop();
+            std::cout << "FileWriter::write(span): " << millis << " ms, "
+                      << numMB / (millis / 1000.0) << " MB/s" << std::endl;
+        }
+        checkFile(tempFile.pathname(), rows, cols);
+
+        // Appending more rows than the header holds, or too few, fails
+        {
+            sio::lite::FileWriter writer(tempFile.pathname());
+            sio::lite::FileHeader header(1, static_cast<int>(cols),
+                                         sizeof(Sample),
+                                         sio::lite::FileHeader::UNSIGNED);
+            writer.beginRows(&header, NUM_BANDS);
+            std::vector<coda_oss::span<const Sample> > twoRows;
+            for (size_t band = 0; band < NUM_BANDS; ++band)
+            {
+                twoRows.push_back(coda_oss::span<const Sample>(
+                        bands[band].data(), 2 * cols));
+            }
+            bool threw = false;
+            try
+            {
+                writer.appendRows(twoRows);
+            }
+            catch (const except::Exception&)
+            {
+                threw = true;
+            }
+            check(threw, "Appending too many rows should throw");
+
+            threw = false;
+            try
+            {
+                writer.finishRows();
+            }
+            catch (const except::Exception&)
+            {
+                threw = true;
+            }
+            check(threw, "Finishing short should throw");
+        }
+        std::cout << "Errors: PASSED" << std::endl;
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    catch (const std::exception& ex)
+    {
+        std::cerr << ex.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -93,12 +93,15 @@ struct CODA_OSS_API AbstractOS
      *  \param fragment       The fragment to search for
      *  \param extension      extensions should only be used for files
      *  \param pathList       The path list (colon delimited)
+     *  \param numThreads     Directories to search at once; see
+     *                        sys::FileFinder::search()
      */
     std::vector<std::string>
     search(const std::vector<std::string>& searchPaths,
            const std::string& fragment = "",
            const std::string& extension = "",
-           bool recursive = true) const;
+           bool recursive = true,
+           size_t numThreads = 1) const;
 
     /*!
      *  Does this path exist?
@@ -278,6 +281,19 @@ struct CODA_OSS_API AbstractOS
     virtual void getAvailableCPUs(std::vector<int>& physicalCPUs,
                                   std::vector<int>& htCPUs) const = 0;
 
+    /*!
+     * Group the available CPUs (as divided by getAvailableCPUs) by the
+     * NUMA node they belong to. Within each node, the physical CPUs come
+     * before the hyperthreaded ones. Nodes without any available CPUs are
+     * left out, and a machine that doesn't report its NUMA nodes is
+     * treated as a single node.
+     *
+     * \param[out] nodeCPUs The available CPUs of each node, in order of
+     *                      node number
+     */
+    virtual void getAvailableCPUsByNUMANode(
+            std::vector<std::vector<int> >& nodeCPUs) const = 0;
+
     /*!
      *  Create a symlink, pathnames can be either absolute or relative
      */
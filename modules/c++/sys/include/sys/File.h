@@ -189,6 +189,45 @@ struct File
     void writeFrom(const void* buffer,
                    size_t size);
 
+    /*!
+     *  Read 'size' bytes starting at 'offset' into a buffer, leaving the
+     *  file pointer where it was.  On POSIX systems this doesn't use the
+     *  file pointer at all, so several threads can read from one handle at
+     *  once.  On Windows, where reading at an offset moves the file
+     *  pointer, it's put back afterwards; so there, calls on the same File
+     *  from several threads must take turns.
+     *  If the end of the file is reached first, an exception occurs.
+     *
+     *  \param offset Where in the file to start reading
+     *  \param buffer The buffer to put to
+     *  \param size The number of bytes
+     */
+    void readAt(sys::Off_T offset, void* buffer, size_t size);
+
+    /*!
+     *  Like readAt(), except that reaching the end of the file isn't an
+     *  error.
+     *
+     *  \param offset Where in the file to start reading
+     *  \param buffer The buffer to put to
+     *  \param size The most bytes to read
+     *  \return The number of bytes read, which is less than 'size' only if
+     *  the end of the file was reached
+     */
+    size_t readAtMost(sys::Off_T offset, void* buffer, size_t size);
+
+    /*!
+     *  Write 'size' bytes from a buffer into the file starting at
+     *  'offset', leaving the file pointer where it was.  As with readAt(),
+     *  this doesn't use the file pointer on POSIX systems, and puts it back
+     *  on Windows.
+     *
+     *  \param offset Where in the file to start writing
+     *  \param buffer The buffer to read from
+     *  \param size The number of bytes to write out
+     */
+    void writeAt(sys::Off_T offset, const void* buffer, size_t size);
+
     /*!
      *  Seek to the specified offset, relative to 'whence.'
      *  Valid values are FROM_START, FROM_CURRENT, FROM_END.
@@ -221,6 +260,31 @@ struct File
      */
     sys::Off_T lastModifiedTime();
 
+    /*!
+     *  Reserve disk space for the first 'length' bytes of the file so
+     *  that large sequential writes don't fragment or fail part way
+     *  through.  The reported file length is not changed.  This is a
+     *  hint; it is silently ignored where the OS or filesystem does not
+     *  support it.
+     *
+     *  \param length The number of bytes to reserve
+     */
+    void preallocate(sys::Off_T length);
+
+    /*!
+     *  Turn unbuffered (O_DIRECT) I/O on or off for this handle.  While
+     *  enabled, the buffer address, file offset and size of every read
+     *  and write must be multiples of DIRECT_IO_ALIGNMENT.
+     *
+     *  \param enable Whether to bypass the OS page cache
+     *  \return true if the mode was changed, false if direct I/O is not
+     *  supported on this platform or filesystem
+     */
+    bool setDirectIO(bool enable);
+
+    //! Alignment required of buffers, offsets and sizes under direct I/O
+    enum { DIRECT_IO_ALIGNMENT = 4096 };
+
     /*!
      *  Flush the file to disk
      */
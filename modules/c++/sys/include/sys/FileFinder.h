@@ -23,6 +23,8 @@
 #ifndef __SYS_FILE_FINDER_H__
 #define __SYS_FILE_FINDER_H__
 
+#include <stddef.h>
+
 #include <functional>
 #include <vector>
 #include <string>
@@ -33,6 +35,23 @@
 namespace sys
 {
 
+/**
+ * A path found by FileFinder, along with its type as reported by the
+ * directory listing (following symbolic links)
+ */
+struct FileEntry final
+{
+    enum class Type
+    {
+        File,
+        Directory,
+        Other
+    };
+
+    std::string path;
+    Type type;
+};
+
 /**
  * Predicate interface for all entries
  */
@@ -43,6 +62,18 @@ struct FilePredicate
 
     virtual ~FilePredicate() = default;
     virtual bool operator()(const std::string& entry) const = 0;
+
+    /**
+     * Called by FileFinder, which already knows the type of each entry;
+     * predicates that only need the type can skip a stat() by overriding
+     * this.  By default, the path is passed to operator().
+     *
+     * FileFinder may call this from several threads at once.
+     */
+    virtual bool match(const FileEntry& entry) const
+    {
+        return (*this)(entry.path);
+    }
 };
 
 /**
@@ -52,6 +83,7 @@ struct ExistsPredicate : FilePredicate
 {
     virtual ~ExistsPredicate() = default;
     virtual bool operator()(const std::string& entry) const;
+    bool match(const FileEntry&) const override;
 };
 
 /**
@@ -61,6 +93,7 @@ struct FileOnlyPredicate: public FilePredicate
 {
     virtual ~FileOnlyPredicate() = default;
     virtual bool operator()(const std::string& entry) const;
+    bool match(const FileEntry&) const override;
 };
 
 /**
@@ -70,6 +103,7 @@ struct DirectoryOnlyPredicate: public FilePredicate
 {
     virtual ~DirectoryOnlyPredicate() = default;
     virtual bool operator()(const std::string& entry) const;
+    bool match(const FileEntry&) const override;
 };
 
 /**
@@ -97,8 +131,11 @@ struct ExtensionPredicate: public FileOnlyPredicate
 {
     ExtensionPredicate(const std::string& ext, bool ignoreCase = true);
     bool operator()(const std::string& filename) const;
+    bool match(const FileEntry&) const override;
 
 private:
+    bool matchExtension(const std::string& filename) const;
+
     std::string mExt;
     bool mIgnoreCase;
 };
@@ -112,6 +149,7 @@ struct NotPredicate : public FilePredicate
     virtual ~NotPredicate();
 
     virtual bool operator()(const std::string& entry) const;
+    bool match(const FileEntry&) const override;
 
 protected:
     typedef std::pair<FilePredicate*, bool> PredicatePair;
@@ -133,6 +171,7 @@ struct LogicalPredicate : public FilePredicate
                                         bool ownIt = false);
 
     virtual bool operator()(const std::string& entry) const;
+    bool match(const FileEntry&) const override;
 
 protected:
     bool mOrOperator = true;
@@ -153,12 +192,38 @@ struct FileFinder final
 
     /**
      * Perform the search
+     * \param numThreads  Directories to list at once; with more than one,
+     *                    the matching paths are returned in no particular
+     *                    order (otherwise it's breadth-first).
      * \return a std::vector<std::string> of paths that match
      */
     static std::vector<std::string> search(
         const FilePredicate& filter,
         const std::vector<std::string>& searchPaths, 
-        bool recursive = false);
+        bool recursive = false,
+        size_t numThreads = 1);
+
+    /**
+     * Called with the search paths that exist, then with the entries
+     * ("." and ".." excluded) of each directory listed
+     */
+    using Visitor = std::function<void(const std::vector<FileEntry>&)>;
+
+    /**
+     * Walk the directory trees under searchPaths, streaming the entries to
+     * visit as each directory is read.  Entry types come from the listing
+     * itself where the OS provides them, so most entries aren't stat()ed.
+     *
+     * \param searchPaths  Files and directories to start from
+     * \param visit        With numThreads > 1, this is called from
+     *                     several threads at once
+     * \param recursive    If false, only the search paths are listed
+     * \param numThreads   Number of threads listing directories
+     */
+    static void walk(const std::vector<std::string>& searchPaths,
+                     const Visitor& visit,
+                     bool recursive = true,
+                     size_t numThreads = 1);
 };
 
 // This is here most to avoid creating a new module for one utility routine
@@ -201,6 +201,20 @@ struct OSUnix final : public AbstractOS
     virtual void getAvailableCPUs(std::vector<int>& physicalCPUs,
                                   std::vector<int>& htCPUs) const;
 
+    /*!
+     * Group the available CPUs (as divided by getAvailableCPUs), read
+     * from /sys/devices/system/node, by the
+     * NUMA node they belong to. Within each node, the physical CPUs come
+     * before the hyperthreaded ones. Nodes without any available CPUs are
+     * left out, and a machine that doesn't report its NUMA nodes is
+     * treated as a single node.
+     *
+     * \param[out] nodeCPUs The available CPUs of each node, in order of
+     *                      node number
+     */
+    virtual void getAvailableCPUsByNUMANode(
+            std::vector<std::vector<int> >& nodeCPUs) const;
+
     /*!
      *  Create a symlink, pathnames can be either absolute or relative
      */
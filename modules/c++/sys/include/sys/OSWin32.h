@@ -226,6 +226,17 @@ struct CODA_OSS_API OSWin32 final : public AbstractOS
     virtual void getAvailableCPUs(std::vector<int>& physicalCPUs,
                                   std::vector<int>& htCPUs) const;
 
+    /*!
+     * Group the available CPUs by the NUMA node they belong to.
+     *
+     * \todo Not yet implemented
+     *
+     * \param[out] nodeCPUs The available CPUs of each node, in order of
+     *                      node number
+     */
+    virtual void getAvailableCPUsByNUMANode(
+            std::vector<std::vector<int> >& nodeCPUs) const;
+
     /*!
      *  Create a symlink, pathnames can be either absolute or relative
      */
@@ -48,7 +48,8 @@ std::vector<std::string>
 AbstractOS::search(const std::vector<std::string>& searchPaths,
                    const std::string& fragment,
                    const std::string& extension,
-                   bool recursive) const
+                   bool recursive,
+                   size_t numThreads) const
 {
     std::vector<std::string> elementsFound;
 
@@ -64,21 +65,24 @@ AbstractOS::search(const std::vector<std::string>& searchPaths,
 
         elementsFound = sys::FileFinder::search(logicPred,
                                                 searchPaths,
-                                                recursive);
+                                                recursive,
+                                                numThreads);
     }
     else if (!extension.empty())
     {
         sys::ExtensionPredicate extPred(extension);
         elementsFound = sys::FileFinder::search(extPred,
                                                 searchPaths,
-                                                recursive);
+                                                recursive,
+                                                numThreads);
     }
     else if (!fragment.empty())
     {
         sys::FragmentPredicate fragPred(fragment);
         elementsFound = sys::FileFinder::search(fragPred,
                                                 searchPaths,
-                                                recursive);
+                                                recursive,
+                                                numThreads);
     }
     return elementsFound;
 }
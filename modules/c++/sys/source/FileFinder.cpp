@@ -21,31 +21,149 @@
  */
 #include "sys/FileFinder.h"
 
+#include <string.h>
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <iterator>
+#include <mutex>
 #include <stdexcept>
+#include <thread>
 
+#include "sys/Conf.h"
 #include "sys/DirectoryEntry.h"
 #include "sys/Path.h"
 
+#if !(defined(WIN32) || defined(_WIN32))
+#include <dirent.h>
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+// Appends the contents of directory ("." and ".." excluded) to entries;
+// a directory that can't be read is treated as empty, as with
+// sys::DirectoryEntry.
+void readDirectory(const std::string& directory,
+                   std::vector<sys::FileEntry>& entries)
+{
+#if defined(WIN32) || defined(_WIN32)
+    WIN32_FIND_DATA findData;
+    const HANDLE handle = FindFirstFile(
+            sys::Path::joinPaths(directory, "*").c_str(), &findData);
+    if (handle == INVALID_HANDLE_VALUE)
+    {
+        return;
+    }
+    do
+    {
+        const std::string name(findData.cFileName);
+        if (name != "." && name != "..")
+        {
+            // same test as sys::OSWin32::isFile()/isDirectory()
+            const auto type = (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) ?
+                    sys::FileEntry::Type::Directory : sys::FileEntry::Type::File;
+            entries.push_back({ sys::Path::joinPaths(directory, name), type });
+        }
+    } while (FindNextFile(handle, &findData));
+    FindClose(handle);
+#else
+    DIR* const dir = ::opendir(directory.c_str());
+    if (dir == nullptr)
+    {
+        return;
+    }
+    while (const struct dirent* const dirEntry = ::readdir(dir))
+    {
+        const char* const name = dirEntry->d_name;
+        if (strcmp(name, ".") == 0 || strcmp(name, "..") == 0)
+        {
+            continue;
+        }
+
+        sys::FileEntry entry{ sys::Path::joinPaths(directory, name),
+                              sys::FileEntry::Type::Other };
+        bool needStat = true;
+#if defined(DT_DIR)
+        // Most file systems fill in d_type; only symbolic links (which
+        // are followed, as stat() does) and unknowns need a stat().
+        switch (dirEntry->d_type)
+        {
+        case DT_REG:
+            entry.type = sys::FileEntry::Type::File;
+            needStat = false;
+            break;
+        case DT_DIR:
+            entry.type = sys::FileEntry::Type::Directory;
+            needStat = false;
+            break;
+        case DT_LNK:
+        case DT_UNKNOWN:
+            break;
+        default:
+            needStat = false;
+            break;
+        }
+#endif
+        if (needStat)
+        {
+            struct stat info;
+            if (::stat(entry.path.c_str(), &info) != 0)
+            {
+                continue; // e.g., a broken link; it doesn't "exist"
+            }
+            if (S_ISREG(info.st_mode))
+            {
+                entry.type = sys::FileEntry::Type::File;
+            }
+            else if (S_ISDIR(info.st_mode))
+            {
+                entry.type = sys::FileEntry::Type::Directory;
+            }
+        }
+        entries.push_back(std::move(entry));
+    }
+    ::closedir(dir);
+#endif
+}
+}
+
 bool sys::ExistsPredicate::operator()(const std::string& entry) const
 {
     return sys::Path(entry).exists();
 }
+bool sys::ExistsPredicate::match(const FileEntry&) const
+{
+    return true; // it was just found
+}
 
 bool sys::FileOnlyPredicate::operator()(const std::string& entry) const
 {
     return sys::Path(entry).isFile();
 }
+bool sys::FileOnlyPredicate::match(const FileEntry& entry) const
+{
+    return entry.type == FileEntry::Type::File;
+}
 
 bool sys::DirectoryOnlyPredicate::operator()(const std::string& entry) const
 {
     return sys::Path(entry).isDirectory();
 }
+bool sys::DirectoryOnlyPredicate::match(const FileEntry& entry) const
+{
+    return entry.type == FileEntry::Type::Directory;
+}
 
 sys::FragmentPredicate::FragmentPredicate(const std::string& fragment,
                                           bool ignoreCase) :
     mFragment(fragment), mIgnoreCase(ignoreCase)
 {
+    if (mIgnoreCase)
+    {
+        str::lower(mFragment);
+    }
 }
 
 bool sys::FragmentPredicate::operator()(const std::string& entry) const
@@ -54,11 +172,7 @@ bool sys::FragmentPredicate::operator()(const std::string& entry) const
     {
         std::string base = entry;
         str::lower(base);
-
-        std::string match = mFragment;
-        str::lower(match);
-
-        return str::contains(base, match);
+        return str::contains(base, mFragment);
     }
     else
         return str::contains(entry, mFragment);
@@ -69,23 +183,31 @@ sys::ExtensionPredicate::ExtensionPredicate(const std::string& ext,
                                             bool ignoreCase) :
     mExt(ext), mIgnoreCase(ignoreCase)
 {
+    if (mIgnoreCase)
+    {
+        str::lower(mExt);
+    }
 }
 
 bool sys::ExtensionPredicate::operator()(const std::string& filename) const
 {
     if (!sys::FileOnlyPredicate::operator()(filename))
         return false;
+    return matchExtension(filename);
+}
+bool sys::ExtensionPredicate::match(const FileEntry& entry) const
+{
+    return sys::FileOnlyPredicate::match(entry) && matchExtension(entry.path);
+}
 
+bool sys::ExtensionPredicate::matchExtension(const std::string& filename) const
+{
     std::string ext = sys::Path::splitExt(filename).second;
     if (mIgnoreCase)
     {
-        std::string matchExt = mExt;
-        str::lower(matchExt);
         str::lower(ext);
-        return ext == matchExt;
     }
-    else
-        return ext == mExt;
+    return ext == mExt;
 }
 
 sys::NotPredicate::NotPredicate(FilePredicate* filter, bool ownIt) :
@@ -107,6 +229,10 @@ bool sys::NotPredicate::operator()(const std::string& entry) const
 {
     return !(*mPredicate.first)(entry);
 }
+bool sys::NotPredicate::match(const FileEntry& entry) const
+{
+    return !mPredicate.first->match(entry);
+}
 
 sys::LogicalPredicate::LogicalPredicate(bool orOperator) :
     mOrOperator(orOperator)
@@ -140,6 +266,19 @@ bool sys::LogicalPredicate::operator()(const std::string& entry) const
     }
     return ok;
 }
+bool sys::LogicalPredicate::match(const FileEntry& entry) const
+{
+    bool ok = !mOrOperator;
+    for (size_t i = 0, n = mPredicates.size(); i < n && ok != mOrOperator; ++i)
+    {
+        const sys::LogicalPredicate::PredicatePair& p = mPredicates[i];
+        if (mOrOperator)
+            ok |= (p.first && p.first->match(entry));
+        else
+            ok &= (p.first && p.first->match(entry));
+    }
+    return ok;
+}
 
 sys::LogicalPredicate& sys::LogicalPredicate::addPredicate(
     FilePredicate* filter,
@@ -154,54 +293,165 @@ sys::LogicalPredicate& sys::LogicalPredicate::addPredicate(
 std::vector<std::string> sys::FileFinder::search(
     const FilePredicate& filter,
     const std::vector<std::string>& searchPaths, 
-    bool recursive)
+    bool recursive,
+    size_t numThreads)
 {
-    // turn it into a list so we can queue additional entries
-    std::list < std::string > paths;
-    std::copy(searchPaths.begin(), searchPaths.end(), 
-              std::back_inserter(paths));
-
     std::vector <std::string> files;
-    size_t numInputPaths = searchPaths.size();
-    for (size_t pathIdx = 0; !paths.empty(); ++pathIdx)
-    {
-        sys::Path path(paths.front());
-        paths.pop_front();
+    std::mutex filesMutex;
+    walk(searchPaths, [&](const std::vector<sys::FileEntry>& entries)
+         {
+             // evaluate the whole batch before taking the lock
+             std::vector<std::string> matches;
+             for (const auto& entry : entries)
+             {
+                 if (filter.match(entry))
+                 {
+                     matches.push_back(entry.path);
+                 }
+             }
+
+             std::lock_guard<std::mutex> lock(filesMutex);
+             files.insert(files.end(), matches.begin(), matches.end());
+         },
+         recursive, numThreads);
+    return files;
+}
 
-        //! check if it exists
+void sys::FileFinder::walk(const std::vector<std::string>& searchPaths,
+                           const Visitor& visit,
+                           bool recursive,
+                           size_t numThreads)
+{
+    std::vector<sys::FileEntry> roots;
+    for (const auto& searchPath : searchPaths)
+    {
+        const sys::Path path(searchPath);
         if (path.exists())
         {
-            // check if this meets the criteria -- 
-            // we only need one to add it
-            if (filter(path.getPath()))
+            const auto type = path.isDirectory() ? sys::FileEntry::Type::Directory :
+                    path.isFile() ? sys::FileEntry::Type::File : sys::FileEntry::Type::Other;
+            roots.push_back({ path.getPath(), type });
+        }
+    }
+    if (roots.empty())
+    {
+        return;
+    }
+    visit(roots);
+
+    // directories still to be listed, oldest first
+    std::deque<std::string> directories;
+    for (const auto& root : roots)
+    {
+        if (root.type == sys::FileEntry::Type::Directory)
+        {
+            directories.push_back(root.path);
+        }
+    }
+
+    const auto listDirectory = [&](const std::string& directory,
+                                   std::vector<std::string>& subdirectories)
+    {
+        std::vector<sys::FileEntry> entries;
+        readDirectory(directory, entries);
+        if (!entries.empty())
+        {
+            visit(entries);
+        }
+        if (recursive)
+        {
+            for (auto& entry : entries)
+            {
+                if (entry.type == sys::FileEntry::Type::Directory)
+                {
+                    subdirectories.push_back(std::move(entry.path));
+                }
+            }
+        }
+    };
+
+    if (numThreads <= 1)
+    {
+        std::vector<std::string> subdirectories;
+        while (!directories.empty())
+        {
+            subdirectories.clear();
+            listDirectory(directories.front(), subdirectories);
+            directories.pop_front();
+            std::move(subdirectories.begin(), subdirectories.end(),
+                      std::back_inserter(directories));
+        }
+        return;
+    }
+
+    // Each thread takes the next directory off the queue and adds the
+    // subdirectories it finds; the walk is over when the queue is empty
+    // and no thread is still listing.
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t numListing = 0;
+    std::exception_ptr error;
+    const auto worker = [&]()
+    {
+        std::vector<std::string> subdirectories;
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+        {
+            changed.wait(lock, [&]()
+                         {
+                             return error || !directories.empty() || numListing == 0;
+                         });
+            if (error || directories.empty())
             {
-                files.push_back(path.getPath());
+                return;
             }
+            const std::string directory = std::move(directories.front());
+            directories.pop_front();
+            ++numListing;
 
-            // if it's a directory we need to search its contents
-            if (path.isDirectory())
+            lock.unlock();
+            subdirectories.clear();
+            try
+            {
+                listDirectory(directory, subdirectories);
+            }
+            catch (...)
             {
-                // If its an original directory or we are recursively searching
-                if (pathIdx < numInputPaths || recursive)
+                lock.lock();
+                if (!error)
                 {
-                    sys::DirectoryEntry d(path.getPath());
-                    for (sys::DirectoryEntry::Iterator p = d.begin(); 
-                         p != d.end(); ++p)
-                    {
-                        std::string fname(*p);
-                        if (fname != "." && fname != "..")
-                        {
-                            // add it to the list
-                            paths.push_back(sys::Path::joinPaths(path.getPath(),
-                                                                 fname));
-                        }
-                    }
+                    error = std::current_exception();
                 }
+                --numListing;
+                changed.notify_all();
+                return;
             }
+            lock.lock();
 
+            --numListing;
+            std::move(subdirectories.begin(), subdirectories.end(),
+                      std::back_inserter(directories));
+            if (!subdirectories.empty() || numListing == 0)
+            {
+                changed.notify_all();
+            }
         }
+    };
+
+    std::vector<std::thread> threads;
+    for (size_t ii = 1; ii < numThreads; ++ii)
+    {
+        threads.emplace_back(worker);
+    }
+    worker(); // this thread does its share too
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    if (error)
+    {
+        std::rethrow_exception(error);
     }
-    return files;
 }
 
 coda_oss::filesystem::path sys::test::findRootDirectory(const coda_oss::filesystem::path& p, const std::string& rootName,
@@ -25,6 +25,7 @@
 #if !(defined(WIN32) || defined(_WIN32))
 
 #include <unistd.h>
+#include <fcntl.h>
 #include <string.h>
 #include <errno.h>
 
@@ -111,6 +112,59 @@ void sys::File::writeFrom(const void* buffer, size_t size)
     while (bytesActuallyWritten < size);
 }
 
+void sys::File::readAt(sys::Off_T offset, void* buffer, size_t size)
+{
+    if (readAtMost(offset, buffer, size) < size)
+    {
+        throw sys::SystemException(Ctxt("Unexpected end of file"));
+    }
+}
+
+size_t sys::File::readAtMost(sys::Off_T offset, void* buffer, size_t size)
+{
+    sys::byte* bufferPtr = static_cast<sys::byte*>(buffer);
+    size_t totalBytesRead = 0;
+    while (totalBytesRead < size)
+    {
+        const SSize_T bytesRead = ::pread(mHandle,
+                                          bufferPtr + totalBytesRead,
+                                          size - totalBytesRead,
+                                          offset + totalBytesRead);
+        if (bytesRead == -1)
+        {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            throw sys::SystemException(Ctxt("While reading from file"));
+        }
+        if (bytesRead == 0)
+        {
+            break;
+        }
+        totalBytesRead += bytesRead;
+    }
+    return totalBytesRead;
+}
+
+void sys::File::writeAt(sys::Off_T offset, const void* buffer, size_t size)
+{
+    const sys::byte* bufferPtr = static_cast<const sys::byte*>(buffer);
+    size_t bytesActuallyWritten = 0;
+    while (bytesActuallyWritten < size)
+    {
+        const SSize_T bytesThisWrite = ::pwrite(mHandle,
+                                                bufferPtr + bytesActuallyWritten,
+                                                size - bytesActuallyWritten,
+                                                offset + bytesActuallyWritten);
+        if (bytesThisWrite == -1)
+        {
+            if (errno == EINTR)
+                continue;
+            throw sys::SystemException(Ctxt("Writing to file"));
+        }
+        bytesActuallyWritten += bytesThisWrite;
+    }
+}
+
 sys::Off_T sys::File::seekTo(sys::Off_T offset, int whence)
 {
     sys::Off_T off = ::lseek(mHandle, offset, whence);
@@ -137,6 +191,31 @@ sys::Off_T sys::File::lastModifiedTime()
     return (sys::Off_T) buf.st_mtime * 1000;
 }
 
+void sys::File::preallocate(sys::Off_T length)
+{
+    if (length <= 0)
+        return;
+#if defined(__linux) || defined(__linux__)
+    // Failure (e.g. EOPNOTSUPP on filesystems without extents) is not an
+    // error; the space will simply be allocated as it's written.
+    (void) ::fallocate(mHandle, FALLOC_FL_KEEP_SIZE, 0, length);
+#endif
+}
+
+bool sys::File::setDirectIO(bool enable)
+{
+#if defined(O_DIRECT)
+    const int flags = ::fcntl(mHandle, F_GETFL);
+    if (flags == -1)
+        return false;
+    const int newFlags = enable ? (flags | O_DIRECT) : (flags & ~O_DIRECT);
+    return ::fcntl(mHandle, F_SETFL, newFlags) == 0;
+#else
+    (void) enable;
+    return false;
+#endif
+}
+
 void sys::File::flush()
 {
     if (::fsync(mHandle) != 0)
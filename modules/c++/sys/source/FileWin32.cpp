@@ -125,6 +125,117 @@ void sys::File::writeFrom(const void* buffer, size_t size)
     }
 }
 
+namespace
+{
+// The handle isn't opened for overlapped I/O, so ReadFile() and WriteFile()
+// move the file pointer even when they're given an offset.  This puts it
+// back.
+class RestoreFilePointer final
+{
+    HANDLE mHandle;
+    LARGE_INTEGER mPosition;
+
+public:
+    explicit RestoreFilePointer(HANDLE handle) : mHandle(handle)
+    {
+        LARGE_INTEGER zero = {};
+        if (!SetFilePointerEx(mHandle, zero, &mPosition, FILE_CURRENT))
+        {
+            throw sys::SystemException(Ctxt("Error getting file position"));
+        }
+    }
+    ~RestoreFilePointer()
+    {
+        SetFilePointerEx(mHandle, mPosition, nullptr, FILE_BEGIN);
+    }
+
+    RestoreFilePointer(const RestoreFilePointer&) = delete;
+    RestoreFilePointer& operator=(const RestoreFilePointer&) = delete;
+};
+
+OVERLAPPED makeOverlapped(sys::Off_T offset)
+{
+    LARGE_INTEGER position;
+    position.QuadPart = offset;
+    OVERLAPPED overlapped = {};
+    overlapped.Offset = position.LowPart;
+    overlapped.OffsetHigh = position.HighPart;
+    return overlapped;
+}
+}
+
+void sys::File::readAt(sys::Off_T offset, void* buffer, size_t size)
+{
+    if (readAtMost(offset, buffer, size) < size)
+    {
+        throw sys::SystemException(Ctxt("Unexpected end of file"));
+    }
+}
+
+size_t sys::File::readAtMost(sys::Off_T offset, void* buffer, size_t size)
+{
+    static const size_t MAX_READ_SIZE = std::numeric_limits<DWORD>::max();
+    size_t bytesRead = 0;
+
+    sys::byte* bufferPtr = static_cast<sys::byte*>(buffer);
+
+    const RestoreFilePointer restore(mHandle);
+    while (bytesRead < size)
+    {
+        const DWORD bytesToRead = static_cast<DWORD>(
+                std::min(MAX_READ_SIZE, size - bytesRead));
+
+        OVERLAPPED overlapped = makeOverlapped(offset + bytesRead);
+        DWORD bytesThisRead = 0;
+        if (!ReadFile(mHandle,
+                      bufferPtr + bytesRead,
+                      bytesToRead,
+                      &bytesThisRead,
+                      &overlapped))
+        {
+            if (GetLastError() == ERROR_HANDLE_EOF)
+            {
+                break;
+            }
+            throw sys::SystemException(Ctxt("Error reading from file"));
+        }
+        else if (bytesThisRead == 0)
+        {
+            break;
+        }
+
+        bytesRead += bytesThisRead;
+    }
+    return bytesRead;
+}
+
+void sys::File::writeAt(sys::Off_T offset, const void* buffer, size_t size)
+{
+    static const size_t MAX_WRITE_SIZE = std::numeric_limits<DWORD>::max();
+    size_t bytesWritten = 0;
+
+    const sys::byte* bufferPtr = static_cast<const sys::byte*>(buffer);
+
+    const RestoreFilePointer restore(mHandle);
+    while (bytesWritten < size)
+    {
+        const DWORD bytesToWrite = static_cast<DWORD>(
+            std::min(MAX_WRITE_SIZE, size - bytesWritten));
+
+        OVERLAPPED overlapped = makeOverlapped(offset + bytesWritten);
+        DWORD bytesThisWrite = 0;
+        if (!WriteFile(mHandle,
+                       bufferPtr + bytesWritten,
+                       bytesToWrite,
+                       &bytesThisWrite,
+                       &overlapped))
+        {
+            throw sys::SystemException(Ctxt("Writing from file"));
+        }
+        bytesWritten += bytesThisWrite;
+    }
+}
+
 sys::Off_T sys::File::seekTo(sys::Off_T offset, int whence)
 {
     /* Ahhh!!! */
@@ -167,6 +278,23 @@ sys::Off_T sys::File::lastModifiedTime()
                             mPath.c_str())));
 }
 
+void sys::File::preallocate(sys::Off_T length)
+{
+    if (length <= 0)
+        return;
+    FILE_ALLOCATION_INFO info;
+    info.AllocationSize.QuadPart = length;
+    // Only a hint; the file still grows as it's written if this fails
+    (void) SetFileInformationByHandle(mHandle, FileAllocationInfo,
+                                      &info, sizeof(info));
+}
+
+bool sys::File::setDirectIO(bool)
+{
+    // FILE_FLAG_NO_BUFFERING can only be chosen when the handle is opened
+    return false;
+}
+
 void sys::File::flush()
 {
     if (!FlushFileBuffers(mHandle))
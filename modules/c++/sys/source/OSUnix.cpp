@@ -28,6 +28,7 @@
 #include <sstream>
 #include <vector>
 #include <set>
+#include <map>
 #include <fstream>
 
 #include "sys/Conf.h"
@@ -134,6 +135,71 @@ std::set<std::string> get_unique_thread_siblings()
 
     return unique_ts;
 }
+
+// Parses a list such as "0-3,8-11" from /sys/devices/system/node
+std::vector<int> parseCPUList(const std::string& cpuList)
+{
+    std::vector<int> cpus;
+    const str::Tokenizer::Tokens ranges = str::Tokenizer(cpuList, ",");
+    for (const auto& range : ranges)
+    {
+        const std::string::size_type dash = range.find('-');
+        const int first = str::toType<int>(range.substr(0, dash));
+        const int last = (dash == std::string::npos) ?
+                first : str::toType<int>(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// The CPUs of each node under /sys/devices/system/node, keyed by node
+// number. Empty if the kernel doesn't report NUMA nodes.
+std::map<int, std::vector<int> > get_numa_node_cpus()
+{
+    std::map<int, std::vector<int> > nodeCPUs;
+    const sys::Path sysNodePath("/sys/devices/system/node");
+    if (!sysNodePath.isDirectory())
+    {
+        return nodeCPUs;
+    }
+
+    const std::vector<std::string> searchPaths(1, sysNodePath.getPath());
+    const std::vector<std::string> subDirs =
+        sys::FileFinder::search(
+            sys::DirectoryOnlyPredicate(),
+            searchPaths,
+            false);
+
+    for (const auto& subDir : subDirs)
+    {
+        const std::string name = sys::Path::basename(subDir);
+        if (name.size() <= 4 || name.compare(0, 4, "node") != 0 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos)
+        {
+            continue;
+        }
+
+        const sys::Path cpuListPath(subDir, "cpulist");
+        std::ifstream cpuListIFS(cpuListPath.getPath().c_str());
+        if (!cpuListIFS.is_open())
+        {
+            std::ostringstream msg;
+            msg << "Unable to open NUMA node CPU list "
+                << cpuListPath.getPath();
+            throw except::Exception(Ctxt(msg.str()));
+        }
+
+        // Memory-only nodes have an empty list
+        std::string cpuList;
+        cpuListIFS >> cpuList;
+        nodeCPUs[str::toType<int>(name.substr(4))] = parseCPUList(cpuList);
+    }
+
+    return nodeCPUs;
+}
 }
 
 std::string sys::OSUnix::getPlatformName() const
@@ -420,6 +486,53 @@ void sys::OSUnix::getAvailableCPUs(std::vector<int>& physicalCPUs,
     }
 }
 
+void sys::OSUnix::getAvailableCPUsByNUMANode(
+        std::vector<std::vector<int> >& nodeCPUs) const
+{
+    nodeCPUs.clear();
+
+    std::vector<int> physicalCPUs;
+    std::vector<int> htCPUs;
+    getAvailableCPUs(physicalCPUs, htCPUs);
+
+    const std::map<int, std::vector<int> > numaNodes(get_numa_node_cpus());
+    if (numaNodes.empty())
+    {
+        nodeCPUs.push_back(physicalCPUs);
+        nodeCPUs.back().insert(nodeCPUs.back().end(),
+                               htCPUs.begin(), htCPUs.end());
+        return;
+    }
+
+    std::map<int, int> cpuToNode;
+    for (const auto& node : numaNodes)
+    {
+        for (const auto& cpu : node.second)
+        {
+            cpuToNode[cpu] = node.first;
+        }
+    }
+
+    // Visit the physical CPUs first so they end up at the front of each
+    // node's list. A CPU missing from every node's list (which shouldn't
+    // happen) is counted as part of the first node.
+    std::vector<int> allCPUs(physicalCPUs);
+    allCPUs.insert(allCPUs.end(), htCPUs.begin(), htCPUs.end());
+    std::map<int, std::vector<int> > availableNodeCPUs;
+    for (const auto& cpu : allCPUs)
+    {
+        const auto node = cpuToNode.find(cpu);
+        const int nodeNum = (node == cpuToNode.end()) ?
+                numaNodes.begin()->first : node->second;
+        availableNodeCPUs[nodeNum].push_back(cpu);
+    }
+
+    for (const auto& node : availableNodeCPUs)
+    {
+        nodeCPUs.push_back(node.second);
+    }
+}
+
 void sys::OSUnix::createSymlink(const std::string& origPathname,
                                 const std::string& symlinkPathname) const
 {
@@ -338,6 +338,14 @@ void sys::OSWin32::getAvailableCPUs(std::vector<int>& /*physicalCPUs*/,
         Ctxt("Windows getAvailableCPUs not yet implemented."));
 }
 
+void sys::OSWin32::getAvailableCPUsByNUMANode(
+        std::vector<std::vector<int> >& /*nodeCPUs*/) const
+{
+    // TODO Need to use GetNumaNodeProcessorMaskEx.
+    throw except::NotImplementedException(
+        Ctxt("Windows getAvailableCPUsByNUMANode not yet implemented."));
+}
+
 void sys::OSWin32::createSymlink(const std::string& origPathname,
                                  const std::string& symlinkPathname) const
 {
@@ -19,6 +19,7 @@
  * see <http://www.gnu.org/licenses/>.
  *
  */
+#include <sstream>
 #include <vector>
 
 #include <import/sys.h>
@@ -63,6 +64,15 @@ int main(int /*argc*/, char** /*argv*/)
         printCPUs("Available physical CPUs", physicalCPUs);
         printCPUs("Available HT CPUs", htCPUs);
 
+        std::vector<std::vector<int> > nodeCPUs;
+        os.getAvailableCPUsByNUMANode(nodeCPUs);
+        for (size_t ii = 0; ii < nodeCPUs.size(); ++ii)
+        {
+            std::ostringstream header;
+            header << "Available CPUs on NUMA node " << ii;
+            printCPUs(header.str(), nodeCPUs[ii]);
+        }
+
     }
     catch (const except::Throwable& t)
     {
@@ -0,0 +1,161 @@
+/* =========================================================================
+ * This file is part of sys-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * sys-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/except.h>
+
+/*
+ * Times sys::FileFinder::search() over a synthetic tree of small files:
+ * with the old path-only predicate (a stat() per test), with the entry
+ * types from the directory listing, and with several threads.
+ *
+ * The tree is created under <directory> unless it's already there, and is
+ * left behind for the next run; 1,000,000 files is a good test, but takes
+ * a while to create.
+ */
+
+namespace
+{
+// An ExtensionPredicate that doesn't know about FileEntry, i.e. what
+// every predicate was before FileFinder::walk()
+struct PathOnlyPredicate final : public sys::FilePredicate
+{
+    PathOnlyPredicate(const std::string& ext) : mPredicate(ext)
+    {
+    }
+    bool operator()(const std::string& entry) const override
+    {
+        return mPredicate(entry);
+    }
+
+private:
+    sys::ExtensionPredicate mPredicate;
+};
+
+// 100 files per directory, 100 directories per level
+void createTree(const std::string& directory, size_t numFiles)
+{
+    const sys::OS os;
+    os.makeDirectory(directory);
+    const size_t numDirectories = (numFiles + 99) / 100;
+    const size_t fanOut = 100;
+    for (size_t dir = 0; dir < numDirectories; ++dir)
+    {
+        // dir 1234 lives at <directory>/12/1234
+        const std::string parent =
+                sys::Path::joinPaths(directory, std::to_string(dir / fanOut));
+        os.makeDirectory(parent);
+        const std::string path =
+                sys::Path::joinPaths(parent, std::to_string(dir));
+        os.makeDirectory(path);
+        for (size_t file = 0; file < 100 && dir * 100 + file < numFiles; ++file)
+        {
+            const auto name = std::to_string(file) + ((file % 10) ? ".dat" : ".xsd");
+            std::ofstream(sys::Path::joinPaths(path, name).c_str()) << file;
+        }
+    }
+}
+
+template <typename SearchT>
+double time(const SearchT& search, size_t& numFound)
+{
+    const auto start = std::chrono::steady_clock::now();
+    numFound = search().size();
+    const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2 || argc > 4)
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " <directory> [files] [threads]\n";
+            return EXIT_FAILURE;
+        }
+        const std::string directory(argv[1]);
+        const size_t numFiles = argc > 2 ? std::stoul(argv[2]) : 100000;
+        const size_t numThreads = argc > 3 ? std::stoul(argv[3]) :
+                std::max<size_t>(std::thread::hardware_concurrency(), 2);
+
+        if (!sys::OS().exists(directory))
+        {
+            std::cout << "Creating " << numFiles << " files in "
+                      << directory << "\n";
+            createTree(directory, numFiles);
+        }
+
+        const std::vector<std::string> searchPaths{ directory };
+        const PathOnlyPredicate pathOnly(".xsd");
+        const sys::ExtensionPredicate extension(".xsd");
+
+        size_t numPathOnly = 0;
+        const double pathOnlySeconds = time([&]()
+        {
+            return sys::FileFinder::search(pathOnly, searchPaths, true);
+        }, numPathOnly);
+
+        size_t numSerial = 0;
+        const double serialSeconds = time([&]()
+        {
+            return sys::FileFinder::search(extension, searchPaths, true);
+        }, numSerial);
+
+        size_t numParallel = 0;
+        const double parallelSeconds = time([&]()
+        {
+            return sys::FileFinder::search(extension, searchPaths, true,
+                                           numThreads);
+        }, numParallel);
+
+        if (numPathOnly != numSerial || numSerial != numParallel)
+        {
+            std::cerr << "Found " << numPathOnly << ", " << numSerial
+                      << " and " << numParallel << " files\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << numSerial << " .xsd files found\n"
+                  << "path-only predicate: " << pathOnlySeconds << " s\n"
+                  << "entry types:         " << serialSeconds << " s\n"
+                  << numThreads << " threads:           "
+                  << parallelSeconds << " s\n";
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << "Caught Throwable: " << t.toString() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -0,0 +1,267 @@
+/* =========================================================================
+ * This file is part of sys-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * sys-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdio.h>
+
+#include <algorithm>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/DirectoryEntry.h>
+#include <sys/FileFinder.h>
+#include <sys/OS.h>
+#include <sys/Path.h>
+#include "TestCase.h"
+
+#if !(defined(WIN32) || defined(_WIN32))
+#include <unistd.h>
+#endif
+
+namespace
+{
+const std::string ROOT = "fileFinderTest";
+
+void createFile(const std::string& pathname)
+{
+    std::ofstream oss(pathname.c_str());
+    oss << pathname;
+}
+
+void removeTree()
+{
+#if !(defined(WIN32) || defined(_WIN32))
+    // sys::OS::remove() would follow the links
+    for (const auto link : { "link.xsd", "linkdir", "broken.xsd" })
+    {
+        ::unlink(sys::Path::joinPaths(ROOT, link).c_str());
+    }
+#endif
+    const sys::OS os;
+    if (os.exists(ROOT))
+    {
+        os.remove(ROOT);
+    }
+}
+
+// ROOT/{a.xsd, b.txt, d0/{a.xsd, b.txt, d1/{...}}, ...}, three levels deep
+void createTree(const std::string& testName)
+{
+    removeTree();
+
+    const sys::OS os;
+    std::vector<std::string> directories{ ROOT };
+    for (size_t level = 0; level < 3; ++level)
+    {
+        std::vector<std::string> next;
+        for (const auto& directory : directories)
+        {
+            os.makeDirectory(directory);
+            createFile(sys::Path::joinPaths(directory, "a.xsd"));
+            createFile(sys::Path::joinPaths(directory, "B.XSD"));
+            createFile(sys::Path::joinPaths(directory, "b.txt"));
+            for (size_t ii = 0; ii < 3; ++ii)
+            {
+                next.push_back(sys::Path::joinPaths(directory, "d" + std::to_string(ii) + ".xsd"));
+            }
+        }
+        directories = next;
+    }
+    for (const auto& directory : directories)
+    {
+        os.makeDirectory(directory);
+    }
+
+#if !(defined(WIN32) || defined(_WIN32))
+    // links are followed; a broken one doesn't exist
+    TEST_ASSERT(::symlink("a.xsd", sys::Path::joinPaths(ROOT, "link.xsd").c_str()) == 0);
+    TEST_ASSERT(::symlink("d0.xsd", sys::Path::joinPaths(ROOT, "linkdir").c_str()) == 0);
+    TEST_ASSERT(::symlink("missing", sys::Path::joinPaths(ROOT, "broken.xsd").c_str()) == 0);
+#endif
+}
+
+// FileFinder::search() before it used FileFinder::walk()
+std::vector<std::string> reference(const sys::FilePredicate& filter,
+                                   const std::vector<std::string>& searchPaths,
+                                   bool recursive)
+{
+    std::list<std::string> paths(searchPaths.begin(), searchPaths.end());
+    std::vector<std::string> files;
+    for (size_t pathIdx = 0; !paths.empty(); ++pathIdx)
+    {
+        sys::Path path(paths.front());
+        paths.pop_front();
+        if (path.exists())
+        {
+            if (filter(path.getPath()))
+            {
+                files.push_back(path.getPath());
+            }
+            if (path.isDirectory() && (pathIdx < searchPaths.size() || recursive))
+            {
+                sys::DirectoryEntry d(path.getPath());
+                for (auto p = d.begin(); p != d.end(); ++p)
+                {
+                    const std::string fname(*p);
+                    if (fname != "." && fname != "..")
+                    {
+                        paths.push_back(sys::Path::joinPaths(path.getPath(), fname));
+                    }
+                }
+            }
+        }
+    }
+    return files;
+}
+
+std::vector<std::string> sorted(std::vector<std::string> paths)
+{
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+void testPredicate(const std::string& testName, const sys::FilePredicate& filter)
+{
+    const std::vector<std::string> searchPaths{ ROOT, sys::Path::joinPaths(ROOT, "b.txt"), "doesNotExist" };
+    for (const auto recursive : { false, true })
+    {
+        const auto expected = reference(filter, searchPaths, recursive);
+        if (recursive)
+        {
+            TEST_ASSERT_FALSE(expected.empty());
+        }
+
+        // one thread gives the same order, too
+        TEST_ASSERT(sys::FileFinder::search(filter, searchPaths, recursive) == expected);
+        for (const size_t numThreads : { 2, 3, 8 })
+        {
+            const auto found = sys::FileFinder::search(filter, searchPaths, recursive, numThreads);
+            TEST_ASSERT(sorted(found) == sorted(expected));
+        }
+    }
+}
+}
+
+TEST_CASE(testPredicates)
+{
+    createTree(testName);
+
+    testPredicate(testName, sys::ExistsPredicate());
+    testPredicate(testName, sys::FileOnlyPredicate());
+    testPredicate(testName, sys::DirectoryOnlyPredicate());
+    testPredicate(testName, sys::FragmentPredicate("D1"));
+    testPredicate(testName, sys::FragmentPredicate("d1", false /*ignoreCase*/));
+    testPredicate(testName, sys::ExtensionPredicate(".xsd"));
+    testPredicate(testName, sys::ExtensionPredicate(".xsd", false /*ignoreCase*/));
+
+    sys::ExtensionPredicate extension(".xsd");
+    sys::FragmentPredicate fragment("d1");
+    sys::LogicalPredicate both(false /*orOperator*/);
+    both.addPredicate(&extension).addPredicate(&fragment);
+    testPredicate(testName, both);
+    testPredicate(testName, sys::NotPredicate(&both));
+
+    // a predicate that only knows about paths
+    struct LengthPredicate final : public sys::FilePredicate
+    {
+        bool operator()(const std::string& entry) const override
+        {
+            return entry.length() > 20;
+        }
+    };
+    testPredicate(testName, LengthPredicate());
+
+    removeTree();
+}
+
+TEST_CASE(testSearch)
+{
+    createTree(testName);
+
+    const sys::OS os;
+    const auto expected = reference(sys::ExtensionPredicate(".xsd"), { ROOT }, true /*recursive*/);
+    TEST_ASSERT(os.search({ ROOT }, "", ".xsd") == expected);
+    TEST_ASSERT(sorted(os.search({ ROOT }, "", ".xsd", true /*recursive*/, 4)) == sorted(expected));
+
+    sys::ExtensionPredicate extension(".xsd");
+    sys::FragmentPredicate fragment("d1");
+    sys::LogicalPredicate both(false /*orOperator*/);
+    both.addPredicate(&extension).addPredicate(&fragment);
+    TEST_ASSERT(os.search({ ROOT }, "d1", ".xsd") == reference(both, { ROOT }, true /*recursive*/));
+
+    removeTree();
+}
+
+TEST_CASE(testWalk)
+{
+    createTree(testName);
+
+    // every entry is seen exactly once, with the right type
+    std::mutex mutex;
+    std::vector<std::string> paths;
+    bool typesMatch = true;
+    sys::FileFinder::walk({ ROOT }, [&](const std::vector<sys::FileEntry>& entries)
+                          {
+                              std::lock_guard<std::mutex> lock(mutex);
+                              for (const auto& entry : entries)
+                              {
+                                  paths.push_back(entry.path);
+                                  typesMatch &= (entry.type == sys::FileEntry::Type::Directory) == sys::Path(entry.path).isDirectory();
+                                  typesMatch &= (entry.type == sys::FileEntry::Type::File) == sys::Path(entry.path).isFile();
+                              }
+                          },
+                          true /*recursive*/, 4);
+    TEST_ASSERT(sorted(paths) == sorted(reference(sys::ExistsPredicate(), { ROOT }, true /*recursive*/)));
+    TEST_ASSERT_TRUE(typesMatch);
+
+    // exceptions from the visitor stop the walk
+    for (const size_t numThreads : { 1, 4 })
+    {
+        bool caught = false;
+        try
+        {
+            sys::FileFinder::walk({ ROOT }, [&](const std::vector<sys::FileEntry>& entries)
+                                  {
+                                      if (entries.front().path != ROOT)
+                                      {
+                                          throw std::runtime_error("stop");
+                                      }
+                                  },
+                                  true /*recursive*/, numThreads);
+        }
+        catch (const std::runtime_error&)
+        {
+            caught = true;
+        }
+        TEST_ASSERT_TRUE(caught);
+    }
+
+    removeTree();
+}
+
+TEST_MAIN(
+    TEST_CHECK(testPredicates);
+    TEST_CHECK(testSearch);
+    TEST_CHECK(testWalk);
+)
@@ -22,7 +22,9 @@
 
 #include "tiff/ImageReader.h"
 
+#include <algorithm>
 #include <sstream>
+#include <vector>
 #include <import/io.h>
 #include <import/except.h>
 #include "tiff/Common.h"
@@ -165,6 +167,8 @@ void tiff::ImageReader::getTileData(unsigned char*buffer,
     sys::Uint32_T widthPadding = (tileByteWidth * tilesAcross) - imageByteWidth;
     sys::Uint32_T bufferOffset = 0;
 
+    // Gather the piece of each tile line we need, then read them all at once
+    std::vector<io::IoSegment> segments;
     while (numElementsToRead)
     {
         sys::Uint32_T bytesToRead = mElementSize * numElementsToRead;
@@ -199,11 +203,11 @@ void tiff::ImageReader::getTileData(unsigned char*buffer,
         sys::Uint32_T seekPos = (*(tiff::GenericType<sys::Uint32_T> *)(*tileOffsets)[tileIndex]) + (rowInTile * tileByteWidth)
                 + colInTile;
 
-        // Go to the offset.
-        mInput->seek(seekPos, io::Seekable::START);
-
-        // Read the data.
-        mInput->read((sys::byte *)buffer + bufferOffset, bytesToRead);
+        io::IoSegment segment;
+        segment.offset = seekPos;
+        segment.buffer = buffer + bufferOffset;
+        segment.length = bytesToRead;
+        segments.push_back(segment);
 
         // Update the strip position in bytes.
         mBytePosition += bytesToRead;
@@ -212,4 +216,31 @@ void tiff::ImageReader::getTileData(unsigned char*buffer,
         bufferOffset += bytesToRead;
         numElementsToRead -= (bytesToRead / mElementSize);
     }
+
+    try
+    {
+        mInput->readv(segments);
+    }
+    catch (const except::Exception&)
+    {
+        // A tile runs past the end of the file.  As ever, read what's
+        // there and leave zeros for the rest.
+        for (const auto& segment : segments)
+        {
+            auto segmentBuffer = static_cast<sys::byte*>(segment.buffer);
+            size_t numRead = 0;
+            while (numRead < segment.length)
+            {
+                const sys::SSize_T thisRead =
+                        mInput->readAt(segment.offset + numRead,
+                                       segmentBuffer + numRead,
+                                       segment.length - numRead);
+                if (thisRead <= 0)
+                    break;
+                numRead += static_cast<size_t>(thisRead);
+            }
+            std::fill_n(segmentBuffer + numRead, segment.length - numRead,
+                        static_cast<sys::byte>(0));
+        }
+    }
 }
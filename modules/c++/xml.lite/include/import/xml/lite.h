@@ -58,12 +58,15 @@
 #include "xml/lite/Attributes.h"
 #include "xml/lite/QName.h"
 #include "xml/lite/NamespaceStack.h"
+#include "xml/lite/DocumentArena.h"
 #include "xml/lite/Document.h"
 #include "xml/lite/Element.h"
+#include "xml/lite/ElementWriter.h"
 #include "xml/lite/XMLException.h"
 #include "xml/lite/XMLReader.h"
 #include "xml/lite/MinidomHandler.h"
 #include "xml/lite/MinidomParser.h"
+#include "xml/lite/PullReader.h"
 #include "xml/lite/Serializable.h"
 #include "xml/lite/Validator.h"
 
@@ -129,6 +129,16 @@ struct AttributeNode final
     std::string getQName() const;
     void getQName(xml::lite::QName&) const;
 
+    //! The name and value, without copying them
+    const xml::lite::QName& getQNameRef() const
+    {
+        return mName;
+    }
+    const std::string& getValueRef() const
+    {
+        return mValue;
+    }
+
 protected:
 
     QName mName;
@@ -42,6 +42,7 @@
 #include "coda_oss/string.h"
 #include "coda_oss/memory.h"
 
+#include "xml/lite/DocumentArena.h"
 #include "xml/lite/Element.h"
 #include "xml/lite/QName.h"
 
@@ -114,6 +115,36 @@ struct Document // SOAPDocument derives :-(
      */
     void destroy();
 
+    /*!
+     * Have createElement() (and so MinidomParser) place elements in an arena
+     * owned by this Document rather than allocating each one from the heap.
+     * Documents with many small nodes build and tear down much faster.
+     * The elements are ArenaElements, whose names are interned in the arena.
+     *
+     * Must be called while the document is empty.  Arena elements belong to
+     * the document: they may be removed or deleted as usual, but none may
+     * outlive it or be used after destroy() (which leaves the arena alone
+     * if the root isn't owned).  Stealing the root with getRootElement(true)
+     * hands back a copy on the heap.
+     *
+     * \param blockSize Size of each block the arena allocates
+     */
+    void useArena(size_t blockSize = DocumentArena::DEFAULT_BLOCK_SIZE);
+
+    //! \return The arena from useArena(), or nullptr
+    DocumentArena* getArena() const
+    {
+        return mArena.get();
+    }
+
+    /*!
+     * Index element lookups in this document's tree, including any tree
+     * later given to setRootElement() (or built by MinidomParser); see
+     * Element::useIndex().
+     * \param enable whether lookups should use the index
+     */
+    void useIndex(bool enable = true);
+
     /*!
      * Insert an element under this element.  Secretly, this
      * tree does not really care whether or not the element in
@@ -158,7 +189,13 @@ struct Document // SOAPDocument derives :-(
     Element *getRootElement(bool steal = false)
     {
         if (steal)
+        {
+            if (mArena && mRootNode && mOwnRoot)
+            {
+                stealArenaRoot();
+            }
             mOwnRoot = false;
+        }
         return mRootNode;
     }
     #ifndef SWIG // SWIG doesn't like std::unique_ptr
@@ -177,9 +214,14 @@ private:
     Document(const Document&);
     Document& operator=(const Document&);
 
+    //! Replace an arena root with a copy on the heap that the caller can own
+    void stealArenaRoot();
+
     //! The root node element
     Element *mRootNode;
     bool mOwnRoot;
+    std::unique_ptr<DocumentArena> mArena;
+    bool mUseIndex = false;
 };
 
 inline Element& getRootElement(Document& doc)
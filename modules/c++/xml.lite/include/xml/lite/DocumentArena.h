@@ -0,0 +1,176 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#ifndef CODA_OSS_xml_lite_DocumentArena_h_INCLUDED_
+#define CODA_OSS_xml_lite_DocumentArena_h_INCLUDED_
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "config/Exports.h"
+#include "xml/lite/Element.h"
+
+namespace xml
+{
+namespace lite
+{
+/*!
+ * \class DocumentArena
+ * \brief Bump allocator and name pool for the nodes of one Document
+ *
+ * Memory is handed out from large blocks and is only given back all at
+ * once, by reset() or the destructor.  intern() keeps one copy of each
+ * distinct string (element names, namespace URIs) so that names can be
+ * compared by address.
+ *
+ * A DocumentArena is not thread-safe.
+ */
+class CODA_OSS_API DocumentArena final
+{
+public:
+    enum
+    {
+        DEFAULT_BLOCK_SIZE = 64 * 1024
+    };
+
+    explicit DocumentArena(size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    DocumentArena(const DocumentArena&) = delete;
+    DocumentArena& operator=(const DocumentArena&) = delete;
+
+    /*!
+     * \param size Number of bytes needed
+     * \param alignment Alignment of the result; must be a power of two
+     * \return Memory that stays valid until reset() or destruction
+     */
+    void* allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+    /*!
+     * \return The pooled copy of str.  Equal strings always give the same
+     *         reference, valid until reset() or destruction.
+     */
+    const std::string& intern(const std::string& str);
+
+    /*!
+     * \return The pooled copy of str, or nullptr if str hasn't been
+     *         interned
+     */
+    const std::string* findInterned(const std::string& str) const;
+
+    /*!
+     * Give back everything allocated and interned.  The first block is kept
+     * for reuse.
+     */
+    void reset();
+
+    //! \return Number of bytes handed out by allocate() since the last reset
+    size_t getBytesAllocated() const
+    {
+        return mBytesAllocated;
+    }
+
+    //! \return Number of blocks currently held
+    size_t getNumBlocks() const
+    {
+        return mBlocks.size();
+    }
+
+private:
+    void addBlock(size_t minSize);
+
+    const size_t mBlockSize;
+    std::vector<std::unique_ptr<char[]> > mBlocks;
+    std::vector<size_t> mBlockSizes;
+    char* mCurrent = nullptr;
+    size_t mRemaining = 0;
+    size_t mBytesAllocated = 0;
+
+    // Nodes of an unordered_set don't move, so references stay valid
+    std::unordered_set<std::string> mNames;
+};
+
+#ifndef SWIG
+/*!
+ * \class ArenaElement
+ * \brief An Element that Document::createElement() placed in an arena
+ *
+ * The local name and URI are also interned in the arena, so lookups can
+ * compare them by address; renaming the element interns the new names.
+ * delete only runs the destructor, the memory going back when the arena
+ * is reset or destroyed.
+ */
+class CODA_OSS_API ArenaElement final : public Element
+{
+public:
+    ArenaElement(DocumentArena& arena, const std::string& qname,
+                 const std::string& uri);
+
+    ArenaElement(const ArenaElement&) = delete;
+    ArenaElement& operator=(const ArenaElement&) = delete;
+
+    DocumentArena& getArena() const
+    {
+        return mArena;
+    }
+
+    //! \return The arena's copy of getLocalName()
+    const std::string& getInternedLocalName() const
+    {
+        return *mLocalName;
+    }
+
+    //! \return The arena's copy of getUri()
+    const std::string& getInternedUri() const
+    {
+        return *mUri;
+    }
+
+    //! Intern the current names; Element calls this when they change
+    void internNames();
+
+    static void* operator new(size_t size, DocumentArena& arena)
+    {
+        return arena.allocate(size);
+    }
+    static void operator delete(void*) noexcept
+    {
+    }
+    //! Only called if the constructor throws
+    static void operator delete(void*, DocumentArena&) noexcept
+    {
+    }
+    static void* operator new(size_t) = delete;
+
+private:
+    DocumentArena& mArena;
+    const std::string* mLocalName = nullptr;
+    const std::string* mUri = nullptr;
+};
+#endif // SWIG
+}
+}
+
+#endif  // CODA_OSS_xml_lite_DocumentArena_h_INCLUDED_
@@ -24,8 +24,11 @@
 #define CODA_OSS_xml_lite_Element_h_INCLUDED_
 #pragma once
 
+#include <stddef.h>
+
 #include <memory>
 #include <string>
+#include <vector>
 #include <new> // std::nothrow_t
 #include <coda_oss/string.h>
 
@@ -96,6 +99,16 @@ struct Element // SOAPElement derives :-(
     //! Destroys any child elements.
     void destroyChildren();
 
+    #ifndef SWIG
+    /*!
+     * Elements come from mem::PoolAllocator, since documents make and free
+     * lots of them.  (Those a Document places in its arena are
+     * ArenaElements, which replace these.)
+     */
+    static void* operator new(size_t size);
+    static void operator delete(void* p, size_t size) noexcept;
+    #endif // SWIG
+
     // use clone() to duplicate an Element
     #if !(defined(SWIG) || defined(SWIGPYTHON) || defined(HAVE_PYTHON_H))  // SWIG needs these
     //private: // encoded as part of the C++ name mangling by some compilers
@@ -107,7 +120,7 @@ struct Element // SOAPElement derives :-(
     #endif
 
     Element(Element&&) = default;
-    Element& operator=(Element&&) = default;
+    Element& operator=(Element&&);
 
     /*!
      *  Clone function performs deep copy
@@ -152,6 +165,24 @@ struct Element // SOAPElement derives :-(
         }
     }
 
+    /*!
+     *  Speed up repeated getElementsByTagName(), getElementByTagName() and
+     *  hasElement() lookups anywhere in the tree holding this element.
+     *  The tree gets one index, shared by all of its elements: lookups on
+     *  an element cache its children (and, for recursive lookups, all of
+     *  its descendants) by interned URI and local name.  Any change to the
+     *  tree by addChild(), removeChild(), destroyChildren() or renaming an
+     *  element just marks the index out of date, and the cache is rebuilt
+     *  by the next lookup; changes made directly to the vector returned by
+     *  getChildren() aren't seen.  Elements added to a tree take on its
+     *  index (or lack of one).
+     *
+     *  Lookups in an indexed tree may be made from several threads at once,
+     *  as long as nothing changes the tree meanwhile.
+     *  \param enable whether lookups should use the index
+     */
+    void useIndex(bool enable = true);
+
     /*!
      *  Get the elements by tag name
      *  \param qname the QName
@@ -307,6 +338,12 @@ struct Element // SOAPElement derives :-(
     std::string getCharacterData() const;
     coda_oss::u8string& getCharacterData(coda_oss::u8string& result) const;
 
+    //! The character data, without copying it
+    const coda_oss::u8string& getCharacterDataRef() const
+    {
+        return mCharacterData;
+    }
+
     /*!
      *  Sets the character data for this element.
      *  \param characters The data to add to this element
@@ -327,6 +364,7 @@ struct Element // SOAPElement derives :-(
     void setLocalName(const std::string& localName)
     {
         mName.setName(localName);
+        nameChanged();
     }
 
     /*!
@@ -345,10 +383,12 @@ struct Element // SOAPElement derives :-(
     void setQName(const std::string& qname)
     {
         mName.setQName(qname);
+        nameChanged();
     }
     void setQName(const xml::lite::QName& qname)
     {
         mName = qname;
+        nameChanged();
     }
 
     /*!
@@ -366,6 +406,12 @@ struct Element // SOAPElement derives :-(
         result = mName;
     }
 
+    //! The QName, without copying it
+    const xml::lite::QName& getQNameRef() const
+    {
+        return mName;
+    }
+
     /*!
      *  Sets the URI for this element.
      *  \param uri the data to add to this element
@@ -373,6 +419,7 @@ struct Element // SOAPElement derives :-(
     void setUri(const xml::lite::Uri& uri)
     {
         mName.setAssociatedUri(uri);
+        nameChanged();
     }
     void setUri(const std::string& uri)
     {
@@ -417,6 +464,14 @@ struct Element // SOAPElement derives :-(
     virtual Element& addChild(mem::auto_ptr<Element> node);
     #endif
 
+    /*!
+     *  Removes a child element WITHOUT destroying it; the caller
+     *  becomes responsible for deleting it.
+     *  \param node the child element to remove
+     *  \return true if node was a child of this element
+     */
+    bool removeChild(const Element* node);
+
     /*!
      *  Returns all of the children of this element
      *  \return the children of this element
@@ -441,6 +496,7 @@ struct Element // SOAPElement derives :-(
     void clearChildren()
     {
         mChildren.clear();
+        treeChanged();
     }
 
     Element* getParent() const
@@ -469,10 +525,22 @@ private:
 
     void depthPrint(io::OutputStream& stream, int depth, const std::string& formatter, bool isConsoleOutput = false) const;
 
+    //! Marks the tree's index (if any) out of date
+    void treeChanged();
+    //! Like treeChanged(), after this element's local name or URI changed
+    void nameChanged();
+    bool findIndexed(const std::string* uri, const std::string& localName,
+                     std::vector<Element*>& elements, bool recurse) const;
+
     Element* mParent = nullptr;
     //! The attributes for this element
     xml::lite::Attributes mAttributes;
     coda_oss::u8string mCharacterData;
+
+    // Shared by every element of an indexed tree; see useIndex()
+    struct Index;
+    std::shared_ptr<Index> mIndex;
+    void shareIndex(const std::shared_ptr<Index>& index);
 };
 
 Element& add(const xml::lite::QName&, const std::string& value, Element& parent);
@@ -0,0 +1,119 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#ifndef CODA_OSS_xml_lite_ElementWriter_h_INCLUDED_
+#define CODA_OSS_xml_lite_ElementWriter_h_INCLUDED_
+#pragma once
+
+#include <stddef.h>
+
+#include <string>
+
+#include "config/Exports.h"
+#include "io/OutputStream.h"
+#include "xml/lite/Element.h"
+
+namespace xml
+{
+namespace lite
+{
+/*!
+ * \class ElementWriter
+ * \brief Buffered serialization of an Element tree
+ *
+ * Produces the same UTF-8 text as Element::print() (or prettyPrint() when
+ * a formatter is given), but builds it in one buffer that is reused from
+ * call to call and handed to the stream with a single write.  Optionally,
+ * markup characters in character data and attribute values are escaped,
+ * and the subtrees below the root are serialized on separate threads.
+ */
+class CODA_OSS_API ElementWriter final
+{
+public:
+    struct Options final
+    {
+        /*!
+         * Indentation for each level, as with prettyPrint() (including
+         * its trailing newline); empty for compact output like print().
+         */
+        std::string formatter;
+
+        /*!
+         * Write '&', '<' and '>' in character data (and '"' in attribute
+         * values) as entity references.  Off by default to match print(),
+         * which writes them as-is.
+         */
+        bool escape = false;
+
+        /*!
+         * Threads for serializing the root's children; each thread gets a
+         * contiguous run of them, which are concatenated in order.
+         */
+        size_t numThreads = 1;
+    };
+
+    ElementWriter() = default;
+    explicit ElementWriter(const Options& options);
+
+    ElementWriter(const ElementWriter&) = delete;
+    ElementWriter& operator=(const ElementWriter&) = delete;
+    ElementWriter(ElementWriter&&) = default;
+    ElementWriter& operator=(ElementWriter&&) = default;
+
+    /*!
+     * Serialize element to stream
+     * \param element  Root of the tree to write
+     * \param stream   Receives the text in one write() call
+     */
+    void write(const Element& element, io::OutputStream& stream);
+
+    /*!
+     * Serialize element into the internal buffer
+     * \return The text; valid until the next call on this writer
+     */
+    const std::string& toString(const Element& element);
+
+    /*!
+     * Append the serialization of element to buffer
+     */
+    void append(const Element& element, std::string& buffer) const;
+
+    /*!
+     * Append text to buffer, escaping it the way character data
+     * (or, with isAttribute, an attribute value) is escaped.
+     */
+    static void appendEscaped(const std::string& text,
+                              std::string& buffer,
+                              bool isAttribute = false);
+
+private:
+    void append(const Element&, size_t depth, std::string&) const;
+    void appendChildren(const Element&, size_t depth, std::string&) const;
+    static void appendQName(const QName&, std::string&);
+
+    Options mOptions;
+    std::string mBuffer;
+};
+}
+}
+
+#endif  // CODA_OSS_xml_lite_ElementWriter_h_INCLUDED_
@@ -0,0 +1,243 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#ifndef CODA_OSS_xml_lite_PullReader_h_INCLUDED_
+#define CODA_OSS_xml_lite_PullReader_h_INCLUDED_
+#pragma once
+
+#include <stddef.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "config/Exports.h"
+#include "coda_oss/span.h"
+#include "io/InputStream.h"
+#include "sys/Conf.h"
+#include "xml/lite/Element.h"
+#include "xml/lite/NamespaceStack.h"
+
+namespace xml
+{
+namespace lite
+{
+/*!
+ * \class PullReader
+ * \brief Streaming, non-validating reader for large documents
+ *
+ * Unlike MinidomParser, nothing is kept beyond the current event: the
+ * caller asks for one start-element, end-element or text event at a time
+ * and gets back views into a reusable buffer.  Parts of the document that
+ * are wanted as a DOM can be built with readElement(), and parts that
+ * aren't can be passed over with skipElement() or nextElement().
+ *
+ * Input must be UTF-8 (or ASCII).  The predefined and numeric character
+ * references are decoded; DTDs are skipped, so entities declared in them
+ * aren't supported.
+ *
+ * Views returned by the accessors are only valid until the next call that
+ * moves the reader.
+ */
+class CODA_OSS_API PullReader final
+{
+public:
+    enum
+    {
+        DEFAULT_BUFFER_SIZE = 64 * 1024
+    };
+
+    enum EventType
+    {
+        START_ELEMENT,
+        END_ELEMENT,
+        CHARACTERS,
+        END_DOCUMENT
+    };
+
+    typedef coda_oss::span<const char> View;
+    typedef std::function<bool(const PullReader&)> Predicate;
+
+    /*!
+     * \param input The document; it is read as needed, not all at once
+     * \param bufferSize Initial buffer size; it grows to hold larger tokens
+     */
+    explicit PullReader(io::InputStream& input,
+                        size_t bufferSize = DEFAULT_BUFFER_SIZE);
+
+    PullReader(const PullReader&) = delete;
+    PullReader& operator=(const PullReader&) = delete;
+
+    /*!
+     * Move to the next event.  Text outside of the root element,
+     * comments and processing instructions are not reported.
+     * \return The new event type; END_DOCUMENT once the root element ends
+     * \throw XMLParseException if the document isn't well-formed
+     */
+    EventType next();
+
+    //! \return The type of the current event
+    EventType getEventType() const
+    {
+        return mEvent;
+    }
+
+    //! \return Nesting depth of the current element; the root is at 1
+    size_t getDepth() const
+    {
+        return mDepth;
+    }
+
+    /*!
+     * \return The local names of the current element and its ancestors,
+     *         e.g. "/root/item/name"
+     */
+    std::string getPath() const;
+
+    //! \return The current element's qualified name (START/END_ELEMENT)
+    View getQName() const;
+
+    //! \return The current element's local name (START/END_ELEMENT)
+    View getLocalName() const;
+
+    //! \return The current element's namespace URI (START/END_ELEMENT)
+    const std::string& getUri() const;
+
+    //! \return Number of attributes on the current START_ELEMENT
+    size_t getNumAttributes() const
+    {
+        return mAttributes.size();
+    }
+
+    //! \return The qualified name of attribute i
+    View getAttributeQName(size_t i) const;
+
+    //! \return The (decoded) value of attribute i
+    View getAttributeValue(size_t i) const;
+
+    //! \return The namespace URI of attribute i
+    std::string getAttributeUri(size_t i) const;
+
+    /*!
+     * \param qname Qualified name of the attribute to look for
+     * \param value Set to the attribute's value if it's found
+     * \return Whether the current START_ELEMENT has the attribute
+     */
+    bool getAttributeValue(const std::string& qname, View& value) const;
+
+    //! \return The (decoded) text of the current CHARACTERS event
+    View getText() const;
+
+    /*!
+     * Pass over the rest of the current START_ELEMENT, including all of its
+     * content, leaving the reader on its END_ELEMENT.  Skipped content is
+     * only scanned for tags, not decoded or fully checked.
+     */
+    void skipElement();
+
+    /*!
+     * Build the current START_ELEMENT and its content into an Element,
+     * leaving the reader on its END_ELEMENT.  Character data is handled as
+     * in MinidomParser.
+     * \param preserveCharacterData If false, character data is trimmed
+     */
+    std::unique_ptr<Element> readElement(bool preserveCharacterData = false);
+
+    /*!
+     * Move to the next START_ELEMENT for which predicate returns true.
+     * \return false if the end of the document is reached first
+     */
+    bool nextElement(const Predicate& predicate);
+
+    /*!
+     * Move to the next START_ELEMENT matching path.  Steps are local names
+     * separated by '/', and "*" matches any name.  A path starting with '/'
+     * is matched from the root, and elements that can't contain a match are
+     * skipped with skipElement(); otherwise the path matches the innermost
+     * elements at any depth, e.g. "item/name".
+     * \return false if the end of the document is reached first
+     */
+    bool nextElement(const std::string& path);
+
+private:
+    struct Range final
+    {
+        size_t offset;
+        size_t length;
+    };
+    struct Attribute final
+    {
+        Range qname;
+        Range value;
+    };
+
+    const char* data(size_t offset) const
+    {
+        return mBuffer.data() + offset;
+    }
+    View view(const Range& range) const
+    {
+        return View(data(range.offset), range.length);
+    }
+
+    bool readMore();
+    bool ensure(size_t size);
+    size_t find(char c, size_t from);
+    size_t find(const char* pattern, size_t patternSize, size_t from);
+    size_t findTagEnd(size_t from);
+    size_t findDeclarationEnd(size_t from);
+
+    void popElement();
+    EventType readText();
+    EventType readStartTag(size_t tagEnd);
+    EventType readEndTag(size_t tagEnd);
+    void readDeclaration();
+    size_t decode(size_t offset, size_t length, bool isAttribute);
+    void checkCurrent(bool isAllowed, const char* function) const;
+    std::string getPrefixUri(const std::string& prefix) const;
+    void fail(const std::string& message) const;
+
+    io::InputStream& mInput;
+    std::vector<char> mBuffer;
+    //! Unconsumed data is in [mPosition, mEnd)
+    size_t mPosition = 0;
+    size_t mEnd = 0;
+    bool mEndOfInput = false;
+    //! Bytes dropped from the front of mBuffer, for error messages
+    sys::Off_T mDiscarded = 0;
+
+    EventType mEvent = END_DOCUMENT;
+    bool mStarted = false;
+    bool mPendingEnd = false;  // <empty/> still needs its END_ELEMENT
+    bool mPendingPop = false;  // the last END_ELEMENT hasn't been popped
+    size_t mDepth = 0;
+    std::vector<std::string> mNames;
+    std::vector<std::string> mUris;
+    NamespaceStack mNamespaces;
+    std::vector<Attribute> mAttributes;
+    Range mText{};
+};
+}
+}
+
+#endif  // CODA_OSS_xml_lite_PullReader_h_INCLUDED_
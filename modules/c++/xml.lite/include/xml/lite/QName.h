@@ -166,6 +166,16 @@ public:
      */
     std::string getPrefix() const;
 
+    //!  The prefix and local name, without copying them
+    const std::string& getPrefixRef() const
+    {
+        return mPrefix;
+    }
+    const std::string& getNameRef() const
+    {
+        return mLocalName;
+    }
+
     /*!
      *  Retrieve the qname as a string.  If you have no prefix/uri
      *  this returns just the local name
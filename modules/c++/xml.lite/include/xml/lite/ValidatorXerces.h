@@ -28,6 +28,7 @@
 #ifdef USE_XERCES
 
 #include <memory>
+#include <mutex>
 #include <vector>
 #include <coda_oss/string.h>
 
@@ -146,6 +147,74 @@ private:
     std::unique_ptr<xml::lite::ValidationErrorHandler> mErrorHandler;
     std::unique_ptr<xercesc::DOMLSParser> mValidator;
 
+    //! mValidator and mErrorHandler handle one document at a time
+    mutable std::mutex mMutex;
+};
+
+/*!
+ * \class ValidatorPool
+ * \brief Schema validation of many documents at once
+ *
+ * The schemas are loaded once into a grammar pool which is then locked,
+ * so that it can be shared by any number of parsers.  Each validate() call
+ * checks out a parser of its own, creating one only when all of the
+ * existing ones are busy, so calls from different threads run in parallel
+ * instead of one after another.
+ */
+class ValidatorPool : public ValidatorInterface
+{
+    XercesContext mCtxt;    //! this must be the first member listed
+
+public:
+
+    /*!
+     *  Constructor
+     *  \param schemaPaths  Vector of both paths and singular schemas
+     *                      Note: All schemas must end in *.xsd
+     *  \param log          Logger for reporting errors
+     *  \param recursive    Do a recursive search for schemas on directory
+     *                      input
+     */
+    ValidatorPool(const std::vector<std::string>& schemaPaths,
+                  logging::Logger* log,
+                  bool recursive = true);
+    ValidatorPool(const std::vector<coda_oss::filesystem::path>&,
+                  logging::Logger* log,
+                  bool recursive = true);
+    ~ValidatorPool();
+
+    ValidatorPool(const ValidatorPool&) = delete;
+    ValidatorPool& operator=(const ValidatorPool&) = delete;
+    ValidatorPool(ValidatorPool&&) = delete;
+    ValidatorPool& operator=(ValidatorPool&&) = delete;
+
+    using ValidatorInterface::validate;
+
+    /*!
+     *  Validation against the shared schema pool; safe to call from
+     *  several threads at once.
+     *  \param xml     The xml document string to validate
+     *  \param xmlID   Identifier for this input xml within the error log
+     *  \param errors  Object for returning errors found (errors are appended)
+     */
+    bool validate(const std::string& xml,
+                  const std::string& xmlID,
+                  std::vector<ValidationInfo>& errors) const override;
+    bool validate(const coda_oss::u8string&, const std::string& xmlID, std::vector<ValidationInfo>&) const override;
+    bool validate(const str::W1252string&, const std::string& xmlID, std::vector<ValidationInfo>&) const override;
+
+    //! \return Number of parsers created; the most validate() calls seen at once
+    size_t getNumParsers() const;
+
+private:
+    struct Parser;
+    std::unique_ptr<Parser> newParser() const;
+
+    std::unique_ptr<xercesc::XMLGrammarPool> mSchemaPool;
+
+    mutable std::mutex mMutex;
+    mutable std::vector<std::unique_ptr<Parser> > mIdleParsers;
+    mutable size_t mNumParsers = 0;
 };
 
 //! stream the entire log -- newline separated
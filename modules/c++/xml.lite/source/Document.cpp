@@ -24,16 +24,55 @@
 
 #include <stdexcept>
 
+#include "except/Exception.h"
+
 void xml::lite::Document::setRootElement(Element * element, bool own)
 {
-    destroy();
+    // Not destroy(): a new root may already be living in the arena
+    remove(mRootNode);
     mOwnRoot = own;
     mRootNode = element;
+    if (mUseIndex && (mRootNode != nullptr))
+    {
+        mRootNode->useIndex();
+    }
 }
 
 void xml::lite::Document::destroy()
 {
+    // A root we don't own may be living in the arena
+    const bool ownRoot = mOwnRoot || (mRootNode == nullptr);
     remove(mRootNode);
+    if (mArena && ownRoot)
+    {
+        mArena->reset();
+    }
+}
+
+void xml::lite::Document::useArena(size_t blockSize)
+{
+    if (mRootNode != nullptr)
+    {
+        throw except::Exception(Ctxt("useArena() requires an empty document"));
+    }
+    mArena = coda_oss::make_unique<DocumentArena>(blockSize);
+}
+
+void xml::lite::Document::useIndex(bool enable)
+{
+    mUseIndex = enable;
+    if (mRootNode != nullptr)
+    {
+        mRootNode->useIndex(enable);
+    }
+}
+
+void xml::lite::Document::stealArenaRoot()
+{
+    auto heapRoot = coda_oss::make_unique<Element>();
+    heapRoot->clone(*mRootNode);
+    destroy();
+    mRootNode = heapRoot.release();
 }
 
 void xml::lite::Document::remove(Element * toDelete)
@@ -49,8 +88,15 @@ void xml::lite::Document::remove(Element * toDelete)
         remove(toDelete, mRootNode);
 }
 
-static std::unique_ptr<xml::lite::Element> newElement(const std::string& qname, const std::string& uri)
+static std::unique_ptr<xml::lite::Element> newElement(const std::string& qname, const std::string& uri,
+                                                      xml::lite::DocumentArena* arena)
 {
+    if (arena != nullptr)
+    {
+        return std::unique_ptr<xml::lite::Element>(
+                new (*arena) xml::lite::ArenaElement(*arena, qname, uri));
+    }
+
     std::unique_ptr<xml::lite::Element> elem(new xml::lite::Element());
     elem->setQName(qname);
     //std::cout << "qname: " << qname << std::endl;
@@ -58,29 +104,30 @@ static std::unique_ptr<xml::lite::Element> newElement(const std::string& qname,
     elem->setUri(uri);
     return elem;
 }
-static std::unique_ptr<xml::lite::Element>newElement(const xml::lite::QName& qname)
+static std::unique_ptr<xml::lite::Element>newElement(const xml::lite::QName& qname,
+                                                     xml::lite::DocumentArena* arena)
 {
-    return newElement(qname.getName(), qname.getAssociatedUri());
+    return newElement(qname.getName(), qname.getAssociatedUri(), arena);
 }
 
 xml::lite::Element* xml::lite::Document::createElement(const std::string& qname, const std::string& uri,
                                    std::string characterData)
 {
-    auto elem = newElement(qname, uri);
+    auto elem = newElement(qname, uri, mArena.get());
     elem->setCharacterData(characterData);
     return elem.release();
 }
 std::unique_ptr<xml::lite::Element> xml::lite::Document::createElement(const QName& qname,
                                    const coda_oss::u8string& characterData) const
 {
-    auto elem = newElement(qname);
+    auto elem = newElement(qname, mArena.get());
     elem->setCharacterData(characterData);
     return elem;
 }
 std::unique_ptr<xml::lite::Element> xml::lite::Document::createElement(const QName& qname,
                                     const std::string& characterData) const
 {
-    auto elem = newElement(qname);
+    auto elem = newElement(qname, mArena.get());
     elem->setCharacterData(characterData);
     return elem;
 }
@@ -103,7 +150,7 @@ void xml::lite::Document::remove(xml::lite::Element * toDelete,
         {
             if (*i == toDelete)
             {
-                fromHere->getChildren().erase(i);
+                fromHere->removeChild(toDelete);
                 delete toDelete;
                 toDelete = NULL;
                 return;
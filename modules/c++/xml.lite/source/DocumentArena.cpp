@@ -0,0 +1,118 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "xml/lite/DocumentArena.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+
+#include "except/Exception.h"
+#include "sys/Conf.h"
+
+namespace
+{
+// Bytes needed to bring address up to a multiple of alignment
+size_t getPadding(const char* address, size_t alignment)
+{
+    const uintptr_t misalignment =
+            reinterpret_cast<uintptr_t>(address) & (alignment - 1);
+    return misalignment == 0 ? 0 : static_cast<size_t>(alignment - misalignment);
+}
+}
+
+xml::lite::DocumentArena::DocumentArena(size_t blockSize) :
+    mBlockSize(std::max<size_t>(blockSize, 1024))
+{
+}
+
+void* xml::lite::DocumentArena::allocate(size_t size, size_t alignment)
+{
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+    {
+        throw except::InvalidArgumentException(
+                Ctxt("alignment must be a power of two"));
+    }
+
+    size_t padding = getPadding(mCurrent, alignment);
+    if (mCurrent == nullptr || padding + size > mRemaining)
+    {
+        addBlock(size + alignment);
+        padding = getPadding(mCurrent, alignment);
+    }
+
+    void* const result = mCurrent + padding;
+    mCurrent += padding + size;
+    mRemaining -= padding + size;
+    mBytesAllocated += size;
+    return result;
+}
+
+const std::string& xml::lite::DocumentArena::intern(const std::string& str)
+{
+    return *mNames.insert(str).first;
+}
+
+const std::string* xml::lite::DocumentArena::findInterned(
+        const std::string& str) const
+{
+    const auto it = mNames.find(str);
+    return it == mNames.end() ? nullptr : &*it;
+}
+
+void xml::lite::DocumentArena::reset()
+{
+    mNames.clear();
+    mBytesAllocated = 0;
+
+    if (mBlocks.empty())
+    {
+        return;
+    }
+    mBlocks.resize(1);
+    mBlockSizes.resize(1);
+    mCurrent = mBlocks[0].get();
+    mRemaining = mBlockSizes[0];
+}
+
+void xml::lite::DocumentArena::addBlock(size_t minSize)
+{
+    const size_t size = std::max(mBlockSize, minSize);
+    mBlocks.push_back(std::unique_ptr<char[]>(new char[size]));
+    mBlockSizes.push_back(size);
+    mCurrent = mBlocks.back().get();
+    mRemaining = size;
+}
+
+xml::lite::ArenaElement::ArenaElement(DocumentArena& arena,
+                                      const std::string& qname,
+                                      const std::string& uri) :
+    Element(qname, uri), mArena(arena)
+{
+    internNames();
+}
+
+void xml::lite::ArenaElement::internNames()
+{
+    mLocalName = &mArena.intern(mName.getName());
+    mUri = &mArena.intern(mName.getUri().value);
+}
@@ -22,17 +22,130 @@
 
 #include <assert.h>
 
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <stdexcept>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <std/string>
 
 #include "xml/lite/Element.h"
+#include "xml/lite/DocumentArena.h"
 #include <import/str.h>
 #include <import/mem.h>
+#include <mem/PoolAllocator.h>
 #include <sys/OS.h>
 #include <str/Encoding.h>
 #include <str/EncodedStringView.h>
 
+// One index serves a whole tree.  Changing the tree only bumps the
+// generation; lookups are cached per element, and the caches are thrown
+// away by the first lookup after a change.
+struct xml::lite::Element::Index final
+{
+    // Matches for one local name: all of them in document order, and the
+    // same elements split up by URI.  Names are interned, so they're keyed
+    // by address.
+    struct Matches final
+    {
+        std::vector<Element*> all;
+        std::unordered_map<const std::string*, std::vector<Element*> > byUri;
+    };
+    typedef std::unordered_map<const std::string*, Matches> Lookup;
+
+    // Names are interned in the arena of the element being looked up, if
+    // it has one, so its ArenaElements' names can be used as they are.
+    struct Names final
+    {
+        DocumentArena* arena;
+        std::unordered_set<std::string>& pool;
+
+        const std::string* intern(const std::string& str)
+        {
+            return arena ? &arena->intern(str) : &*pool.insert(str).first;
+        }
+        const std::string* find(const std::string& str) const
+        {
+            if (arena)
+            {
+                return arena->findInterned(str);
+            }
+            const auto it = pool.find(str);
+            return it == pool.end() ? nullptr : &*it;
+        }
+    };
+
+    std::atomic<size_t> generation{0};
+
+    // Lookups are const, so building a cache mustn't race with another
+    // thread doing a lookup in the same tree.
+    std::mutex mutex;
+    size_t cachedGeneration = 0;
+    std::unordered_map<const Element*, Lookup> childLookups;
+    std::unordered_map<const Element*, Lookup> descendantLookups;
+    std::unordered_set<std::string> pool;
+
+    // Same (pre-)order as the unindexed search
+    static void addChildren(const Element& parent, bool recurse,
+                            Names& names, Lookup& lookup)
+    {
+        for (auto child : parent.mChildren)
+        {
+            const std::string* localName;
+            const std::string* uri;
+            const auto arenaChild = dynamic_cast<const ArenaElement*>(child);
+            if (arenaChild && &arenaChild->getArena() == names.arena)
+            {
+                localName = &arenaChild->getInternedLocalName();
+                uri = &arenaChild->getInternedUri();
+            }
+            else
+            {
+                localName = names.intern(child->mName.getName());
+                uri = names.intern(child->mName.getUri().value);
+            }
+
+            Matches& matches = lookup[localName];
+            matches.all.push_back(child);
+            matches.byUri[uri].push_back(child);
+            if (recurse)
+            {
+                addChildren(*child, recurse, names, lookup);
+            }
+        }
+    }
+
+    static const std::vector<Element*>* find(const Lookup& lookup,
+                                             const Names& names,
+                                             const std::string* uri,
+                                             const std::string& localName)
+    {
+        const auto byName = lookup.find(names.find(localName));
+        if (byName == lookup.end())
+        {
+            return nullptr;
+        }
+        if (uri == nullptr)
+        {
+            return &byName->second.all;
+        }
+        const auto uris = byName->second.byUri.find(names.find(*uri));
+        return uris == byName->second.byUri.end() ? nullptr : &uris->second;
+    }
+};
+
+void* xml::lite::Element::operator new(size_t size)
+{
+    return mem::PoolAllocator::allocate(size);
+}
+void xml::lite::Element::operator delete(void* p, size_t size) noexcept
+{
+    mem::PoolAllocator::deallocate(p, size);
+}
+
 std::unique_ptr<xml::lite::Element> xml::lite::Element::create(const std::string& qname, const std::string& uri, const std::string& characterData)
 {
     return coda_oss::make_unique<Element>(qname, uri, characterData);
@@ -59,6 +172,20 @@ xml::lite::Element& xml::lite::Element::operator=(const xml::lite::Element& node
         mAttributes = node.mAttributes;
         mChildren = node.mChildren;
         mParent = node.mParent;
+        nameChanged();
+    }
+    return *this;
+}
+xml::lite::Element& xml::lite::Element::operator=(xml::lite::Element&& node)
+{
+    if (this != &node)
+    {
+        mName = std::move(node.mName);
+        mCharacterData = std::move(node.mCharacterData);
+        mAttributes = std::move(node.mAttributes);
+        mChildren = std::move(node.mChildren);
+        mParent = node.mParent;
+        nameChanged();
     }
     return *this;
 }
@@ -80,11 +207,100 @@ void xml::lite::Element::clone(const xml::lite::Element& node)
     }
 }
 
+void xml::lite::Element::useIndex(bool enable)
+{
+    Element* root = this;
+    while (root->mParent != nullptr)
+    {
+        root = root->mParent;
+    }
+    if (enable != (root->mIndex != nullptr))
+    {
+        root->shareIndex(enable ? std::make_shared<Index>() : nullptr);
+    }
+}
+
+void xml::lite::Element::shareIndex(const std::shared_ptr<Index>& index)
+{
+    mIndex = index;
+    for (auto child : mChildren)
+    {
+        if (child->mIndex != index)
+        {
+            child->shareIndex(index);
+        }
+    }
+}
+
+void xml::lite::Element::treeChanged()
+{
+    if (mIndex)
+    {
+        ++mIndex->generation;
+    }
+}
+
+void xml::lite::Element::nameChanged()
+{
+    if (auto arenaElement = dynamic_cast<ArenaElement*>(this))
+    {
+        arenaElement->internNames();
+    }
+    treeChanged();
+}
+
+bool xml::lite::Element::findIndexed(const std::string* uri,
+                                     const std::string& localName,
+                                     std::vector<Element*>& elements,
+                                     bool recurse) const
+{
+    if (!mIndex)
+    {
+        return false;
+    }
+
+    Index& index = *mIndex;
+    const auto arenaElement = dynamic_cast<const ArenaElement*>(this);
+    Index::Names names{arenaElement ? &arenaElement->getArena() : nullptr,
+                       index.pool};
+
+    std::lock_guard<std::mutex> lock(index.mutex);
+    const size_t generation = index.generation;
+    if (index.cachedGeneration != generation)
+    {
+        index.childLookups.clear();
+        index.descendantLookups.clear();
+        index.pool.clear();
+        index.cachedGeneration = generation;
+    }
+
+    auto& lookups = recurse ? index.descendantLookups : index.childLookups;
+    auto lookup = lookups.find(this);
+    if (lookup == lookups.end())
+    {
+        lookup = lookups.emplace(this, Index::Lookup()).first;
+        Index::addChildren(*this, recurse, names, lookup->second);
+    }
+
+    const auto matches = Index::find(lookup->second, names, uri, localName);
+    if (matches != nullptr)
+    {
+        elements.insert(elements.end(), matches->begin(), matches->end());
+    }
+    return true;
+}
+
 bool xml::lite::Element::hasElement(const QName& qname) const
 {
     const auto uri = qname.getUri().value;
     const auto localName = qname.getName();
 
+    std::vector<Element*> elements;
+    if (findIndexed(&uri, localName, elements, false /*recurse*/))
+    {
+        return !elements.empty();
+    }
+
     for (unsigned int i = 0; i < mChildren.size(); i++)
     {
         if (mChildren[i]->getUri() == uri&& mChildren[i]->getLocalName()
@@ -96,6 +312,11 @@ bool xml::lite::Element::hasElement(const QName& qname) const
 
 bool xml::lite::Element::hasElement(const std::string& localName) const
 {
+    std::vector<Element*> elements;
+    if (findIndexed(nullptr, localName, elements, false /*recurse*/))
+    {
+        return !elements.empty();
+    }
 
     for (unsigned int i = 0; i < mChildren.size(); i++)
     {
@@ -109,6 +330,10 @@ void xml::lite::Element::getElementsByTagName(const QName& n, std::vector<Elemen
 {
     const auto uri = n.getUri().value;
     const auto localName = n.getName();
+    if (findIndexed(&uri, localName, elements, recurse))
+    {
+        return;
+    }
 
     for (unsigned int i = 0; i < mChildren.size(); i++)
     {
@@ -162,6 +387,11 @@ void xml::lite::Element::getElementsByTagName(const std::string& localName,
                                               std::vector<Element*>& elements,
                                               bool recurse) const 
 {
+    if (findIndexed(nullptr, localName, elements, recurse))
+    {
+        return;
+    }
+
     for (unsigned int i = 0; i < mChildren.size(); i++)
     {
         if (mChildren[i]->getLocalName() == localName)
@@ -218,6 +448,10 @@ xml::lite::Element& xml::lite::Element::getElementByTagNameNS(
 
 void xml::lite::Element::destroyChildren()
 {
+    if (!mChildren.empty())
+    {
+        treeChanged();
+    }
     // While something is in vector
     while (mChildren.size())
     {
@@ -335,6 +569,11 @@ void xml::lite::Element::addChild(xml::lite::Element * node)
 {
     mChildren.push_back(node);
     node->setParent(this);
+    if (node->mIndex != mIndex)
+    {
+        node->shareIndex(mIndex);
+    }
+    treeChanged();
 }
 
 xml::lite::Element& xml::lite::Element::addChild(std::unique_ptr<xml::lite::Element>&& node)
@@ -350,6 +589,23 @@ xml::lite::Element& xml::lite::Element::addChild(mem::auto_ptr<xml::lite::Elemen
 }
 #endif
 
+bool xml::lite::Element::removeChild(const Element* node)
+{
+    const auto it = std::find(mChildren.begin(), mChildren.end(), node);
+    if (it == mChildren.end())
+    {
+        return false;
+    }
+
+    // The detached subtree keeps sharing the index, which at worst means
+    // needless rebuilds; unsharing it would mean walking the whole subtree.
+    Element* const child = *it;
+    mChildren.erase(it);
+    child->setParent(nullptr);
+    treeChanged();
+    return true;
+}
+
 void xml::lite::Element::changePrefix(Element* element,
     const std::string& prefix, const std::string& uri)
 {
@@ -389,6 +645,7 @@ void xml::lite::Element::changeURI(Element* element,
     if (element->mName.getPrefix() == prefix)
     {
         element->mName.setAssociatedUri(uri);
+        element->nameChanged();
     }
 
     // Traverse backward to support removing nodes
@@ -440,6 +697,7 @@ void xml::lite::Element::setNamespaceURI(
     str::trim(prefix);
     auto uri = uri_.value;
     changeURI(this, prefix, uri);
+    treeChanged();
 
     // Add namespace definition
     ::xml::lite::Attributes& attr = getAttributes();
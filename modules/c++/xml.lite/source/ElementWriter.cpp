@@ -0,0 +1,255 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "xml/lite/ElementWriter.h"
+
+#include <stdint.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <mt/Runnable1D.h>
+
+namespace
+{
+// Non-zero if any byte of v is zero
+inline uint64_t hasZeroByte(uint64_t v)
+{
+    return (v - 0x0101010101010101ULL) & ~v & 0x8080808080808080ULL;
+}
+inline uint64_t repeatByte(char c)
+{
+    return 0x0101010101010101ULL * static_cast<unsigned char>(c);
+}
+
+const char* getEntity(char c, bool isAttribute)
+{
+    switch (c)
+    {
+    case '&': return "&amp;";
+    case '<': return "&lt;";
+    case '>': return "&gt;";
+    case '"': return isAttribute ? "&quot;" : nullptr;
+    default: return nullptr;
+    }
+}
+
+void appendEscaped(const char* text, size_t length, bool isAttribute,
+                   std::string& buffer)
+{
+    // Check eight bytes at a time; nearly all text has nothing to escape,
+    // and a word without any markup characters is skipped in one step.
+    const uint64_t amp = repeatByte('&');
+    const uint64_t lt = repeatByte('<');
+    const uint64_t gt = repeatByte('>');
+    const uint64_t quot = isAttribute ? repeatByte('"') : amp;
+
+    size_t runStart = 0; // first character not yet copied to buffer
+    size_t ii = 0;
+    while (ii < length)
+    {
+        if (ii + sizeof(uint64_t) <= length)
+        {
+            uint64_t word;
+            memcpy(&word, text + ii, sizeof(word));
+            if (!(hasZeroByte(word ^ amp) | hasZeroByte(word ^ lt) |
+                  hasZeroByte(word ^ gt) | hasZeroByte(word ^ quot)))
+            {
+                ii += sizeof(word);
+                continue;
+            }
+        }
+
+        const size_t end = std::min(ii + sizeof(uint64_t), length);
+        for (; ii < end; ++ii)
+        {
+            const char* const entity = getEntity(text[ii], isAttribute);
+            if (entity)
+            {
+                buffer.append(text + runStart, ii - runStart);
+                buffer += entity;
+                runStart = ii + 1;
+            }
+        }
+    }
+    buffer.append(text + runStart, length - runStart);
+}
+}
+
+namespace xml
+{
+namespace lite
+{
+ElementWriter::ElementWriter(const Options& options) :
+    mOptions(options)
+{
+}
+
+void ElementWriter::write(const Element& element, io::OutputStream& stream)
+{
+    const auto& text = toString(element);
+    stream.write(text.data(), text.size());
+}
+
+const std::string& ElementWriter::toString(const Element& element)
+{
+    mBuffer.clear(); // keeps the capacity from last time
+    append(element, mBuffer);
+    return mBuffer;
+}
+
+void ElementWriter::append(const Element& element, std::string& buffer) const
+{
+    append(element, 0, buffer);
+    if (!mOptions.formatter.empty())
+    {
+        buffer += '\n';
+    }
+}
+
+void ElementWriter::appendEscaped(const std::string& text,
+                                  std::string& buffer,
+                                  bool isAttribute)
+{
+    ::appendEscaped(text.data(), text.size(), isAttribute, buffer);
+}
+
+void ElementWriter::appendQName(const QName& name, std::string& buffer)
+{
+    const auto& prefix = name.getPrefixRef();
+    if (!prefix.empty())
+    {
+        buffer += prefix;
+        buffer += ':';
+    }
+    buffer += name.getNameRef();
+}
+
+void ElementWriter::append(const Element& element,
+                           size_t depth,
+                           std::string& buffer) const
+{
+    const auto appendPrefix = [&]()
+    {
+        for (size_t ii = 0; ii < depth; ++ii)
+        {
+            buffer += mOptions.formatter;
+        }
+    };
+
+    appendPrefix();
+    buffer += '<';
+    appendQName(element.getQNameRef(), buffer);
+
+    const auto& attributes = element.getAttributes();
+    for (int ii = 0; ii < attributes.getLength(); ++ii)
+    {
+        const auto& attribute = attributes.getNode(ii);
+        buffer += ' ';
+        appendQName(attribute.getQNameRef(), buffer);
+        buffer += "=\"";
+        if (mOptions.escape)
+        {
+            appendEscaped(attribute.getValueRef(), buffer, true /*isAttribute*/);
+        }
+        else
+        {
+            buffer += attribute.getValueRef();
+        }
+        buffer += '"';
+    }
+
+    const auto& characterData = element.getCharacterDataRef();
+    const auto& children = element.getChildren();
+    if (characterData.empty() && children.empty())
+    {
+        buffer += "/>";
+        return;
+    }
+
+    buffer += '>';
+    const auto text = reinterpret_cast<const char*>(characterData.data());
+    if (mOptions.escape)
+    {
+        ::appendEscaped(text, characterData.size(), false /*isAttribute*/, buffer);
+    }
+    else
+    {
+        buffer.append(text, characterData.size());
+    }
+
+    appendChildren(element, depth, buffer);
+
+    if (!children.empty() && !mOptions.formatter.empty())
+    {
+        buffer += '\n';
+        appendPrefix();
+    }
+    buffer += "</";
+    appendQName(element.getQNameRef(), buffer);
+    buffer += '>';
+}
+
+void ElementWriter::appendChildren(const Element& element,
+                                   size_t depth,
+                                   std::string& buffer) const
+{
+    const auto& children = element.getChildren();
+    const auto appendChild = [&](const Element& child, std::string& out)
+    {
+        if (!mOptions.formatter.empty())
+        {
+            out += '\n';
+        }
+        append(child, depth + 1, out);
+    };
+
+    // Only the root's children are split up: that's where the big,
+    // independent subtrees are, and it keeps the number of pieces small.
+    if (depth > 0 || mOptions.numThreads <= 1 || children.size() < 2)
+    {
+        for (const auto child : children)
+        {
+            appendChild(*child, buffer);
+        }
+        return;
+    }
+
+    std::vector<std::string> pieces(children.size());
+    mt::run1D(children.size(),
+              std::min(mOptions.numThreads, children.size()),
+              [&](size_t ii) { appendChild(*children[ii], pieces[ii]); });
+
+    size_t size = buffer.size();
+    for (const auto& piece : pieces)
+    {
+        size += piece.size();
+    }
+    buffer.reserve(size);
+    for (const auto& piece : pieces)
+    {
+        buffer += piece;
+    }
+}
+}
+}
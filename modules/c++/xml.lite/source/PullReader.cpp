@@ -0,0 +1,1006 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include "xml/lite/PullReader.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include <except/Exception.h>
+#include <str/Convert.h>
+#include <str/Encoding.h>
+#include <str/Manip.h>
+#include "xml/lite/XMLException.h"
+
+namespace
+{
+const size_t NOT_FOUND = static_cast<size_t>(-1);
+const char XML_URI[] = "http://www.w3.org/XML/1998/namespace";
+const char XMLNS_URI[] = "http://www.w3.org/2000/xmlns/";
+
+inline bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+inline bool equals(xml::lite::PullReader::View view, const char* s, size_t size)
+{
+    return view.size() == size && memcmp(view.data(), s, size) == 0;
+}
+
+inline bool startsWith(xml::lite::PullReader::View view, const char* s, size_t size)
+{
+    return view.size() >= size && memcmp(view.data(), s, size) == 0;
+}
+
+// "prefix:local" -> "local"
+xml::lite::PullReader::View localName(xml::lite::PullReader::View qname)
+{
+    const void* colon = memchr(qname.data(), ':', qname.size());
+    if (colon == nullptr)
+    {
+        return qname;
+    }
+    const auto prefixSize = static_cast<const char*>(colon) - qname.data() + 1;
+    return xml::lite::PullReader::View(qname.data() + prefixSize, qname.size() - prefixSize);
+}
+
+std::string prefix(xml::lite::PullReader::View qname)
+{
+    const void* colon = memchr(qname.data(), ':', qname.size());
+    return colon == nullptr ? std::string() :
+            std::string(qname.data(), static_cast<const char*>(colon) - qname.data());
+}
+
+inline std::string toString(xml::lite::PullReader::View view)
+{
+    return std::string(view.data(), view.size());
+}
+
+// Always fits: a character reference is at least as long as its UTF-8
+size_t encodeUtf8(unsigned long c, char* out)
+{
+    if (c < 0x80)
+    {
+        out[0] = static_cast<char>(c);
+        return 1;
+    }
+    if (c < 0x800)
+    {
+        out[0] = static_cast<char>(0xC0 | (c >> 6));
+        out[1] = static_cast<char>(0x80 | (c & 0x3F));
+        return 2;
+    }
+    if (c < 0x10000)
+    {
+        out[0] = static_cast<char>(0xE0 | (c >> 12));
+        out[1] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (c & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (c >> 18));
+    out[1] = static_cast<char>(0x80 | ((c >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((c >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (c & 0x3F));
+    return 4;
+}
+}
+
+xml::lite::PullReader::PullReader(io::InputStream& input, size_t bufferSize) :
+    mInput(input),
+    mBuffer(std::max<size_t>(bufferSize, 16))
+{
+}
+
+bool xml::lite::PullReader::readMore()
+{
+    if (mEndOfInput)
+    {
+        return false;
+    }
+
+    // Keep the unconsumed data, at the front of the buffer
+    if (mPosition > 0)
+    {
+        memmove(mBuffer.data(), data(mPosition), mEnd - mPosition);
+        mEnd -= mPosition;
+        mDiscarded += mPosition;
+        mPosition = 0;
+    }
+    if (mEnd == mBuffer.size())
+    {
+        mBuffer.resize(mBuffer.size() * 2);
+    }
+
+    const auto numRead = mInput.read(mBuffer.data() + mEnd, mBuffer.size() - mEnd);
+    if (numRead <= 0)
+    {
+        mEndOfInput = true;
+        return false;
+    }
+    mEnd += static_cast<size_t>(numRead);
+    return true;
+}
+
+bool xml::lite::PullReader::ensure(size_t size)
+{
+    while (mEnd - mPosition < size)
+    {
+        if (!readMore())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// The find functions work with offsets from mPosition, which stay valid when
+// readMore() moves the data.
+size_t xml::lite::PullReader::find(char c, size_t from)
+{
+    for (;;)
+    {
+        const size_t available = mEnd - mPosition;
+        if (from < available)
+        {
+            const void* found = memchr(data(mPosition + from), c, available - from);
+            if (found != nullptr)
+            {
+                return static_cast<const char*>(found) - data(mPosition);
+            }
+            from = available;
+        }
+        if (!readMore())
+        {
+            return NOT_FOUND;
+        }
+    }
+}
+
+size_t xml::lite::PullReader::find(const char* pattern, size_t patternSize, size_t from)
+{
+    for (;;)
+    {
+        const size_t available = mEnd - mPosition;
+        while (from + patternSize <= available)
+        {
+            const void* found = memchr(data(mPosition + from), pattern[0],
+                                       available - from - patternSize + 1);
+            if (found == nullptr)
+            {
+                from = available - patternSize + 1;
+                break;
+            }
+            const size_t offset = static_cast<const char*>(found) - data(mPosition);
+            if (memcmp(found, pattern, patternSize) == 0)
+            {
+                return offset;
+            }
+            from = offset + 1;
+        }
+        if (!readMore())
+        {
+            return NOT_FOUND;
+        }
+    }
+}
+
+size_t xml::lite::PullReader::findTagEnd(size_t from)
+{
+    // '>' is allowed in attribute values
+    char quote = 0;
+    for (;;)
+    {
+        const size_t available = mEnd - mPosition;
+        for (; from < available; ++from)
+        {
+            const char c = *data(mPosition + from);
+            if (quote != 0)
+            {
+                if (c == quote)
+                {
+                    quote = 0;
+                }
+            }
+            else if (c == '>')
+            {
+                return from;
+            }
+            else if (c == '"' || c == '\'')
+            {
+                quote = c;
+            }
+        }
+        if (!readMore())
+        {
+            return NOT_FOUND;
+        }
+    }
+}
+
+size_t xml::lite::PullReader::findDeclarationEnd(size_t from)
+{
+    // <!DOCTYPE ... [ <!ENTITY ... > ... ]>
+    char quote = 0;
+    size_t depth = 0;
+    for (;;)
+    {
+        const size_t available = mEnd - mPosition;
+        for (; from < available; ++from)
+        {
+            const char c = *data(mPosition + from);
+            if (quote != 0)
+            {
+                if (c == quote)
+                {
+                    quote = 0;
+                }
+            }
+            else if (c == '"' || c == '\'')
+            {
+                quote = c;
+            }
+            else if (c == '[')
+            {
+                ++depth;
+            }
+            else if (c == ']' && depth > 0)
+            {
+                --depth;
+            }
+            else if (c == '>' && depth == 0)
+            {
+                return from;
+            }
+        }
+        if (!readMore())
+        {
+            return NOT_FOUND;
+        }
+    }
+}
+
+void xml::lite::PullReader::fail(const std::string& message) const
+{
+    throw XMLParseException(Ctxt(message + " at byte " +
+                                 str::toString(mDiscarded + static_cast<sys::Off_T>(mPosition))));
+}
+
+void xml::lite::PullReader::checkCurrent(bool isAllowed, const char* function) const
+{
+    if (!isAllowed)
+    {
+        throw XMLException(Ctxt(std::string(function) +
+                                "() isn't allowed for the current event"));
+    }
+}
+
+std::string xml::lite::PullReader::getPrefixUri(const std::string& prefix) const
+{
+    if (prefix == "xml")
+    {
+        return XML_URI;
+    }
+    if (prefix == "xmlns")
+    {
+        return XMLNS_URI;
+    }
+    return mNamespaces.getMapping(prefix);
+}
+
+void xml::lite::PullReader::popElement()
+{
+    mNamespaces.pop();
+    --mDepth;
+    mPendingPop = false;
+}
+
+xml::lite::PullReader::EventType xml::lite::PullReader::next()
+{
+    mAttributes.clear();
+    if (mPendingPop)
+    {
+        popElement();
+    }
+    if (mPendingEnd)
+    {
+        mPendingEnd = false;
+        mPendingPop = true;
+        return mEvent = END_ELEMENT;
+    }
+
+    for (;;)
+    {
+        if (!ensure(1))
+        {
+            if (!mStarted || mDepth > 0)
+            {
+                fail("Unexpected end of document");
+            }
+            return mEvent = END_DOCUMENT;
+        }
+
+        if (*data(mPosition) != '<')
+        {
+            if (mDepth > 0)
+            {
+                return readText();
+            }
+
+            // Only whitespace is allowed around the root element
+            size_t end = find('<', 0);
+            if (end == NOT_FOUND)
+            {
+                end = mEnd - mPosition;
+            }
+            const size_t skipBOM = (mDiscarded == 0 && mPosition == 0 && end >= 3 &&
+                                    memcmp(data(0), "\xEF\xBB\xBF", 3) == 0) ? 3 : 0;
+            for (size_t ii = skipBOM; ii < end; ++ii)
+            {
+                if (!isSpace(*data(mPosition + ii)))
+                {
+                    mPosition += ii;
+                    fail("Text outside of the root element");
+                }
+            }
+            mPosition += end;
+            continue;
+        }
+
+        ensure(9);
+        const View token(data(mPosition), mEnd - mPosition);
+        if (startsWith(token, "<?", 2))
+        {
+            const size_t end = find("?>", 2, 2);
+            if (end == NOT_FOUND)
+            {
+                fail("Unterminated processing instruction");
+            }
+            if (!mStarted && end > 5 && memcmp(data(mPosition), "<?xml", 5) == 0 &&
+                isSpace(*data(mPosition + 5)))
+            {
+                readDeclaration();
+            }
+            mPosition += end + 2;
+        }
+        else if (startsWith(token, "<!--", 4))
+        {
+            const size_t end = find("-->", 3, 4);
+            if (end == NOT_FOUND)
+            {
+                fail("Unterminated comment");
+            }
+            mPosition += end + 3;
+        }
+        else if (startsWith(token, "<![CDATA[", 9))
+        {
+            if (mDepth == 0)
+            {
+                fail("CDATA outside of the root element");
+            }
+            const size_t end = find("]]>", 3, 9);
+            if (end == NOT_FOUND)
+            {
+                fail("Unterminated CDATA section");
+            }
+            mText.offset = mPosition + 9;
+            mText.length = end - 9;
+            mPosition += end + 3;
+            return mEvent = CHARACTERS;
+        }
+        else if (startsWith(token, "<!", 2))
+        {
+            if (mStarted)
+            {
+                fail("Unexpected declaration");
+            }
+            const size_t end = findDeclarationEnd(2);
+            if (end == NOT_FOUND)
+            {
+                fail("Unterminated declaration");
+            }
+            mPosition += end + 1;
+        }
+        else
+        {
+            if (mStarted && mDepth == 0)
+            {
+                fail("Content after the root element");
+            }
+            const size_t tagEnd = findTagEnd(1);
+            if (tagEnd == NOT_FOUND)
+            {
+                fail("Unterminated tag");
+            }
+            return *data(mPosition + 1) == '/' ? readEndTag(tagEnd) :
+                                                 readStartTag(tagEnd);
+        }
+    }
+}
+
+void xml::lite::PullReader::readDeclaration()
+{
+    // <?xml version="1.0" encoding="..."?> is at mPosition
+    const size_t end = find("?>", 2, 5);
+    const std::string declaration(data(mPosition), end);
+    const auto pos = declaration.find("encoding");
+    if (pos == std::string::npos)
+    {
+        return;
+    }
+    const auto quote = declaration.find_first_of("\"'", pos);
+    if (quote == std::string::npos)
+    {
+        fail("Malformed XML declaration");
+    }
+    const auto close = declaration.find(declaration[quote], quote + 1);
+    if (close == std::string::npos)
+    {
+        fail("Malformed XML declaration");
+    }
+    auto encoding = declaration.substr(quote + 1, close - quote - 1);
+    str::lower(encoding);
+    if (encoding != "utf-8" && encoding != "utf8" &&
+        encoding != "us-ascii" && encoding != "ascii")
+    {
+        throw XMLNotSupportedException(Ctxt("Unsupported encoding: " + encoding));
+    }
+}
+
+xml::lite::PullReader::EventType xml::lite::PullReader::readText()
+{
+    size_t end = find('<', 0);
+    if (end == NOT_FOUND)
+    {
+        // Reported by the next call
+        end = mEnd - mPosition;
+    }
+    mText.offset = mPosition;
+    mText.length = decode(mPosition, end, false /*isAttribute*/);
+    mPosition += end;
+    return mEvent = CHARACTERS;
+}
+
+xml::lite::PullReader::EventType xml::lite::PullReader::readStartTag(size_t tagEnd)
+{
+    const size_t begin = mPosition;
+    auto at = [&](size_t i) { return *data(begin + i); };
+
+    size_t end = tagEnd;
+    const bool isEmpty = at(end - 1) == '/';
+    if (isEmpty)
+    {
+        --end;
+    }
+
+    size_t i = 1;
+    while (i < end && !isSpace(at(i)))
+    {
+        ++i;
+    }
+    if (i == 1)
+    {
+        fail("Missing element name");
+    }
+    const Range name{ begin + 1, i - 1 };
+
+    for (;;)
+    {
+        while (i < end && isSpace(at(i)))
+        {
+            ++i;
+        }
+        if (i >= end)
+        {
+            break;
+        }
+
+        Attribute attribute;
+        attribute.qname.offset = begin + i;
+        while (i < end && at(i) != '=' && !isSpace(at(i)))
+        {
+            ++i;
+        }
+        attribute.qname.length = begin + i - attribute.qname.offset;
+        while (i < end && isSpace(at(i)))
+        {
+            ++i;
+        }
+        if (i >= end || at(i) != '=')
+        {
+            fail("Attribute without a value");
+        }
+        ++i;
+        while (i < end && isSpace(at(i)))
+        {
+            ++i;
+        }
+        if (i >= end || (at(i) != '"' && at(i) != '\''))
+        {
+            fail("Attribute value must be quoted");
+        }
+        const char quote = at(i++);
+        const size_t valueStart = i;
+        while (i < end && at(i) != quote)
+        {
+            ++i;
+        }
+        if (i >= end)
+        {
+            fail("Unterminated attribute value");
+        }
+        attribute.value.offset = begin + valueStart;
+        attribute.value.length = decode(begin + valueStart, i - valueStart, true /*isAttribute*/);
+        ++i;
+        mAttributes.push_back(attribute);
+    }
+
+    ++mDepth;
+    if (mNames.size() < mDepth)
+    {
+        mNames.resize(mDepth);
+        mUris.resize(mDepth);
+    }
+    mNames[mDepth - 1].assign(data(name.offset), name.length);
+
+    mNamespaces.push();
+    for (const auto& attribute : mAttributes)
+    {
+        const auto qname = view(attribute.qname);
+        if (equals(qname, "xmlns", 5))
+        {
+            mNamespaces.newMapping("", toString(view(attribute.value)));
+        }
+        else if (startsWith(qname, "xmlns:", 6))
+        {
+            mNamespaces.newMapping(std::string(qname.data() + 6, qname.size() - 6),
+                                   toString(view(attribute.value)));
+        }
+    }
+    const auto elementPrefix = prefix(View(mNames[mDepth - 1].data(), mNames[mDepth - 1].size()));
+    mUris[mDepth - 1] = getPrefixUri(elementPrefix);
+    if (!elementPrefix.empty() && mUris[mDepth - 1].empty())
+    {
+        fail("Undeclared namespace prefix '" + elementPrefix + "'");
+    }
+
+    mStarted = true;
+    mPendingEnd = isEmpty;
+    mPosition += tagEnd + 1;
+    return mEvent = START_ELEMENT;
+}
+
+xml::lite::PullReader::EventType xml::lite::PullReader::readEndTag(size_t tagEnd)
+{
+    size_t end = tagEnd;
+    while (end > 2 && isSpace(*data(mPosition + end - 1)))
+    {
+        --end;
+    }
+    const View name(data(mPosition + 2), end - 2);
+    if (mDepth == 0)
+    {
+        fail("Unexpected end tag");
+    }
+    const auto& expected = mNames[mDepth - 1];
+    if (!equals(name, expected.data(), expected.size()))
+    {
+        fail("Expected </" + expected + "> but got </" + toString(name) + ">");
+    }
+
+    mPosition += tagEnd + 1;
+    mPendingPop = true;
+    return mEvent = END_ELEMENT;
+}
+
+size_t xml::lite::PullReader::decode(size_t offset, size_t length, bool isAttribute)
+{
+    char* const begin = mBuffer.data() + offset;
+    const char* const end = begin + length;
+
+    // Most text doesn't need anything done to it
+    if (memchr(begin, '&', length) == nullptr && memchr(begin, '\r', length) == nullptr &&
+        (!isAttribute || (memchr(begin, '\n', length) == nullptr &&
+                          memchr(begin, '\t', length) == nullptr)))
+    {
+        return length;
+    }
+
+    // Decoding only ever shrinks the text, so it's done in place
+    const char* in = begin;
+    char* out = begin;
+    while (in < end)
+    {
+        const char c = *in;
+        if (c == '&')
+        {
+            const char* const semicolon =
+                    static_cast<const char*>(memchr(in, ';', end - in));
+            if (semicolon == nullptr)
+            {
+                fail("Unterminated character reference");
+            }
+            const View reference(in + 1, semicolon - in - 1);
+            if (startsWith(reference, "#", 1))
+            {
+                const bool isHex = startsWith(reference, "#x", 2);
+                unsigned long value = 0;
+                size_t ii = isHex ? 2 : 1;
+                if (ii == reference.size())
+                {
+                    fail("Malformed character reference");
+                }
+                for (; ii < reference.size() && value <= 0x10FFFF; ++ii)
+                {
+                    const char digit = reference[ii];
+                    if (digit >= '0' && digit <= '9')
+                    {
+                        value = value * (isHex ? 16 : 10) + (digit - '0');
+                    }
+                    else if (isHex && digit >= 'a' && digit <= 'f')
+                    {
+                        value = value * 16 + (digit - 'a' + 10);
+                    }
+                    else if (isHex && digit >= 'A' && digit <= 'F')
+                    {
+                        value = value * 16 + (digit - 'A' + 10);
+                    }
+                    else
+                    {
+                        fail("Malformed character reference");
+                    }
+                }
+                if (value == 0 || value > 0x10FFFF)
+                {
+                    fail("Character reference out of range");
+                }
+                out += encodeUtf8(value, out);
+            }
+            else if (equals(reference, "lt", 2))
+            {
+                *out++ = '<';
+            }
+            else if (equals(reference, "gt", 2))
+            {
+                *out++ = '>';
+            }
+            else if (equals(reference, "amp", 3))
+            {
+                *out++ = '&';
+            }
+            else if (equals(reference, "apos", 4))
+            {
+                *out++ = '\'';
+            }
+            else if (equals(reference, "quot", 4))
+            {
+                *out++ = '"';
+            }
+            else
+            {
+                throw XMLNotSupportedException(Ctxt("Undeclared entity: &" +
+                                                    toString(reference) + ";"));
+            }
+            in = semicolon + 1;
+        }
+        else if (c == '\r')
+        {
+            // Line ends are normalized to "\n"
+            *out++ = isAttribute ? ' ' : '\n';
+            if (++in < end && *in == '\n')
+            {
+                ++in;
+            }
+        }
+        else if (isAttribute && (c == '\n' || c == '\t'))
+        {
+            *out++ = ' ';
+            ++in;
+        }
+        else
+        {
+            *out++ = *in++;
+        }
+    }
+    return out - begin;
+}
+
+std::string xml::lite::PullReader::getPath() const
+{
+    std::string path;
+    for (size_t ii = 0; ii < mDepth; ++ii)
+    {
+        const auto name = localName(View(mNames[ii].data(), mNames[ii].size()));
+        path += '/';
+        path.append(name.data(), name.size());
+    }
+    return path;
+}
+
+xml::lite::PullReader::View xml::lite::PullReader::getQName() const
+{
+    checkCurrent(mEvent == START_ELEMENT || mEvent == END_ELEMENT, "getQName");
+    const auto& name = mNames[mDepth - 1];
+    return View(name.data(), name.size());
+}
+
+xml::lite::PullReader::View xml::lite::PullReader::getLocalName() const
+{
+    return localName(getQName());
+}
+
+const std::string& xml::lite::PullReader::getUri() const
+{
+    checkCurrent(mEvent == START_ELEMENT || mEvent == END_ELEMENT, "getUri");
+    return mUris[mDepth - 1];
+}
+
+xml::lite::PullReader::View xml::lite::PullReader::getAttributeQName(size_t i) const
+{
+    return view(mAttributes.at(i).qname);
+}
+
+xml::lite::PullReader::View xml::lite::PullReader::getAttributeValue(size_t i) const
+{
+    return view(mAttributes.at(i).value);
+}
+
+std::string xml::lite::PullReader::getAttributeUri(size_t i) const
+{
+    const auto qname = getAttributeQName(i);
+    if (equals(qname, "xmlns", 5))
+    {
+        return XMLNS_URI;
+    }
+    // Unprefixed attributes aren't in any namespace
+    const auto attributePrefix = prefix(qname);
+    return attributePrefix.empty() ? std::string() : getPrefixUri(attributePrefix);
+}
+
+bool xml::lite::PullReader::getAttributeValue(const std::string& qname, View& value) const
+{
+    for (const auto& attribute : mAttributes)
+    {
+        if (equals(view(attribute.qname), qname.data(), qname.size()))
+        {
+            value = view(attribute.value);
+            return true;
+        }
+    }
+    return false;
+}
+
+xml::lite::PullReader::View xml::lite::PullReader::getText() const
+{
+    checkCurrent(mEvent == CHARACTERS, "getText");
+    return view(mText);
+}
+
+void xml::lite::PullReader::skipElement()
+{
+    checkCurrent(mEvent == START_ELEMENT, "skipElement");
+    mAttributes.clear();
+    if (mPendingEnd)
+    {
+        next();
+        return;
+    }
+
+    // Only look at tags, and just enough to keep track of the depth
+    for (size_t depth = 1;;)
+    {
+        const size_t start = find('<', 0);
+        if (start == NOT_FOUND)
+        {
+            fail("Unexpected end of document");
+        }
+        mPosition += start;
+
+        ensure(9);
+        const View token(data(mPosition), mEnd - mPosition);
+        size_t end = NOT_FOUND;
+        size_t endSize = 1;
+        if (startsWith(token, "<!--", 4))
+        {
+            end = find("-->", 3, 4);
+            endSize = 3;
+        }
+        else if (startsWith(token, "<![CDATA[", 9))
+        {
+            end = find("]]>", 3, 9);
+            endSize = 3;
+        }
+        else if (startsWith(token, "<?", 2))
+        {
+            end = find("?>", 2, 2);
+            endSize = 2;
+        }
+        else
+        {
+            end = findTagEnd(1);
+            if (end != NOT_FOUND)
+            {
+                if (*data(mPosition + 1) == '/')
+                {
+                    if (--depth == 0)
+                    {
+                        readEndTag(end);
+                        return;
+                    }
+                }
+                else if (*data(mPosition + end - 1) != '/')
+                {
+                    ++depth;
+                }
+            }
+        }
+        if (end == NOT_FOUND)
+        {
+            fail("Unexpected end of document");
+        }
+        mPosition += end + endSize;
+    }
+}
+
+std::unique_ptr<xml::lite::Element> xml::lite::PullReader::readElement(bool preserveCharacterData)
+{
+    checkCurrent(mEvent == START_ELEMENT, "readElement");
+
+    auto newElement = [&]() {
+        auto element = coda_oss::make_unique<Element>(toString(getQName()), getUri());
+        for (size_t ii = 0; ii < getNumAttributes(); ++ii)
+        {
+            AttributeNode attribute;
+            attribute.setQName(toString(getAttributeQName(ii)));
+            attribute.setUri(getAttributeUri(ii));
+            attribute.setValue(toString(getAttributeValue(ii)));
+            element->getAttributes().add(attribute);
+        }
+        return element;
+    };
+
+    // Character data is only what's directly in each element
+    auto root = newElement();
+    std::vector<Element*> elements(1, root.get());
+    std::vector<std::string> characterData(1);
+    while (!elements.empty())
+    {
+        switch (next())
+        {
+        case START_ELEMENT:
+            elements.push_back(&elements.back()->addChild(newElement()));
+            characterData.emplace_back();
+            break;
+
+        case CHARACTERS:
+        {
+            const auto text = getText();
+            characterData.back().append(text.data(), text.size());
+            break;
+        }
+
+        case END_ELEMENT:
+        {
+            auto u8 = str::to_u8string(
+                    reinterpret_cast<coda_oss::u8string::const_pointer>(characterData.back().data()),
+                    characterData.back().size());
+            if (!preserveCharacterData && !u8.empty())
+            {
+                str::trim(u8);
+            }
+            elements.back()->setCharacterData(std::move(u8));
+            elements.pop_back();
+            characterData.pop_back();
+            break;
+        }
+
+        case END_DOCUMENT:
+            fail("Unexpected end of document");
+        }
+    }
+    return root;
+}
+
+bool xml::lite::PullReader::nextElement(const Predicate& predicate)
+{
+    for (;;)
+    {
+        switch (next())
+        {
+        case START_ELEMENT:
+            if (predicate(*this))
+            {
+                return true;
+            }
+            break;
+        case END_DOCUMENT:
+            return false;
+        default:
+            break;
+        }
+    }
+}
+
+bool xml::lite::PullReader::nextElement(const std::string& path)
+{
+    const bool isAbsolute = !path.empty() && path[0] == '/';
+    const auto steps = str::split(isAbsolute ? path.substr(1) : path, "/");
+    if (steps.empty() ||
+        std::find(steps.begin(), steps.end(), std::string()) != steps.end())
+    {
+        throw except::InvalidArgumentException(Ctxt("Invalid path: '" + path + "'"));
+    }
+
+    // Does the element at depth (1-based) match steps[step]?
+    auto matches = [&](size_t depth, size_t step) {
+        const auto& name = mNames[depth - 1];
+        return steps[step] == "*" ||
+               equals(localName(View(name.data(), name.size())),
+                      steps[step].data(), steps[step].size());
+    };
+
+    for (;;)
+    {
+        switch (next())
+        {
+        case START_ELEMENT:
+        {
+            bool isMatch = mDepth >= steps.size();
+            if (isAbsolute)
+            {
+                bool isPrefix = mDepth <= steps.size();
+                for (size_t depth = 1; isPrefix && depth <= mDepth; ++depth)
+                {
+                    isPrefix = matches(depth, depth - 1);
+                }
+                isMatch = isPrefix && mDepth == steps.size();
+                if (!isPrefix)
+                {
+                    // Nothing inside can match
+                    skipElement();
+                }
+            }
+            else if (isMatch)
+            {
+                for (size_t ii = 0; ii < steps.size(); ++ii)
+                {
+                    if (!matches(mDepth - ii, steps.size() - 1 - ii))
+                    {
+                        isMatch = false;
+                        break;
+                    }
+                }
+            }
+            if (isMatch)
+            {
+                return true;
+            }
+            break;
+        }
+        case END_DOCUMENT:
+            return false;
+        default:
+            break;
+        }
+    }
+}
@@ -29,7 +29,6 @@
 
 #include <sys/OS.h>
 #include <io/StringStream.h>
-#include <mem/ScopedArray.h>
 #include <str/EncodedStringView.h>
 #include <str/utf8.h>
 
@@ -39,6 +38,8 @@ namespace fs = std::filesystem;
 #ifdef USE_XERCES
 #include <xml/lite/ValidatorXerces.h>
 
+#include <xercesc/framework/Wrapper4InputSource.hpp>
+
 namespace xml
 {
 namespace lite
@@ -96,33 +97,26 @@ ValidatorXerces::ValidatorXerces(
     ValidatorXerces(convert(schemaPaths), log, recursive)
 {
 }
-ValidatorXerces::ValidatorXerces(
-    const std::vector<std::string>& schemaPaths, 
-    logging::Logger* log,
-    bool recursive) :
-    ValidatorInterface(schemaPaths, log, recursive)
+// A validating parser that takes its schemas from schemaPool
+static std::unique_ptr<xercesc::DOMLSParser> newValidator(
+        xercesc::XMLGrammarPool& schemaPool,
+        ValidationErrorHandler& errorHandler)
 {
-    // add each schema into a grammar pool --
-    // this allows reuse
-    mSchemaPool.reset(
-        new xercesc::XMLGrammarPoolImpl(
-            xercesc::XMLPlatformUtils::fgMemoryManager));
-
     const XMLCh ls_id [] = {xercesc::chLatin_L, 
                             xercesc::chLatin_S, 
                             xercesc::chNull};
 
     // create the validator
-    mValidator.reset(
+    std::unique_ptr<xercesc::DOMLSParser> validator(
         xercesc::DOMImplementationRegistry::
             getDOMImplementation (ls_id)->createLSParser(
                 xercesc::DOMImplementationLS::MODE_SYNCHRONOUS,
                 0, 
                 xercesc::XMLPlatformUtils::fgMemoryManager,
-                mSchemaPool.get()));
+                &schemaPool));
 
     // set the configuration settings
-    xercesc::DOMConfiguration* config = mValidator->getDomConfig();
+    xercesc::DOMConfiguration* config = validator->getDomConfig();
     config->setParameter(xercesc::XMLUni::fgDOMComments, false);
     config->setParameter(xercesc::XMLUni::fgDOMDatatypeNormalization, true);
     config->setParameter(xercesc::XMLUni::fgDOMEntities, false);
@@ -147,12 +141,20 @@ ValidatorXerces::ValidatorXerces(
     config->setParameter(xercesc::XMLUni::fgXercesUserAdoptsDOMDocument, true);
 
     // add a error handler we still have control over
-    mErrorHandler.reset(
-            new ValidationErrorHandler());
     config->setParameter(xercesc::XMLUni::fgDOMErrorHandler, 
-                         mErrorHandler.get());
+                         &errorHandler);
+
+    return validator;
+}
 
-    // load our schemas --
+// Load the schemas through validator into its grammar pool, then lock the
+// pool: no additional schemas will be loaded after this point!
+static void loadSchemas(xercesc::DOMLSParser& validator,
+                        xercesc::XMLGrammarPool& schemaPool,
+                        const std::vector<std::string>& schemaPaths,
+                        logging::Logger* log,
+                        bool recursive)
+{
     // search each directory for schemas
     sys::OS os;
     std::vector<std::string> schemas = 
@@ -161,93 +163,101 @@ ValidatorXerces::ValidatorXerces(
     //  add the schema to the validator
     for (size_t i = 0; i < schemas.size(); ++i)
     {
-        if (!mValidator->loadGrammar(schemas[i].c_str(), 
-                                     xercesc::Grammar::SchemaGrammarType,
-                                     true))
+        if (!validator.loadGrammar(schemas[i].c_str(), 
+                                   xercesc::Grammar::SchemaGrammarType,
+                                   true))
         {
             std::ostringstream oss;
             oss << "Error: Failure to load schema " << schemas[i];
-            log->warn(Ctxt(oss.str()));
+            if (log != nullptr)
+            {
+                log->warn(Ctxt(oss.str()));
+            }
         }
     }
 
-    //! no additional schemas will be loaded after this point!
-    mSchemaPool->lockPool();
+    schemaPool.lockPool();
 }
 
-// From config.h.in: Define to the 16 bit type used to represent Xerces UTF-16 characters
-// On Windows, this needs to be wchar_t so that various "wide character" Win32 APIs can be called.
-static_assert(sizeof(XMLCh) == 2, "XMLCh should be two bytes for UTF-16.");
-
-#if _WIN32
-// On other platforms, char16_t/uint16_t is used; only wchar_t on Windows.
-using XMLCh_t = wchar_t;
-static_assert(std::is_same<::XMLCh, XMLCh_t>::value, "XMLCh should be wchar_t");
-inline void reset(str::EncodedStringView xmlView, std::unique_ptr<std::wstring>& pWString)
+ValidatorXerces::ValidatorXerces(
+    const std::vector<std::string>& schemaPaths, 
+    logging::Logger* log,
+    bool recursive) :
+    ValidatorInterface(schemaPaths, log, recursive)
 {
-    pWString.reset(new std::wstring(xmlView.wstring())); // std::make_unique fails with older compilers
-}
-#else
-#if defined(__INTEL_COMPILER) && (__INTEL_COMPILER_BUILD_DATE < 20190815)
-using XMLCh_t = uint16_t;
-static_assert(std::is_same<::XMLCh, XMLCh_t>::value, "XMLCh should be uint16_t");
-#else
-using XMLCh_t = char16_t;
-static_assert(std::is_same<::XMLCh, XMLCh_t>::value, "XMLCh should be char16_t");
-#endif
-#endif
+    // add each schema into a grammar pool --
+    // this allows reuse
+    mSchemaPool.reset(
+        new xercesc::XMLGrammarPoolImpl(
+            xercesc::XMLPlatformUtils::fgMemoryManager));
 
-inline void reset(str::EncodedStringView xmlView, std::unique_ptr<std::u16string>& pWString)
-{
-    pWString.reset(new std::u16string(xmlView.u16string())); // std::make_unique fails with older compilers
-}
-inline void reset(str::EncodedStringView xmlView, std::unique_ptr<str::ui16string>& pWString)
-{
-    pWString.reset(new str::ui16string(xmlView.ui16string_())); // std::make_unique fails with older compilers
-}
+    mErrorHandler.reset(
+            new ValidationErrorHandler());
+    mValidator = newValidator(*mSchemaPool, *mErrorHandler);
 
-using XMLCh_string = std::basic_string<XMLCh_t>;
-static std::unique_ptr<XMLCh_string> setStringData(xercesc::DOMLSInputImpl& input, const std::u8string& xml)
-{
-    // expand to the wide character data for use with xerces
-    std::unique_ptr<XMLCh_string> retval;
-    reset(str::EncodedStringView(xml), retval);
-    input.setStringData(retval->c_str());
-    return retval;
+    // load our schemas
+    loadSchemas(*mValidator, *mSchemaPool, schemaPaths, log, recursive);
 }
 
-bool ValidatorXerces::validate_(const std::u8string& xml, 
-                               const std::string& xmlID,
-                               std::vector<ValidationInfo>& errors) const
+// Validate the UTF-8 xml with validator, appending to errors
+static bool validateUtf8(xercesc::DOMLSParser& validator,
+                         ValidationErrorHandler& errorHandler,
+                         const coda_oss::u8string& xml,
+                         const std::string& xmlID,
+                         std::vector<ValidationInfo>& errors)
 {
+    // Widening to UTF-16 used to reject bad UTF-8 with this exception;
+    // callers still rely on it to fall back to Windows-1252.
+    const auto begin = reinterpret_cast<const uint8_t*>(xml.data());
+    const auto end = begin + xml.size();
+    const auto invalid = utf8::find_invalid(begin, end);
+    if (invalid != end)
+    {
+        throw utf8::invalid_utf8(*invalid);
+    }
+
     // clear the log before its use -- 
     // however we do not clear the users 'errors' because 
     // they might want an accumulation of errors
-    mErrorHandler->clearErrorLog();
+    errorHandler.clearErrorLog();
 
     // set the id so all errors coming from this session 
     // get a matching id
-    mErrorHandler->setID(xmlID);
-
-    // get a vehicle to validate data
-    xercesc::DOMLSInputImpl input(
-        xercesc::XMLPlatformUtils::fgMemoryManager);
+    errorHandler.setID(xmlID);
 
-    // expand to the wide character data for use with xerces
-    auto pWString = setStringData(input, xml);
+    // Xerces reads the UTF-8 bytes directly; there's no need to widen the
+    // whole document to UTF-16 first.  Any encoding="..." in the XML
+    // declaration is overridden, as the data has already been converted.
+    xercesc::MemBufInputSource source(
+        reinterpret_cast<const XMLByte*>(xml.data()), xml.size(),
+        xmlID.c_str(), false /*adoptBuffer*/);
+    source.setEncoding(xercesc::XMLUni::fgUTF8EncodingString);
+    xercesc::Wrapper4InputSource input(&source, false /*adoptIS*/);
 
     // validate the document
-    mValidator->parse(&input)->release();
+    xercesc::DOMDocument* const document = validator.parse(&input);
+    if (document != nullptr)
+    {
+        document->release();
+    }
 
     // add the new errors to the vector 
     errors.insert(errors.end(), 
-                  mErrorHandler->getErrorLog().begin(), 
-                  mErrorHandler->getErrorLog().end());
+                  errorHandler.getErrorLog().begin(), 
+                  errorHandler.getErrorLog().end());
 
     // reset the id
-    mErrorHandler->setID("");
+    errorHandler.setID("");
+
+    return (!errorHandler.getErrorLog().empty());
+}
 
-    return (!mErrorHandler->getErrorLog().empty());
+bool ValidatorXerces::validate_(const std::u8string& xml, 
+                               const std::string& xmlID,
+                               std::vector<ValidationInfo>& errors) const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return validateUtf8(*mValidator, *mErrorHandler, xml, xmlID, errors);
 }
 
 static str::EncodedStringView encodeXml(const std::string& xml)
@@ -274,20 +284,29 @@ static str::EncodedStringView encodeXml(const std::string& xml)
     return str::EncodedStringView(xml);
 }
 
-bool ValidatorXerces::validate(const std::string& xml,
-                               const std::string& xmlID,
-                               std::vector<ValidationInfo>& errors) const
+template <typename TValidator>
+static bool validateString(const TValidator& validator,
+                           const std::string& xml,
+                           const std::string& xmlID,
+                           std::vector<ValidationInfo>& errors)
 {
     const auto view = encodeXml(xml);
     try
     {
-      return validate(view.u8string(), xmlID, errors);
+      return validator.validate(view.u8string(), xmlID, errors);
     }
     catch (const utf8::invalid_utf8&) { }
 
     // Can't process as "native" (UTF-8 on Linux, Windows-1252 on Windows).
     // Must be Windows-1252 on Linux.
-    return validate(str::c_str<str::W1252string>(xml), xmlID, errors);
+    return validator.validate(str::c_str<str::W1252string>(xml), xmlID, errors);
+}
+
+bool ValidatorXerces::validate(const std::string& xml,
+                               const std::string& xmlID,
+                               std::vector<ValidationInfo>& errors) const
+{
+    return validateString(*this, xml, xmlID, errors);
 }
 bool ValidatorXerces::validate(const coda_oss::u8string& xml,
                                const std::string& xmlID,
@@ -303,6 +322,129 @@ bool ValidatorXerces::validate(const str::W1252string& xml,
     return validate(xmlView.u8string(), xmlID, errors);
 }
 
+// One validating parser and the error handler it reports to
+struct ValidatorPool::Parser final
+{
+    ValidationErrorHandler errorHandler;
+    std::unique_ptr<xercesc::DOMLSParser> validator;
+};
+
+ValidatorPool::ValidatorPool(
+        const std::vector<fs::path>& schemaPaths,
+        logging::Logger* log,
+        bool recursive) :
+    ValidatorPool(convert(schemaPaths), log, recursive)
+{
+}
+ValidatorPool::ValidatorPool(
+    const std::vector<std::string>& schemaPaths,
+    logging::Logger* log,
+    bool recursive) :
+    ValidatorInterface(schemaPaths, log, recursive)
+{
+    mSchemaPool.reset(
+        new xercesc::XMLGrammarPoolImpl(
+            xercesc::XMLPlatformUtils::fgMemoryManager));
+
+    // The first parser loads the schemas, then waits for the first validate()
+    auto parser = newParser();
+    loadSchemas(*parser->validator, *mSchemaPool, schemaPaths, log, recursive);
+    mIdleParsers.push_back(std::move(parser));
+    mNumParsers = 1;
+}
+
+ValidatorPool::~ValidatorPool()
+{
+    // Parsers refer to mSchemaPool, so they have to go first
+    mIdleParsers.clear();
+}
+
+std::unique_ptr<ValidatorPool::Parser> ValidatorPool::newParser() const
+{
+    std::unique_ptr<Parser> parser(new Parser()); // std::make_unique fails with older compilers
+    parser->validator = newValidator(*mSchemaPool, parser->errorHandler);
+    return parser;
+}
+
+size_t ValidatorPool::getNumParsers() const
+{
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mNumParsers;
+}
+
+bool ValidatorPool::validate(const std::string& xml,
+                             const std::string& xmlID,
+                             std::vector<ValidationInfo>& errors) const
+{
+    return validateString(*this, xml, xmlID, errors);
+}
+bool ValidatorPool::validate(const coda_oss::u8string& xml,
+                             const std::string& xmlID,
+                             std::vector<ValidationInfo>& errors) const
+{
+    std::unique_ptr<Parser> parser;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (!mIdleParsers.empty())
+        {
+            parser = std::move(mIdleParsers.back());
+            mIdleParsers.pop_back();
+        }
+        else
+        {
+            ++mNumParsers;
+        }
+    }
+    if (!parser)
+    {
+        // Creating a parser is slow, so it's done without holding mMutex;
+        // the grammar pool is locked, so a new parser only reads it.
+        try
+        {
+            parser = newParser();
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mNumParsers;
+            throw;
+        }
+    }
+
+    // Errors go to a local log so the parser can be handed back even if
+    // Xerces throws
+    std::vector<ValidationInfo> log;
+    std::exception_ptr exception;
+    bool result = false;
+    try
+    {
+        result = validateUtf8(*parser->validator, parser->errorHandler, xml, xmlID, log);
+    }
+    catch (...)
+    {
+        exception = std::current_exception();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIdleParsers.push_back(std::move(parser));
+    }
+    if (exception)
+    {
+        std::rethrow_exception(exception);
+    }
+
+    errors.insert(errors.end(), log.begin(), log.end());
+    return result;
+}
+bool ValidatorPool::validate(const str::W1252string& xml,
+                             const std::string& xmlID,
+                             std::vector<ValidationInfo>& errors) const
+{
+    const str::EncodedStringView xmlView(xml);
+    return validate(xmlView.u8string(), xmlID, errors);
+}
+
 }
 }
 #endif
@@ -0,0 +1,105 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <import/except.h>
+#include <import/io.h>
+#include <import/xml/lite.h>
+
+/*
+ * Times repeated recursive getElementsByTagName() lookups over a parsed
+ * document (e.g. large_benchmark1.xml) with and without
+ * xml::lite::Element::useIndex().
+ */
+
+namespace
+{
+double lookup(const xml::lite::Element& root,
+              const std::vector<std::string>& names,
+              size_t numPasses,
+              size_t& numFound)
+{
+    const auto start = std::chrono::steady_clock::now();
+    numFound = 0;
+    for (size_t pass = 0; pass < numPasses; ++pass)
+    {
+        for (const auto& name : names)
+        {
+            numFound += root.getElementsByTagName(name, true /*recurse*/).size();
+        }
+    }
+    const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2 || argc > 3)
+        {
+            std::cerr << "Usage: " << argv[0] << " <xml file> [passes]\n";
+            return EXIT_FAILURE;
+        }
+        const size_t numPasses = argc > 2 ? std::stoul(argv[2]) : 100;
+
+        io::FileInputStream xmlFile(argv[1]);
+        xml::lite::MinidomParser treeBuilder;
+        treeBuilder.parse(xmlFile);
+        xml::lite::Element& root = *treeBuilder.getDocument()->getRootElement();
+
+        const std::vector<std::string> names = {
+                "class", "method", "parameter", "description", "missing" };
+
+        size_t scanned = 0;
+        const double scanSeconds = lookup(root, names, numPasses, scanned);
+
+        root.useIndex();
+        size_t indexed = 0;
+        const double indexSeconds = lookup(root, names, numPasses, indexed);
+
+        if (scanned != indexed)
+        {
+            std::cerr << "Found " << indexed << " elements with the index but "
+                      << scanned << " without\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << numPasses << " passes, " << scanned << " elements found\n"
+                  << "scan:  " << scanSeconds << " s\n"
+                  << "index: " << indexSeconds << " s (including the build)\n";
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << "Caught Throwable: " << t.toString() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -0,0 +1,116 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#include <import/except.h>
+#include <import/io.h>
+#include <import/xml/lite.h>
+
+/*
+ * Times serializing a document (e.g. large_benchmark1.xml) with
+ * xml::lite::Element::print() and with xml::lite::ElementWriter, serially
+ * and with the root's children split across threads.
+ */
+
+namespace
+{
+template <typename WriteT>
+double time(size_t numPasses, const WriteT& write)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t pass = 0; pass < numPasses; ++pass)
+    {
+        write();
+    }
+    const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        if (argc < 2 || argc > 4)
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " <xml file> [passes] [threads]\n";
+            return EXIT_FAILURE;
+        }
+        const size_t numPasses = argc > 2 ? std::stoul(argv[2]) : 20;
+        const size_t numThreads = argc > 3 ? std::stoul(argv[3]) : 4;
+
+        io::FileInputStream xmlFile(argv[1]);
+        xml::lite::PullReader reader(xmlFile);
+        reader.next();
+        const auto root = reader.readElement();
+
+        io::StringStream printed;
+        const double printSeconds = time(numPasses, [&]()
+        {
+            printed.reset();
+            root->print(printed);
+        });
+
+        xml::lite::ElementWriter writer;
+        io::StringStream written;
+        const double writerSeconds = time(numPasses, [&]()
+        {
+            written.reset();
+            writer.write(*root, written);
+        });
+
+        xml::lite::ElementWriter::Options options;
+        options.numThreads = numThreads;
+        xml::lite::ElementWriter parallelWriter(options);
+        const double parallelSeconds = time(numPasses, [&]()
+        {
+            parallelWriter.toString(*root);
+        });
+
+        if (written.stream().str() != printed.stream().str() ||
+            parallelWriter.toString(*root) != printed.stream().str())
+        {
+            std::cerr << "ElementWriter output differs from print()\n";
+            return EXIT_FAILURE;
+        }
+
+        std::cout << numPasses << " passes, " << printed.stream().str().size()
+                  << " bytes\n"
+                  << "print():               " << printSeconds << " s\n"
+                  << "ElementWriter:         " << writerSeconds << " s\n"
+                  << "ElementWriter (" << numThreads << " threads): "
+                  << parallelSeconds << " s\n";
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << "Caught Throwable: " << t.toString() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return 0;
+}
@@ -0,0 +1,170 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include <TestCase.h>
+#include "xml/lite/Document.h"
+#include "xml/lite/DocumentArena.h"
+#include "xml/lite/Element.h"
+
+TEST_CASE(testArenaAllocate)
+{
+    xml::lite::DocumentArena arena(1024);
+    for (size_t ii = 1; ii < 100; ++ii)
+    {
+        void* const p = arena.allocate(ii * 7, 16);
+        TEST_ASSERT_EQ(reinterpret_cast<uintptr_t>(p) % 16, static_cast<uintptr_t>(0));
+    }
+    TEST_ASSERT(arena.getNumBlocks() > 1);
+
+    // Larger than a block
+    TEST_ASSERT(arena.allocate(10000) != nullptr);
+    TEST_EXCEPTION(arena.allocate(8, 3));
+
+    arena.reset();
+    TEST_ASSERT_EQ(arena.getNumBlocks(), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(arena.getBytesAllocated(), static_cast<size_t>(0));
+}
+
+TEST_CASE(testArenaIntern)
+{
+    xml::lite::DocumentArena arena;
+    const std::string& a = arena.intern("urn:example:names");
+    const std::string& b = arena.intern(std::string("urn:example:") + "names");
+    const std::string& c = arena.intern("other");
+    TEST_ASSERT_EQ(&a, &b);
+    TEST_ASSERT(&a != &c);
+    TEST_ASSERT_EQ(a, "urn:example:names");
+}
+
+TEST_CASE(testArenaDocument)
+{
+    xml::lite::Document doc;
+    doc.useArena(4096);
+    TEST_ASSERT(doc.getArena() != nullptr);
+
+    xml::lite::Element* root = doc.createElement("x:root", "urn:example", "");
+    doc.setRootElement(root);
+    for (size_t ii = 0; ii < 1000; ++ii)
+    {
+        xml::lite::Element* child =
+                doc.createElement("x:child", "urn:example", std::to_string(ii));
+        doc.insert(child, root);
+    }
+    TEST_ASSERT(doc.getArena()->getNumBlocks() > 1);
+
+    // Heap elements can be mixed in and are freed as usual
+    root->addChild(xml::lite::Element::create("heap", "", "on the heap"));
+    TEST_ASSERT_EQ(root->getChildren().size(), static_cast<size_t>(1001));
+
+    // Removing deletes the element; its memory stays with the arena
+    doc.remove(root->getChildren()[0]);
+    TEST_ASSERT_EQ(root->getChildren().size(), static_cast<size_t>(1000));
+    TEST_ASSERT_EQ(root->getChildren()[0]->getCharacterData(), "1");
+    TEST_ASSERT_EQ(root->getChildren()[0]->getUri(), "urn:example");
+    TEST_ASSERT_EQ(root->getChildren()[0]->getLocalName(), "child");
+
+    doc.destroy();
+    TEST_ASSERT(doc.getRootElement() == nullptr);
+    TEST_ASSERT_EQ(doc.getArena()->getNumBlocks(), static_cast<size_t>(1));
+
+    // Can't switch to an arena with nodes in place
+    doc.setRootElement(doc.createElement("root", "", ""));
+    TEST_EXCEPTION(doc.useArena());
+}
+
+TEST_CASE(testArenaInternedNames)
+{
+    xml::lite::Document doc;
+    doc.useArena();
+    auto& arena = *doc.getArena();
+    doc.setRootElement(doc.createElement("x:root", "urn:example", ""));
+    doc.insert(doc.createElement("x:child", "urn:example", ""), doc.getRootElement());
+
+    auto root = dynamic_cast<xml::lite::ArenaElement*>(doc.getRootElement());
+    TEST_ASSERT(root != nullptr);
+    auto child = dynamic_cast<xml::lite::ArenaElement*>(root->getChildren()[0]);
+    TEST_ASSERT(child != nullptr);
+    TEST_ASSERT_EQ(&root->getInternedUri(), &child->getInternedUri());
+    TEST_ASSERT_EQ(&root->getInternedUri(), arena.findInterned("urn:example"));
+    TEST_ASSERT_EQ(&child->getInternedLocalName(), arena.findInterned("child"));
+    TEST_ASSERT(arena.findInterned("other") == nullptr);
+
+    // Renaming interns the new names
+    child->setLocalName("root");
+    child->setUri("urn:other");
+    TEST_ASSERT_EQ(&child->getInternedLocalName(), &root->getInternedLocalName());
+    TEST_ASSERT_EQ(child->getInternedUri(), "urn:other");
+    TEST_ASSERT_EQ(&child->getInternedUri(), arena.findInterned("urn:other"));
+    root->setNamespaceURI("x", "urn:renamed");
+    TEST_ASSERT_EQ(&root->getInternedUri(), arena.findInterned("urn:renamed"));
+
+    // Heap elements don't come from the arena
+    TEST_ASSERT(dynamic_cast<xml::lite::ArenaElement*>(
+            xml::lite::Element::create("heap").get()) == nullptr);
+}
+
+TEST_CASE(testArenaUnownedRoot)
+{
+    xml::lite::Document doc;
+    doc.useArena();
+    xml::lite::Element* root = doc.createElement("root", "", "text");
+    doc.setRootElement(root, false /*own*/);
+
+    // The arena isn't reset out from under a root the document doesn't own
+    doc.destroy();
+    TEST_ASSERT(doc.getRootElement() == nullptr);
+    TEST_ASSERT(doc.getArena()->getBytesAllocated() > 0);
+    TEST_ASSERT_EQ(root->getCharacterData(), "text");
+    delete root;
+}
+
+TEST_CASE(testArenaStealRoot)
+{
+    std::unique_ptr<xml::lite::Element> stolen;
+    {
+        xml::lite::Document doc;
+        doc.useArena();
+        doc.setRootElement(doc.createElement("root", "", ""));
+        doc.insert(doc.createElement("child", "", "text"), doc.getRootElement());
+        doc.getRootElement(stolen);
+    }
+
+    // The stolen copy lives on the heap and outlives the document
+    TEST_ASSERT_EQ(stolen->getLocalName(), "root");
+    TEST_ASSERT_EQ(stolen->getChildren().size(), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(stolen->getChildren()[0]->getCharacterData(), "text");
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testArenaAllocate);
+    TEST_CHECK(testArenaIntern);
+    TEST_CHECK(testArenaDocument);
+    TEST_CHECK(testArenaInternedNames);
+    TEST_CHECK(testArenaUnownedRoot);
+    TEST_CHECK(testArenaStealRoot);
+}
@@ -0,0 +1,285 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <TestCase.h>
+#include "xml/lite/Document.h"
+#include "xml/lite/Element.h"
+#include "xml/lite/QName.h"
+
+namespace
+{
+const std::string URI_A = "urn:example:a";
+const std::string URI_B = "urn:example:b";
+
+// <root> with two levels of <item>, <name> and <value> in two namespaces
+std::unique_ptr<xml::lite::Element> makeTree()
+{
+    auto root = xml::lite::Element::create("root", URI_A);
+    for (size_t ii = 0; ii < 10; ++ii)
+    {
+        auto& item = root->addChild(xml::lite::Element::create("item", URI_A));
+        item.addChild(xml::lite::Element::create("name", URI_A, std::to_string(ii)));
+        item.addChild(xml::lite::Element::create("value", (ii % 2) ? URI_A : URI_B));
+        auto& nested = item.addChild(xml::lite::Element::create("item", URI_B));
+        nested.addChild(xml::lite::Element::create("name", URI_B));
+    }
+    root->addChild(xml::lite::Element::create("name", URI_A));
+    return root;
+}
+
+// What getElementsByTagName() did before there was an index
+void scan(const xml::lite::Element& element, const std::string* uri,
+          const std::string& localName, bool recurse,
+          std::vector<xml::lite::Element*>& found)
+{
+    for (auto child : element.getChildren())
+    {
+        if (child->getLocalName() == localName &&
+            (uri == nullptr || child->getUri() == *uri))
+        {
+            found.push_back(child);
+        }
+        if (recurse)
+        {
+            scan(*child, uri, localName, recurse, found);
+        }
+    }
+}
+
+void assertMatchesScan(const std::string& testName, const xml::lite::Element& element)
+{
+    for (const std::string localName : {"item", "name", "value", "renamed", "missing"})
+    {
+        for (const auto recurse : {false, true})
+        {
+            std::vector<xml::lite::Element*> expected;
+            scan(element, nullptr, localName, recurse, expected);
+            TEST_ASSERT(element.getElementsByTagName(localName, recurse) == expected);
+
+            for (const auto& uri : {URI_A, URI_B})
+            {
+                expected.clear();
+                scan(element, &uri, localName, recurse, expected);
+                TEST_ASSERT(element.getElementsByTagName(uri, localName, recurse) == expected);
+            }
+        }
+
+        std::vector<xml::lite::Element*> children;
+        scan(element, nullptr, localName, false /*recurse*/, children);
+        TEST_ASSERT_EQ(element.hasElement(localName), !children.empty());
+    }
+}
+}
+
+TEST_CASE(testIndexedLookups)
+{
+    auto root = makeTree();
+    root->useIndex();
+    for (int pass = 0; pass < 2; ++pass) // the second pass reuses the index
+    {
+        assertMatchesScan(testName, *root);
+        TEST_ASSERT_EQ(root->getElementsByTagName("name", true).size(),
+                       static_cast<size_t>(21));
+        TEST_ASSERT_EQ(root->getElementsByTagName(URI_B, "name", true).size(),
+                       static_cast<size_t>(10));
+        TEST_ASSERT(root->hasElement(URI_A, "name"));
+        TEST_ASSERT(!root->hasElement(URI_B, "name"));
+        TEST_ASSERT_EQ(&root->getElementByTagName("name"), root->getChildren().back());
+        TEST_ASSERT(root->getElementByTagName(std::nothrow, "value") == nullptr);
+        TEST_EXCEPTION(root->getElementByTagName("item"));
+    }
+
+    root->useIndex(false);
+    assertMatchesScan(testName, *root);
+}
+
+TEST_CASE(testIndexAfterAddAndRemove)
+{
+    auto root = makeTree();
+    root->useIndex();
+    assertMatchesScan(testName, *root);
+
+    // Changes deep in the tree are seen by the root's index
+    auto& item = *root->getChildren()[3];
+    item.addChild(xml::lite::Element::create("value", URI_B));
+    TEST_ASSERT_EQ(root->getElementsByTagName(URI_B, "value", true).size(),
+                   static_cast<size_t>(6));
+    assertMatchesScan(testName, *root);
+
+    auto removed = item.getChildren()[0];
+    TEST_ASSERT(item.removeChild(removed));
+    TEST_ASSERT(!item.removeChild(removed));
+    TEST_ASSERT(removed->getParent() == nullptr);
+    delete removed;
+    TEST_ASSERT_EQ(root->getElementsByTagName("name", true).size(),
+                   static_cast<size_t>(20));
+    assertMatchesScan(testName, *root);
+
+    item.destroyChildren();
+    TEST_ASSERT_EQ(root->getElementsByTagName("name", true).size(),
+                   static_cast<size_t>(19));
+    assertMatchesScan(testName, *root);
+}
+
+TEST_CASE(testIndexAfterRename)
+{
+    auto root = makeTree();
+    root->useIndex();
+    auto& item = *root->getChildren()[5];
+    item.useIndex(); // already indexed along with the rest of the tree
+    TEST_ASSERT(item.hasElement("value"));
+    assertMatchesScan(testName, *root);
+
+    item.getChildren()[1]->setLocalName("renamed");
+    TEST_ASSERT(!item.hasElement("value"));
+    TEST_ASSERT(item.hasElement("renamed"));
+    assertMatchesScan(testName, *root);
+    assertMatchesScan(testName, item);
+
+    item.getChildren()[0]->setUri(URI_B);
+    TEST_ASSERT(!item.hasElement(URI_A, "name"));
+    TEST_ASSERT(item.hasElement(URI_B, "name"));
+    assertMatchesScan(testName, *root);
+
+    root->setNamespaceURI("", URI_B);
+    assertMatchesScan(testName, *root);
+}
+
+TEST_CASE(testIndexAfterMovingSubtree)
+{
+    auto root = makeTree();
+    root->useIndex();
+    auto& item = *root->getChildren()[0];
+    item.useIndex();
+    TEST_ASSERT_EQ(item.getElementsByTagName("name", true).size(), static_cast<size_t>(2));
+    assertMatchesScan(testName, *root);
+
+    // item goes unindexed in a tree without an index ...
+    TEST_ASSERT(root->removeChild(&item));
+    std::unique_ptr<xml::lite::Element> detached(&item);
+    auto other = xml::lite::Element::create("other");
+    auto& moved = other->addChild(std::move(detached));
+    TEST_ASSERT_EQ(moved.getElementsByTagName("name", true).size(), static_cast<size_t>(2));
+    moved.getChildren()[2]->addChild(xml::lite::Element::create("name"));
+    TEST_ASSERT_EQ(moved.getElementsByTagName("name", true).size(), static_cast<size_t>(3));
+    assertMatchesScan(testName, moved);
+
+    TEST_ASSERT_EQ(root->getElementsByTagName("item", true).size(), static_cast<size_t>(18));
+    assertMatchesScan(testName, *root);
+
+    // ... and takes on the index of one that has one
+    other->useIndex();
+    TEST_ASSERT_EQ(moved.getElementsByTagName("name", true).size(), static_cast<size_t>(3));
+    TEST_ASSERT(other->removeChild(&moved));
+    detached.reset(&moved);
+    root->addChild(std::move(detached)).addChild(xml::lite::Element::create("name"));
+    TEST_ASSERT_EQ(root->getElementsByTagName("name", true).size(), static_cast<size_t>(23));
+    assertMatchesScan(testName, *root);
+}
+
+TEST_CASE(testDocumentRemove)
+{
+    xml::lite::Document doc;
+    doc.setRootElement(makeTree().release());
+    auto root = doc.getRootElement();
+    root->useIndex();
+    TEST_ASSERT_EQ(root->getElementsByTagName("value", true).size(), static_cast<size_t>(10));
+
+    doc.remove(root->getChildren()[4]->getChildren()[1]);
+    TEST_ASSERT_EQ(root->getElementsByTagName("value", true).size(), static_cast<size_t>(9));
+    doc.remove(root->getChildren()[4]);
+    TEST_ASSERT_EQ(root->getElementsByTagName("item", true).size(), static_cast<size_t>(18));
+    assertMatchesScan(testName, *root);
+}
+
+TEST_CASE(testDocumentIndex)
+{
+    // Indexing is turned on before there's a tree, and the tree is in an
+    // arena, with a heap element mixed in
+    xml::lite::Document doc;
+    doc.useArena();
+    doc.useIndex();
+    auto root = doc.createElement("root", URI_A);
+    for (size_t ii = 0; ii < 10; ++ii)
+    {
+        auto item = doc.createElement("item", URI_A);
+        doc.insert(doc.createElement("name", (ii % 2) ? URI_A : URI_B), item);
+        doc.insert(item, root);
+    }
+    root->getChildren()[3]->addChild(xml::lite::Element::create("name", URI_A));
+    doc.setRootElement(root);
+
+    TEST_ASSERT_EQ(root->getElementsByTagName("name", true).size(), static_cast<size_t>(11));
+    TEST_ASSERT_EQ(root->getElementsByTagName(URI_A, "name", true).size(), static_cast<size_t>(6));
+    TEST_ASSERT(root->getChildren()[3]->hasElement(URI_A, "name"));
+    TEST_ASSERT(!root->hasElement("missing"));
+    assertMatchesScan(testName, *root);
+
+    root->getChildren()[0]->getChildren()[0]->setLocalName("renamed");
+    TEST_ASSERT_EQ(root->getElementsByTagName("renamed", true).size(), static_cast<size_t>(1));
+    assertMatchesScan(testName, *root);
+
+    doc.useIndex(false);
+    assertMatchesScan(testName, *root);
+}
+
+TEST_CASE(testConcurrentLookups)
+{
+    auto root = makeTree();
+    root->useIndex();
+
+    std::vector<size_t> counts(8);
+    std::vector<std::thread> threads;
+    for (size_t ii = 0; ii < counts.size(); ++ii)
+    {
+        threads.emplace_back([&, ii]() {
+            const auto& item = *root->getChildren()[ii];
+            for (size_t jj = 0; jj < 100; ++jj)
+            {
+                counts[ii] += root->getElementsByTagName(URI_B, "name", true).size() +
+                        item.getElementsByTagName("name", true).size();
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    for (const auto count : counts)
+    {
+        TEST_ASSERT_EQ(count, static_cast<size_t>(100 * (10 + 2)));
+    }
+}
+
+TEST_MAIN(
+    TEST_CHECK(testIndexedLookups);
+    TEST_CHECK(testIndexAfterAddAndRemove);
+    TEST_CHECK(testIndexAfterRename);
+    TEST_CHECK(testIndexAfterMovingSubtree);
+    TEST_CHECK(testDocumentRemove);
+    TEST_CHECK(testDocumentIndex);
+    TEST_CHECK(testConcurrentLookups);
+    )
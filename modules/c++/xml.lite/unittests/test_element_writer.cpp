@@ -0,0 +1,164 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+
+#include <string>
+
+#include <TestCase.h>
+#include "io/StringStream.h"
+#include "xml/lite/Element.h"
+#include "xml/lite/ElementWriter.h"
+
+namespace
+{
+const std::string URI = "urn:example:writer";
+
+std::unique_ptr<xml::lite::Element> makeTree()
+{
+    auto root = xml::lite::Element::create("ns:root", URI);
+    root->getAttributes()["xmlns:ns"] = URI;
+    for (size_t ii = 0; ii < 20; ++ii)
+    {
+        auto& item = root->addChild(xml::lite::Element::create("ns:item", URI));
+        item.getAttributes()["id"] = std::to_string(ii);
+        item.addChild(xml::lite::Element::create("name", URI, "item " + std::to_string(ii)));
+        item.addChild(xml::lite::Element::create("empty", URI));
+        auto& nested = item.addChild(xml::lite::Element::create("nested", URI));
+        nested.addChild(xml::lite::Element::create("value", URI, "a fairly long value " + std::to_string(ii * 7)));
+    }
+    return root;
+}
+
+std::string print(const xml::lite::Element& element, const std::string& formatter)
+{
+    io::StringStream stream;
+    if (formatter.empty())
+    {
+        element.print(stream);
+    }
+    else
+    {
+        element.prettyPrint(stream, formatter);
+    }
+    return stream.stream().str();
+}
+
+std::string escape(const std::string& text, bool isAttribute = false)
+{
+    std::string result;
+    xml::lite::ElementWriter::appendEscaped(text, result, isAttribute);
+    return result;
+}
+}
+
+TEST_CASE(testMatchesPrint)
+{
+    const auto root = makeTree();
+    for (const std::string formatter : {"", "    ", "\t"})
+    {
+        xml::lite::ElementWriter::Options options;
+        options.formatter = formatter;
+        xml::lite::ElementWriter writer(options);
+        TEST_ASSERT_EQ(writer.toString(*root), print(*root, formatter));
+
+        // the buffer is reused
+        TEST_ASSERT_EQ(writer.toString(*root), print(*root, formatter));
+
+        io::StringStream stream;
+        writer.write(*root, stream);
+        TEST_ASSERT_EQ(stream.stream().str(), print(*root, formatter));
+    }
+}
+
+TEST_CASE(testParallel)
+{
+    const auto root = makeTree();
+    for (const std::string formatter : {"", "  "})
+    {
+        for (const size_t numThreads : {2, 3, 16, 64})
+        {
+            xml::lite::ElementWriter::Options options;
+            options.formatter = formatter;
+            options.numThreads = numThreads;
+            xml::lite::ElementWriter writer(options);
+            TEST_ASSERT_EQ(writer.toString(*root), print(*root, formatter));
+        }
+    }
+
+    // a root with one child (or none) isn't split up
+    xml::lite::ElementWriter::Options options;
+    options.numThreads = 4;
+    xml::lite::ElementWriter writer(options);
+    auto single = xml::lite::Element::create("root", URI);
+    TEST_ASSERT_EQ(writer.toString(*single), "<root/>");
+    single->addChild(xml::lite::Element::create("child", URI, "text"));
+    TEST_ASSERT_EQ(writer.toString(*single), "<root><child>text</child></root>");
+}
+
+TEST_CASE(testEscape)
+{
+    TEST_ASSERT_EQ(escape(""), "");
+    TEST_ASSERT_EQ(escape("plain text with no markup at all"), "plain text with no markup at all");
+    TEST_ASSERT_EQ(escape("a<b"), "a&lt;b");
+    TEST_ASSERT_EQ(escape("&"), "&amp;");
+    TEST_ASSERT_EQ(escape("x > y && \"quoted\""), "x &gt; y &amp;&amp; \"quoted\"");
+    TEST_ASSERT_EQ(escape("x > y && \"quoted\"", true /*isAttribute*/),
+                   "x &gt; y &amp;&amp; &quot;quoted&quot;");
+
+    // markup at every position around the eight-byte boundaries
+    for (size_t length = 1; length < 20; ++length)
+    {
+        for (size_t ii = 0; ii < length; ++ii)
+        {
+            std::string text(length, 'z');
+            text[ii] = '<';
+            const auto expected = text.substr(0, ii) + "&lt;" + text.substr(ii + 1);
+            TEST_ASSERT_EQ(escape(text), expected);
+        }
+    }
+
+    // bytes that only look like markup to a sloppy word test
+    const std::string nearMisses("\x25\x27\x3b\x3d\x3f\x21\x23\xa6\xbc\xbe\xa2", 11);
+    TEST_ASSERT_EQ(escape(nearMisses, true /*isAttribute*/), nearMisses);
+}
+
+TEST_CASE(testEscapedElements)
+{
+    auto root = xml::lite::Element::create("root", URI, "1 < 2 & 3 > 2");
+    root->getAttributes()["title"] = "\"A\" & <B>";
+
+    xml::lite::ElementWriter::Options options;
+    options.escape = true;
+    xml::lite::ElementWriter writer(options);
+    TEST_ASSERT_EQ(writer.toString(*root),
+                   "<root title=\"&quot;A&quot; &amp; &lt;B&gt;\">1 &lt; 2 &amp; 3 &gt; 2</root>");
+
+    // without escaping, the text is written as-is, just like print()
+    TEST_ASSERT_EQ(xml::lite::ElementWriter().toString(*root), print(*root, ""));
+}
+
+TEST_MAIN(
+    TEST_CHECK(testMatchesPrint);
+    TEST_CHECK(testParallel);
+    TEST_CHECK(testEscape);
+    TEST_CHECK(testEscapedElements);
+    )
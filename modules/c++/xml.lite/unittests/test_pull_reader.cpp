@@ -0,0 +1,268 @@
+/* =========================================================================
+ * This file is part of xml.lite-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * xml.lite-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <TestCase.h>
+#include "io/StringStream.h"
+#include "xml/lite/Element.h"
+#include "xml/lite/PullReader.h"
+#include "xml/lite/XMLException.h"
+
+namespace
+{
+const std::string DOCUMENT =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<!DOCTYPE root [ <!ELEMENT root ANY> ]>\n"
+    "<!-- a comment -->\n"
+    "<root xmlns=\"urn:a\" xmlns:b=\"urn:b\" id='1'>\n"
+    "  <item b:kind=\"x &amp; y\">one &lt;1&gt;</item>\n"
+    "  <?pi ignored?>\n"
+    "  <b:item><name>two</name><empty/></b:item>\n"
+    "  <item><![CDATA[<three>]]>&#x20AC;&#65;</item>\n"
+    "</root>\n";
+
+std::unique_ptr<io::StringStream> makeStream(const std::string& xml)
+{
+    std::unique_ptr<io::StringStream> stream(new io::StringStream());
+    stream->write(xml);
+    return stream;
+}
+
+std::string toString(xml::lite::PullReader::View view)
+{
+    return std::string(view.data(), view.size());
+}
+
+// "<a><b/>text</a>" -> "<a <b >b text>a"
+std::string events(const std::string& xml, size_t bufferSize)
+{
+    auto stream = makeStream(xml);
+    xml::lite::PullReader reader(*stream, bufferSize);
+    std::string result;
+    for (;;)
+    {
+        switch (reader.next())
+        {
+        case xml::lite::PullReader::START_ELEMENT:
+            result += "<" + toString(reader.getLocalName()) + " ";
+            break;
+        case xml::lite::PullReader::END_ELEMENT:
+            result += ">" + toString(reader.getLocalName()) + " ";
+            break;
+        case xml::lite::PullReader::CHARACTERS:
+            result += toString(reader.getText());
+            break;
+        case xml::lite::PullReader::END_DOCUMENT:
+            return result;
+        }
+    }
+}
+}
+
+TEST_CASE(testEvents)
+{
+    auto stream = makeStream(DOCUMENT);
+    xml::lite::PullReader reader(*stream);
+
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::START_ELEMENT);
+    TEST_ASSERT_EQ(toString(reader.getQName()), "root");
+    TEST_ASSERT_EQ(reader.getUri(), "urn:a");
+    TEST_ASSERT_EQ(reader.getDepth(), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(reader.getNumAttributes(), static_cast<size_t>(3));
+    xml::lite::PullReader::View value;
+    TEST_ASSERT(reader.getAttributeValue("id", value));
+    TEST_ASSERT_EQ(toString(value), "1");
+    TEST_ASSERT_EQ(reader.getAttributeUri(0), "http://www.w3.org/2000/xmlns/");
+
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::CHARACTERS);
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::START_ELEMENT);
+    TEST_ASSERT_EQ(reader.getPath(), "/root/item");
+    TEST_ASSERT_EQ(toString(reader.getAttributeQName(0)), "b:kind");
+    TEST_ASSERT_EQ(toString(reader.getAttributeValue(0)), "x & y");
+    TEST_ASSERT_EQ(reader.getAttributeUri(0), "urn:b");
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::CHARACTERS);
+    TEST_ASSERT_EQ(toString(reader.getText()), "one <1>");
+    TEST_EXCEPTION(reader.getQName());
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::END_ELEMENT);
+    TEST_ASSERT_EQ(toString(reader.getQName()), "item");
+
+    TEST_ASSERT(reader.nextElement([](const xml::lite::PullReader& r) {
+        return r.getUri() == "urn:b"; }));
+    TEST_ASSERT_EQ(toString(reader.getQName()), "b:item");
+    TEST_ASSERT_EQ(toString(reader.getLocalName()), "item");
+    TEST_ASSERT_EQ(reader.getDepth(), static_cast<size_t>(2));
+    TEST_ASSERT(reader.nextElement("empty"));
+    TEST_ASSERT_EQ(reader.getUri(), "urn:a");
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::END_ELEMENT);
+    TEST_ASSERT_EQ(reader.getPath(), "/root/item/empty");
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::END_ELEMENT);
+    TEST_ASSERT_EQ(toString(reader.getQName()), "b:item");
+
+    TEST_ASSERT(reader.nextElement("item"));
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::CHARACTERS);
+    TEST_ASSERT_EQ(toString(reader.getText()), "<three>");
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::CHARACTERS);
+    TEST_ASSERT_EQ(toString(reader.getText()), "\xE2\x82\xAC" "A");
+
+    TEST_ASSERT(!reader.nextElement("item"));
+    TEST_ASSERT_EQ(reader.getEventType(), xml::lite::PullReader::END_DOCUMENT);
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::END_DOCUMENT);
+}
+
+TEST_CASE(testSmallBuffer)
+{
+    // Tokens are split across reads and the buffer has to grow
+    const auto expected = events(DOCUMENT, xml::lite::PullReader::DEFAULT_BUFFER_SIZE);
+    for (size_t bufferSize = 1; bufferSize < 40; ++bufferSize)
+    {
+        TEST_ASSERT_EQ(events(DOCUMENT, bufferSize), expected);
+    }
+
+    std::string xml = "<list>";
+    for (size_t ii = 0; ii < 1000; ++ii)
+    {
+        xml += "<entry n=\"" + std::to_string(ii) + "\">&#x41;" + std::string(ii % 50, 'x') + "</entry>\r\n";
+    }
+    xml += "</list>";
+    auto stream = makeStream(xml);
+    xml::lite::PullReader reader(*stream, 64);
+    size_t count = 0;
+    while (reader.nextElement("/list/entry"))
+    {
+        TEST_ASSERT_EQ(toString(reader.getAttributeValue(0)), std::to_string(count));
+        TEST_ASSERT(reader.next() == xml::lite::PullReader::CHARACTERS);
+        TEST_ASSERT_EQ(toString(reader.getText()), "A" + std::string(count % 50, 'x'));
+        ++count;
+    }
+    TEST_ASSERT_EQ(count, static_cast<size_t>(1000));
+}
+
+TEST_CASE(testReadElement)
+{
+    auto stream = makeStream(DOCUMENT);
+    xml::lite::PullReader reader(*stream, 32);
+    TEST_ASSERT(reader.nextElement("/root/item"));
+    TEST_ASSERT(reader.nextElement("/root/item")); // the b:item
+    const auto item = reader.readElement();
+    TEST_ASSERT_EQ(reader.getEventType(), xml::lite::PullReader::END_ELEMENT);
+    TEST_ASSERT_EQ(toString(reader.getQName()), "b:item");
+
+    TEST_ASSERT_EQ(item->getLocalName(), "item");
+    TEST_ASSERT_EQ(item->getUri(), "urn:b");
+    TEST_ASSERT_EQ(item->getChildren().size(), static_cast<size_t>(2));
+    TEST_ASSERT_EQ(item->getElementByTagName("name").getCharacterData(), "two");
+    TEST_ASSERT_EQ(item->getElementByTagName(xml::lite::QName(xml::lite::Uri("urn:a"), "empty")).getCharacterData(), "");
+
+    // Whitespace is trimmed unless it's asked for
+    TEST_ASSERT(reader.nextElement("item"));
+    const auto third = reader.readElement(true /*preserveCharacterData*/);
+    TEST_ASSERT_EQ(third->getCharacterData(), "<three>\xE2\x82\xAC" "A");
+
+    auto stream2 = makeStream(DOCUMENT);
+    xml::lite::PullReader reader2(*stream2);
+    reader2.next();
+    const auto root = reader2.readElement();
+    TEST_ASSERT_EQ(root->getChildren().size(), static_cast<size_t>(3));
+    TEST_ASSERT_EQ(root->getAttributes().getValue("id"), "1");
+    TEST_ASSERT_EQ(root->getChildren()[0]->getAttributes().getValue("urn:b", "kind"), "x & y");
+    TEST_ASSERT_EQ(root->getChildren()[0]->getCharacterData(), "one <1>");
+    TEST_ASSERT(reader2.next() == xml::lite::PullReader::END_DOCUMENT);
+}
+
+TEST_CASE(testSkipElement)
+{
+    auto stream = makeStream(DOCUMENT);
+    xml::lite::PullReader reader(*stream, 16);
+    reader.next();
+    TEST_ASSERT(reader.nextElement("item"));
+    reader.skipElement();
+    TEST_ASSERT_EQ(reader.getEventType(), xml::lite::PullReader::END_ELEMENT);
+    TEST_ASSERT_EQ(reader.getDepth(), static_cast<size_t>(2));
+    TEST_ASSERT(reader.nextElement("item"));
+    reader.skipElement(); // has the <?pi?> and <empty/>
+    TEST_ASSERT_EQ(toString(reader.getQName()), "b:item");
+    TEST_ASSERT(reader.nextElement("item"));
+    reader.skipElement(); // has the CDATA "<three>"
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::CHARACTERS);
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::END_ELEMENT);
+    TEST_ASSERT_EQ(toString(reader.getQName()), "root");
+    TEST_ASSERT(reader.next() == xml::lite::PullReader::END_DOCUMENT);
+
+    // Absolute paths skip over everything that can't match
+    auto stream2 = makeStream("<a><b><c/></b><c><b><c/></b></c><b><c>x</c></b></a>");
+    xml::lite::PullReader reader2(*stream2);
+    size_t count = 0;
+    while (reader2.nextElement("/a/b/c"))
+    {
+        ++count;
+    }
+    TEST_ASSERT_EQ(count, static_cast<size_t>(2));
+
+    auto stream3 = makeStream("<a><b><c/></b><c><b><c/></b></c><b><c>x</c></b></a>");
+    xml::lite::PullReader reader3(*stream3);
+    count = 0;
+    while (reader3.nextElement("b/*"))
+    {
+        ++count;
+    }
+    TEST_ASSERT_EQ(count, static_cast<size_t>(3));
+    TEST_EXCEPTION(reader3.nextElement(""));
+    TEST_EXCEPTION(reader3.nextElement("/"));
+}
+
+TEST_CASE(testErrors)
+{
+    const std::vector<std::string> bad = {
+        "",
+        "<a>",
+        "<a></b>",
+        "<a><b></a></b>",
+        "<a/><b/>",
+        "text<a/>",
+        "<a/>text",
+        "<a b=c/>",
+        "<a b=\"c/>",
+        "<p:a/>",
+        "<a>&#xFFFFFFFF;</a>",
+        "<a><!-- unterminated </a>",
+    };
+    for (const auto& xml : bad)
+    {
+        TEST_EXCEPTION(events(xml, 16));
+    }
+
+    // Only UTF-8, and no entities from a DTD
+    TEST_EXCEPTION(events("<?xml version='1.0' encoding='UTF-16'?><a/>", 16));
+    TEST_EXCEPTION(events("<!DOCTYPE a [<!ENTITY e 'x'>]><a>&e;</a>", 16));
+    TEST_ASSERT_EQ(events("\xEF\xBB\xBF<?xml version='1.0' encoding='us-ascii'?><a/>", 16), "<a >a ");
+}
+
+TEST_MAIN(
+    TEST_CHECK(testEvents);
+    TEST_CHECK(testSmallBuffer);
+    TEST_CHECK(testReadElement);
+    TEST_CHECK(testSkipElement);
+    TEST_CHECK(testErrors);
+    )
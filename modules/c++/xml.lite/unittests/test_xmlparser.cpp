@@ -23,6 +23,8 @@
 #include <std/string>
 #include <std/filesystem>
 #include <std/optional>
+#include <thread>
+#include <vector>
 
 #include "io/StringStream.h"
 #include "io/FileInputStream.h"
@@ -490,6 +492,60 @@ TEST_CASE(testValidateXmlFile)
     testValidateXmlFile(testName, "encoding_windows-1252.xml", io::W1252StringStream());
 }
 
+TEST_CASE(testValidatorPool)
+{
+    const auto unittests = findRoot() / "modules" / "c++" / "xml.lite" / "unittests";
+    const auto xsd = unittests / "doc.xsd";
+    if (!exists(xsd))  // running in "externals" of a different project
+    {
+        std::clog << "Path does not exist: '" << xsd << "'\n";
+        return;
+    }
+
+    const std::vector<std::filesystem::path> schemaPaths{xsd.parent_path()};
+    const xml::lite::ValidatorPool validator(schemaPaths, nullptr /*log*/);
+
+    const std::vector<std::string> xmlFiles{"ascii.xml", "utf-8.xml", "encoding_utf-8.xml", "windows-1252.xml"};
+    std::vector<std::string> contents;
+    for (const auto& xmlFile : xmlFiles)
+    {
+        io::FileInputStream fis(unittests / xmlFile);
+        io::StringStream oss;
+        fis.streamTo(oss);
+        contents.push_back(oss.stream().str());
+    }
+
+    // every thread validates every file, several times over
+    constexpr size_t numThreads = 4;
+    std::vector<size_t> numFailures(numThreads);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < numThreads; ++t)
+    {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < 25; ++i)
+            {
+                const auto n = (t + i) % contents.size();
+                std::vector<xml::lite::ValidationInfo> errors;
+                if (validator.validate(contents[n], xmlFiles[n] /*xmlID*/, errors) || !errors.empty())
+                {
+                    ++numFailures[t];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto failures : numFailures)
+    {
+        TEST_ASSERT_EQ(failures, static_cast<size_t>(0));
+    }
+    TEST_ASSERT_GREATER_EQ(validator.getNumParsers(), static_cast<size_t>(1));
+    TEST_ASSERT_LESSER_EQ(validator.getNumParsers(), numThreads);
+}
+
 int main(int, char**)
 {
     TEST_CHECK(testXmlParseSimple);
@@ -508,4 +564,5 @@ int main(int, char**)
     TEST_CHECK(testReadEmbeddedXml);
 
     TEST_CHECK(testValidateXmlFile);
+    TEST_CHECK(testValidatorPool);
 }
@@ -23,6 +23,8 @@
 #ifndef __ZIP_GZIP_INPUT_STREAM_H__
 #define __ZIP_GZIP_INPUT_STREAM_H__
 
+#include <memory>
+
 #include "zip/Types.h"
 
 namespace zip
@@ -37,15 +39,37 @@ namespace zip
  *  the user should only call streamTo() if the optional buffer size
  *  argument is given, and in a loop.  On the last run, the buffer
  *  size should will probably smaller than the amount requested.
+ *
+ *  The read-ahead constructor inflates on a background thread, so
+ *  decompression overlaps whatever the caller does with the data.  When
+ *  the file is made of the sized members written by a block-parallel
+ *  GZipOutputStream, batches of members are inflated on numThreads
+ *  threads at once.  Any other gzip data is inflated serially.
+ *
+ *  Unlike gzread(), which the other constructor uses, the read-ahead
+ *  stream throws on input that isn't gzip, and on anything but another
+ *  member after the last one, rather than passing it through or
+ *  stopping quietly.
  */
 class GZipInputStream: public io::InputStream
 {
+    struct ReadAhead;
+
     gzFile mFile;
+    std::unique_ptr<ReadAhead> mReadAhead;
 public:
 
     //!  Constructor requires initialization
     GZipInputStream(const std::string& file);
 
+    /*!
+     *  Inflate on a read-ahead thread, using up to numThreads
+     *  threads for streams made of sized members.
+     */
+    GZipInputStream(const std::string& file, size_t numThreads);
+
+    virtual ~GZipInputStream();
+
     /*!
      *  Close the gzip stream.  You must call this
      *  afterward (it is not done automatically);
@@ -23,6 +23,8 @@
 #ifndef __ZIP_GZIP_OUTPUT_STREAM_H__
 #define __ZIP_GZIP_OUTPUT_STREAM_H__
 
+#include <memory>
+
 #include "zip/Types.h"
 
 namespace zip
@@ -31,14 +33,44 @@ namespace zip
  *  \class GZipOutputStream
  *  \brief IO wrapper for zlib API
  *
+ *  The block-parallel constructor splits the input into blocks and
+ *  deflates a batch of them at once, one block per thread, the same way
+ *  pigz does.  Each block is primed with the last 32K of the data before
+ *  it, so the result is a single ordinary gzip member that compresses
+ *  nearly as well as the serial stream.  With independent members each
+ *  block is instead written as its own sized gzip member; that costs a
+ *  little in ratio but lets GZipInputStream inflate the members in
+ *  parallel.  Either way the output can be read by gunzip.
  */
 class GZipOutputStream: public io::OutputStream
 {
+    struct BlockCompressor;
+
     gzFile mFile;
+    std::unique_ptr<BlockCompressor> mCompressor;
 public:
+    enum { DEFAULT_BLOCK_SIZE = 1 << 20 };
+
     //!  Constructor requires initialization
     GZipOutputStream(const std::string& file);
 
+    /*!
+     *  Compress blocks of blockSize bytes on numThreads threads.
+     *
+     *  \param file The gzip file to write
+     *  \param numThreads The number of blocks deflated at once
+     *  \param blockSize The number of uncompressed bytes in each block
+     *  \param independentMembers Write each block as its own gzip member
+     *  \param level The zlib compression level
+     */
+    GZipOutputStream(const std::string& file,
+                     size_t numThreads,
+                     size_t blockSize = DEFAULT_BLOCK_SIZE,
+                     bool independentMembers = false,
+                     int level = Z_DEFAULT_COMPRESSION);
+
+    virtual ~GZipOutputStream();
+
     /*!
      *  Write len (or less) bytes into the gzip stream.
      *  If an error occurs, this function throws.  If
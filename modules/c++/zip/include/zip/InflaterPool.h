@@ -0,0 +1,80 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __ZIP_INFLATER_POOL_H__
+#define __ZIP_INFLATER_POOL_H__
+
+#include <mutex>
+#include <vector>
+
+#include "zip/Types.h"
+
+namespace zip
+{
+/*!
+ *  \class InflaterPool
+ *  \brief Raw-deflate inflate contexts kept around for reuse
+ *
+ *  Setting up a z_stream allocates its ~40K window and tables; for an
+ *  archive of many small entries that costs as much as inflating them.
+ *  The pool hands out contexts that have already been through
+ *  inflateReset(), along with the input buffer that goes with each one.
+ *  It is safe to acquire and release from several threads at once.
+ */
+class InflaterPool
+{
+public:
+    struct Inflater
+    {
+        z_stream stream;
+        std::vector<Bytef> input;
+    };
+
+    //!  Keep up to maxIdle contexts; any more are freed when released
+    InflaterPool(size_t maxIdle = 64);
+
+    ~InflaterPool();
+
+    /*!
+     *  Get an inflater ready for a new raw-deflate stream, and give it
+     *  back with release().  With a NULL pool this makes a new context
+     *  every time and release() frees it.
+     */
+    static Inflater* acquire(InflaterPool* pool);
+
+    //!  Return an inflater from acquire(); NULL is ignored
+    static void release(InflaterPool* pool, Inflater* inflater);
+
+private:
+    InflaterPool(const InflaterPool&);
+    InflaterPool& operator=(const InflaterPool&);
+
+    static Inflater* create();
+    static void destroy(Inflater* inflater);
+
+    const size_t mMaxIdle;
+    std::mutex mMutex;
+    std::vector<Inflater*> mIdle;
+};
+}
+
+#endif
@@ -39,7 +39,29 @@ enum
     MAX_EOCD_SEARCH = MAX_COMMENT_LEN + EOCD_LEN,
     ENTRY_SIGNATURE = 0x02014b50,
     ENTRY_LEN = 46,
-    LFH_SIZE = 30
+    LFH_SIGNATURE = 0x04034b50,
+    LFH_SIZE = 30,
+    ZIP64_EOCD_SIGNATURE = 0x06064b50,
+    ZIP64_EOCD_LEN = 56,
+    ZIP64_LOCATOR_SIGNATURE = 0x07064b50,
+    ZIP64_LOCATOR_LEN = 20,
+    ZIP64_EXTRA_ID = 0x0001
+};
+
+/*!
+ *  Layout of the gzip members written by a block-parallel
+ *  GZipOutputStream.  Each member carries an extra field with
+ *  subfield id GZIP_SIZE_SI1, GZIP_SIZE_SI2 that holds the total size of
+ *  the member, so a reader can find every member without inflating.
+ */
+enum
+{
+    GZIP_HEADER_LEN = 10,
+    GZIP_TRAILER_LEN = 8,
+    GZIP_SIZE_SI1 = 'C',
+    GZIP_SIZE_SI2 = 'Z',
+    GZIP_SIZE_XLEN = 8,
+    GZIP_SIZED_HEADER_LEN = GZIP_HEADER_LEN + 2 + GZIP_SIZE_XLEN
 };
 }
 
@@ -23,6 +23,10 @@
 #ifndef __ZIP_ZIP_ENTRY_H__
 #define __ZIP_ZIP_ENTRY_H__
 
+#include <memory>
+
+#include "io/SeekableStreams.h"
+#include "zip/InflaterPool.h"
 #include "zip/Types.h"
 
 namespace zip
@@ -33,6 +37,10 @@ namespace zip
  *
  *  Class stores the information about individual elements
  *  in a PKZIP zip file
+ *
+ *  An entry either points at its compressed bytes in memory or, when it
+ *  comes from a streaming ZipFile, knows where its local header is in the
+ *  archive and reads from there only when it is decompressed.
  */
 class ZipEntry
 {
@@ -42,6 +50,9 @@ class ZipEntry
     };
 
     sys::ubyte* mCompressedData;
+    io::SeekableInputStream* mSource;
+    sys::Off_T mLocalHeaderOffset;
+    InflaterPool* mInflaters;
     sys::Size_T mCompressedSize;
     sys::Size_T mUncompressedSize;
     std::string mFileName;
@@ -58,7 +69,7 @@ class ZipEntry
     sys::Uint32_T mExternalAttrs;
 
     static void inflate(sys::ubyte* out, sys::Size_T outLen, sys::ubyte* in,
-            sys::Size_T inLen);
+            sys::Size_T inLen, z_stream& zstream);
 
 public:
 
@@ -70,7 +81,39 @@ public:
             sys::Uint16_T compressionMethod, sys::Uint16_T lastModifiedTime,
             sys::Uint16_T lastModifiedDate, sys::Uint32_T crc32,
             sys::Uint16_T internalAttrs, sys::Uint32_T externalAttrs) :
-        mCompressedData(compressedData), mCompressedSize(compressedSize),
+        mCompressedData(compressedData), mSource(nullptr),
+                mLocalHeaderOffset(0), mInflaters(nullptr),
+                mCompressedSize(compressedSize),
+                mUncompressedSize(uncompressedSize), mFileName(fileName),
+                mFileComment(fileComment), mVersionMadeBy(versionMadeBy),
+                mVersionToExtract(versionToExtract), mGeneralPurposeBitFlag(
+                        generalPurposeBitFlag), mCompressionMethod(
+                        compressionMethod),
+                mLastModifiedTime(lastModifiedTime), mLastModifiedDate(
+                        lastModifiedDate), mCRC32(crc32), mInternalAttrs(
+                        internalAttrs), mExternalAttrs(externalAttrs)
+    {
+    }
+
+    /*!
+     *  An entry whose data is read from source, starting at the
+     *  local file header at localHeaderOffset, on demand.  Inflate
+     *  contexts come from inflaters, if given.  The source and pool must
+     *  outlive the entry.
+     */
+    ZipEntry(io::SeekableInputStream* source, sys::Off_T localHeaderOffset,
+            sys::Size_T compressedSize,
+            sys::Size_T uncompressedSize, std::string fileName,
+            std::string fileComment, sys::Uint16_T versionMadeBy,
+            sys::Uint16_T versionToExtract,
+            sys::Uint16_T generalPurposeBitFlag,
+            sys::Uint16_T compressionMethod, sys::Uint16_T lastModifiedTime,
+            sys::Uint16_T lastModifiedDate, sys::Uint32_T crc32,
+            sys::Uint16_T internalAttrs, sys::Uint32_T externalAttrs,
+            InflaterPool* inflaters = nullptr) :
+        mCompressedData(nullptr), mSource(source),
+                mLocalHeaderOffset(localHeaderOffset), mInflaters(inflaters),
+                mCompressedSize(compressedSize),
                 mUncompressedSize(uncompressedSize), mFileName(fileName),
                 mFileComment(fileComment), mVersionMadeBy(versionMadeBy),
                 mVersionToExtract(versionToExtract), mGeneralPurposeBitFlag(
@@ -86,8 +129,26 @@ public:
     {
     }
 
-    sys::ubyte* decompress();
-    void decompress(sys::ubyte* out, sys::Size_T outLen);
+    sys::ubyte* decompress() const;
+    void decompress(sys::ubyte* out, sys::Size_T outLen) const;
+
+    /*!
+     *  Open a stream that inflates the entry a piece at a time as it is
+     *  read, so memory use doesn't depend on the size of the entry.  The
+     *  CRC is checked once the last byte has been read.  Several streams,
+     *  of the same or different entries, may be read at once from
+     *  different threads.  The entry must outlive the stream.
+     */
+    std::unique_ptr<io::InputStream> openInputStream() const;
+
+    //!  Offset of the first byte of compressed data in the archive
+    sys::Off_T getDataOffset() const;
+
+    //!  True for the entries that only record a directory
+    bool isDirectory() const
+    {
+        return !mFileName.empty() && mFileName[mFileName.size() - 1] == '/';
+    }
 
     sys::Uint16_T getVersionMadeBy() const
     {
@@ -145,6 +206,10 @@ public:
     {
         return mCompressedSize;
     }
+    sys::Off_T getLocalHeaderOffset() const
+    {
+        return mLocalHeaderOffset;
+    }
 };
 
 /*!
@@ -23,6 +23,9 @@
 #ifndef __ZIP_ZIP_FILE_H__
 #define __ZIP_ZIP_FILE_H__
 
+#include <memory>
+#include <unordered_map>
+
 #include "zip/ZipEntry.h"
 
 /*!
@@ -46,6 +49,14 @@ namespace zip
  *  \class ZipFile
  *  \brief Contains the functionality for reading PKZIP files
  *
+ *  Given a seekable stream (or a pathname), only the end of central
+ *  directory record and the central directory are read up front; each
+ *  entry reads and inflates its own data from the archive when it is
+ *  decompressed or opened as a stream, so memory use doesn't grow with
+ *  the size of the archive.  Zip64 archives are supported.
+ *
+ *  A plain InputStream can't be read out of order, so that constructor
+ *  still reads the whole archive into memory first.
  */
 
 class ZipFile
@@ -54,38 +65,52 @@ class ZipFile
     //!  This is the container for ZipEntry objects
     std::vector<ZipEntry*> mEntries;
 
+    //!  Index into mEntries of the first entry with each name
+    std::unordered_map<std::string, size_t> mIndex;
+
+    //!  Inflate contexts shared by all of the entries
+    InflaterPool mInflaters;
+
     //!  Zip (apparently) is little-endian
     bool mSwapBytes;
 
-    //!  Compressed data buffer (yes we eat the whole file)
-    sys::ubyte* mCompressed;
-    sys::Size_T mCompressedLength;
+    //!  The archive, when we opened or buffered it ourselves
+    std::unique_ptr<io::SeekableInputStream> mOwnedInput;
+    io::SeekableInputStream* mInput;
+    sys::Off_T mLength;
 
     sys::Uint16_T mDiskNum;
     sys::Uint16_T mDiskWithCentralDir;
 
-    sys::Uint32_T mCentralDirSize;
-    sys::Uint32_T mCentralDirOffset;
+    sys::Uint64_T mCentralDirSize;
+    sys::Uint64_T mCentralDirOffset;
 
     std::string mComment;
 
     //!  Read an integer (little-endian)
-    sys::Uint32_T readInt(sys::ubyte* buf);
+    sys::Uint32_T readInt(const sys::ubyte* buf);
 
     //!  Read a short (little-endian)
-    sys::Uint16_T readShort(sys::ubyte* buf);
+    sys::Uint16_T readShort(const sys::ubyte* buf);
+
+    //!  Read a long (little-endian)
+    sys::Uint64_T readLong(const sys::ubyte* buf);
+
+    //!  Read exactly len bytes at offset
+    void readAt(sys::Off_T offset, void* buffer, size_t len);
 
     //!  Read the top-level zip directory
     void readCentralDir();
 
     //!  Get the ZipEntry for some element
-    ZipEntry* newCentralDirEntry(sys::ubyte** p, sys::SSize_T len);
+    ZipEntry* newCentralDirEntry(const sys::ubyte** p, const sys::ubyte* end);
 
-    //!  Get information for the central dir
-    void readCentralDirValues(sys::ubyte* buf, sys::SSize_T len);
+    //!  Get information for the central dir, returning its entry count
+    sys::Uint64_T readCentralDirValues(const sys::ubyte* buf,
+                                       sys::SSize_T len);
 
-    //!  Copy to a string
-    //void copyString(const sys::ubyte* buf, sys::SSize_T len);
+    //!  Replace the central dir values with those of the Zip64 record
+    sys::Uint64_T readZip64CentralDirValues(sys::Off_T eocdOffset);
 
 public:
 
@@ -95,18 +120,21 @@ public:
     /*!
      *  We require an input stream for initialization
      *  This stream should be already initialized, since we
-     *  are planning on reading from it immediately
+     *  are planning on reading from it immediately.  The
+     *  whole stream is read into memory.
      */
-    ZipFile(io::InputStream* inputStream) :
-        mCompressed(nullptr)
-    {
-        mSwapBytes = sys::isBigEndianSystem();
-        mCompressedLength = inputStream->available();
-        mCompressed = new sys::ubyte[mCompressedLength];
-        inputStream->read((sys::byte*) mCompressed, mCompressedLength);
+    ZipFile(io::InputStream* inputStream);
 
-        readCentralDir();
-    }
+    /*!
+     *  Read the archive from a seekable stream, which must stay open
+     *  for as long as the ZipFile (or any stream opened from one of its
+     *  entries) is in use.  Entries are read with positional reads, so
+     *  the stream's position is left alone.
+     */
+    ZipFile(io::SeekableInputStream* inputStream);
+
+    //!  Open and read the archive at pathname
+    ZipFile(const std::string& pathname);
 
     /*!
      *  When the ZipFile object goes out of scope, that
@@ -117,7 +145,28 @@ public:
     ~ZipFile();
 
     //!  Look for a ZipEntry with the same fileName
-    Iterator lookup(std::string fileName) const;
+    Iterator lookup(const std::string& fileName) const;
+
+    /*!
+     *  Decompress entries into buffer, one after another in the order
+     *  given, using up to numThreads threads.  buffer must have room for
+     *  the sum of the entries' uncompressed sizes.
+     *
+     *  \return Where each entry starts in buffer, plus (last) the total
+     *  \throw InvalidArgumentException if buffer is too small
+     */
+    std::vector<sys::Size_T> decompress(
+            const std::vector<const ZipEntry*>& entries,
+            sys::ubyte* buffer,
+            sys::Size_T bufferSize,
+            size_t numThreads = 1) const;
+
+    /*!
+     *  Extract every entry under directory, creating subdirectories as
+     *  needed.  Entries are inflated numThreads at a time.  Entries whose
+     *  names would land outside of directory are refused.
+     */
+    void extract(const std::string& directory, size_t numThreads = 1) const;
 
     //!  Iterator to beginning of collection
     Iterator begin() const
@@ -131,11 +180,11 @@ public:
         return mEntries.end();
     }
 
-    sys::Uint32_T getCentralDirSize() const
+    sys::Uint64_T getCentralDirSize() const
     {
         return mCentralDirSize;
     }
-    sys::Uint32_T getCentralDirOffset() const
+    sys::Uint64_T getCentralDirOffset() const
     {
         return mCentralDirOffset;
     }
@@ -22,9 +22,371 @@
 
 #include "zip/GZipInputStream.h"
 
+#include <string.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <mt/Runnable1D.h>
+
 using namespace zip;
 
-GZipInputStream::GZipInputStream(const std::string& file)
+namespace
+{
+// Inflated data is handed to the reader in pieces of about this size
+const size_t CHUNK_SIZE = 1 << 20;
+
+sys::Uint32_T readLE(const Bytef* data, size_t numBytes)
+{
+    sys::Uint32_T value = 0;
+    for (size_t ii = 0; ii < numBytes; ++ii)
+    {
+        value |= static_cast<sys::Uint32_T>(data[ii]) << (8 * ii);
+    }
+    return value;
+}
+
+/*
+ *  If the header at 'header' is that of a sized member, as written by a
+ *  block-parallel GZipOutputStream, return the size of the whole member.
+ *  Otherwise return zero.
+ */
+size_t getSizedMemberLength(const Bytef* header, size_t available)
+{
+    if (available < GZIP_SIZED_HEADER_LEN ||
+        header[0] != 0x1f || header[1] != 0x8b || header[2] != 8 ||
+        header[3] != 0x04 ||
+        readLE(header + GZIP_HEADER_LEN, 2) != GZIP_SIZE_XLEN ||
+        header[12] != GZIP_SIZE_SI1 || header[13] != GZIP_SIZE_SI2 ||
+        readLE(header + 14, 2) != 4)
+    {
+        return 0;
+    }
+    const size_t length = readLE(header + 16, 4);
+    return length >= GZIP_SIZED_HEADER_LEN + GZIP_TRAILER_LEN ? length : 0;
+}
+
+// Inflate one complete sized member and check it against its trailer
+void inflateMember(const std::vector<Bytef>& member, std::vector<Bytef>& out)
+{
+    const Bytef* const trailer = &member[member.size() - GZIP_TRAILER_LEN];
+    const sys::Uint32_T crc = readLE(trailer, 4);
+    const size_t size = readLE(trailer + 4, 4);
+
+    z_stream stream = {};
+    if (inflateInit2(&stream, -MAX_WBITS) != Z_OK)
+    {
+        throw except::IOException(Ctxt("Failed to initialize inflate"));
+    }
+    stream.next_in = const_cast<Bytef*>(&member[GZIP_SIZED_HEADER_LEN]);
+    stream.avail_in = static_cast<uInt>(
+            member.size() - GZIP_SIZED_HEADER_LEN - GZIP_TRAILER_LEN);
+
+    // The trailer's size can't be trusted with an allocation, so the
+    // buffer only grows as data actually comes out.  It can end up one
+    // byte bigger than the trailer says, which is how too much data is
+    // caught below.
+    out.resize(std::min(size, CHUNK_SIZE) + 1);
+    size_t produced = 0;
+    int rv = Z_OK;
+    while (true)
+    {
+        stream.next_out = &out[produced];
+        stream.avail_out = static_cast<uInt>(out.size() - produced);
+        rv = inflate(&stream, Z_FINISH);
+        produced = out.size() - stream.avail_out;
+        if ((rv != Z_OK && rv != Z_BUF_ERROR) || stream.avail_out != 0 ||
+            produced > size)
+        {
+            break;
+        }
+        out.resize(out.size() + std::min(size + 1 - produced, out.size()));
+    }
+    inflateEnd(&stream);
+
+    if (rv != Z_STREAM_END || produced != size ||
+        crc32(crc32(0, Z_NULL, 0), out.data(),
+              static_cast<uInt>(size)) != crc)
+    {
+        throw except::IOException(Ctxt("Corrupt gzip member"));
+    }
+    out.resize(size);
+}
+}
+
+/*
+ *  Inflates the file on a background thread and queues the results for
+ *  readImpl().  The queue is bounded, so the thread never gets more than
+ *  a couple of batches ahead of the reader.
+ */
+struct GZipInputStream::ReadAhead
+{
+    ReadAhead(const std::string& file, size_t numThreads) :
+        mFile(file),
+        mLength(static_cast<size_t>(mFile.length())),
+        mOffset(0),
+        mNumThreads(std::max<size_t>(numThreads, 1)),
+        mMaxQueued(2 * mNumThreads),
+        mPosition(0),
+        mDone(false),
+        mStop(false)
+    {
+        mThread = std::thread(&ReadAhead::run, this);
+    }
+
+    ~ReadAhead()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mStop = true;
+        }
+        mNotFull.notify_all();
+        mThread.join();
+    }
+
+    // Returns 0 once the stream is exhausted
+    size_t read(void* buffer, size_t len)
+    {
+        sys::byte* const out = static_cast<sys::byte*>(buffer);
+        size_t numRead = 0;
+        while (numRead < len)
+        {
+            if (mPosition == mCurrent.size())
+            {
+                // Only block for more data if we have nothing to return
+                if (!next(numRead == 0))
+                {
+                    break;
+                }
+                continue;
+            }
+            const size_t count =
+                    std::min(len - numRead, mCurrent.size() - mPosition);
+            memcpy(out + numRead, &mCurrent[mPosition], count);
+            mPosition += count;
+            numRead += count;
+        }
+        return numRead;
+    }
+
+private:
+    // Make the next queued chunk current
+    bool next(bool wait)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        if (wait)
+        {
+            mNotEmpty.wait(lock, [this]()
+            {
+                return !mQueue.empty() || mDone;
+            });
+        }
+        if (mQueue.empty())
+        {
+            if (mDone && mError)
+            {
+                std::rethrow_exception(mError);
+            }
+            return false;
+        }
+        mCurrent.swap(mQueue.front());
+        mQueue.pop_front();
+        mPosition = 0;
+        lock.unlock();
+        mNotFull.notify_one();
+        return true;
+    }
+
+    // Returns false if the reader has gone away
+    bool push(std::vector<Bytef>& chunk)
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mNotFull.wait(lock, [this]()
+        {
+            return mQueue.size() < mMaxQueued || mStop;
+        });
+        if (mStop)
+        {
+            return false;
+        }
+        mQueue.push_back(std::vector<Bytef>());
+        mQueue.back().swap(chunk);
+        lock.unlock();
+        mNotEmpty.notify_one();
+        return true;
+    }
+
+    void run()
+    {
+        try
+        {
+            if (inflateSizedMembers())
+            {
+                inflateSerially();
+            }
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mError = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDone = true;
+        }
+        mNotEmpty.notify_all();
+    }
+
+    /*
+     *  Inflate batches of sized members in parallel for as long as the
+     *  file is made of them.  Returns false if the reader went away,
+     *  otherwise true with mOffset at the first byte not yet inflated.
+     */
+    bool inflateSizedMembers()
+    {
+        Bytef header[GZIP_SIZED_HEADER_LEN];
+        while (mOffset < mLength)
+        {
+            std::vector<std::vector<Bytef> > members;
+            size_t offset = mOffset;
+            while (members.size() < mNumThreads && offset < mLength)
+            {
+                const size_t available =
+                        std::min<size_t>(GZIP_SIZED_HEADER_LEN, mLength - offset);
+                mFile.readAt(offset, header, available);
+                const size_t length = getSizedMemberLength(header, available);
+                if (length == 0 || length > mLength - offset)
+                {
+                    break;
+                }
+                members.push_back(std::vector<Bytef>(length));
+                mFile.readAt(offset, members.back().data(), length);
+                offset += length;
+            }
+            if (members.empty())
+            {
+                return true;
+            }
+
+            std::vector<std::vector<Bytef> > inflated(members.size());
+            mt::run1D(members.size(), std::min(mNumThreads, members.size()),
+                      [&](size_t ii)
+            {
+                inflateMember(members[ii], inflated[ii]);
+            });
+            mOffset = offset;
+
+            for (auto& chunk : inflated)
+            {
+                if (!chunk.empty() && !push(chunk))
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Inflate whatever gzip data is left, one member after another
+    void inflateSerially()
+    {
+        if (mOffset >= mLength)
+        {
+            return;
+        }
+
+        z_stream stream = {};
+        if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK)
+        {
+            throw except::IOException(Ctxt("Failed to initialize inflate"));
+        }
+        std::vector<Bytef> input(CHUNK_SIZE);
+        std::vector<Bytef> output(CHUNK_SIZE);
+        stream.next_out = output.data();
+        stream.avail_out = static_cast<uInt>(output.size());
+
+        int rv = Z_OK;
+        while (true)
+        {
+            if (stream.avail_in == 0 && mOffset < mLength)
+            {
+                const size_t count = std::min(input.size(), mLength - mOffset);
+                mFile.readAt(mOffset, input.data(), count);
+                mOffset += count;
+                stream.next_in = input.data();
+                stream.avail_in = static_cast<uInt>(count);
+            }
+
+            rv = inflate(&stream, Z_NO_FLUSH);
+            if (rv == Z_STREAM_END)
+            {
+                // Another member may follow this one
+                if (stream.avail_in == 0 && mOffset == mLength)
+                {
+                    break;
+                }
+                inflateReset(&stream);
+            }
+            else if (rv != Z_OK && !(rv == Z_BUF_ERROR && stream.avail_in == 0 &&
+                                     mOffset < mLength))
+            {
+                break;
+            }
+
+            if (stream.avail_out == 0)
+            {
+                if (!push(output))
+                {
+                    break;
+                }
+                output.resize(CHUNK_SIZE);
+                stream.next_out = output.data();
+                stream.avail_out = static_cast<uInt>(output.size());
+            }
+        }
+        inflateEnd(&stream);
+
+        if (rv != Z_STREAM_END && rv != Z_OK)
+        {
+            throw except::IOException(Ctxt(
+                    rv == Z_BUF_ERROR ? "Unexpected end of gzip stream" :
+                                        "Corrupt gzip stream"));
+        }
+        output.resize(output.size() - stream.avail_out);
+        if (!output.empty())
+        {
+            push(output);
+        }
+    }
+
+    sys::File mFile;
+    const size_t mLength;
+    size_t mOffset;
+    const size_t mNumThreads;
+    const size_t mMaxQueued;
+
+    // Owned by the reader
+    std::vector<Bytef> mCurrent;
+    size_t mPosition;
+
+    std::mutex mMutex;
+    std::condition_variable mNotEmpty;
+    std::condition_variable mNotFull;
+    std::deque<std::vector<Bytef> > mQueue;
+    bool mDone;
+    bool mStop;
+    std::exception_ptr mError;
+    std::thread mThread;
+};
+
+GZipInputStream::GZipInputStream(const std::string& file) :
+    mFile(NULL)
 {
     mFile = gzopen(file.c_str(), "rb");
     if (mFile == NULL)
@@ -34,14 +396,42 @@ GZipInputStream::GZipInputStream(const std::string& file)
     }
 }
 
+GZipInputStream::GZipInputStream(const std::string& file, size_t numThreads) :
+    mFile(NULL)
+{
+    if (!sys::OS().isFile(file))
+    {
+        throw except::IOException(Ctxt(
+                "Failed to open gzip stream [" + file + "]"));
+    }
+    mReadAhead.reset(new ReadAhead(file, numThreads));
+}
+
+GZipInputStream::~GZipInputStream()
+{
+}
+
 void GZipInputStream::close()
 {
+    if (mReadAhead.get())
+    {
+        mReadAhead.reset();
+        return;
+    }
+
     gzclose( mFile);
     mFile = NULL;
 }
 
 sys::SSize_T GZipInputStream::readImpl(void* buffer, size_t len)
 {
+    if (mReadAhead.get())
+    {
+        const size_t numRead = mReadAhead->read(buffer, len);
+        return numRead == 0 ? io::InputStream::IS_EOF :
+                              static_cast<sys::SSize_T>(numRead);
+    }
+
     auto rv = gzread(mFile, buffer, static_cast<unsigned int>(len));
     if (rv == -1)
     {
@@ -22,9 +22,256 @@
 
 #include "zip/GZipOutputStream.h"
 
+#include <algorithm>
+#include <vector>
+
+#include <mt/Runnable1D.h>
+
 using namespace zip;
 
-GZipOutputStream::GZipOutputStream(const std::string& file)
+namespace
+{
+// Deflate's window; this much history primes the next block
+const size_t MAX_DICTIONARY = 32768;
+
+void appendLE(std::vector<Bytef>& out, sys::Uint32_T value, size_t numBytes)
+{
+    for (size_t ii = 0; ii < numBytes; ++ii)
+    {
+        out.push_back(static_cast<Bytef>((value >> (8 * ii)) & 0xff));
+    }
+}
+
+void appendHeader(std::vector<Bytef>& out, bool sized)
+{
+    // ID1, ID2, CM = deflate, FLG, MTIME (unset), XFL, OS = unknown
+    const Bytef header[GZIP_HEADER_LEN] =
+    { 0x1f, 0x8b, 8, static_cast<Bytef>(sized ? 0x04 : 0), 0, 0, 0, 0, 0, 0xff };
+    out.insert(out.end(), header, header + GZIP_HEADER_LEN);
+    if (sized)
+    {
+        // XLEN, then one subfield whose payload is the member size,
+        // filled in by setMemberSize() once the member is complete
+        appendLE(out, GZIP_SIZE_XLEN, 2);
+        out.push_back(GZIP_SIZE_SI1);
+        out.push_back(GZIP_SIZE_SI2);
+        appendLE(out, 4, 2);
+        appendLE(out, 0, 4);
+    }
+}
+
+void setMemberSize(std::vector<Bytef>& member)
+{
+    const auto size = static_cast<sys::Uint32_T>(member.size());
+    for (size_t ii = 0; ii < 4; ++ii)
+    {
+        member[GZIP_SIZED_HEADER_LEN - 4 + ii] =
+                static_cast<Bytef>((size >> (8 * ii)) & 0xff);
+    }
+}
+
+/*
+ *  Raw-deflate one block onto the end of 'out'.  Unless this is the last
+ *  block of the member, the block ends with a sync flush so the next
+ *  block's deflate data can simply be appended to it.
+ */
+void deflateBlock(const Bytef* data, size_t len,
+                  const Bytef* dictionary, size_t dictionaryLen,
+                  bool last, int level, std::vector<Bytef>& out)
+{
+    z_stream stream = {};
+    if (deflateInit2(&stream, level, Z_DEFLATED, -MAX_WBITS, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        throw except::IOException(Ctxt("Failed to initialize deflate"));
+    }
+    if (dictionaryLen > 0 &&
+        deflateSetDictionary(&stream, dictionary,
+                             static_cast<uInt>(dictionaryLen)) != Z_OK)
+    {
+        deflateEnd(&stream);
+        throw except::IOException(Ctxt("Failed to set deflate dictionary"));
+    }
+
+    const size_t start = out.size();
+    // The sync flush adds at most an empty stored block to the bound
+    size_t capacity = deflateBound(&stream, static_cast<uLong>(len)) + 16;
+    out.resize(start + capacity);
+
+    stream.next_in = const_cast<Bytef*>(data);
+    stream.avail_in = static_cast<uInt>(len);
+    stream.next_out = &out[start];
+    stream.avail_out = static_cast<uInt>(capacity);
+    const int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    while (true)
+    {
+        const int rv = deflate(&stream, flush);
+        if (rv == Z_STREAM_ERROR)
+        {
+            deflateEnd(&stream);
+            throw except::IOException(Ctxt("Failed to deflate block"));
+        }
+        if ((last && rv == Z_STREAM_END) ||
+            (!last && stream.avail_out > 0))
+        {
+            break;
+        }
+
+        // Out of room; grow and carry on where deflate left off
+        const size_t used = capacity - stream.avail_out;
+        capacity *= 2;
+        out.resize(start + capacity);
+        stream.next_out = &out[start + used];
+        stream.avail_out = static_cast<uInt>(capacity - used);
+    }
+    out.resize(start + capacity - stream.avail_out);
+    deflateEnd(&stream);
+}
+}
+
+struct GZipOutputStream::BlockCompressor
+{
+    BlockCompressor(const std::string& file,
+                    size_t numThreads,
+                    size_t blockSize,
+                    bool independentMembers,
+                    int level) :
+        mFile(file, sys::File::WRITE_ONLY,
+              sys::File::CREATE | sys::File::TRUNCATE),
+        mNumThreads(std::max<size_t>(numThreads, 1)),
+        mBlockSize(blockSize),
+        mIndependentMembers(independentMembers),
+        mLevel(level),
+        mHistory(0),
+        mCrc(crc32(0, Z_NULL, 0)),
+        mTotal(0),
+        mWroteHeader(false)
+    {
+        if (mBlockSize == 0 || mBlockSize > (1u << 30))
+        {
+            throw except::InvalidArgumentException(Ctxt(
+                    "Block size must be between 1 byte and 1GB"));
+        }
+    }
+
+    void write(const void* buffer, size_t len)
+    {
+        const Bytef* data = static_cast<const Bytef*>(buffer);
+        const size_t batchSize = mNumThreads * mBlockSize;
+        while (len > 0)
+        {
+            // Fill to one byte past a batch before compressing it, so the
+            // final block written by close() is only ever empty when the
+            // whole stream is
+            const size_t pending = mBuffer.size() - mHistory;
+            const size_t count = std::min(batchSize + 1 - pending, len);
+            mBuffer.insert(mBuffer.end(), data, data + count);
+            data += count;
+            len -= count;
+
+            if (mBuffer.size() - mHistory > batchSize)
+            {
+                compress(batchSize, false);
+            }
+        }
+    }
+
+    void close()
+    {
+        compress(mBuffer.size() - mHistory, true);
+        mFile.close();
+    }
+
+private:
+    /*
+     *  Compress the first len pending bytes, a batch of blocks at a time,
+     *  and write them out.  If finish is set these are the last bytes of
+     *  the stream.
+     */
+    void compress(size_t len, bool finish)
+    {
+        const size_t numBlocks = std::max<size_t>(
+                (len + mBlockSize - 1) / mBlockSize, 1);
+        std::vector<std::vector<Bytef> > blocks(numBlocks);
+        std::vector<uLong> crcs(numBlocks);
+
+        const Bytef* const pending = mBuffer.data() + mHistory;
+        mt::run1D(numBlocks, std::min(mNumThreads, numBlocks),
+                  [&](size_t ii)
+        {
+            const size_t offset = ii * mBlockSize;
+            const size_t blockLen = std::min(mBlockSize, len - offset);
+            const Bytef* const block = pending + offset;
+            crcs[ii] = crc32(0, block, static_cast<uInt>(blockLen));
+
+            if (mIndependentMembers)
+            {
+                appendHeader(blocks[ii], true);
+                deflateBlock(block, blockLen, nullptr, 0, true, mLevel,
+                             blocks[ii]);
+                appendLE(blocks[ii], static_cast<sys::Uint32_T>(crcs[ii]), 4);
+                appendLE(blocks[ii], static_cast<sys::Uint32_T>(blockLen), 4);
+                setMemberSize(blocks[ii]);
+            }
+            else
+            {
+                const size_t dictionaryLen =
+                        std::min(MAX_DICTIONARY, mHistory + offset);
+                deflateBlock(block, blockLen, block - dictionaryLen,
+                             dictionaryLen, finish && ii == numBlocks - 1,
+                             mLevel, blocks[ii]);
+            }
+        });
+
+        if (!mIndependentMembers && !mWroteHeader)
+        {
+            std::vector<Bytef> header;
+            appendHeader(header, false);
+            mFile.writeFrom(header.data(), header.size());
+            mWroteHeader = true;
+        }
+        for (size_t ii = 0; ii < numBlocks; ++ii)
+        {
+            const size_t blockLen =
+                    std::min(mBlockSize, len - std::min(len, ii * mBlockSize));
+            mCrc = crc32_combine(mCrc, crcs[ii], static_cast<z_off_t>(blockLen));
+            mFile.writeFrom(blocks[ii].data(), blocks[ii].size());
+        }
+        mTotal += len;
+
+        if (finish && !mIndependentMembers)
+        {
+            std::vector<Bytef> trailer;
+            appendLE(trailer, static_cast<sys::Uint32_T>(mCrc), 4);
+            appendLE(trailer, static_cast<sys::Uint32_T>(mTotal), 4);
+            mFile.writeFrom(trailer.data(), trailer.size());
+        }
+
+        // Keep the tail of what was just compressed to prime the next batch
+        const size_t consumed = mHistory + len;
+        const size_t keep = std::min(MAX_DICTIONARY, consumed);
+        mBuffer.erase(mBuffer.begin(), mBuffer.begin() + (consumed - keep));
+        mHistory = keep;
+    }
+
+    sys::File mFile;
+    const size_t mNumThreads;
+    const size_t mBlockSize;
+    const bool mIndependentMembers;
+    const int mLevel;
+
+    // Up to MAX_DICTIONARY bytes of already compressed history,
+    // followed by the bytes not yet compressed
+    std::vector<Bytef> mBuffer;
+    size_t mHistory;
+
+    uLong mCrc;
+    sys::Uint64_T mTotal;
+    bool mWroteHeader;
+};
+
+GZipOutputStream::GZipOutputStream(const std::string& file) :
+    mFile(NULL)
 {
     mFile = gzopen(file.c_str(), "wb");
     if (mFile == NULL)
@@ -35,8 +282,29 @@ GZipOutputStream::GZipOutputStream(const std::string& file)
 
 }
 
+GZipOutputStream::GZipOutputStream(const std::string& file,
+                                   size_t numThreads,
+                                   size_t blockSize,
+                                   bool independentMembers,
+                                   int level) :
+    mFile(NULL),
+    mCompressor(new BlockCompressor(file, numThreads, blockSize,
+                                    independentMembers, level))
+{
+}
+
+GZipOutputStream::~GZipOutputStream()
+{
+}
+
 void GZipOutputStream::write(const void* buffer, size_t len)
 {
+    if (mCompressor.get())
+    {
+        mCompressor->write(buffer, len);
+        return;
+    }
+
     size_t written = 0;
     int rv = 0;
     const sys::byte* const bufferPtr = static_cast<const sys::byte*>(buffer);
@@ -58,6 +326,13 @@ void GZipOutputStream::write(const void* buffer, size_t len)
 
 void GZipOutputStream::close()
 {
+    if (mCompressor.get())
+    {
+        mCompressor->close();
+        mCompressor.reset();
+        return;
+    }
+
     gzclose( mFile);
     mFile = NULL;
 }
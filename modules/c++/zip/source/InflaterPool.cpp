@@ -0,0 +1,117 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "zip/InflaterPool.h"
+
+#include <string.h>
+
+namespace
+{
+// Bigger input buffers are freed rather than kept with an idle inflater
+const size_t MAX_IDLE_INPUT = 256 * 1024;
+}
+
+namespace zip
+{
+InflaterPool::InflaterPool(size_t maxIdle) :
+    mMaxIdle(maxIdle)
+{
+}
+
+InflaterPool::~InflaterPool()
+{
+    for (size_t ii = 0; ii < mIdle.size(); ++ii)
+    {
+        destroy(mIdle[ii]);
+    }
+}
+
+InflaterPool::Inflater* InflaterPool::create()
+{
+    Inflater* const inflater = new Inflater;
+    memset(&inflater->stream, 0, sizeof(inflater->stream));
+    const int zerr = inflateInit2(&inflater->stream, -MAX_WBITS);
+    if (zerr != Z_OK)
+    {
+        delete inflater;
+        throw except::IOException(Ctxt(
+                FmtX("inflateInit2 failed [%d]", zerr)));
+    }
+    return inflater;
+}
+
+void InflaterPool::destroy(Inflater* inflater)
+{
+    inflateEnd(&inflater->stream);
+    delete inflater;
+}
+
+InflaterPool::Inflater* InflaterPool::acquire(InflaterPool* pool)
+{
+    Inflater* inflater = nullptr;
+    if (pool)
+    {
+        std::lock_guard<std::mutex> lock(pool->mMutex);
+        if (!pool->mIdle.empty())
+        {
+            inflater = pool->mIdle.back();
+            pool->mIdle.pop_back();
+        }
+    }
+    if (inflater == nullptr)
+    {
+        return create();
+    }
+
+    // Much cheaper than inflateEnd() and inflateInit2(); the window and
+    // tables are kept
+    if (inflateReset(&inflater->stream) != Z_OK)
+    {
+        destroy(inflater);
+        return create();
+    }
+    return inflater;
+}
+
+void InflaterPool::release(InflaterPool* pool, Inflater* inflater)
+{
+    if (inflater == nullptr)
+    {
+        return;
+    }
+    if (pool)
+    {
+        if (inflater->input.capacity() > MAX_IDLE_INPUT)
+        {
+            std::vector<Bytef>().swap(inflater->input);
+        }
+
+        std::lock_guard<std::mutex> lock(pool->mMutex);
+        if (pool->mIdle.size() < pool->mMaxIdle)
+        {
+            pool->mIdle.push_back(inflater);
+            return;
+        }
+    }
+    destroy(inflater);
+}
+}
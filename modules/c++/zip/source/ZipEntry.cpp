@@ -22,6 +22,12 @@
 
 #include "zip/ZipEntry.h"
 
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "io/BufferViewStream.h"
+
 const static char* sZipFileMadeByStr[] = {
         "MS-DOS and OS/2 (FAT / VFAT / FAT32 file systems)", "Amiga",
         "OpenVMS", "UNIX", "VM/CMS", "Atari ST", "OS/2 H.P.F.S.", "Macintosh",
@@ -29,30 +35,210 @@ const static char* sZipFileMadeByStr[] = {
         "Acorn Risc", "VFAT", "alternative MVS", "BeOS", "Tandem", "OS/400",
         "OS/X (Darwin)", NULL };
 
+namespace
+{
+// Compressed bytes are read from the archive this much at a time
+const size_t READ_CHUNK_SIZE = 65536;
+
+// Entries up to this size are decompressed with a single read and inflate
+const size_t SMALL_ENTRY_SIZE = 1 << 20;
+
+// Room for a local extra field longer than the central directory's
+const size_t LOCAL_EXTRA_SLACK = 256;
+
+sys::Uint16_T readShort(const sys::ubyte* buf)
+{
+    return static_cast<sys::Uint16_T>(buf[0] | (buf[1] << 8));
+}
+
+sys::Uint32_T readInt(const sys::ubyte* buf)
+{
+    return static_cast<sys::Uint32_T>(readShort(buf)) |
+            (static_cast<sys::Uint32_T>(readShort(buf + 2)) << 16);
+}
+
+void readFully(io::SeekableInputStream& source, sys::Off_T offset,
+               void* buffer, size_t len)
+{
+    source.readv({ { offset, buffer, len } });
+}
+
+// Like readFully(), but stops short at the end of the source
+size_t readUpTo(io::SeekableInputStream& source, sys::Off_T offset,
+                void* buffer, size_t len)
+{
+    sys::byte* const bytes = static_cast<sys::byte*>(buffer);
+    size_t numRead = 0;
+    while (numRead < len)
+    {
+        const sys::SSize_T thisRead =
+                source.readAt(offset + numRead, bytes + numRead, len - numRead);
+        if (thisRead <= 0)
+        {
+            break;
+        }
+        numRead += static_cast<size_t>(thisRead);
+    }
+    return numRead;
+}
+
+// Holds an inflater from the pool (or a fresh one) until it goes away
+class InflaterLease
+{
+public:
+    explicit InflaterLease(zip::InflaterPool* pool) :
+        mPool(pool),
+        mInflater(zip::InflaterPool::acquire(pool))
+    {
+    }
+
+    ~InflaterLease()
+    {
+        zip::InflaterPool::release(mPool, mInflater);
+    }
+
+    zip::InflaterPool::Inflater& operator*() const
+    {
+        return *mInflater;
+    }
+
+private:
+    InflaterLease(const InflaterLease&);
+    InflaterLease& operator=(const InflaterLease&);
+
+    zip::InflaterPool* const mPool;
+    zip::InflaterPool::Inflater* const mInflater;
+};
+
+/*
+ *  Inflates (or, for stored entries, copies) one entry straight from the
+ *  archive, reading the compressed data a chunk at a time.  Positional
+ *  reads leave the archive stream alone, so any number of these can be
+ *  read at once.
+ */
+class EntryInputStream : public io::InputStream
+{
+public:
+    EntryInputStream(io::SeekableInputStream& source, sys::Off_T dataOffset,
+                     sys::Uint64_T compressedSize,
+                     sys::Uint64_T uncompressedSize,
+                     bool stored, sys::Uint32_T crc,
+                     zip::InflaterPool* inflaters) :
+        mSource(source),
+        mOffset(dataOffset),
+        mCompressedRemaining(compressedSize),
+        mUncompressedRemaining(uncompressedSize),
+        mStored(stored),
+        mExpectedCRC(crc),
+        mCRC(crc32(0, Z_NULL, 0))
+    {
+        if (!mStored)
+        {
+            mInflater.reset(new InflaterLease(inflaters));
+            if ((**mInflater).input.size() < READ_CHUNK_SIZE)
+            {
+                (**mInflater).input.resize(READ_CHUNK_SIZE);
+            }
+        }
+    }
+
+    sys::Off_T available() override
+    {
+        return static_cast<sys::Off_T>(mUncompressedRemaining);
+    }
+
+protected:
+    sys::SSize_T readImpl(void* buffer, size_t len) override
+    {
+        if (mUncompressedRemaining == 0)
+        {
+            return io::InputStream::IS_EOF;
+        }
+        len = static_cast<size_t>(std::min<sys::Uint64_T>(
+                std::min<sys::Uint64_T>(len, mUncompressedRemaining),
+                std::numeric_limits<uInt>::max()));
+
+        size_t numRead = 0;
+        if (mStored)
+        {
+            readFully(mSource, mOffset, buffer, len);
+            mOffset += len;
+            numRead = len;
+        }
+        else
+        {
+            z_stream& stream = (**mInflater).stream;
+            std::vector<Bytef>& input = (**mInflater).input;
+            stream.next_out = static_cast<Bytef*>(buffer);
+            stream.avail_out = static_cast<uInt>(len);
+            while (stream.avail_out > 0)
+            {
+                if (stream.avail_in == 0 && mCompressedRemaining > 0)
+                {
+                    const size_t count = static_cast<size_t>(
+                            std::min<sys::Uint64_T>(input.size(),
+                                                    mCompressedRemaining));
+                    readFully(mSource, mOffset, input.data(), count);
+                    mOffset += count;
+                    mCompressedRemaining -= count;
+                    stream.next_in = input.data();
+                    stream.avail_in = static_cast<uInt>(count);
+                }
+
+                const int zerr = ::inflate(&stream, Z_NO_FLUSH);
+                if (zerr == Z_STREAM_END)
+                {
+                    break;
+                }
+                if (zerr != Z_OK)
+                {
+                    throw except::IOException(Ctxt(
+                            FmtX("inflate failed [%d]", zerr)));
+                }
+            }
+            numRead = len - stream.avail_out;
+            if (numRead == 0)
+            {
+                throw except::IOException(Ctxt(
+                        "Compressed data ended before the entry did"));
+            }
+        }
+
+        mCRC = crc32(mCRC, static_cast<const Bytef*>(buffer),
+                     static_cast<uInt>(numRead));
+        mUncompressedRemaining -= numRead;
+        if (mUncompressedRemaining == 0 && mCRC != mExpectedCRC)
+        {
+            throw except::IOException(Ctxt("Entry failed its CRC check"));
+        }
+        return static_cast<sys::SSize_T>(numRead);
+    }
+
+private:
+    io::SeekableInputStream& mSource;
+    sys::Off_T mOffset;
+    sys::Uint64_T mCompressedRemaining;
+    sys::Uint64_T mUncompressedRemaining;
+    const bool mStored;
+    const uLong mExpectedCRC;
+    uLong mCRC;
+    std::unique_ptr<InflaterLease> mInflater;
+};
+}
+
 namespace zip
 {
 void ZipEntry::inflate(sys::ubyte* out, sys::Size_T outLen, sys::ubyte* in,
-        sys::Size_T inLen)
+        sys::Size_T inLen, z_stream& zstream)
 {
-    z_stream zstream;
-    memset(&zstream, 0, sizeof(zstream));
-    zstream.zalloc = Z_NULL;
-    zstream.zfree = Z_NULL;
-    zstream.opaque = Z_NULL;
     zstream.next_in = in;
     zstream.avail_in = static_cast <uInt>(inLen);
     zstream.next_out = (Bytef*) out;
     zstream.avail_out = static_cast <uInt>(outLen);
     zstream.data_type = Z_UNKNOWN;
 
-    int zerr = inflateInit2(&zstream, -MAX_WBITS);
-    if (zerr != Z_OK)
-    {
-        throw except::IOException(Ctxt(FmtX("inflateInit2 failed [%d]", zerr)));
-    }
-
     // decompress
-    zerr = ::inflate(&zstream, Z_FINISH);
+    const int zerr = ::inflate(&zstream, Z_FINISH);
 
     if (zerr != Z_STREAM_END)
     {
@@ -60,7 +246,6 @@ void ZipEntry::inflate(sys::ubyte* out, sys::Size_T outLen, sys::ubyte* in,
                 "inflate failed [%d]: wanted: %d, got: %lu", zerr,
                 Z_STREAM_END, zstream.total_out)));
     }
-    inflateEnd(&zstream);
 }
 
 const char* ZipEntry::getVersionMadeByString() const
@@ -72,23 +257,136 @@ const char* ZipEntry::getVersionMadeByString() const
     return sZipFileMadeByStr[mVersionMadeBy];
 }
 
-sys::ubyte* ZipEntry::decompress()
+sys::ubyte* ZipEntry::decompress() const
 {
     sys::ubyte* uncompressed = new sys::ubyte[mUncompressedSize];
     decompress(uncompressed, mUncompressedSize);
     return uncompressed;
 }
 
-void ZipEntry::decompress(sys::ubyte* out, sys::Size_T outLen)
+void ZipEntry::decompress(sys::ubyte* out, sys::Size_T outLen) const
 {
-    if (mCompressionMethod == COMP_STORED)
+    if (mSource && (mCompressionMethod != COMP_DEFLATED ||
+                    mCompressedSize > SMALL_ENTRY_SIZE))
+    {
+        std::unique_ptr<io::InputStream> input(openInputStream());
+        sys::Size_T numRead = 0;
+        while (numRead < outLen)
+        {
+            const sys::SSize_T thisRead =
+                    input->read(out + numRead, outLen - numRead);
+            if (thisRead <= 0)
+            {
+                break;
+            }
+            numRead += static_cast<sys::Size_T>(thisRead);
+        }
+    }
+    else if (mSource)
+    {
+        // Read the local header and the compressed data together, guessing
+        // the header's length from the central directory's copy
+        const InflaterLease inflater(mInflaters);
+        std::vector<Bytef>& input = (*inflater).input;
+        size_t length = LFH_SIZE + mFileName.size() + LOCAL_EXTRA_SLACK +
+                mCompressedSize;
+        input.resize(std::max(input.size(), length));
+        length = readUpTo(*mSource, mLocalHeaderOffset, input.data(), length);
+        if (length < LFH_SIZE || readInt(input.data()) != LFH_SIGNATURE)
+        {
+            throw except::IOException(Ctxt(
+                    "Did not find local file header for " + mFileName));
+        }
+
+        const size_t dataStart = LFH_SIZE + readShort(&input[26]) +
+                readShort(&input[28]);
+        const size_t dataEnd = dataStart + mCompressedSize;
+        if (dataEnd > length)
+        {
+            input.resize(std::max(input.size(), dataEnd));
+            readFully(*mSource, mLocalHeaderOffset + length,
+                      &input[length], dataEnd - length);
+        }
+
+        inflate(out, outLen, &input[dataStart], mCompressedSize,
+                (*inflater).stream);
+        if (outLen >= mUncompressedSize &&
+            crc32(crc32(0, Z_NULL, 0), out,
+                  static_cast<uInt>(mUncompressedSize)) != mCRC32)
+        {
+            throw except::IOException(Ctxt(
+                    "Entry " + mFileName + " failed its CRC check"));
+        }
+    }
+    else if (mCompressionMethod == COMP_STORED)
     {
         memcpy(out, mCompressedData, outLen);
     }
     else
     {
-        inflate(out, outLen, mCompressedData, mCompressedSize);
+        const InflaterLease inflater(mInflaters);
+        inflate(out, outLen, mCompressedData, mCompressedSize,
+                (*inflater).stream);
+    }
+}
+
+std::unique_ptr<io::InputStream> ZipEntry::openInputStream() const
+{
+    if (mCompressionMethod != COMP_STORED &&
+        mCompressionMethod != COMP_DEFLATED)
+    {
+        throw except::NotImplementedException(Ctxt(FmtX(
+                "Unsupported compression method [%d] for %s",
+                mCompressionMethod, mFileName.c_str())));
+    }
+
+    if (mSource)
+    {
+        return std::unique_ptr<io::InputStream>(new EntryInputStream(
+                *mSource, getDataOffset(), mCompressedSize, mUncompressedSize,
+                mCompressionMethod == COMP_STORED, mCRC32, mInflaters));
+    }
+
+    // Same thing, reading from the compressed bytes in memory
+    typedef io::BufferViewStream<sys::ubyte> ViewStream;
+    struct ViewingStream : public EntryInputStream
+    {
+        ViewingStream(std::unique_ptr<ViewStream>&& view,
+                      sys::Uint64_T compressedSize,
+                      sys::Uint64_T uncompressedSize,
+                      bool stored, sys::Uint32_T crc) :
+            EntryInputStream(*view, 0, compressedSize, uncompressedSize,
+                             stored, crc, nullptr),
+            mView(std::move(view))
+        {
+        }
+        std::unique_ptr<ViewStream> mView;
+    };
+    std::unique_ptr<ViewStream> view(new ViewStream(
+            mem::BufferView<sys::ubyte>(mCompressedData, mCompressedSize)));
+    return std::unique_ptr<io::InputStream>(new ViewingStream(
+            std::move(view), mCompressedSize, mUncompressedSize,
+            mCompressionMethod == COMP_STORED, mCRC32));
+}
+
+sys::Off_T ZipEntry::getDataOffset() const
+{
+    if (!mSource)
+    {
+        return 0;
+    }
+
+    sys::ubyte header[LFH_SIZE];
+    readFully(*mSource, mLocalHeaderOffset, header, LFH_SIZE);
+    if (readInt(header) != LFH_SIGNATURE)
+    {
+        throw except::IOException(Ctxt(
+                "Did not find local file header for " + mFileName));
     }
+    // The local header's name and extra field needn't match the central
+    // directory's, so their lengths come from here
+    return mLocalHeaderOffset + LFH_SIZE + readShort(&header[26]) +
+            readShort(&header[28]);
 }
 
 std::ostream& operator<<(std::ostream& os, const zip::ZipEntry& ze)
@@ -22,11 +22,100 @@
 
 #include "zip/ZipFile.h"
 
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+#include "io/ByteStream.h"
+#include "io/FileInputStream.h"
+#include "io/FileOutputStream.h"
+#include "mt/WorkSharingBalancedRunnable1D.h"
+
 #define Z_READ_SHORT_INC(BUF, OFF) readShort(&BUF[OFF]); OFF += 2
 #define Z_READ_INT_INC(BUF, OFF) readInt(&BUF[OFF]); OFF += 4
+#define Z_READ_LONG_INC(BUF, OFF) readLong(&BUF[OFF]); OFF += 8
+
+namespace
+{
+// Placeholders in the classic records for values kept in Zip64 fields
+const sys::Uint16_T ZIP64_COUNT = 0xffff;
+const sys::Uint32_T ZIP64_SIZE = 0xffffffff;
+
+// Extracted entries are copied out this much at a time
+const size_t EXTRACT_CHUNK_SIZE = 1 << 20;
+
+// Refuse names that would be written outside of the target directory
+bool isSafeEntryName(const std::string& name)
+{
+    if (name.empty() || name[0] == '/' || name[0] == '\\' ||
+        name.find(':') != std::string::npos)
+    {
+        return false;
+    }
+    size_t start = 0;
+    while (start <= name.size())
+    {
+        size_t end = name.find_first_of("/\\", start);
+        if (end == std::string::npos)
+        {
+            end = name.size();
+        }
+        if (name.compare(start, end - start, "..") == 0)
+        {
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+}
 
 namespace zip
 {
+ZipFile::ZipFile(io::InputStream* inputStream) :
+    mSwapBytes(sys::isBigEndianSystem()),
+    mInput(nullptr),
+    mLength(0)
+{
+    // yes we eat the whole file
+    const auto length = inputStream->available();
+    std::unique_ptr<io::ByteStream> bytes(
+            new io::ByteStream(static_cast<sys::Size_T>(length)));
+    if (length > 0)
+    {
+        inputStream->read(bytes->get(), static_cast<size_t>(length));
+    }
+    mInput = bytes.get();
+    mOwnedInput = std::move(bytes);
+    mLength = length;
+
+    readCentralDir();
+}
+
+ZipFile::ZipFile(io::SeekableInputStream* inputStream) :
+    mSwapBytes(sys::isBigEndianSystem()),
+    mInput(inputStream),
+    mLength(0)
+{
+    const sys::Off_T position = mInput->tell();
+    mLength = mInput->seek(0, io::Seekable::END);
+    mInput->seek(position, io::Seekable::START);
+
+    readCentralDir();
+}
+
+ZipFile::ZipFile(const std::string& pathname) :
+    mSwapBytes(sys::isBigEndianSystem()),
+    mOwnedInput(new io::FileInputStream(pathname)),
+    mInput(mOwnedInput.get()),
+    mLength(0)
+{
+    mLength = mInput->seek(0, io::Seekable::END);
+    mInput->seek(0, io::Seekable::START);
+
+    readCentralDir();
+}
+
 ZipFile::~ZipFile()
 {
     for (size_t i = 0; i < mEntries.size(); ++i)
@@ -34,12 +123,9 @@ ZipFile::~ZipFile()
         // Delete ZipEntry
         delete mEntries[i];
     }
-
-    if (mCompressed)
-        delete[] mCompressed;
 }
 
-sys::Uint32_T ZipFile::readInt(sys::ubyte* buf)
+sys::Uint32_T ZipFile::readInt(const sys::ubyte* buf)
 {
     sys::ubyte* p;
     sys::Uint32_T le;// = *((sys::Uint32_T *)buf);
@@ -55,7 +141,7 @@ sys::Uint32_T ZipFile::readInt(sys::ubyte* buf)
     return le;
 }
 
-sys::Uint16_T ZipFile::readShort(sys::ubyte* buf)
+sys::Uint16_T ZipFile::readShort(const sys::ubyte* buf)
 {
     sys::ubyte* p;
     sys::Uint16_T le;// = *((sys::Uint16_T *)buf);
@@ -67,39 +153,46 @@ sys::Uint16_T ZipFile::readShort(sys::ubyte* buf)
     return le;
 }
 
-ZipFile::Iterator ZipFile::lookup(std::string fileName) const
+sys::Uint64_T ZipFile::readLong(const sys::ubyte* buf)
 {
-    ZipFile::Iterator p;
-    for (p = mEntries.begin(); p != mEntries.end(); ++p)
-    {
+    return static_cast<sys::Uint64_T>(readInt(buf)) |
+            (static_cast<sys::Uint64_T>(readInt(buf + 4)) << 32);
+}
 
-        if ((*p)->getFileName() == fileName)
-            break;
+void ZipFile::readAt(sys::Off_T offset, void* buffer, size_t len)
+{
+    if (offset < 0 || offset + static_cast<sys::Off_T>(len) > mLength)
+    {
+        throw except::IOException(Ctxt("Read past the end of the zip stream"));
     }
+    mInput->readv({ { offset, buffer, len } });
+}
 
-    return p;
+ZipFile::Iterator ZipFile::lookup(const std::string& fileName) const
+{
+    const auto p = mIndex.find(fileName);
+    if (p == mIndex.end())
+        return mEntries.end();
 
+    return mEntries.begin() + p->second;
 }
 
 void ZipFile::readCentralDir()
 {
-    if (mCompressedLength < EOCD_LEN)
+    if (mLength < EOCD_LEN)
         throw except::IOException(Ctxt(
                 "stream source too small to be a zip stream"));
-    sys::ubyte* start;
 
-    if (mCompressedLength > MAX_EOCD_SEARCH)
-    {
-        start = mCompressed + mCompressedLength - MAX_EOCD_SEARCH;
-    }
-    else
-    {
-        start = mCompressed;
-    }
-    sys::ubyte* p = mCompressed + mCompressedLength - 4;
+    // The EOCD is somewhere in the last MAX_EOCD_SEARCH bytes, so
+    // that's all we need to look through
+    const sys::Off_T searchStart =
+            std::max<sys::Off_T>(mLength - MAX_EOCD_SEARCH, 0);
+    std::vector<sys::ubyte> tail(static_cast<size_t>(mLength - searchStart));
+    readAt(searchStart, tail.data(), tail.size());
 
-    sys::ubyte* eocd = nullptr;
-    auto i = mCompressedLength - 4;
+    const sys::ubyte* const start = tail.data();
+    const sys::ubyte* p = start + tail.size() - EOCD_LEN;
+    const sys::ubyte* eocd = nullptr;
     while (p >= start)
     {
         if (*p == 0x50)
@@ -111,32 +204,70 @@ void ZipFile::readCentralDir()
             }
         }
         p--;
-        i--;
     }
-    if (p < start)
+    if (eocd == nullptr)
     {
         throw except::IOException(Ctxt("EOCD not found"));
     }
     // else still rockin'
-    readCentralDirValues(eocd, (mCompressed + mCompressedLength) - eocd);
+    sys::Uint64_T entryCount =
+            readCentralDirValues(eocd, (start + tail.size()) - eocd);
 
-    p = mCompressed + mCentralDirOffset;
-    const sys::SSize_T len = (mCompressed + mCompressedLength) - p;
-    for (auto& entry : mEntries)
+    // A Zip64 archive has a locator immediately before the EOCD
+    const sys::Off_T eocdOffset = searchStart + (eocd - start);
+    if (eocdOffset >= ZIP64_LOCATOR_LEN)
     {
-        entry = newCentralDirEntry(&p, len);
+        sys::ubyte locator[ZIP64_LOCATOR_LEN];
+        readAt(eocdOffset - ZIP64_LOCATOR_LEN, locator, ZIP64_LOCATOR_LEN);
+        if (readInt(locator) == ZIP64_LOCATOR_SIGNATURE)
+        {
+            entryCount = readZip64CentralDirValues(
+                    static_cast<sys::Off_T>(readLong(&locator[8])));
+        }
+    }
+
+    // The counts and sizes are only as good as the archive, so make sure
+    // they fit in it before allocating anything based on them
+    const sys::Uint64_T length = static_cast<sys::Uint64_T>(mLength);
+    if (mCentralDirOffset > length ||
+        mCentralDirSize > length - mCentralDirOffset)
+    {
+        throw except::IOException(Ctxt(
+                "Central directory runs past the end of the zip stream"));
+    }
+
+    // Every entry takes at least ENTRY_LEN bytes of the central directory
+    if (entryCount > mCentralDirSize / ENTRY_LEN)
+        throw except::IOException(Ctxt("Too many entries for the central dir"));
+    mEntries.resize(static_cast<size_t>(entryCount));
+
+    // This, and the EOCD, is all of the archive that's read up front
+    std::vector<sys::ubyte> centralDir(static_cast<size_t>(mCentralDirSize));
+    readAt(static_cast<sys::Off_T>(mCentralDirOffset), centralDir.data(),
+           centralDir.size());
+
+    const sys::ubyte* entry = centralDir.data();
+    const sys::ubyte* const end = centralDir.data() + centralDir.size();
+    mIndex.reserve(mEntries.size());
+    for (size_t ii = 0; ii < mEntries.size(); ++ii)
+    {
+        mEntries[ii] = newCentralDirEntry(&entry, end);
+
+        // Like the linear search this replaces, the first one wins
+        mIndex.emplace(mEntries[ii]->getFileName(), ii);
     }
 
 }
 
-ZipEntry* ZipFile::newCentralDirEntry(sys::ubyte** buf, sys::SSize_T len)
+ZipEntry* ZipFile::newCentralDirEntry(const sys::ubyte** buf,
+                                      const sys::ubyte* end)
 {
-    if (len < ENTRY_LEN)
+    if (end - *buf < ENTRY_LEN)
         throw except::IOException(Ctxt("CDE entry not large enough"));
 
     sys::SSize_T off = 0;
 
-    sys::ubyte* p = *buf;
+    const sys::ubyte* p = *buf;
 
     sys::Uint32_T entrySig = Z_READ_INT_INC(p, off);
 
@@ -150,26 +281,56 @@ ZipEntry* ZipFile::newCentralDirEntry(sys::ubyte** buf, sys::SSize_T len)
     sys::Uint16_T lastModifiedTime = Z_READ_SHORT_INC(p, off);
     sys::Uint16_T lastModifiedDate = Z_READ_SHORT_INC(p, off);
     sys::Uint32_T crc32 = Z_READ_INT_INC(p, off);
-    sys::Uint32_T compressedSize = Z_READ_INT_INC(p, off);
-    sys::Uint32_T uncompressedSize = Z_READ_INT_INC(p, off);
+    sys::Uint64_T compressedSize = Z_READ_INT_INC(p, off);
+    sys::Uint64_T uncompressedSize = Z_READ_INT_INC(p, off);
     sys::Uint16_T fileNameLength = Z_READ_SHORT_INC(p, off);
     sys::Uint16_T extraFieldLength = Z_READ_SHORT_INC(p, off);
     sys::Uint16_T fileCommentLength = Z_READ_SHORT_INC(p, off);
     Z_READ_SHORT_INC(p, off); // skipping diskNumberStart
     sys::Uint16_T internalAttrs = Z_READ_SHORT_INC(p, off);
     auto externalAttrs = Z_READ_INT_INC(p, off);
-    sys::Uint32_T localHeaderRelOffset = readInt(&p[off]);
+    sys::Uint64_T localHeaderRelOffset = readInt(&p[off]);
     p += ENTRY_LEN;
 
+    if (end - p < fileNameLength + extraFieldLength + fileCommentLength)
+        throw except::IOException(Ctxt("CDE entry not large enough"));
+
     std::string fileName;
     if (fileNameLength != 0)
         fileName = std::string((const char*) p, fileNameLength);
 
     p += fileNameLength;
 
-    // I dont know what extra field is, but skip it for now	    
-    if (extraFieldLength)
-        p += extraFieldLength;
+    // The only extra field we need is Zip64's, which holds (in this order)
+    // whichever of the sizes and offset didn't fit in 32 bits
+    const sys::ubyte* const extraEnd = p + extraFieldLength;
+    while (extraEnd - p >= 4)
+    {
+        const sys::Uint16_T id = readShort(p);
+        const sys::Uint16_T size = readShort(p + 2);
+        p += 4;
+        if (extraEnd - p < size)
+            break;
+
+        if (id == ZIP64_EXTRA_ID)
+        {
+            sys::Uint16_T extraOff = 0;
+            if (uncompressedSize == ZIP64_SIZE && extraOff + 8 <= size)
+            {
+                uncompressedSize = Z_READ_LONG_INC(p, extraOff);
+            }
+            if (compressedSize == ZIP64_SIZE && extraOff + 8 <= size)
+            {
+                compressedSize = Z_READ_LONG_INC(p, extraOff);
+            }
+            if (localHeaderRelOffset == ZIP64_SIZE && extraOff + 8 <= size)
+            {
+                localHeaderRelOffset = Z_READ_LONG_INC(p, extraOff);
+            }
+        }
+        p += size;
+    }
+    p = extraEnd;
 
     std::string fileComment;
     if (fileCommentLength)
@@ -179,22 +340,25 @@ ZipEntry* ZipFile::newCentralDirEntry(sys::ubyte** buf, sys::SSize_T len)
 
     *buf = p;
 
-    p = mCompressed + localHeaderRelOffset;
-
-    extraFieldLength = readShort(&p[0x1c]);
-
-    sys::Size_T dataOffset = localHeaderRelOffset + LFH_SIZE + fileNameLength
-            + extraFieldLength;
+    if (localHeaderRelOffset + LFH_SIZE > static_cast<sys::Uint64_T>(mLength) ||
+        compressedSize > static_cast<sys::Uint64_T>(mLength))
+    {
+        throw except::IOException(Ctxt(
+                "Entry " + fileName + " runs past the end of the zip stream"));
+    }
 
-    return new ZipEntry(mCompressed + dataOffset, compressedSize,
-            uncompressedSize, fileName, fileComment, versionMadeBy,
-            versionToExtract, generalPurposeBitFlag, compressionMethod,
-            lastModifiedTime, lastModifiedDate, crc32, internalAttrs,
-            externalAttrs);
+    // The entry finds its data (past the local header) when it's read
+    return new ZipEntry(mInput, static_cast<sys::Off_T>(localHeaderRelOffset),
+            static_cast<sys::Size_T>(compressedSize),
+            static_cast<sys::Size_T>(uncompressedSize), fileName, fileComment,
+            versionMadeBy, versionToExtract, generalPurposeBitFlag,
+            compressionMethod, lastModifiedTime, lastModifiedDate, crc32,
+            internalAttrs, externalAttrs, &mInflaters);
 
 }
 
-void ZipFile::readCentralDirValues(sys::ubyte* buf, sys::SSize_T len)
+sys::Uint64_T ZipFile::readCentralDirValues(const sys::ubyte* buf,
+                                            sys::SSize_T len)
 {
 
     if (len < EOCD_LEN)
@@ -210,14 +374,15 @@ void ZipFile::readCentralDirValues(sys::ubyte* buf, sys::SSize_T len)
     if (diskWithCentralDir != diskNum)
         throw except::IOException(Ctxt("central dir disk number must be same"));
 
+    mDiskNum = diskNum;
+    mDiskWithCentralDir = diskWithCentralDir;
+
     sys::Uint16_T entryCount = Z_READ_SHORT_INC(buf, off);
     sys::Uint16_T totalEntries = Z_READ_SHORT_INC(buf, off);
 
     if (totalEntries != entryCount)
         throw except::IOException(Ctxt("Total entries must match entries"));
 
-    mEntries.resize(entryCount);
-
     mCentralDirSize = Z_READ_INT_INC(buf, off);
     mCentralDirOffset = Z_READ_INT_INC(buf, off);
 
@@ -227,6 +392,125 @@ void ZipFile::readCentralDirValues(sys::ubyte* buf, sys::SSize_T len)
         throw except::IOException(Ctxt("Comment line too long"));
 
     mComment = std::string((const char*) (buf + EOCD_LEN), commentLength);
+    return entryCount;
+}
+
+sys::Uint64_T ZipFile::readZip64CentralDirValues(sys::Off_T eocdOffset)
+{
+    sys::ubyte buf[ZIP64_EOCD_LEN];
+    readAt(eocdOffset, buf, ZIP64_EOCD_LEN);
+    if (readInt(buf) != ZIP64_EOCD_SIGNATURE)
+        throw except::IOException(Ctxt("Zip64 EOCD not found"));
+
+    // Skip the signature, record size and versions
+    sys::Uint16_T off = 16;
+    sys::Uint32_T diskNum = Z_READ_INT_INC(buf, off);
+    sys::Uint32_T diskWithCentralDir = Z_READ_INT_INC(buf, off);
+    if (diskNum != 0 || diskWithCentralDir != diskNum)
+        throw except::IOException(Ctxt("disk number must be 0"));
+
+    sys::Uint64_T entryCount = Z_READ_LONG_INC(buf, off);
+    sys::Uint64_T totalEntries = Z_READ_LONG_INC(buf, off);
+    if (totalEntries != entryCount)
+        throw except::IOException(Ctxt("Total entries must match entries"));
+
+    mCentralDirSize = Z_READ_LONG_INC(buf, off);
+    mCentralDirOffset = Z_READ_LONG_INC(buf, off);
+    return entryCount;
+}
+
+std::vector<sys::Size_T> ZipFile::decompress(
+        const std::vector<const ZipEntry*>& entries,
+        sys::ubyte* buffer,
+        sys::Size_T bufferSize,
+        size_t numThreads) const
+{
+    std::vector<sys::Size_T> offsets(entries.size() + 1, 0);
+    for (size_t ii = 0; ii < entries.size(); ++ii)
+    {
+        offsets[ii + 1] = offsets[ii] + entries[ii]->getUncompressedSize();
+    }
+    if (offsets.back() > bufferSize)
+    {
+        throw except::InvalidArgumentException(Ctxt(FmtX(
+                "Need %lu bytes to decompress %lu entries but have %lu",
+                static_cast<unsigned long>(offsets.back()),
+                static_cast<unsigned long>(entries.size()),
+                static_cast<unsigned long>(bufferSize))));
+    }
+
+    const auto decompressOne = [&](size_t ii)
+    {
+        entries[ii]->decompress(buffer + offsets[ii],
+                                entries[ii]->getUncompressedSize());
+    };
+    mt::runWorkSharingBalanced1D(entries.size(),
+                                 std::min(std::max<size_t>(numThreads, 1),
+                                          std::max<size_t>(entries.size(), 1)),
+                                 decompressOne);
+    return offsets;
+}
+
+void ZipFile::extract(const std::string& directory, size_t numThreads) const
+{
+    // Make the directories here, so the workers only write files
+    std::vector<const ZipEntry*> files;
+    std::vector<std::string> paths;
+    for (const auto& entry : mEntries)
+    {
+        const std::string name = entry->getFileName();
+        if (!isSafeEntryName(name))
+        {
+            throw except::IOException(Ctxt(
+                    "Refusing to extract entry [" + name + "]"));
+        }
+
+        const std::string path = sys::Path::joinPaths(directory, name);
+        if (entry->isDirectory())
+        {
+            sys::Path(path).makeDirectory(true);
+        }
+        else
+        {
+            sys::Path(sys::Path::splitPath(path).first).makeDirectory(true);
+            files.push_back(entry);
+            paths.push_back(path);
+        }
+    }
+
+    std::atomic<bool> failed(false);
+    const auto extractOne = [&](size_t ii)
+    {
+        if (failed)
+        {
+            return; // don't start anything new
+        }
+        try
+        {
+            std::unique_ptr<io::InputStream> input(files[ii]->openInputStream());
+            io::FileOutputStream output(paths[ii]);
+            std::vector<sys::byte> buffer(static_cast<size_t>(std::min<sys::Uint64_T>(
+                    EXTRACT_CHUNK_SIZE,
+                    std::max<sys::Uint64_T>(files[ii]->getUncompressedSize(), 1))));
+            sys::SSize_T numRead = 0;
+            while ((numRead = input->read(buffer.data(), buffer.size())) > 0)
+            {
+                output.write(buffer.data(), static_cast<size_t>(numRead));
+            }
+            output.close();
+        }
+        catch (const except::Exception& ex)
+        {
+            failed = true;
+            throw except::IOException(ex, Ctxt(
+                    "Could not extract entry [" + files[ii]->getFileName() +
+                    "] to [" + paths[ii] + "]"));
+        }
+    };
+    mt::runWorkSharingBalanced1D(files.size(),
+                                 std::min(std::max<size_t>(numThreads, 1),
+                                          std::max<size_t>(files.size(), 1)),
+                                 extractOne);
 }
 
 std::ostream& operator<<(std::ostream& os, const ZipFile& zf)
@@ -0,0 +1,162 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/except.h>
+#include <import/io.h>
+#include <import/zip.h>
+
+/*
+ * Compresses <megabytes> of synthetic, moderately compressible data with
+ * the serial zip::GZipOutputStream, as one block-parallel member and as
+ * independent members, then reads each file back serially and with the
+ * read-ahead stream and checks the round trip.
+ */
+
+namespace
+{
+std::vector<sys::byte> makeData(size_t numBytes)
+{
+    // Runs of words from a small vocabulary, with some noise mixed in
+    static const char* const words[] =
+    { "azimuth ", "range ", "pixel ", "sample ", "line ", "band ", "0.125 " };
+    std::vector<sys::byte> data;
+    data.reserve(numBytes);
+    unsigned int state = 12345;
+    while (data.size() < numBytes)
+    {
+        state = state * 1103515245 + 12345;
+        const char* word = words[(state >> 16) % 7];
+        for (; *word && data.size() < numBytes; ++word)
+        {
+            data.push_back(static_cast<sys::byte>(*word));
+        }
+        if ((state & 0x7) == 0 && data.size() < numBytes)
+        {
+            data.push_back(static_cast<sys::byte>(state >> 24));
+        }
+    }
+    return data;
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename StreamT>
+void time(const std::string& label, StreamT& output,
+          const std::vector<sys::byte>& data, const std::string& pathname)
+{
+    const auto start = std::chrono::steady_clock::now();
+    output.write(data.data(), data.size());
+    output.close();
+    const double seconds = secondsSince(start);
+    std::cout << label << ": " << seconds << " s, "
+              << data.size() / (seconds * 1048576.0) << " MB/s, "
+              << sys::OS().getSize(pathname) << " bytes\n";
+}
+
+void timeRead(const std::string& label, zip::GZipInputStream& input,
+              const std::vector<sys::byte>& data)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<sys::byte> result(data.size() + 1);
+    size_t numRead = 0;
+    sys::SSize_T rv = 0;
+    while ((rv = input.read(result.data() + numRead,
+                            result.size() - numRead)) > 0)
+    {
+        numRead += static_cast<size_t>(rv);
+    }
+    input.close();
+    const double seconds = secondsSince(start);
+    result.resize(numRead);
+    std::cout << "    " << label << ": " << seconds << " s, "
+              << (result == data ? "matches" : "DOES NOT MATCH") << "\n";
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                  << " <megabytes> [numThreads]\n";
+        return 1;
+    }
+
+    try
+    {
+        const size_t numBytes = static_cast<size_t>(atoi(argv[1])) << 20;
+        const size_t numThreads = argc > 2 ?
+                static_cast<size_t>(atoi(argv[2])) :
+                std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        const std::vector<sys::byte> data(makeData(numBytes));
+
+        const std::string serial("gzip_benchmark_serial.gz");
+        const std::string parallel("gzip_benchmark_parallel.gz");
+        const std::string members("gzip_benchmark_members.gz");
+        {
+            zip::GZipOutputStream output(serial);
+            time("gzwrite", output, data, serial);
+        }
+        {
+            zip::GZipOutputStream output(parallel, numThreads);
+            time("Parallel, one member", output, data, parallel);
+        }
+        {
+            zip::GZipOutputStream output(members, numThreads,
+                                         zip::GZipOutputStream::DEFAULT_BLOCK_SIZE,
+                                         true);
+            time("Parallel, independent members", output, data, members);
+        }
+
+        for (const auto& pathname : { serial, parallel, members })
+        {
+            std::cout << pathname << "\n";
+            {
+                zip::GZipInputStream input(pathname);
+                timeRead("gzread", input, data);
+            }
+            {
+                zip::GZipInputStream input(pathname, numThreads);
+                timeRead("Read-ahead", input, data);
+            }
+            sys::OS().remove(pathname);
+        }
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,143 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <import/sys.h>
+#include <import/except.h>
+#include <import/zip.h>
+
+/*
+ * Reads every entry of an archive of many small entries: looking each one
+ * up by name, decompressing each into its own buffer, and decompressing
+ * them all at once into one buffer with ZipFile::decompress().
+ *
+ * The archive is written to <zip-file> unless it's already there.
+ */
+
+namespace
+{
+std::string entryName(size_t ii)
+{
+    return "dir" + std::to_string(ii / 1000) + "/entry" +
+            std::to_string(ii) + ".xml";
+}
+
+void createArchive(const std::string& pathname, size_t numEntries)
+{
+    zip::ZipOutputStream output(pathname);
+    for (size_t ii = 0; ii < numEntries; ++ii)
+    {
+        std::string contents = "<entry id=\"" + std::to_string(ii) + "\">";
+        for (size_t jj = 0; jj < 20 + ii % 50; ++jj)
+        {
+            contents += "<value>" + std::to_string(ii * jj) + "</value>";
+        }
+        contents += "</entry>\n";
+
+        output.createFileInZip(entryName(ii));
+        output.write(contents.data(), contents.size());
+        output.closeFileInZip();
+    }
+    output.close();
+}
+
+double secondsSince(const std::chrono::steady_clock::time_point& start)
+{
+    return std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+}
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 4)
+    {
+        std::cerr << "Usage: " << sys::Path::basename(argv[0])
+                  << " <zip-file> [numEntries] [numThreads]\n";
+        return 1;
+    }
+
+    try
+    {
+        const std::string pathname(argv[1]);
+        const size_t numEntries = argc > 2 ?
+                static_cast<size_t>(atoi(argv[2])) : 100000;
+        const size_t numThreads = argc > 3 ?
+                static_cast<size_t>(atoi(argv[3])) :
+                std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        if (!sys::OS().exists(pathname))
+        {
+            createArchive(pathname, numEntries);
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        zip::ZipFile zipFile(pathname);
+        std::cout << "Opened " << zipFile.getNumEntries() << " entries in "
+                  << secondsSince(start) << " s\n";
+
+        start = std::chrono::steady_clock::now();
+        std::vector<const zip::ZipEntry*> entries;
+        for (size_t ii = 0; ii < zipFile.getNumEntries(); ++ii)
+        {
+            const auto p = zipFile.lookup(entryName(ii));
+            if (p != zipFile.end())
+            {
+                entries.push_back(*p);
+            }
+        }
+        std::cout << "Looked up " << entries.size() << " names in "
+                  << secondsSince(start) << " s\n";
+
+        start = std::chrono::steady_clock::now();
+        size_t total = 0;
+        for (const auto& entry : entries)
+        {
+            std::unique_ptr<sys::ubyte[]> data(entry->decompress());
+            total += entry->getUncompressedSize();
+        }
+        std::cout << "Decompressed " << total << " bytes one entry at a time in "
+                  << secondsSince(start) << " s\n";
+
+        for (size_t threads = 1; threads <= numThreads; threads *= 2)
+        {
+            start = std::chrono::steady_clock::now();
+            std::vector<sys::ubyte> buffer(total);
+            const auto offsets = zipFile.decompress(entries, buffer.data(),
+                                                    buffer.size(), threads);
+            std::cout << "Decompressed " << offsets.back()
+                      << " bytes in one batch on " << threads << " thread(s) in "
+                      << secondsSince(start) << " s\n";
+        }
+    }
+    catch (const except::Exception& ex)
+    {
+        std::cerr << ex.toString() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,55 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ * 
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public 
+ * License along with this program; If not, 
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+
+#include <import/sys.h>
+#include <import/io.h>
+#include "zip/ZipFile.h"
+
+int main(int argc, char** argv)
+{
+    if (argc != 3 && argc != 4)
+        die_printf("Usage: %s <zip-file> <directory> [numThreads]\n", argv[0]);
+
+    try
+    {
+        const std::string inputName(argv[1]);
+        const std::string directory(argv[2]);
+        const size_t numThreads = argc == 4 ? atoi(argv[3]) : 1;
+
+        // Only the central directory is read here...
+        zip::ZipFile zipFile(inputName);
+        std::cout << "Extracting " << zipFile.getNumEntries()
+                  << " entries from " << inputName << " to " << directory
+                  << std::endl;
+
+        // ...and each entry is inflated straight from the archive
+        zipFile.extract(directory, numThreads);
+    }
+    catch (except::Exception& ex)
+    {
+        std::cout << ex.toString() << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    return 0;
+}
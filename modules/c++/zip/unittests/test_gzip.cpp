@@ -0,0 +1,282 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <sys/OS.h>
+#include <zip/GZipInputStream.h>
+#include <zip/GZipOutputStream.h>
+#include "TestCase.h"
+
+namespace
+{
+const std::string SIZED = "test_gzip_sized.gz";
+const std::string PLAIN = "test_gzip_plain.gz";
+const std::string MIXED = "test_gzip_mixed.gz";
+const std::string SINGLE = "test_gzip_single.gz";
+
+std::string makeData(size_t size, size_t seed)
+{
+    // Compressible, but not trivially so
+    std::string data(size, '\0');
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        data[ii] = static_cast<char>('a' + (ii * ii + seed) % 13);
+    }
+    return data;
+}
+
+std::string readFile(const std::string& pathname)
+{
+    std::ifstream in(pathname.c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+void writeFile(const std::string& pathname, const std::string& contents)
+{
+    std::ofstream(pathname.c_str(), std::ios::binary) << contents;
+}
+
+std::string inflate(zip::GZipInputStream& input)
+{
+    std::string result;
+    std::vector<char> buffer(1000);
+    sys::SSize_T numRead;
+    while ((numRead = input.read(buffer.data(), buffer.size())) > 0)
+    {
+        result.append(buffer.data(), static_cast<size_t>(numRead));
+    }
+    input.close();
+    return result;
+}
+
+// Read with zlib alone, to check what we write is ordinary gzip
+std::string gzreadAll(const std::string& pathname)
+{
+    gzFile file = gzopen(pathname.c_str(), "rb");
+    std::string result;
+    std::vector<char> buffer(1000);
+    int numRead;
+    while ((numRead = gzread(file, buffer.data(),
+                             static_cast<unsigned int>(buffer.size()))) > 0)
+    {
+        result.append(buffer.data(), static_cast<size_t>(numRead));
+    }
+    gzclose(file);
+    return numRead < 0 ? "gzread failed" : result;
+}
+
+// Inflate the first gzip member, returning what's left after it
+std::string firstMember(const std::string& compressed, std::string& rest)
+{
+    z_stream stream = z_stream();
+    inflateInit2(&stream, MAX_WBITS + 16);
+    std::string result(1 << 20, '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(
+            const_cast<char*>(compressed.data()));
+    stream.avail_in = static_cast<uInt>(compressed.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+    stream.avail_out = static_cast<uInt>(result.size());
+    const int rv = ::inflate(&stream, Z_FINISH);
+    result.resize(rv == Z_STREAM_END ? stream.total_out : 0);
+    rest = compressed.substr(compressed.size() - stream.avail_in);
+    inflateEnd(&stream);
+    return result;
+}
+
+void removeFiles()
+{
+    const sys::OS os;
+    for (const auto& pathname : { SIZED, PLAIN, MIXED, SINGLE })
+    {
+        if (os.exists(pathname))
+        {
+            os.remove(pathname);
+        }
+    }
+}
+}
+
+TEST_CASE(testSizedAndPlainMembers)
+{
+    const std::string sizedData = makeData(100000, 1);
+    const std::string plainData = makeData(30000, 2);
+    {
+        zip::GZipOutputStream output(SIZED, 4, 4096, true /*independentMembers*/);
+        output.write(sizedData.data(), sizedData.size());
+        output.close();
+    }
+    {
+        zip::GZipOutputStream output(PLAIN);
+        output.write(plainData.data(), plainData.size());
+        output.close();
+    }
+    // Sized members, then a plain one, then sized members again
+    writeFile(MIXED, readFile(SIZED) + readFile(PLAIN) + readFile(SIZED));
+    const std::string expected = sizedData + plainData + sizedData;
+
+    for (const size_t numThreads : { 1, 4 })
+    {
+        zip::GZipInputStream sized(SIZED, numThreads);
+        TEST_ASSERT(inflate(sized) == sizedData);
+
+        zip::GZipInputStream plain(PLAIN, numThreads);
+        TEST_ASSERT(inflate(plain) == plainData);
+
+        zip::GZipInputStream mixed(MIXED, numThreads);
+        TEST_ASSERT(inflate(mixed) == expected);
+    }
+
+    // zlib itself reads them all too
+    zip::GZipInputStream mixed(MIXED);
+    TEST_ASSERT(inflate(mixed) == expected);
+
+    removeFiles();
+}
+
+TEST_CASE(testBadMemberSize)
+{
+    const std::string data = makeData(5000, 3);
+    {
+        zip::GZipOutputStream output(SIZED, 2, 4096, true /*independentMembers*/);
+        output.write(data.data(), data.size());
+        output.close();
+    }
+    const std::string original = readFile(SIZED);
+
+    // The size in the last member's trailer (the last four bytes), made
+    // too big and too small; neither may be believed
+    const std::vector<std::string> sizes{ std::string(4, '\xff'),
+                                          std::string(4, '\0') };
+    for (const auto& size : sizes)
+    {
+        writeFile(SIZED, original.substr(0, original.size() - 4) + size);
+        zip::GZipInputStream input(SIZED, 2);
+        TEST_EXCEPTION(inflate(input));
+    }
+
+    removeFiles();
+}
+
+TEST_CASE(testSingleMember)
+{
+    // By default the parallel blocks make up one member, each primed
+    // with the end of the one before, as pigz does
+    const std::string data = makeData(100000, 4);
+    {
+        zip::GZipOutputStream output(SINGLE, 4, 4096);
+        for (size_t ii = 0; ii < data.size(); ii += 3000)
+        {
+            output.write(data.data() + ii, std::min<size_t>(3000,
+                                                            data.size() - ii));
+        }
+        output.close();
+    }
+
+    std::string rest;
+    TEST_ASSERT(firstMember(readFile(SINGLE), rest) == data);
+    TEST_ASSERT(rest.empty());
+
+    for (const size_t numThreads : { 1, 4 })
+    {
+        zip::GZipInputStream input(SINGLE, numThreads);
+        TEST_ASSERT(inflate(input) == data);
+    }
+    zip::GZipInputStream input(SINGLE);
+    TEST_ASSERT(inflate(input) == data);
+    TEST_ASSERT(gzreadAll(SINGLE) == data);
+
+    // An empty stream is still a valid (empty) member
+    {
+        zip::GZipOutputStream output(SINGLE, 4, 4096);
+        output.close();
+    }
+    TEST_ASSERT(gzreadAll(SINGLE).empty());
+    zip::GZipInputStream empty(SINGLE, 2);
+    TEST_ASSERT(inflate(empty).empty());
+
+    removeFiles();
+}
+
+TEST_CASE(testNotGzip)
+{
+    // zlib's gzread() stops quietly at anything after the last member,
+    // and passes non-gzip files through as they are.  The read-ahead
+    // stream is stricter and throws for both.
+    const std::string data = makeData(20000, 5);
+    {
+        zip::GZipOutputStream output(PLAIN);
+        output.write(data.data(), data.size());
+        output.close();
+    }
+    const std::string compressed = readFile(PLAIN);
+    {
+        zip::GZipOutputStream output(SIZED, 2, 4096, true /*independentMembers*/);
+        output.write(data.data(), data.size());
+        output.close();
+    }
+    const std::string sized = readFile(SIZED);
+
+    for (const std::string& garbage : { std::string("trailing garbage"),
+                                        std::string(100, '\0') })
+    {
+        writeFile(PLAIN, compressed + garbage);
+        writeFile(SIZED, sized + garbage);
+        TEST_ASSERT(gzreadAll(PLAIN) == data);
+        for (const size_t numThreads : { 1, 4 })
+        {
+            zip::GZipInputStream plain(PLAIN, numThreads);
+            TEST_EXCEPTION(inflate(plain));
+            zip::GZipInputStream sizedMembers(SIZED, numThreads);
+            TEST_EXCEPTION(inflate(sizedMembers));
+        }
+    }
+
+    // Not gzip at all
+    writeFile(PLAIN, data);
+    TEST_ASSERT(gzreadAll(PLAIN) == data);
+    zip::GZipInputStream passThrough(PLAIN);
+    TEST_ASSERT(inflate(passThrough) == data);
+    for (const size_t numThreads : { 1, 4 })
+    {
+        zip::GZipInputStream plain(PLAIN, numThreads);
+        TEST_EXCEPTION(inflate(plain));
+    }
+
+    // Cut off partway through
+    writeFile(PLAIN, compressed.substr(0, compressed.size() / 2));
+    zip::GZipInputStream truncated(PLAIN, 2);
+    TEST_EXCEPTION(inflate(truncated));
+
+    removeFiles();
+}
+
+TEST_MAIN(
+    TEST_CHECK(testSizedAndPlainMembers);
+    TEST_CHECK(testBadMemberSize);
+    TEST_CHECK(testSingleMember);
+    TEST_CHECK(testNotGzip);
+    )
@@ -0,0 +1,596 @@
+/* =========================================================================
+ * This file is part of zip-c++
+ * =========================================================================
+ *
+ * (C) Copyright 2022, Maxar Technologies, Inc.
+ *
+ * zip-c++ is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; If not, http://www.gnu.org/licenses/.
+ *
+ */
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <io/ByteStream.h>
+#include <sys/OS.h>
+#include <sys/Path.h>
+#include <zip/InflaterPool.h>
+#include <zip/ZipFile.h>
+#include "TestCase.h"
+
+namespace
+{
+const std::string EXTRACT_DIR = "test_zip_file_extract";
+
+struct Member
+{
+    Member(const std::string& name_, const std::string& data_,
+           bool deflated_ = true, size_t localExtra_ = 0) :
+        name(name_),
+        data(data_),
+        deflated(deflated_),
+        localExtra(localExtra_),
+        crc(static_cast<sys::Uint32_T>(crc32(
+                crc32(0, Z_NULL, 0),
+                reinterpret_cast<const Bytef*>(data_.data()),
+                static_cast<uInt>(data_.size()))))
+    {
+    }
+
+    std::string name;
+    std::string data;
+    bool deflated;
+    size_t localExtra; // bytes of padding in the local header only
+    sys::Uint32_T crc;
+};
+
+std::string makeData(size_t size, size_t seed)
+{
+    // Compressible, but not trivially so
+    std::string data(size, '\0');
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        data[ii] = static_cast<char>('a' + (ii * ii + seed) % 13);
+    }
+    return data;
+}
+
+std::string makeNoise(size_t size, size_t seed)
+{
+    // Doesn't compress at all
+    std::string data(size, '\0');
+    sys::Uint32_T state = static_cast<sys::Uint32_T>(seed);
+    for (size_t ii = 0; ii < size; ++ii)
+    {
+        state = state * 1664525 + 1013904223;
+        data[ii] = static_cast<char>(state >> 24);
+    }
+    return data;
+}
+
+std::string rawDeflate(const std::string& data)
+{
+    z_stream stream = z_stream();
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8,
+                 Z_DEFAULT_STRATEGY);
+    std::string result(deflateBound(&stream, static_cast<uLong>(data.size())),
+                       '\0');
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+    stream.avail_in = static_cast<uInt>(data.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+    stream.avail_out = static_cast<uInt>(result.size());
+    deflate(&stream, Z_FINISH);
+    result.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result;
+}
+
+void putShort(std::string& out, size_t value)
+{
+    out += static_cast<char>(value & 0xff);
+    out += static_cast<char>((value >> 8) & 0xff);
+}
+
+void putInt(std::string& out, sys::Uint64_T value)
+{
+    putShort(out, static_cast<size_t>(value & 0xffff));
+    putShort(out, static_cast<size_t>((value >> 16) & 0xffff));
+}
+
+void putLong(std::string& out, sys::Uint64_T value)
+{
+    putInt(out, value & 0xffffffff);
+    putInt(out, value >> 32);
+}
+
+/*
+ *  Lay out an archive by hand, so the tests control every field.  With
+ *  zip64, the sizes, offsets and counts are left in the Zip64 extra
+ *  fields and end of central directory record.
+ */
+std::string makeArchive(const std::vector<Member>& members,
+                        bool zip64 = false)
+{
+    std::string archive;
+    std::string centralDir;
+    for (const auto& member : members)
+    {
+        const std::string compressed =
+                member.deflated ? rawDeflate(member.data) : member.data;
+        const sys::Uint64_T offset = archive.size();
+        const size_t method = member.deflated ? 8 : 0; // deflated : stored
+
+        putInt(archive, zip::LFH_SIGNATURE);
+        putShort(archive, 20);
+        putShort(archive, 0);
+        putShort(archive, method);
+        putInt(archive, 0);
+        putInt(archive, member.crc);
+        putInt(archive, compressed.size());
+        putInt(archive, member.data.size());
+        putShort(archive, member.name.size());
+        putShort(archive, member.localExtra);
+        archive += member.name;
+        archive += std::string(member.localExtra, '\0');
+        archive += compressed;
+
+        putInt(centralDir, zip::ENTRY_SIGNATURE);
+        putShort(centralDir, zip64 ? 45 : 20);
+        putShort(centralDir, zip64 ? 45 : 20);
+        putShort(centralDir, 0);
+        putShort(centralDir, method);
+        putInt(centralDir, 0);
+        putInt(centralDir, member.crc);
+        putInt(centralDir, zip64 ? 0xffffffff : compressed.size());
+        putInt(centralDir, zip64 ? 0xffffffff : member.data.size());
+        putShort(centralDir, member.name.size());
+        putShort(centralDir, zip64 ? 28 : 0);
+        putShort(centralDir, 0);
+        putShort(centralDir, 0);
+        putShort(centralDir, 0);
+        putInt(centralDir, 0);
+        putInt(centralDir, zip64 ? 0xffffffff : offset);
+        centralDir += member.name;
+        if (zip64)
+        {
+            putShort(centralDir, zip::ZIP64_EXTRA_ID);
+            putShort(centralDir, 24);
+            putLong(centralDir, member.data.size());
+            putLong(centralDir, compressed.size());
+            putLong(centralDir, offset);
+        }
+    }
+
+    const sys::Uint64_T centralDirOffset = archive.size();
+    archive += centralDir;
+    if (zip64)
+    {
+        const sys::Uint64_T eocdOffset = archive.size();
+        putInt(archive, zip::ZIP64_EOCD_SIGNATURE);
+        putLong(archive, zip::ZIP64_EOCD_LEN - 12);
+        putShort(archive, 45);
+        putShort(archive, 45);
+        putInt(archive, 0);
+        putInt(archive, 0);
+        putLong(archive, members.size());
+        putLong(archive, members.size());
+        putLong(archive, centralDir.size());
+        putLong(archive, centralDirOffset);
+
+        putInt(archive, zip::ZIP64_LOCATOR_SIGNATURE);
+        putInt(archive, 0);
+        putLong(archive, eocdOffset);
+        putInt(archive, 1);
+    }
+
+    putInt(archive, zip::CD_SIGNATURE);
+    putShort(archive, 0);
+    putShort(archive, 0);
+    putShort(archive, zip64 ? 0xffff : members.size());
+    putShort(archive, zip64 ? 0xffff : members.size());
+    putInt(archive, zip64 ? 0xffffffff : centralDir.size());
+    putInt(archive, zip64 ? 0xffffffff : centralDirOffset);
+    putShort(archive, 0);
+    return archive;
+}
+
+struct ArchiveStream : public io::ByteStream
+{
+    explicit ArchiveStream(const std::string& archive)
+    {
+        write(archive.data(), archive.size());
+        seek(0, io::Seekable::START);
+    }
+};
+
+std::string readAll(io::InputStream& input)
+{
+    std::string result;
+    std::vector<char> buffer(1000);
+    sys::SSize_T numRead;
+    while ((numRead = input.read(buffer.data(), buffer.size())) > 0)
+    {
+        result.append(buffer.data(), static_cast<size_t>(numRead));
+    }
+    return result;
+}
+
+std::string readFile(const std::string& pathname)
+{
+    std::ifstream in(pathname.c_str(), std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+void removeExtractDir()
+{
+    const sys::OS os;
+    if (os.exists(EXTRACT_DIR))
+    {
+        os.remove(EXTRACT_DIR);
+    }
+}
+}
+
+TEST_CASE(testZip64)
+{
+    const std::vector<Member> members = {
+            Member("stored.txt", makeData(1000, 1), false),
+            Member("dir/deflated.txt", makeData(50000, 2)) };
+    const std::string archive = makeArchive(members, true);
+    ArchiveStream input(archive);
+    const zip::ZipFile zipFile(&input);
+
+    TEST_ASSERT_EQ(zipFile.getNumEntries(), 2ul);
+    TEST_ASSERT_TRUE(zipFile.getCentralDirOffset() < archive.size());
+    for (const auto& member : members)
+    {
+        const zip::ZipFile::Iterator entry = zipFile.lookup(member.name);
+        TEST_ASSERT_TRUE(entry != zipFile.end());
+        TEST_ASSERT_EQ((*entry)->getUncompressedSize(), member.data.size());
+
+        std::unique_ptr<io::InputStream> stream((*entry)->openInputStream());
+        const std::string contents = readAll(*stream);
+        TEST_ASSERT_EQ(contents, member.data);
+    }
+}
+
+TEST_CASE(testZip64BadCentralDir)
+{
+    const std::vector<Member> members = { Member("a.txt", "abc") };
+    const std::string archive = makeArchive(members, true);
+
+    // Zip64 EOCD record, then the locator and the classic EOCD
+    const size_t eocd64 = archive.size() - zip::EOCD_LEN -
+            zip::ZIP64_LOCATOR_LEN - zip::ZIP64_EOCD_LEN;
+    const auto withLongs = [&](size_t offset,
+                               const std::vector<sys::Uint64_T>& values)
+    {
+        std::string bytes;
+        for (const auto value : values)
+        {
+            putLong(bytes, value);
+        }
+        std::string result = archive;
+        result.replace(eocd64 + offset, bytes.size(), bytes);
+        return result;
+    };
+    const sys::Uint64_T huge = static_cast<sys::Uint64_T>(1) << 50;
+
+    // A huge entry count, with a central dir size to match, is caught
+    // before anything is allocated for the entries
+    ArchiveStream hugeCount(withLongs(24,
+                                      { huge, huge, huge * zip::ENTRY_LEN }));
+    TEST_EXCEPTION(zip::ZipFile(&hugeCount));
+
+    // As is one that's more than the central dir could hold
+    ArchiveStream tooMany(withLongs(24, { 2, 2 }));
+    TEST_EXCEPTION(zip::ZipFile(&tooMany));
+
+    // Or a central dir that starts past the end of the archive
+    ArchiveStream pastEnd(withLongs(48, { archive.size() + 1 }));
+    TEST_EXCEPTION(zip::ZipFile(&pastEnd));
+
+    // Or whose size and offset wrap around
+    ArchiveStream wrapped(withLongs(40, { static_cast<sys::Uint64_T>(0) - 1 }));
+    TEST_EXCEPTION(zip::ZipFile(&wrapped));
+
+    // The unmodified archive is fine
+    ArchiveStream good(archive);
+    TEST_ASSERT_EQ(zip::ZipFile(&good).getNumEntries(), 1ul);
+}
+
+TEST_CASE(testExtract)
+{
+    removeExtractDir();
+    const std::vector<Member> members = {
+            Member("top.txt", makeData(3000, 3)),
+            Member("sub/", ""),
+            Member("sub/inner.txt", makeData(100, 4), false) };
+    ArchiveStream input(makeArchive(members));
+    const zip::ZipFile zipFile(&input);
+    zipFile.extract(EXTRACT_DIR, 2);
+
+    TEST_ASSERT_EQ(readFile(sys::Path::joinPaths(EXTRACT_DIR, "top.txt")),
+                   members[0].data);
+    TEST_ASSERT_EQ(readFile(sys::Path::joinPaths(EXTRACT_DIR,
+                                                 "sub/inner.txt")),
+                   members[2].data);
+    removeExtractDir();
+}
+
+TEST_CASE(testExtractRefusesUnsafeNames)
+{
+    removeExtractDir();
+    const sys::OS os;
+    for (const std::string name : { "../escaped.txt", "sub/../../escaped.txt",
+                                    "/tmp/test_zip_file_escaped.txt",
+                                    "..\\escaped.txt", "C:escaped.txt" })
+    {
+        ArchiveStream input(makeArchive({ Member(name, "escaped") }));
+        const zip::ZipFile zipFile(&input);
+        TEST_EXCEPTION(zipFile.extract(EXTRACT_DIR));
+    }
+    TEST_ASSERT_FALSE(os.exists("escaped.txt"));
+    TEST_ASSERT_FALSE(os.exists("/tmp/test_zip_file_escaped.txt"));
+    removeExtractDir();
+}
+
+TEST_CASE(testCRCMismatch)
+{
+    for (const bool deflated : { true, false })
+    {
+        Member member("corrupt.txt", makeData(200000, 5), deflated);
+        member.crc ^= 1;
+        ArchiveStream input(makeArchive({ member }));
+        const zip::ZipFile zipFile(&input);
+        const zip::ZipEntry& entry = **zipFile.begin();
+
+        std::unique_ptr<io::InputStream> stream(entry.openInputStream());
+        TEST_EXCEPTION(readAll(*stream));
+
+        std::vector<sys::ubyte> buffer(member.data.size());
+        TEST_EXCEPTION(entry.decompress(buffer.data(), buffer.size()));
+    }
+}
+
+TEST_CASE(testLookup)
+{
+    const std::vector<Member> members = {
+            Member("a.txt", "first"),
+            Member("b.txt", "other"),
+            Member("a.txt", "second") };
+    ArchiveStream input(makeArchive(members));
+    const zip::ZipFile zipFile(&input);
+    TEST_ASSERT_EQ(zipFile.getNumEntries(), 3ul);
+
+    TEST_ASSERT_TRUE(zipFile.lookup("missing.txt") == zipFile.end());
+    TEST_ASSERT_TRUE(zipFile.lookup("") == zipFile.end());
+    TEST_ASSERT_TRUE(zipFile.lookup("A.TXT") == zipFile.end());
+
+    // The first of the duplicates wins
+    TEST_ASSERT_TRUE(zipFile.lookup("a.txt") == zipFile.begin());
+    TEST_ASSERT_TRUE(zipFile.lookup("b.txt") == zipFile.begin() + 1);
+}
+
+TEST_CASE(testDecompress)
+{
+    // Stored, small deflated and (over the single read limit) large
+    // deflated entries, plus an empty one
+    const std::vector<Member> members = {
+            Member("stored.txt", makeData(777, 6), false),
+            Member("small.txt", makeData(20000, 7)),
+            Member("empty.txt", ""),
+            Member("large.bin", makeNoise(1100000, 8)),
+            Member("padded.txt", makeData(5000, 9), true, 1000) };
+    ArchiveStream input(makeArchive(members));
+    const zip::ZipFile zipFile(&input);
+
+    // In a different order than the archive's
+    const std::vector<size_t> order = { 4, 0, 3, 2, 1 };
+    std::vector<const zip::ZipEntry*> entries;
+    size_t total = 0;
+    for (const auto ii : order)
+    {
+        entries.push_back(*zipFile.lookup(members[ii].name));
+        total += members[ii].data.size();
+    }
+
+    for (const size_t numThreads : { 1, 3, 16 })
+    {
+        std::vector<sys::ubyte> buffer(total + 10, 0xff);
+        const std::vector<sys::Size_T> offsets = zipFile.decompress(
+                entries, buffer.data(), buffer.size(), numThreads);
+        TEST_ASSERT_EQ(offsets.size(), entries.size() + 1);
+        TEST_ASSERT_EQ(offsets[0], static_cast<sys::Size_T>(0));
+        for (size_t ii = 0; ii < order.size(); ++ii)
+        {
+            const std::string& data = members[order[ii]].data;
+            TEST_ASSERT_EQ(offsets[ii + 1] - offsets[ii], data.size());
+            const std::string result(
+                    reinterpret_cast<const char*>(&buffer[offsets[ii]]),
+                    data.size());
+            TEST_ASSERT_TRUE(result == data);
+        }
+        TEST_ASSERT_EQ(offsets.back(), total);
+
+        // Nothing past the end is touched
+        TEST_ASSERT_EQ(buffer[total], 0xff);
+    }
+
+    // Nothing at all is a no-op
+    const std::vector<sys::Size_T> none =
+            zipFile.decompress({}, nullptr, 0, 4);
+    TEST_ASSERT_EQ(none.size(), static_cast<size_t>(1));
+    TEST_ASSERT_EQ(none[0], static_cast<sys::Size_T>(0));
+}
+
+TEST_CASE(testDecompressSmallEntries)
+{
+    // A local extra field longer than the guess at the header's length
+    // takes a second read; one that fits takes only the first
+    const std::vector<Member> members = {
+            Member("fits.txt", makeData(3000, 10), true, 100),
+            Member("long_extra.txt", makeData(3000, 11), true, 5000),
+            Member("tiny.txt", "x") };
+    ArchiveStream input(makeArchive(members));
+    const zip::ZipFile zipFile(&input);
+
+    // Twice, so the second time round uses pooled inflaters
+    for (size_t pass = 0; pass < 2; ++pass)
+    {
+        for (const auto& member : members)
+        {
+            const zip::ZipEntry& entry = **zipFile.lookup(member.name);
+            std::vector<sys::ubyte> buffer(member.data.size());
+            entry.decompress(buffer.data(), buffer.size());
+            const std::string result(buffer.begin(), buffer.end());
+            TEST_ASSERT_TRUE(result == member.data);
+        }
+    }
+}
+
+TEST_CASE(testDecompressBufferTooSmall)
+{
+    const std::vector<Member> members = {
+            Member("a.txt", makeData(1000, 12)),
+            Member("b.txt", makeData(2000, 13)) };
+    ArchiveStream input(makeArchive(members));
+    const zip::ZipFile zipFile(&input);
+    const std::vector<const zip::ZipEntry*> entries(zipFile.begin(),
+                                                    zipFile.end());
+
+    std::vector<sys::ubyte> buffer(2999, 0xff);
+    TEST_SPECIFIC_EXCEPTION(
+            zipFile.decompress(entries, buffer.data(), buffer.size(), 2),
+            except::InvalidArgumentException);
+
+    // Nothing is written before it gives up
+    TEST_ASSERT_TRUE(std::all_of(buffer.begin(), buffer.end(),
+                                 [](sys::ubyte b) { return b == 0xff; }));
+}
+
+TEST_CASE(testConcurrentDecompress)
+{
+    std::vector<Member> members;
+    for (size_t ii = 0; ii < 40; ++ii)
+    {
+        members.push_back(Member("entry" + std::to_string(ii) + ".txt",
+                                 makeData(1000 + ii * 500, ii)));
+    }
+    ArchiveStream input(makeArchive(members));
+    const zip::ZipFile zipFile(&input);
+    const std::vector<const zip::ZipEntry*> entries(zipFile.begin(),
+                                                    zipFile.end());
+    std::string expected;
+    for (const auto& member : members)
+    {
+        expected += member.data;
+    }
+
+    // Every thread's decompress() draws on the same InflaterPool
+    const size_t numCallers = 8;
+    std::vector<std::string> results(numCallers);
+    std::vector<std::thread> callers;
+    for (size_t ii = 0; ii < numCallers; ++ii)
+    {
+        callers.emplace_back([&, ii]()
+        {
+            for (size_t pass = 0; pass < 5; ++pass)
+            {
+                std::vector<sys::ubyte> buffer(expected.size());
+                zipFile.decompress(entries, buffer.data(), buffer.size(), 3);
+                results[ii].assign(buffer.begin(), buffer.end());
+                if (results[ii] != expected)
+                {
+                    return;
+                }
+            }
+        });
+    }
+    for (auto& caller : callers)
+    {
+        caller.join();
+    }
+    for (const auto& result : results)
+    {
+        TEST_ASSERT_TRUE(result == expected);
+    }
+}
+
+TEST_CASE(testInflaterPool)
+{
+    zip::InflaterPool pool(1);
+
+    // A released inflater is handed out again, ready for a new stream
+    zip::InflaterPool::Inflater* const first =
+            zip::InflaterPool::acquire(&pool);
+    zip::InflaterPool::Inflater* const second =
+            zip::InflaterPool::acquire(&pool);
+    TEST_ASSERT_TRUE(first != second);
+    zip::InflaterPool::release(&pool, first);
+    zip::InflaterPool::release(&pool, second); // past maxIdle, so freed
+    zip::InflaterPool::Inflater* const again =
+            zip::InflaterPool::acquire(&pool);
+    TEST_ASSERT_TRUE(again == first);
+
+    const std::string data = makeData(10000, 14);
+    std::string compressed = rawDeflate(data);
+    const auto inflateWith = [&](zip::InflaterPool::Inflater& inflater)
+    {
+        std::string result(data.size(), '\0');
+        z_stream& stream = inflater.stream;
+        stream.next_in = reinterpret_cast<Bytef*>(&compressed[0]);
+        stream.avail_in = static_cast<uInt>(compressed.size());
+        stream.next_out = reinterpret_cast<Bytef*>(&result[0]);
+        stream.avail_out = static_cast<uInt>(result.size());
+        TEST_ASSERT_EQ(inflate(&stream, Z_FINISH), Z_STREAM_END);
+        TEST_ASSERT_TRUE(result == data);
+    };
+    inflateWith(*again);
+    zip::InflaterPool::release(&pool, again);
+
+    // Having been reset, the pooled one starts a new stream
+    zip::InflaterPool::Inflater* const reused =
+            zip::InflaterPool::acquire(&pool);
+    TEST_ASSERT_TRUE(reused == first);
+    inflateWith(*reused);
+    zip::InflaterPool::release(&pool, reused);
+
+    // Without a pool each one is new, and freed on release; NULL is ignored
+    zip::InflaterPool::Inflater* const unpooled =
+            zip::InflaterPool::acquire(nullptr);
+    inflateWith(*unpooled);
+    zip::InflaterPool::release(nullptr, unpooled);
+    zip::InflaterPool::release(&pool, nullptr);
+}
+
+TEST_MAIN(
+    TEST_CHECK(testZip64);
+    TEST_CHECK(testZip64BadCentralDir);
+    TEST_CHECK(testExtract);
+    TEST_CHECK(testExtractRefusesUnsafeNames);
+    TEST_CHECK(testCRCMismatch);
+    TEST_CHECK(testLookup);
+    TEST_CHECK(testDecompress);
+    TEST_CHECK(testDecompressSmallEntries);
+    TEST_CHECK(testDecompressBufferTooSmall);
+    TEST_CHECK(testConcurrentDecompress);
+    TEST_CHECK(testInflaterPool);
+    )
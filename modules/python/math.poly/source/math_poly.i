@@ -30,6 +30,153 @@ typedef math::linear::Vector<double> VectorDouble;
 #include "numpyutils/numpyutils.h"
 #include "Python.h"
 #include "numpy/arrayobject.h"
+#include "mt/Runnable1D.h"
+
+namespace
+{
+// Arrays are only split between threads in pieces of at least this many
+// points
+const size_t MIN_POINTS_PER_THREAD = 64 * 1024;
+
+// Lets other Python threads run while we're evaluating
+class ReleaseGIL
+{
+public:
+    ReleaseGIL() :
+        mState(PyEval_SaveThread())
+    {
+    }
+
+    ~ReleaseGIL()
+    {
+        PyEval_RestoreThread(mState);
+    }
+
+private:
+    ReleaseGIL(const ReleaseGIL&);
+    ReleaseGIL& operator=(const ReleaseGIL&);
+
+    PyThreadState* const mState;
+};
+
+// Calls evaluate(start, count) on one of numPieces even pieces of numItems
+template <typename EvaluateT>
+class EvaluatePiece
+{
+public:
+    EvaluatePiece(const EvaluateT& evaluate,
+                  size_t numItems,
+                  size_t numPieces) :
+        mEvaluate(evaluate),
+        mNumItems(numItems),
+        mNumPieces(numPieces)
+    {
+    }
+
+    void operator()(size_t piece) const
+    {
+        const size_t start = piece * mNumItems / mNumPieces;
+        const size_t end = (piece + 1) * mNumItems / mNumPieces;
+        mEvaluate(start, end - start);
+    }
+
+private:
+    const EvaluateT& mEvaluate;
+    const size_t mNumItems;
+    const size_t mNumPieces;
+};
+
+/*
+ * Splits numItems of pointsPerItem points each between up to numThreads
+ * threads (0 for one per CPU), and runs evaluate(start, count) on each
+ * piece without the GIL
+ */
+template <typename EvaluateT>
+void evaluateInPieces(const EvaluateT& evaluate,
+                      size_t numItems,
+                      size_t pointsPerItem,
+                      size_t numThreads)
+{
+    if (numThreads == 0)
+    {
+        numThreads = sys::OS().getNumCPUs();
+    }
+    const size_t minItemsPerThread = std::max<size_t>(
+            1, MIN_POINTS_PER_THREAD / std::max<size_t>(1, pointsPerItem));
+    numThreads = std::max<size_t>(
+            1, std::min(numThreads, numItems / minItemsPerThread));
+
+    const EvaluatePiece<EvaluateT> op(evaluate, numItems, numThreads);
+    ReleaseGIL releaseGIL;
+    mt::run1D(numThreads, numThreads, op);
+}
+
+// Owns a new reference
+class PyObjectRef
+{
+public:
+    explicit PyObjectRef(PyObject* object = NULL) :
+        mObject(object)
+    {
+    }
+
+    ~PyObjectRef()
+    {
+        Py_XDECREF(mObject);
+    }
+
+    PyObject* get() const
+    {
+        return mObject;
+    }
+
+    PyObject* release()
+    {
+        PyObject* const object = mObject;
+        mObject = NULL;
+        return object;
+    }
+
+private:
+    PyObjectRef(const PyObjectRef&);
+    PyObjectRef& operator=(const PyObjectRef&);
+
+    PyObject* mObject;
+};
+
+// A new reference to 'output' after checking it, or to a new array of
+// doubles of 'dims' if it's None
+PyObject* prepareOutput(PyObject* output, int numDims, const npy_intp* dims)
+{
+    const bool isNew = output == Py_None;
+    numpyutils::createOrVerify(output, NPY_DOUBLE, numDims, dims);
+    if (!isNew)
+    {
+        Py_INCREF(output);
+    }
+    return output;
+}
+
+// Same as above, shaped like the array 'shapeOf'
+PyObject* prepareOutputLike(PyObject* output, PyObject* shapeOf)
+{
+    PyArrayObject* const array = reinterpret_cast<PyArrayObject*>(shapeOf);
+    return prepareOutput(output, PyArray_NDIM(array), PyArray_DIMS(array));
+}
+
+// Results are written as inputs are read, so they mustn't share memory
+void verifyNoOverlap(PyObject* input, PyObject* output)
+{
+    const double* const in = numpyutils::getBuffer<double>(input);
+    const double* const out = numpyutils::getBuffer<double>(output);
+    if (in < out + numpyutils::getNumElements(output) &&
+        out < in + numpyutils::getNumElements(input))
+    {
+        throw except::Exception(Ctxt(
+                "Output array can't share memory with an input"));
+    }
+}
+}
 %}
 
 typedef math::linear::VectorN<3,double> Vector3;
@@ -126,6 +273,33 @@ typedef math::linear::Vector<double> VectorDouble;
         return pyresult;
     }
 
+    /*
+     * Evaluates at every point of an array (or anything NumPy can turn into
+     * one), writing to 'output' if it's given, or to a new array shaped like
+     * the input if it's None.  The GIL is released while evaluating, which
+     * is split between up to numThreads threads (0 for one per CPU).
+     */
+    PyObject* evaluate(PyObject* input, PyObject* output = Py_None,
+                       size_t numThreads = 0)
+    {
+        PyObjectRef at(numpyutils::toContiguousArray(input, NPY_DOUBLE));
+        PyObjectRef out(prepareOutputLike(output, at.get()));
+        verifyNoOverlap(at.get(), out.get());
+
+        const math::poly::OneD<double>& poly = *self;
+        const double* const x = numpyutils::getBuffer<double>(at.get());
+        double* const y = numpyutils::getBuffer<double>(out.get());
+        const auto evaluatePoints = [&](size_t start, size_t count)
+        {
+            poly.evaluate(coda_oss::span<const double>(x + start, count),
+                          coda_oss::span<double>(y + start, count));
+        };
+        evaluateInPieces(evaluatePoints,
+                         numpyutils::getNumElements(at.get()), 1,
+                         numThreads);
+        return out.release();
+    }
+
     PyObject* asArray()
     {
         if (!self->empty())
@@ -276,6 +450,76 @@ typedef math::linear::Vector<double> VectorDouble;
         }
         return numpyutils::toNumpyArray(numColumns, NPY_DOUBLE, rows);
     }
+
+    /*
+     * Evaluates at every (xs[i], ys[i]) of two arrays with the same number
+     * of elements, writing to 'output' if it's given, or to a new array
+     * shaped like xs if it's None.  The GIL is released while evaluating,
+     * which is split between up to numThreads threads (0 for one per CPU).
+     */
+    PyObject* evaluate(PyObject* x_input, PyObject* y_input,
+                       PyObject* output = Py_None, size_t numThreads = 0)
+    {
+        PyObjectRef xs(numpyutils::toContiguousArray(x_input, NPY_DOUBLE));
+        PyObjectRef ys(numpyutils::toContiguousArray(y_input, NPY_DOUBLE));
+        const size_t numPoints = numpyutils::getNumElements(xs.get());
+        if (numpyutils::getNumElements(ys.get()) != numPoints)
+        {
+            throw except::Exception(Ctxt(
+                    "Input arrays must have the same number of elements"));
+        }
+        PyObjectRef out(prepareOutputLike(output, xs.get()));
+        verifyNoOverlap(xs.get(), out.get());
+        verifyNoOverlap(ys.get(), out.get());
+
+        const math::poly::TwoD<double>& poly = *self;
+        const double* const x = numpyutils::getBuffer<double>(xs.get());
+        const double* const y = numpyutils::getBuffer<double>(ys.get());
+        double* const z = numpyutils::getBuffer<double>(out.get());
+        const auto evaluatePoints = [&](size_t start, size_t count)
+        {
+            poly.evaluate(coda_oss::span<const double>(x + start, count),
+                          coda_oss::span<const double>(y + start, count),
+                          coda_oss::span<double>(z + start, count));
+        };
+        evaluateInPieces(evaluatePoints, numPoints, 1, numThreads);
+        return out.release();
+    }
+
+    /*
+     * Evaluates at every point of the grid xs by ys, writing
+     * (len(xs), len(ys)) results to 'output' if it's given, or to a new
+     * array if it's None.  Threading is as in evaluate().
+     */
+    PyObject* evaluateGrid(PyObject* x_input, PyObject* y_input,
+                           PyObject* output = Py_None,
+                           size_t numThreads = 0)
+    {
+        PyObjectRef xs(numpyutils::toContiguousArray(x_input, NPY_DOUBLE));
+        PyObjectRef ys(numpyutils::toContiguousArray(y_input, NPY_DOUBLE));
+        const size_t numRows = numpyutils::getNumElements(xs.get());
+        const size_t numCols = numpyutils::getNumElements(ys.get());
+        const npy_intp dims[] = {static_cast<npy_intp>(numRows),
+                                 static_cast<npy_intp>(numCols)};
+        PyObjectRef out(prepareOutput(output, 2, dims));
+        verifyNoOverlap(xs.get(), out.get());
+        verifyNoOverlap(ys.get(), out.get());
+
+        const math::poly::TwoD<double>& poly = *self;
+        const double* const x = numpyutils::getBuffer<double>(xs.get());
+        const coda_oss::span<const double> y(
+                numpyutils::getBuffer<double>(ys.get()), numCols);
+        double* const z = numpyutils::getBuffer<double>(out.get());
+        const auto evaluateRows = [&](size_t start, size_t count)
+        {
+            poly.evaluateGrid(coda_oss::span<const double>(x + start, count),
+                              y,
+                              coda_oss::span<double>(z + start * numCols,
+                                                     count * numCols));
+        };
+        evaluateInPieces(evaluateRows, numRows, numCols, numThreads);
+        return out.release();
+    }
     %pythoncode
     %{
         @staticmethod
@@ -72,7 +72,7 @@ if __name__ == '__main__':
 
     # Pickle and unpickle
     pPoly1D = pickle.loads(pickle.dumps(poly1D))
-    if pPoly1D.coeffs() == poly1D.coeffs():
+    if list(pPoly1D.coeffs()) == list(poly1D.coeffs()):
         print('Pickling and unpickling 1D matched as expected')
     else:
         sys.exit('Pickling 1D did not match!')
@@ -425,3 +425,47 @@ if __name__ == '__main__':
     assert isinstance(original.asArray(), np.ndarray)
 
 
+
+
+    ##############################
+    # Vectorized evaluation test #
+    ##############################
+    # evaluate()/evaluateGrid() are declared in math_poly.i; they only
+    # exist once the wrappers have been regenerated with ENABLE_SWIG=ON
+    if not hasattr(Poly1D, 'evaluate'):
+        print("Skipping vectorized evaluation; wrappers predate evaluate()")
+    else:
+        poly1D = Poly1D([1.0, -2.0, 0.5, 0.25])
+        x = np.linspace(-3.0, 3.0, 300).reshape(20, 15)
+        expected = np.array([[poly1D(float(value)) for value in row] for row in x])
+        print("Evaluating 1D polynomial over a numpy array")
+        if not np.allclose(poly1D.evaluate(x), expected):
+            sys.exit('1D evaluate did not match!')
+        output = np.empty_like(x)
+        poly1D.evaluate(x, output, 2)
+        if not np.allclose(output, expected):
+            sys.exit('1D evaluate into an output array did not match!')
+
+        threw = False
+        try:
+            poly1D.evaluate(x, np.empty(3))
+        except RuntimeError:
+            threw = True
+        if not threw:
+            sys.exit('1D evaluate into the wrong size array did not throw!')
+
+        xs = np.linspace(-1.0, 2.0, 40)
+        ys = np.linspace(0.5, -3.0, 40)
+        print("Evaluating 2D polynomial over numpy arrays")
+        expected = np.array([original(float(xx), float(yy))
+                             for xx, yy in zip(xs, ys)])
+        if not np.allclose(original.evaluate(xs, ys), expected):
+            sys.exit('2D evaluate did not match!')
+
+        ys = ys[:25]
+        grid = original.evaluateGrid(xs, ys)
+        expected = np.array([[original(float(xx), float(yy)) for yy in ys]
+                             for xx in xs])
+        if grid.shape != (40, 25) or not np.allclose(grid, expected):
+            sys.exit('2D evaluateGrid did not match!')
+        print("Vectorized evaluation successful")
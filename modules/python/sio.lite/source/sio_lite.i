@@ -10,6 +10,68 @@
 
 %{
     #include "import/sio/lite.h"
+
+namespace
+{
+// Lets other Python threads run while we're reading
+class ReleaseGIL
+{
+public:
+    ReleaseGIL() :
+        mState(PyEval_SaveThread())
+    {
+    }
+
+    ~ReleaseGIL()
+    {
+        PyEval_RestoreThread(mState);
+    }
+
+private:
+    ReleaseGIL(const ReleaseGIL&);
+    ReleaseGIL& operator=(const ReleaseGIL&);
+
+    PyThreadState* const mState;
+};
+
+// The memory behind any object supporting the buffer protocol, such as a
+// NumPy array, for as long as this is around
+class BufferView
+{
+public:
+    BufferView(PyObject* object, int flags)
+    {
+        if (PyObject_GetBuffer(object, &mBuffer,
+                               flags | PyBUF_C_CONTIGUOUS) < 0)
+        {
+            // Python's error is left set to say why
+            throw except::Exception(Ctxt(
+                    "Expected an object with a C-contiguous buffer"));
+        }
+    }
+
+    ~BufferView()
+    {
+        PyBuffer_Release(&mBuffer);
+    }
+
+    void* data() const
+    {
+        return mBuffer.buf;
+    }
+
+    size_t size() const
+    {
+        return static_cast<size_t>(mBuffer.len);
+    }
+
+private:
+    BufferView(const BufferView&);
+    BufferView& operator=(const BufferView&);
+
+    Py_buffer mBuffer;
+};
+}
 %}
 
 // NOTE: In the cases below, need to use 'long long' rather
@@ -42,10 +104,36 @@
 };
 
 
+%extend sio::lite::FileReader
+{
+    /*
+     * Reads the whole image straight into 'buffer', e.g. a NumPy array,
+     * which must be C-contiguous, writeable and big enough.  Elements end up
+     * in this system's byte order.  The GIL is released while reading,
+     * which is split between up to numThreads threads (0 for one per CPU).
+     */
+    void readInto(PyObject* buffer, size_t numThreads = 0)
+    {
+        const BufferView view(buffer, PyBUF_WRITABLE);
+        const sio::lite::FileHeader* const header = $self->getHeader();
+        const types::RowCol<size_t> dims(
+                static_cast<size_t>(header->getNumLines()),
+                static_cast<size_t>(header->getNumElements()));
+        const coda_oss::span<sys::byte> bytes(
+                static_cast<sys::byte*>(view.data()), view.size());
+
+        ReleaseGIL releaseGIL;
+        $self->readWindow(types::RowCol<size_t>(0, 0), dims, bytes,
+                          numThreads);
+    }
+};
+
 %include "sio/lite/FileHeader.h"
 %include "sio/lite/FileWriter.h"
+%include "sio/lite/SioFileWriter.h"
 %include "sio/lite/StreamReader.h"
 %include "sio/lite/FileReader.h"
+%include "sio/lite/SioFileReader.h"
 
 %pythoncode
 %{
@@ -131,4 +219,22 @@ def read(inputPathname):
     pointer, ro = numpyArray.__array_interface__['data']
     reader.read(pointer, numpyArray.shape[0] * numpyArray.shape[1] * elementSize)
     return numpyArray;
+
+def readSIO(inputPathname, numThreads = 0):
+    """
+    Read an SIO straight into a new NumPy array in this system's byte
+    order (read() leaves it in the file's).  The array is handed to C++
+    as a buffer rather than an address, and is filled without the GIL,
+    split between numThreads threads (0 for one per CPU).
+    """
+    reader = FileReader(inputPathname)
+    header = reader.getHeader()
+
+    dtype = dtypeFromSioType(header.getElementType(),
+                             header.getElementSize())
+    numpyArray = numpy.empty(shape = (header.getNumLines(),
+                                      header.getNumElements()),
+                             dtype = dtype)
+    reader.readInto(numpyArray, numThreads)
+    return numpyArray
 %}
@@ -24,6 +24,7 @@
  *
 """
 
+from coda import sio_lite
 from coda.sio_lite import read
 import sys
 
@@ -38,4 +39,17 @@ if __name__ == '__main__':
     
     print("Dims: " + str(array.shape))
     print("Type: " + str(array.dtype))
-    
+
+    # readSIO() is declared in sio_lite.i; it only exists once the
+    # wrappers have been regenerated with ENABLE_SWIG=ON
+    if not hasattr(sio_lite, 'readSIO'):
+        print("Skipping readSIO(); wrappers predate it")
+    else:
+        # readSIO() gives the same image, in this system's byte order
+        native = sio_lite.readSIO(inputPathname)
+        reader = sio_lite.FileReader(inputPathname)
+        if reader.getHeader().isDifferentByteOrdering():
+            array = array.byteswap()
+        if native.shape != array.shape or native.tobytes() != array.tobytes():
+            sys.exit('readSIO() did not match read()!')
+        print("readSIO() matched read()")